@@ -0,0 +1,195 @@
+// Times full-series indicator evaluation: the previous per-index algorithms
+// (each index recomputed from its window) against one pass of the
+// incremental indicators in indicators.h.
+//
+//   bench_indicators [candles]
+//
+// Default is 1M candles of a deterministic random walk, SMA/EMA 50, RSI 14
+// and MACD 12/26/9. The per-index versions are reproduced here as they were
+// before the incremental rewrite, so the numbers stay comparable.
+//
+// A second table times the batch kernels in indicator_kernels.h over
+// column data, scalar against AVX2 (when the CPU has it), and reports the
+// input bandwidth of each.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <numeric>
+#include <random>
+#include <vector>
+
+#include "core/candle.h"
+#include "indicator_kernels.h"
+#include "indicators.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+namespace legacy {
+
+double sma(const std::vector<Core::Candle> &c, std::size_t index, std::size_t period) {
+  if (period == 0 || index >= c.size() || index + 1 < period)
+    return 0.0;
+  const auto begin = c.begin() + static_cast<long>(index + 1 - period);
+  const auto end = c.begin() + static_cast<long>(index) + 1;
+  return std::accumulate(begin, end, 0.0,
+                         [](double acc, const Core::Candle &x) { return acc + x.close; }) /
+         static_cast<double>(period);
+}
+
+double ema(const std::vector<Core::Candle> &c, std::size_t index, std::size_t period) {
+  if (period == 0 || index >= c.size() || index + 1 < period)
+    return 0.0;
+  const double k = 2.0 / (static_cast<double>(period) + 1.0);
+  double e = sma(c, index - (period > 1 ? 1 : 0), period);
+  for (std::size_t i = index + 1 - period; i <= index; ++i)
+    e = (c[i].close - e) * k + e;
+  return e;
+}
+
+double rsi(const std::vector<Core::Candle> &c, std::size_t index, std::size_t period) {
+  if (period == 0 || index >= c.size() || index + 1 < period)
+    return 0.0;
+  double gain = 0.0, loss = 0.0;
+  for (std::size_t i = index + 2 - period; i <= index; ++i) {
+    const double change = c[i].close - c[i - 1].close;
+    if (change > 0)
+      gain += change;
+    else
+      loss -= change;
+  }
+  if (loss == 0.0)
+    return 100.0;
+  return 100.0 - 100.0 / (1.0 + gain / loss);
+}
+
+double macd_line(const std::vector<Core::Candle> &c, std::size_t index, std::size_t fast,
+                 std::size_t slow) {
+  if (index >= c.size() || index + 1 < slow)
+    return 0.0;
+  return ema(c, index, fast) - ema(c, index, slow);
+}
+
+double macd_signal(const std::vector<Core::Candle> &c, std::size_t index, std::size_t fast,
+                   std::size_t slow, std::size_t signal) {
+  if (index >= c.size() || index + 1 < slow + signal - 1)
+    return 0.0;
+  const double k = 2.0 / (static_cast<double>(signal) + 1.0);
+  double s = macd_line(c, index + 1 - signal, fast, slow);
+  for (std::size_t i = index + 2 - signal; i <= index; ++i)
+    s = (macd_line(c, i, fast, slow) - s) * k + s;
+  return s;
+}
+
+} // namespace legacy
+
+template <typename F> double seconds(F &&f) {
+  const auto start = Clock::now();
+  f();
+  return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+volatile double g_sink = 0.0;
+
+} // namespace
+
+int main(int argc, char **argv) {
+  const std::size_t n = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1'000'000;
+  std::mt19937_64 rng(42);
+  std::normal_distribution<double> step(0.0, 1.0);
+  std::vector<Core::Candle> candles;
+  candles.reserve(n);
+  double price = 1000.0;
+  for (std::size_t i = 0; i < n; ++i) {
+    price += step(rng);
+    candles.emplace_back(static_cast<long long>(i) * 60'000, price, price, price, price, 1.0);
+  }
+
+  struct Row {
+    const char *name;
+    double before;
+    double after;
+  };
+  std::vector<Row> rows;
+  auto measure = [&](const char *name, auto &&per_index, auto &&one_pass) {
+    const double before = seconds([&] {
+      double acc = 0.0;
+      for (std::size_t i = 0; i < n; ++i)
+        acc += per_index(i);
+      g_sink = acc;
+    });
+    const double after = seconds([&] { g_sink = one_pass(); });
+    rows.push_back({name, before, after});
+  };
+
+  measure(
+      "SMA(50)", [&](std::size_t i) { return legacy::sma(candles, i, 50); },
+      [&] { return Signal::sma_series(candles, 50).back(); });
+  measure(
+      "EMA(50)", [&](std::size_t i) { return legacy::ema(candles, i, 50); },
+      [&] { return Signal::ema_series(candles, 50).back(); });
+  measure(
+      "RSI(14)", [&](std::size_t i) { return legacy::rsi(candles, i, 14); },
+      [&] { return Signal::rsi_series(candles, 14).back(); });
+  measure(
+      "MACD(12,26,9)",
+      [&](std::size_t i) {
+        return legacy::macd_line(candles, i, 12, 26) - legacy::macd_signal(candles, i, 12, 26, 9);
+      },
+      [&] { return Signal::macd_series(candles, 12, 26, 9).back().histogram; });
+
+  std::printf("%zu candles\n%-14s %12s %12s %9s\n", n, "indicator", "per-index s", "one-pass s",
+              "speedup");
+  for (const auto &r : rows)
+    std::printf("%-14s %12.4f %12.4f %8.0fx\n", r.name, r.before, r.after, r.before / r.after);
+
+  // Batch kernels: best of a few runs, since each pass is short.
+  const auto cols = Signal::to_columns(candles);
+  std::vector<double> out(n);
+  struct Kernel {
+    const char *name;
+    std::size_t inputs;
+    void (*run)(const Signal::CandleColumns &, std::vector<double> &);
+  };
+  const Kernel kernels[] = {
+      {"SMA(50)", 1, [](const auto &c, auto &o) { Signal::compute_sma(c.close, 50, o); }},
+      {"EMA(50)", 1, [](const auto &c, auto &o) { Signal::compute_ema(c.close, 50, o); }},
+      {"RSI(14)", 1, [](const auto &c, auto &o) { Signal::compute_rsi(c.close, 14, o); }},
+      {"min(50)", 1, [](const auto &c, auto &o) { Signal::compute_rolling_min(c.low, 50, o); }},
+      {"max(50)", 1, [](const auto &c, auto &o) { Signal::compute_rolling_max(c.high, 50, o); }},
+      {"stddev(20)", 1,
+       [](const auto &c, auto &o) { Signal::compute_rolling_stddev(c.close, 20, o); }},
+      {"true range", 3,
+       [](const auto &c, auto &o) { Signal::compute_true_range(c.high, c.low, c.close, o); }},
+  };
+  auto best_of = [&](const Kernel &k) {
+    double best = 1e30;
+    for (int rep = 0; rep < 5; ++rep) {
+      best = std::min(best, seconds([&] { k.run(cols, out); }));
+      g_sink = out.back();
+    }
+    return best;
+  };
+  const bool avx2 = Signal::avx2_available();
+  std::printf("\nbatch kernels (%s)\n%-14s %12s %9s %12s %9s %9s\n",
+              avx2 ? "avx2 available" : "scalar only", "kernel", "scalar ms", "GB/s", "avx2 ms",
+              "GB/s", "speedup");
+  const auto saved = Signal::kernel_isa();
+  for (const auto &k : kernels) {
+    const double bytes = static_cast<double>(n * (k.inputs + 1) * sizeof(double));
+    Signal::set_kernel_isa(Signal::KernelIsa::Scalar);
+    const double scalar = best_of(k);
+    std::printf("%-14s %12.3f %9.2f", k.name, scalar * 1e3, bytes / scalar / 1e9);
+    if (avx2) {
+      Signal::set_kernel_isa(Signal::KernelIsa::Avx2);
+      const double vector = best_of(k);
+      std::printf(" %12.3f %9.2f %8.1fx", vector * 1e3, bytes / vector / 1e9, scalar / vector);
+    }
+    std::printf("\n");
+  }
+  Signal::set_kernel_isa(saved);
+  return 0;
+}
@@ -0,0 +1,193 @@
+// Replays depth traffic through Core::OrderBook and reports throughput.
+//
+//   bench_order_book [depth.jsonl] [passes]
+//
+// depth.jsonl holds one Binance message per line, as captured from the
+// stream: depthUpdate events (bare or in a combined-stream envelope) and
+// optionally a REST snapshot ({"lastUpdateId",...}) first. Without a file a
+// deterministic synthetic session is generated: 200k diffs around a
+// drifting mid, 1-20 levels each, mostly within ten ticks of the touch.
+// The headline number is end-to-end replay: each message parsed from its
+// text and applied, as the stream does. Parsing (direct scan and, for
+// comparison, the nlohmann DOM) and book updates are also timed apart.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <optional>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+#include "core/depth_parsers.h"
+#include "core/order_book.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+std::vector<std::string> synthetic_session(std::size_t diffs) {
+  std::mt19937_64 rng(42);
+  std::uniform_int_distribution<int> levels(1, 20);
+  std::geometric_distribution<int> distance(0.3);
+  std::uniform_real_distribution<double> qty(0.0, 5.0);
+  std::bernoulli_distribution remove(0.3), drift(0.05), up(0.5);
+  const double tick = 0.01;
+  long long mid = 1'000'000; // in ticks
+
+  std::vector<std::string> lines;
+  nlohmann::json snap = {{"lastUpdateId", 1000}, {"bids", nlohmann::json::array()},
+                         {"asks", nlohmann::json::array()}};
+  for (int i = 1; i <= 1000; ++i) {
+    snap["bids"].push_back({std::to_string((mid - i) * tick), std::to_string(qty(rng))});
+    snap["asks"].push_back({std::to_string((mid + i) * tick), std::to_string(qty(rng))});
+  }
+  lines.push_back(snap.dump());
+  std::uint64_t id = 1001;
+  for (std::size_t n = 0; n < diffs; ++n) {
+    if (drift(rng))
+      mid += up(rng) ? 1 : -1;
+    nlohmann::json b = nlohmann::json::array(), a = nlohmann::json::array();
+    const int count = levels(rng);
+    for (int i = 0; i < count; ++i) {
+      const long long d = 1 + distance(rng);
+      const bool bid = up(rng);
+      const double q = remove(rng) ? 0.0 : qty(rng);
+      (bid ? b : a).push_back({std::to_string((bid ? mid - d : mid + d) * tick),
+                               std::to_string(q)});
+    }
+    const std::uint64_t first = id;
+    id += 1 + static_cast<std::uint64_t>(count / 4);
+    lines.push_back(nlohmann::json{{"e", "depthUpdate"}, {"E", n}, {"s", "BTCUSDT"},
+                                   {"U", first}, {"u", id - 1}, {"b", b}, {"a", a}}
+                        .dump());
+  }
+  return lines;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  std::vector<std::string> lines;
+  if (argc > 1) {
+    std::ifstream in(argv[1]);
+    if (!in) {
+      std::fprintf(stderr, "cannot open %s\n", argv[1]);
+      return 1;
+    }
+    for (std::string line; std::getline(in, line);)
+      if (!line.empty())
+        lines.push_back(std::move(line));
+  } else {
+    lines = synthetic_session(200'000);
+  }
+  const int passes = argc > 2 ? std::max(1, std::atoi(argv[2])) : 10;
+
+  std::optional<Core::DepthSnapshot> snapshot;
+  std::vector<std::string_view> messages;
+  messages.reserve(lines.size());
+  for (const auto &line : lines) {
+    if (!snapshot && line.find("\"lastUpdateId\"") != std::string::npos) {
+      auto j = nlohmann::json::parse(line, nullptr, false);
+      if (!j.is_discarded())
+        snapshot = Core::parse_binance_depth_snapshot(j.contains("data") ? j["data"] : j);
+      continue;
+    }
+    messages.push_back(line);
+  }
+
+  // Direct scan into reused diffs, kept for the apply-only measurement.
+  auto t0 = Clock::now();
+  std::vector<Core::DepthDiff> diffs;
+  diffs.reserve(messages.size());
+  Core::DepthDiff scratch;
+  for (const auto message : messages) {
+    if (Core::parse_binance_depth_update(message, scratch))
+      diffs.push_back(scratch);
+  }
+  const double parse_s = std::chrono::duration<double>(Clock::now() - t0).count();
+  if (diffs.empty()) {
+    std::fprintf(stderr, "no depthUpdate messages\n");
+    return 1;
+  }
+  if (!snapshot) {
+    // A capture without a snapshot starts from an empty book.
+    snapshot = Core::DepthSnapshot{};
+    snapshot->last_update_id = diffs.front().first_update_id - 1;
+  }
+  std::size_t level_updates = 0;
+  for (const auto &d : diffs)
+    level_updates += d.bids.size() + d.asks.size();
+
+  t0 = Clock::now();
+  std::size_t dom_parsed = 0;
+  for (const auto message : messages) {
+    auto j = nlohmann::json::parse(message, nullptr, false);
+    if (j.is_discarded())
+      continue;
+    if (j.contains("data"))
+      j = j["data"];
+    dom_parsed += Core::parse_binance_depth_update(j).has_value();
+  }
+  const double dom_s = std::chrono::duration<double>(Clock::now() - t0).count();
+
+  Core::OrderBook book;
+  std::size_t applied = 0, gaps = 0;
+  double checksum = 0.0;
+  auto apply = [&](const Core::DepthDiff &d) {
+    switch (book.apply_diff(d)) {
+    case Core::OrderBook::DiffResult::Applied:
+      ++applied;
+      break;
+    case Core::OrderBook::DiffResult::Gap:
+      // Keep measuring: resume from this diff as if resynchronised.
+      ++gaps;
+      book.apply_snapshot({d.final_update_id, {}, {}});
+      break;
+    case Core::OrderBook::DiffResult::Stale:
+      break;
+    }
+    if (!book.empty())
+      checksum += book.microprice();
+  };
+
+  t0 = Clock::now();
+  for (int p = 0; p < passes; ++p) {
+    book.apply_snapshot(*snapshot);
+    for (const auto message : messages) {
+      if (Core::parse_binance_depth_update(message, scratch))
+        apply(scratch);
+    }
+  }
+  const double replay_s = std::chrono::duration<double>(Clock::now() - t0).count();
+  const std::size_t replayed = applied;
+
+  applied = 0;
+  t0 = Clock::now();
+  for (int p = 0; p < passes; ++p) {
+    book.apply_snapshot(*snapshot);
+    for (const auto &d : diffs)
+      apply(d);
+  }
+  const double apply_s = std::chrono::duration<double>(Clock::now() - t0).count();
+
+  const double total_levels = static_cast<double>(level_updates) * passes;
+  std::printf("messages: %zu diffs, %zu level updates, %d passes\n", diffs.size(),
+              level_updates, passes);
+  std::printf("replay:   %.3f s, %.0f diffs/s end to end (parse + apply + microprice)\n",
+              replay_s, replayed / replay_s);
+  std::printf("parse:    %.3f s, %.0f diffs/s (direct scan); nlohmann DOM %.0f diffs/s\n",
+              parse_s, diffs.size() / parse_s, dom_parsed / dom_s);
+  std::printf("apply:    %.3f s, %.0f diffs/s, %.0f level updates/s "
+              "(incl. microprice per diff)\n",
+              apply_s, applied / apply_s, total_levels / apply_s);
+  std::printf("book:     %zu bids, %zu asks, %zu gaps, checksum %.3f\n",
+              book.depth(Core::OrderBook::Side::Bid),
+              book.depth(Core::OrderBook::Side::Ask), gaps, checksum);
+  return 0;
+}
@@ -0,0 +1,126 @@
+// Times a parameter sweep of expression rules (rule_program.h): how many
+// rule variants per second can be compiled and evaluated over one series.
+//
+//   bench_rules [candles]
+//
+// Default is 100k candles of a deterministic random walk. Each family is a
+// grid of buy/sell rules; "shared" evaluates them over a named series so
+// indicators repeated across variants come from the IndicatorCache, "cold"
+// clears the cache before every variant.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "core/candle.h"
+#include "indicator_cache.h"
+#include "rule_program.h"
+#include "strategy.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct Rule {
+  std::string buy;
+  std::string sell;
+};
+
+std::vector<Rule> rsi_grid() {
+  std::vector<Rule> rules;
+  for (int period : {7, 14, 21})
+    for (int low : {20, 25, 30, 35})
+      for (int high : {65, 70, 75, 80})
+        for (int trend : {50, 100, 200})
+          rules.push_back({"rsi(" + std::to_string(period) + ") < " + std::to_string(low) +
+                               " and close > ema(" + std::to_string(trend) + ")",
+                           "rsi(" + std::to_string(period) + ") > " + std::to_string(high)});
+  return rules;
+}
+
+std::vector<Rule> crossover_grid() {
+  std::vector<Rule> rules;
+  for (int fast = 3; fast <= 20; ++fast)
+    for (int slow = 30; slow <= 110; slow += 10) {
+      const std::string args = "sma(" + std::to_string(fast) + "), sma(" + std::to_string(slow) + ")";
+      rules.push_back({"cross_above(" + args + ")", "cross_below(" + args + ")"});
+    }
+  return rules;
+}
+
+std::vector<Rule> breakout_grid() {
+  std::vector<Rule> rules;
+  for (int back = 1; back <= 10; ++back)
+    for (double pct : {0.5, 1.0, 1.5, 2.0, 3.0})
+      for (int macd_fast : {8, 12})
+        rules.push_back(
+            {"close > prev(high, " + std::to_string(back) + ") * (1 + " + std::to_string(pct) +
+                 " / 100) and macd_hist(" + std::to_string(macd_fast) + ", 26, 9) > 0",
+             "close < prev(low, " + std::to_string(back) + ") or cross_below(macd(" +
+                 std::to_string(macd_fast) + ", 26, 9), macd_signal(" + std::to_string(macd_fast) +
+                 ", 26, 9))"});
+  return rules;
+}
+
+volatile long long g_sink = 0;
+
+} // namespace
+
+int main(int argc, char **argv) {
+  const std::size_t n = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 100'000;
+  std::mt19937_64 rng(42);
+  std::normal_distribution<double> step(0.0, 1.0);
+  std::vector<Core::Candle> candles;
+  candles.reserve(n);
+  double price = 1000.0;
+  for (std::size_t i = 0; i < n; ++i) {
+    price += step(rng);
+    candles.emplace_back(static_cast<long long>(i) * 60'000, price, price + 1.0, price - 1.0, price,
+                         1.0);
+  }
+
+  struct Family {
+    const char *name;
+    std::vector<Rule> rules;
+  };
+  const Family families[] = {
+      {"rsi + trend", rsi_grid()}, {"sma crossover", crossover_grid()}, {"breakout", breakout_grid()}};
+
+  auto &cache = Signal::IndicatorCache::instance();
+  const std::string id = Signal::series_id("BENCHUSDT", "1m");
+  std::vector<int> out(n);
+  auto sweep = [&](const std::vector<Rule> &rules, bool shared) {
+    cache.clear();
+    const auto start = Clock::now();
+    long long fired = 0;
+    for (const auto &rule : rules) {
+      if (!shared)
+        cache.clear();
+      std::string error;
+      const auto program = Signal::RuleProgram::compile(rule.buy, rule.sell, error);
+      if (!program) {
+        std::fprintf(stderr, "%s\n", error.c_str());
+        std::exit(1);
+      }
+      program->run({candles, id}, 0, out);
+      fired += std::count_if(out.begin(), out.end(), [](int s) { return s != 0; });
+    }
+    g_sink = fired;
+    return std::chrono::duration<double>(Clock::now() - start).count();
+  };
+
+  std::printf("%zu candles\n%-14s %9s %10s %12s %10s %12s\n", n, "family", "variants", "shared s",
+              "variants/s", "cold s", "variants/s");
+  for (const auto &f : families) {
+    const double shared = sweep(f.rules, true);
+    const double cold = sweep(f.rules, false);
+    const double count = static_cast<double>(f.rules.size());
+    std::printf("%-14s %9zu %10.4f %12.0f %10.4f %12.0f\n", f.name, f.rules.size(), shared,
+                count / shared, cold, count / cold);
+  }
+  return 0;
+}
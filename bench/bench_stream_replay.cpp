@@ -0,0 +1,226 @@
+// Replays a market-data recording through StreamMultiplexer and the per-series
+// KlineQueue hand-off, and reports throughput and per-stage latency.
+//
+//   bench_stream_replay [session.cmdr] [speed] [frame_ms]
+//
+// session.cmdr is a Binance recording made with CANDLE_MARKET_RECORD; every
+// kline stream seen in it is subscribed. speed scales the recorded pace
+// (default 0: as fast as possible). frame_ms is the consumer's drain period,
+// standing in for the UI frame (default 16). Without a file a deterministic
+// minute-boundary storm is generated: 100 pairs, 30 minutes, 20 forming
+// updates per pair and minute, every pair closing within 50 ms of the
+// boundary.
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+#include "core/candle_manager.h"
+#include "core/kline_queue.h"
+#include "core/latency_tracker.h"
+#include "core/market_data_recorder.h"
+#include "core/stream_multiplexer.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+using Series = std::pair<std::string, std::string>;
+
+// No event time: the synthetic clock is unrelated to ours, so the network
+// stage is not measured.
+std::string kline_message(const std::string &symbol, long long open_time, double close,
+                          bool closed) {
+  std::string lower = symbol;
+  std::transform(lower.begin(), lower.end(), lower.begin(),
+                 [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+  nlohmann::json j = {
+      {"stream", lower + "@kline_1m"},
+      {"data",
+       {{"e", "kline"},
+        {"k",
+         {{"t", open_time}, {"T", open_time + 59'999}, {"o", std::to_string(close - 1)},
+          {"h", std::to_string(close + 1)}, {"l", std::to_string(close - 2)},
+          {"c", std::to_string(close)}, {"v", "12.5"}, {"x", closed}}}}}};
+  return j.dump();
+}
+
+void synthetic_storm(Core::MarketDataReplayer &replayer, std::size_t pairs,
+                     std::size_t minutes, std::size_t updates) {
+  const long long base_ms = 1'700'000'040'000LL; // a minute boundary
+  std::vector<std::string> symbols;
+  for (std::size_t p = 0; p < pairs; ++p) {
+    char buf[16];
+    std::snprintf(buf, sizeof(buf), "S%03zuUSDT", p);
+    symbols.push_back(buf);
+  }
+  auto add = [&](Core::MarketDataRecord::Kind kind, long long time_us,
+                 std::string payload) {
+    Core::MarketDataRecord r;
+    r.kind = kind;
+    r.connection = 1;
+    r.time_us = time_us;
+    r.payload = std::move(payload);
+    replayer.add(std::move(r));
+  };
+  add(Core::MarketDataRecord::Kind::Open, 0, "wss://stream.binance.com/stream");
+  for (std::size_t m = 0; m < minutes; ++m) {
+    const long long open_ms = base_ms + static_cast<long long>(m) * 60'000;
+    const long long start_us = static_cast<long long>(m) * 60'000'000;
+    for (std::size_t u = 1; u <= updates; ++u)
+      for (std::size_t p = 0; p < pairs; ++p) {
+        const long long t = start_us + static_cast<long long>(u * 60'000'000 / (updates + 1)) +
+                            static_cast<long long>(p) * 100;
+        add(Core::MarketDataRecord::Kind::Message, t,
+            kline_message(symbols[p], open_ms, 100.0 + static_cast<double>(p + u), false));
+      }
+    // The closing storm: every pair within 50 ms of the boundary.
+    for (std::size_t p = 0; p < pairs; ++p) {
+      const long long t = start_us + 60'000'000 + static_cast<long long>(p) * 500;
+      add(Core::MarketDataRecord::Kind::Message, t,
+          kline_message(symbols[p], open_ms, 100.0 + static_cast<double>(p), true));
+    }
+  }
+}
+
+// Kline series named in the recording, e.g. "btcusdt@kline_1m" -> BTCUSDT 1m.
+std::set<Series> recorded_series(const std::filesystem::path &file) {
+  std::set<Series> out;
+  std::vector<Core::MarketDataRecord> records;
+  Core::MarketDataReplayer::read_file(file, records);
+  for (const auto &r : records) {
+    if (r.kind != Core::MarketDataRecord::Kind::Message)
+      continue;
+    auto j = nlohmann::json::parse(r.payload, nullptr, false);
+    if (!j.is_object() || !j.contains("stream"))
+      continue;
+    const std::string stream = j["stream"].get<std::string>();
+    const auto at = stream.find("@kline_");
+    if (at == std::string::npos)
+      continue;
+    std::string symbol = stream.substr(0, at);
+    std::transform(symbol.begin(), symbol.end(), symbol.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::toupper(c)); });
+    out.insert({symbol, stream.substr(at + 7)});
+  }
+  return out;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  Core::MarketDataReplayer::Options options;
+  options.speed = argc > 2 ? std::atof(argv[2]) : 0.0;
+  const auto frame = std::chrono::milliseconds(argc > 3 ? std::atoi(argv[3]) : 16);
+  auto replayer = std::make_shared<Core::MarketDataReplayer>(options);
+  std::set<Series> series;
+  if (argc > 1) {
+    if (replayer->load(argv[1]) == 0) {
+      std::fprintf(stderr, "could not read %s\n", argv[1]);
+      return 1;
+    }
+    series = recorded_series(argv[1]);
+  } else {
+    synthetic_storm(*replayer, 100, 30, 20);
+    for (std::size_t p = 0; p < 100; ++p) {
+      char buf[16];
+      std::snprintf(buf, sizeof(buf), "S%03zuUSDT", p);
+      series.insert({buf, "1m"});
+    }
+  }
+
+  const auto dir = std::filesystem::temp_directory_path() / "bench_stream_replay";
+  std::filesystem::remove_all(dir);
+  Core::CandleManager manager(dir);
+  Core::StreamMultiplexer mux("binance", manager, Core::replay_websocket_factory(replayer));
+  mux.set_live_update_interval(std::chrono::milliseconds(250));
+
+  std::map<Series, std::shared_ptr<Core::KlineQueue>> queues;
+  for (const auto &s : series) {
+    auto queue = std::make_shared<Core::KlineQueue>();
+    queues[s] = queue;
+    mux.bus()->on_candle_closed(
+        [queue](const Core::CandleEvent &e) {
+          queue->publish({e.candle, true, e.stamps ? *e.stamps : Core::LatencyStamps{}});
+        },
+        s.first, s.second);
+    mux.bus()->on_candle_update(
+        [queue](const Core::CandleEvent &e) {
+          queue->publish({e.candle, false, e.stamps ? *e.stamps : Core::LatencyStamps{}});
+        },
+        s.first, s.second);
+    mux.subscribe(s.first, s.second);
+  }
+
+  // Consumer: one drain of every queue per frame, as App::drain_stream_queues.
+  auto &tracker = Core::LatencyTracker::instance();
+  std::map<Series, std::vector<Core::Candle>> candles;
+  std::size_t frames = 0, applied = 0, busiest = 0;
+  std::atomic<bool> done{false};
+  auto drain = [&] {
+    std::size_t n = 0;
+    std::vector<Core::KlineUpdate> updates;
+    for (auto &[key, queue] : queues) {
+      updates.clear();
+      if (queue->drain(updates) == 0)
+        continue;
+      const long long merged = Core::LatencyTracker::steady_us();
+      auto &vec = candles[key];
+      for (const auto &u : updates) {
+        if (vec.empty() || u.candle.open_time > vec.back().open_time)
+          vec.push_back(u.candle);
+        else if (u.candle.open_time == vec.back().open_time)
+          vec.back() = u.candle;
+        if (u.stamps.parsed_us > 0)
+          tracker.record(Core::LatencyTracker::Stage::Merge, merged - u.stamps.parsed_us);
+      }
+      n += updates.size();
+    }
+    return n;
+  };
+  std::thread consumer([&] {
+    while (!done.load()) {
+      const auto next = Clock::now() + frame;
+      const std::size_t n = drain();
+      applied += n;
+      busiest = std::max(busiest, n);
+      ++frames;
+      std::this_thread::sleep_until(next);
+    }
+  });
+
+  const auto started = Clock::now();
+  mux.start();
+  replayer->wait_finished(std::chrono::hours(24));
+  const double replay_s = std::chrono::duration<double>(Clock::now() - started).count();
+  mux.stop(); // flushes pending forming bars and the batch writer
+  done = true;
+  consumer.join();
+  applied += drain();
+
+  const auto writes = mux.writer_stats();
+  std::printf("series %zu, frames %zu x %lld ms, speed %s\n", series.size(), frames,
+              static_cast<long long>(frame.count()),
+              options.speed > 0 ? std::to_string(options.speed).c_str() : "max");
+  std::printf("replay: %zu messages in %.3f s (%.0f msg/s)\n", replayer->delivered(),
+              replay_s, replayer->delivered() / replay_s);
+  std::printf("merge: %zu updates applied, busiest frame %zu\n", applied, busiest);
+  std::printf("persist: %llu candles in %llu commits\n",
+              static_cast<unsigned long long>(writes.candles),
+              static_cast<unsigned long long>(writes.commits));
+  std::printf("latency p50/p99 ms: %s\n", tracker.status_line().c_str());
+  std::filesystem::remove_all(dir);
+  return 0;
+}
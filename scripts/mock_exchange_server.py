@@ -0,0 +1,239 @@
+#!/usr/bin/env python3
+"""Local mock of the Binance and Hyperliquid kline endpoints.
+
+Serves deterministic synthetic candles so fetch throughput and error handling
+can be exercised offline. Point the terminal at it with
+
+    CANDLE_HYPERLIQUID_BASE_URL=http://127.0.0.1:8765
+    CANDLE_BINANCE_BASE_URL=http://127.0.0.1:8765
+
+Endpoints:
+    GET  /api/v3/klines        Binance klines (symbol, interval, startTime, endTime, limit)
+    GET  /api/v3/exchangeInfo  Binance exchange info (ETag / 304 supported)
+    GET  /api/v3/ticker/24hr   Binance 24h tickers
+    POST /info                 Hyperliquid {"type": "candleSnapshot", "req": {...}}
+
+Only the Python standard library is used.
+"""
+
+import argparse
+import hashlib
+import json
+import math
+import random
+import threading
+import time
+from http.server import BaseHTTPRequestHandler, ThreadingHTTPServer
+from urllib.parse import parse_qs, urlparse
+
+INTERVALS_MS = {
+    "1m": 60_000,
+    "3m": 180_000,
+    "5m": 300_000,
+    "15m": 900_000,
+    "30m": 1_800_000,
+    "1h": 3_600_000,
+    "2h": 7_200_000,
+    "4h": 14_400_000,
+    "1d": 86_400_000,
+}
+SYMBOLS = ["BTCUSDT", "ETHUSDT", "SOLUSDT", "BNBUSDT", "XRPUSDT", "DOGEUSDT"]
+
+
+def synth_candle(symbol, interval_ms, open_time):
+    """Deterministic OHLCV for (symbol, open_time): same inputs, same bar."""
+    digest = hashlib.sha256(f"{symbol}:{interval_ms}:{open_time}".encode()).digest()
+    rnd = random.Random(digest)
+    sym = int.from_bytes(hashlib.sha256(symbol.encode()).digest()[:2], "big")
+    # Smooth per-symbol wave so consecutive bars look like a price series.
+    base = 100.0 + sym % 1000 + 20.0 * math.sin(open_time / (interval_ms * 50.0))
+    o = base
+    c = base * (1.0 + rnd.uniform(-0.01, 0.01))
+    h = max(o, c) * (1.0 + rnd.uniform(0.0, 0.005))
+    low = min(o, c) * (1.0 - rnd.uniform(0.0, 0.005))
+    v = rnd.uniform(1.0, 1000.0)
+    n = rnd.randint(1, 500)
+    return open_time, o, h, low, c, v, n
+
+
+class TokenBucket:
+    def __init__(self, rate_per_s):
+        self.rate = rate_per_s
+        self.tokens = rate_per_s
+        self.last = time.monotonic()
+        self.lock = threading.Lock()
+
+    def take(self):
+        if self.rate <= 0:
+            return True
+        with self.lock:
+            now = time.monotonic()
+            self.tokens = min(self.rate, self.tokens + (now - self.last) * self.rate)
+            self.last = now
+            if self.tokens >= 1.0:
+                self.tokens -= 1.0
+                return True
+            return False
+
+
+class Handler(BaseHTTPRequestHandler):
+    server_version = "MockExchange/1.0"
+    opts = None
+    bucket = None
+    stats = {"requests": 0, "errors": 0, "throttled": 0}
+    stats_lock = threading.Lock()
+
+    def log_message(self, fmt, *args):
+        if self.opts.verbose:
+            super().log_message(fmt, *args)
+
+    # -- helpers -----------------------------------------------------------
+    def _count(self, key):
+        with self.stats_lock:
+            self.stats[key] += 1
+
+    def _send_json(self, status, payload, headers=None):
+        body = json.dumps(payload).encode()
+        self.send_response(status)
+        self.send_header("Content-Type", "application/json")
+        self.send_header("Content-Length", str(len(body)))
+        for k, v in (headers or {}).items():
+            self.send_header(k, v)
+        self.end_headers()
+        self.wfile.write(body)
+
+    def _gate(self):
+        """Apply latency, rate limiting and injected errors. True = continue."""
+        self._count("requests")
+        delay = self.opts.latency_ms + random.uniform(0, self.opts.jitter_ms)
+        if delay > 0:
+            time.sleep(delay / 1000.0)
+        if not self.bucket.take():
+            self._count("throttled")
+            self._send_json(429, {"code": -1003, "msg": "Too many requests"},
+                            {"Retry-After": "1"})
+            return False
+        if self.opts.error_rate > 0 and random.random() < self.opts.error_rate:
+            self._count("errors")
+            self._send_json(self.opts.error_status, {"code": -1000, "msg": "Injected error"})
+            return False
+        return True
+
+    def _bars(self, symbol, interval, start, end, limit):
+        step = INTERVALS_MS.get(interval)
+        if step is None:
+            return None
+        first = (start + step - 1) // step * step
+        out = []
+        t = first
+        while t <= end and len(out) < limit:
+            out.append(synth_candle(symbol, step, t))
+            t += step
+        return step, out
+
+    # -- routes ------------------------------------------------------------
+    def do_GET(self):
+        url = urlparse(self.path)
+        if url.path == "/stats":
+            with self.stats_lock:
+                return self._send_json(200, dict(self.stats))
+        if not self._gate():
+            return
+        q = {k: v[0] for k, v in parse_qs(url.query).items()}
+        if url.path == "/api/v3/klines":
+            return self._binance_klines(q)
+        if url.path == "/api/v3/exchangeInfo":
+            return self._binance_exchange_info()
+        if url.path == "/api/v3/ticker/24hr":
+            tickers = [{"symbol": s, "quoteVolume": str(1_000_000.0 / (i + 1))}
+                       for i, s in enumerate(SYMBOLS)]
+            return self._send_json(200, tickers)
+        self._send_json(404, {"msg": "not found"})
+
+    def do_POST(self):
+        url = urlparse(self.path)
+        length = int(self.headers.get("Content-Length") or 0)
+        raw = self.rfile.read(length) if length else b""
+        if not self._gate():
+            return
+        if url.path != "/info":
+            return self._send_json(404, {"msg": "not found"})
+        try:
+            req = json.loads(raw or b"{}")
+        except json.JSONDecodeError:
+            return self._send_json(400, {"msg": "bad json"})
+        if req.get("type") != "candleSnapshot":
+            return self._send_json(400, {"msg": "unsupported type"})
+        r = req.get("req", {})
+        coin = r.get("coin", "BTC")
+        interval = r.get("interval", "1m")
+        now = int(time.time() * 1000)
+        res = self._bars(coin, interval, int(r.get("startTime", 0)),
+                         min(int(r.get("endTime", now)), now), self.opts.hl_max_rows)
+        if res is None:
+            return self._send_json(400, {"msg": "bad interval"})
+        step, bars = res
+        payload = [{
+            "t": t, "T": t + step - 1, "s": coin, "i": interval,
+            "o": f"{o:.4f}", "h": f"{h:.4f}", "l": f"{low:.4f}", "c": f"{c:.4f}",
+            "v": f"{v:.4f}", "n": n,
+        } for (t, o, h, low, c, v, n) in bars]
+        self._send_json(200, payload)
+
+    def _binance_klines(self, q):
+        now = int(time.time() * 1000)
+        interval = q.get("interval", "1m")
+        step = INTERVALS_MS.get(interval)
+        if step is None:
+            return self._send_json(400, {"code": -1120, "msg": "Invalid interval."})
+        limit = min(int(q.get("limit", 500)), 1000)
+        end = min(int(q.get("endTime", now)), now)
+        start = int(q.get("startTime", end - step * limit))
+        _, bars = self._bars(q.get("symbol", "BTCUSDT"), interval, start, end, limit)
+        payload = [[t, f"{o:.4f}", f"{h:.4f}", f"{low:.4f}", f"{c:.4f}", f"{v:.4f}",
+                    t + step - 1, f"{v * c:.4f}", n, f"{v / 2:.4f}", f"{v * c / 2:.4f}", "0"]
+                   for (t, o, h, low, c, v, n) in bars]
+        self._send_json(200, payload)
+
+    def _binance_exchange_info(self):
+        etag = '"mock-exchange-info-v1"'
+        if self.headers.get("If-None-Match") == etag:
+            self.send_response(304)
+            self.send_header("ETag", etag)
+            self.end_headers()
+            return
+        info = {"symbols": [{"symbol": s, "klineIntervals": list(INTERVALS_MS)}
+                            for s in SYMBOLS]}
+        self._send_json(200, info, {"ETag": etag})
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    ap.add_argument("--host", default="127.0.0.1")
+    ap.add_argument("--port", type=int, default=8765)
+    ap.add_argument("--latency-ms", type=float, default=0.0, help="fixed delay per request")
+    ap.add_argument("--jitter-ms", type=float, default=0.0, help="extra uniform random delay")
+    ap.add_argument("--error-rate", type=float, default=0.0, help="fraction of requests failing")
+    ap.add_argument("--error-status", type=int, default=503)
+    ap.add_argument("--rate-limit", type=float, default=0.0,
+                    help="requests per second before answering 429 (0 = unlimited)")
+    ap.add_argument("--hl-max-rows", type=int, default=5000,
+                    help="row cap for Hyperliquid candleSnapshot responses")
+    ap.add_argument("--seed", type=int, default=None, help="seed for latency/error injection")
+    ap.add_argument("--verbose", action="store_true")
+    opts = ap.parse_args()
+
+    if opts.seed is not None:
+        random.seed(opts.seed)
+    Handler.opts = opts
+    Handler.bucket = TokenBucket(opts.rate_limit)
+    server = ThreadingHTTPServer((opts.host, opts.port), Handler)
+    print(f"Mock exchange listening on http://{opts.host}:{opts.port}")
+    try:
+        server.serve_forever()
+    except KeyboardInterrupt:
+        pass
+
+
+if __name__ == "__main__":
+    main()
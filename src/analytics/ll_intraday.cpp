@@ -4,6 +4,7 @@
 #include <algorithm>
 #include <cmath>
 #include <fstream>
+#include <functional>
 #include <iomanip>
 #include <limits>
 #include <optional>
@@ -22,13 +23,42 @@ static std::vector<double> ema(const std::vector<double>& src, int length){
     return out;
 }
 
+// Calls f(j, best) with the extreme of x(j) .. x(j+w-1) for every window of w
+// candles, keeping the window's candidates in a monotonic deque of indices:
+// O(n) for any w. `better(a, b)` is strict (std::greater<> for maxima).
+template <typename Get, typename Better, typename F>
+static void sliding_windows(int n, int w, Get x, Better better, F f){
+    if(w<=0 || w>n) return;
+    std::vector<int> dq(n); int head=0, tail=0;
+    for(int i=0;i<n;++i){
+        while(tail>head && !better(x(dq[tail-1]), x(i))) --tail;
+        dq[tail++]=i;
+        if(dq[head]<=i-w) ++head;
+        if(i>=w-1) f(i-w+1, x(dq[head]));
+    }
+}
+
+// A pivot high is at least as high as the `left` candles before it and higher
+// than the `right` after it (pivot lows likewise). Same results as comparing
+// every neighbour, in four O(n) passes.
 static void pivots(const std::vector<Core::Candle>& v, int left, int right, std::vector<uint8_t>& is_ph, std::vector<uint8_t>& is_pl){
-    size_t n=v.size(); is_ph.assign(n,0); is_pl.assign(n,0);
-    for(int i=left; i<(int)n-right; ++i){
-        bool ph=true, pl=true;
-        for(int k=0;k<=left;k++){ if(!(v[i].high >= v[i-k].high)) ph=false; if(!(v[i].low  <= v[i-k].low )) pl=false; }
-        for(int k=1;k<=right;k++){ if(!(v[i].high > v[i+k].high)) ph=false; if(!(v[i].low  < v[i+k].low )) pl=false; }
-        if(ph) is_ph[i]=1; if(pl) is_pl[i]=1;
+    const int n=(int)v.size(); is_ph.assign(n,0); is_pl.assign(n,0);
+    if(left<0 || right<0 || n-right<=left) return;
+    std::fill(is_ph.begin()+left, is_ph.end()-right, 1);
+    std::fill(is_pl.begin()+left, is_pl.end()-right, 1);
+    auto high=[&](int i){ return v[i].high; }; auto low=[&](int i){ return v[i].low; };
+    // Window [j, j+left) is the left side of candle j+left, [j, j+right) the right side of j-1.
+    sliding_windows(n, left,  high, std::greater<>(), [&](int j, double m){ int i=j+left; if(i<n-right && !(v[i].high >= m)) is_ph[i]=0; });
+    sliding_windows(n, right, high, std::greater<>(), [&](int j, double m){ int i=j-1;    if(i>=left    && !(v[i].high >  m)) is_ph[i]=0; });
+    sliding_windows(n, left,  low,  std::less<>(),    [&](int j, double m){ int i=j+left; if(i<n-right && !(v[i].low  <= m)) is_pl[i]=0; });
+    sliding_windows(n, right, low,  std::less<>(),    [&](int j, double m){ int i=j-1;    if(i>=left    && !(v[i].low  <  m)) is_pl[i]=0; });
+    // Every comparison with a NaN is false, so a NaN rules out each pivot
+    // whose window holds it (the deque extremes are not meaningful there).
+    int nan_h=-1, nan_l=-1, scanned=0;
+    for(int i=left;i<n-right;++i){
+        for(; scanned<=i+right; ++scanned){ if(std::isnan(v[scanned].high)) nan_h=scanned; if(std::isnan(v[scanned].low)) nan_l=scanned; }
+        if(nan_h>=i-left) is_ph[i]=0;
+        if(nan_l>=i-left) is_pl[i]=0;
     }
 }
 
@@ -44,22 +74,53 @@ Result analyze_core_candles(const std::vector<Core::Candle>& v, const Params& P)
     Result res; res.summary.left=P.left; res.summary.right=P.right; res.summary.ema_fast=P.ema_fast; res.summary.ema_slow=P.ema_slow; res.summary.retest_eps=P.retest_eps; res.summary.lookahead_min=P.lookahead_min; res.summary.rows_used=v.size();
     if(v.size() < (size_t)(P.left+P.right+2)) return res;
     std::vector<double> closes; closes.reserve(v.size()); for(const auto& c: v) closes.push_back(c.close);
-    auto ema_fast = llintraday::ema(closes, P.ema_fast);
     auto ema_slow = llintraday::ema(closes, P.ema_slow);
     std::vector<uint8_t> is_ph, is_pl; pivots(v, P.left, P.right, is_ph, is_pl);
     auto ph_idx = indices_of(is_ph); auto pl_idx = indices_of(is_pl);
     auto ll_idx = lower_lows(pl_idx, v);
+    const int n = (int)v.size(); const size_t n_ph = ph_idx.size();
+
+    // Next-crossing arrays, so each lookup below jumps instead of scanning
+    // the lookahead window:
+    //   next_higher[k]: the first pivot high after ph_idx[k] that is higher;
+    //   next_lower[i]:  the first candle after i with a lower low;
+    //   next_above[i]:  the first candle from i on closing above the slow EMA.
+    std::vector<size_t> next_higher(n_ph), stack;
+    for(size_t k=n_ph; k-- > 0;){
+        while(!stack.empty() && v[ph_idx[stack.back()]].high <= v[ph_idx[k]].high) stack.pop_back();
+        next_higher[k] = stack.empty() ? n_ph : stack.back(); stack.push_back(k);
+    }
+    std::vector<int> next_lower(n); std::vector<int> lows_stack;
+    for(int i=n-1; i>=0; --i){
+        while(!lows_stack.empty() && v[lows_stack.back()].low >= v[i].low) lows_stack.pop_back();
+        next_lower[i] = lows_stack.empty() ? n : lows_stack.back(); lows_stack.push_back(i);
+    }
+    std::vector<int> next_above(n+1, n);
+    for(int i=n-1; i>=0; --i) next_above[i] = v[i].close > ema_slow[i] ? i : next_above[i+1];
+
     res.records.reserve(ll_idx.size());
     std::vector<std::optional<int>> t_hh, t_ema, t_retest; t_hh.reserve(ll_idx.size()); t_ema.reserve(ll_idx.size()); t_retest.reserve(ll_idx.size());
-    auto last_ph_before = [&](int i) -> std::optional<int>{ int j=-1; for(int k : ph_idx){ if(k<i) j=k; else break; } return j>=0?std::optional<int>(j):std::nullopt; };
-    auto first_hh_after = [&](int idx_ll, std::optional<int> last_ph_before_ll, int lookahead_last) -> std::optional<int>{ if(!last_ph_before_ll) return std::nullopt; double ref_high = v[*last_ph_before_ll].high; for(int j : ph_idx){ if(j<=idx_ll) continue; if(j>lookahead_last) break; if(v[j].high > ref_high) return j; } return std::nullopt; };
-    auto first_close_above = [&](int idx_ll, const std::vector<double>& ema_vec, int lookahead_last)->std::optional<int>{ for(int i=idx_ll+1; i<=lookahead_last && i<(int)v.size(); ++i){ if(v[i].close > ema_vec[i]) return i; } return std::nullopt; };
-    auto first_retest = [&](int idx_ll, double eps, int lookahead_last)->std::optional<int>{ double ll_price=v[idx_ll].low; double thr=ll_price*(1.0+eps); for(int i=idx_ll+1; i<=lookahead_last && i<(int)v.size(); ++i){ if(v[i].low<=thr) return i; } return std::nullopt; };
+    // Pivot highs skipped by a jump are no higher than the one jumped from,
+    // itself not above ref_high. When the lower low is not also a pivot high,
+    // the first candidate is the pivot right after the reference one and
+    // next_higher answers at once.
+    auto first_hh_after = [&](int idx_ll, size_t ref, int lookahead_last) -> std::optional<int>{
+        const double ref_high = v[ph_idx[ref]].high;
+        size_t k = ref+1;
+        if(k<n_ph && ph_idx[k]==idx_ll) ++k; else k = next_higher[ref];
+        while(k<n_ph && ph_idx[k]<=lookahead_last && !(v[ph_idx[k]].high > ref_high)) k = next_higher[k];
+        return k<n_ph && ph_idx[k]<=lookahead_last ? std::optional<int>(ph_idx[k]) : std::nullopt; };
+    auto first_close_above = [&](int idx_ll, int lookahead_last)->std::optional<int>{ int i = next_above[idx_ll+1]; return i<=lookahead_last ? std::optional<int>(i) : std::nullopt; };
+    // Candles skipped by a jump have lows no lower than one above the threshold.
+    auto first_retest = [&](int idx_ll, double eps, int lookahead_last)->std::optional<int>{ double ll_price=v[idx_ll].low; double thr=ll_price*(1.0+eps); int i=idx_ll+1; while(i<=lookahead_last && !(v[i].low<=thr)) i=next_lower[i]; return i<=lookahead_last ? std::optional<int>(i) : std::nullopt; };
     for(int idx_ll : ll_idx){
         Record rec{}; rec.ll_time_ms = v[idx_ll].open_time; rec.ll_price = v[idx_ll].low;
-        auto last_ph = last_ph_before(idx_ll); auto lookahead_last = std::min<int>((int)v.size()-1, idx_ll + P.lookahead_min);
-        auto hh_i   = first_hh_after(idx_ll, last_ph, lookahead_last);
-        auto ema_i  = first_close_above(idx_ll, ema_slow, lookahead_last);
+        // Binary search for the last pivot high before the lower low.
+        const size_t ph_before = (size_t)(std::lower_bound(ph_idx.begin(), ph_idx.end(), idx_ll) - ph_idx.begin());
+        std::optional<int> last_ph; if(ph_before>0) last_ph = ph_idx[ph_before-1];
+        auto lookahead_last = std::min<int>(n-1, idx_ll + P.lookahead_min);
+        auto hh_i   = last_ph ? first_hh_after(idx_ll, ph_before-1, lookahead_last) : std::nullopt;
+        auto ema_i  = first_close_above(idx_ll, lookahead_last);
         auto ret_i  = first_retest(idx_ll, P.retest_eps, lookahead_last);
         if(last_ph){ rec.prev_ph_time_ms = v[*last_ph].open_time; rec.prev_ph_price = v[*last_ph].high; }
         if(hh_i){ rec.hh_time_ms = v[*hh_i].open_time; rec.mins_ll_to_hh = mins_between_ms(rec.ll_time_ms, *rec.hh_time_ms); }
@@ -6,11 +6,14 @@
 #include "core/candle_manager.h"
 #include "core/candle_utils.h"
 #include "core/interval_utils.h"
-#include "core/kline_stream.h"
+#include "core/latency_tracker.h"
+#include "core/market_data_recorder.h"
+#include "core/stream_multiplexer.h"
 #include "core/logger.h"
 #include "core/path_utils.h"
 #include "imgui.h"
 #include "imgui_internal.h"
+#include "indicator_cache.h"
 
 #include <algorithm>
 #include <chrono>
@@ -19,6 +22,7 @@
 #include <functional>
 #include <filesystem>
 #include <future>
+#include <iterator>
 #include <map>
 #include <memory>
 #include <mutex>
@@ -236,9 +240,14 @@ void App::load_config() {
     this->ctx_->candles_limit = static_cast<int>(cfg->candles_limit);
     this->ctx_->streaming_enabled = cfg->enable_streaming;
     this->ctx_->save_journal_csv = cfg->save_journal_csv;
-    // Optional chunk size from JSON (if present) via raw JSON read is not
-    // stored in ConfigData; read from environment override as a quick control.
-    // Default remains 1000.
+    this->ctx_->prefetch_enabled = cfg->prefetch;
+    this->ctx_->live_bars = cfg->live_bars;
+    this->ctx_->live_bar_throttle =
+        std::chrono::milliseconds(cfg->live_bar_throttle_ms);
+    Signal::IndicatorCache::instance().set_max_bytes(
+        static_cast<std::size_t>(cfg->indicator_cache_mb) << 20);
+    // Optional per-task cap from the environment; by default the whole
+    // missing window is requested in one call.
     const char* chunk_env = std::getenv("CANDLE_FETCH_CHUNK");
     if (chunk_env) {
       try {
@@ -270,6 +279,21 @@ void App::load_config() {
   load_pairs(pair_names);
   update_available_intervals();
   load_existing_candles();
+  // Pairs given up during an outage are polled again once the provider has
+  // answered a probe successfully.
+  data_service_.set_on_provider_recovered([this](const std::string &provider) {
+    add_status("Provider '" + provider + "' recovered");
+    this->ctx_->provider_recovered = true;
+  });
+  if (this->ctx_->prefetch_enabled) {
+    prefetch_ = std::make_unique<PrefetchScheduler>(
+        [this, limit = static_cast<std::size_t>(this->ctx_->candles_limit)](
+            const std::string &pair, const std::string &interval) {
+          return data_service_.warm_candles(pair, interval, limit);
+        },
+        [this]() { return data_service_.has_idle_fetch_capacity(); });
+    prefetch_->start();
+  }
   start_initial_fetch_and_streams();
 }
 
@@ -334,6 +358,8 @@ void App::load_pairs(std::vector<std::string> &pair_names) {
     }
     Config::ConfigManager::save_selected_pairs(resolve_config_path().string(),
                                                names);
+    // Pairs added or removed in the Control Panel join or leave the stream.
+    sync_stream_subscriptions();
   };
   this->ctx_->selected_pairs = pair_names;
   this->ctx_->active_pair = this->ctx_->selected_pairs[0];
@@ -407,29 +433,10 @@ void App::load_existing_candles() {
           pair, interval,
           std::async(std::launch::async, [this, pair, interval]() {
             auto candles = data_service_.load_candles(pair, interval);
-            long long interval_ms = Core::parse_interval(interval).count();
-            if (interval_ms > 0 && candles.size() > 1) {
-              bool fixed = false;
-              for (std::size_t i = 0; i + 1 < candles.size(); ++i) {
-                const auto &cur = candles[i];
-                const auto &next = candles[i + 1];
-                long long expected = cur.open_time + interval_ms;
-                if (next.open_time - cur.open_time > interval_ms) {
-                  auto res = data_service_.fetch_range(
-                      pair, interval, expected, next.open_time - interval_ms);
-                  if (res.error == Core::FetchError::None &&
-                      !res.candles.empty()) {
-                    candles.insert(candles.begin() + i + 1, res.candles.begin(),
-                                   res.candles.end());
-                    data_service_.append_candles(pair, interval, res.candles);
-                    i += res.candles.size();
-                    fixed = true;
-                  }
-                }
-              }
-              if (fixed)
-                Core::fill_missing(candles, interval_ms);
-            }
+            // Repair holes (and synthetic filler) with a planned batch of
+            // range requests rather than one request per gap.
+            if (candles.size() > 1)
+              data_service_.backfill(pair, interval, candles);
             return candles;
           })});
     }
@@ -451,6 +458,7 @@ void App::load_existing_candles() {
         {
           std::lock_guard<std::shared_mutex> lock(this->ctx_->candles_mutex);
           this->ctx_->all_candles[pair][interval] = candles;
+          ++this->ctx_->series_versions[{pair, interval}];
         }
         if (pair == this->ctx_->active_pair &&
             interval == this->ctx_->active_interval) {
@@ -491,7 +499,7 @@ void App::start_initial_fetch_and_streams() {
   if (missing > 0) {
     {
       std::lock_guard<std::mutex> lock(this->ctx_->fetch_mutex);
-      int chunk = std::max(1, std::min(this->ctx_->fetch_chunk_size, missing));
+      int chunk = fetch_chunk_for(missing);
       this->ctx_->fetch_queue.push_back(
           {this->ctx_->active_pair, this->ctx_->active_interval,
            data_service_.fetch_klines_async(
@@ -511,34 +519,43 @@ void App::start_initial_fetch_and_streams() {
     }
   }
   this->ctx_->next_fetch_time.store(0);
-  if (this->ctx_->streaming_enabled && this->ctx_->active_interval != "5s" &&
-      this->ctx_->active_interval != "15s") {
-    for (const auto &p : this->ctx_->pairs) {
-      std::string pair = p.name;
-      std::string provider = data_service_.get_active_provider_name();
-      std::transform(provider.begin(), provider.end(), provider.begin(), [](unsigned char c){ return static_cast<char>(std::tolower(c)); });
-      if (provider.find("binance") != std::string::npos) provider = "binance";
-      else if (provider.find("gate") != std::string::npos) provider = "gateio";
-      else provider.clear();
-      auto stream = std::make_shared<Core::KlineStream>(
-          pair, this->ctx_->active_interval, data_service_.candle_manager(),
-          Core::default_websocket_factory(), nullptr, std::chrono::milliseconds(1000), provider);
-      stream->start(
-          [this, pair](const Core::Candle &c) {
-            std::lock_guard<std::shared_mutex> lock(this->ctx_->candles_mutex);
-            auto &vec =
-                this->ctx_->all_candles[pair][this->ctx_->active_interval];
-            if (vec.empty() || c.open_time > vec.back().open_time)
-              vec.push_back(c);
-          },
-          [this, pair]() {
-            this->ctx_->stream_failed = true;
-            this->ctx_->next_fetch_time.store(0);
-            add_status("Stream failed for " + pair + ", switching to HTTP");
-          },
-          ui_manager_.candle_callback());
-      this->ctx_->streams[pair] = std::move(stream);
-    }
+  // Sub-minute intervals stream too: the multiplexer builds them from trades.
+  if (this->ctx_->streaming_enabled) {
+    std::string provider = data_service_.get_active_provider_name();
+    std::transform(provider.begin(), provider.end(), provider.begin(), [](unsigned char c){ return static_cast<char>(std::tolower(c)); });
+    if (provider.find("binance") != std::string::npos) provider = "binance";
+    else if (provider.find("gate") != std::string::npos) provider = "gateio";
+    else if (provider.find("hyperliquid") != std::string::npos) provider = "hyperliquid";
+    else provider.clear();
+    // One connection and one reactor thread for every pair.
+    this->ctx_->market_data->on_stream_status([this](const Core::StreamStatusEvent &e) {
+      if (e.status != Core::StreamStatus::Failed)
+        return;
+      this->ctx_->stream_failed = true;
+      this->ctx_->next_fetch_time.store(0);
+      add_status("Stream failed, switching to HTTP");
+    });
+    // CANDLE_MARKET_REPLAY feeds a recorded session instead of the network;
+    // CANDLE_MARKET_RECORD captures this one.
+    Core::WebSocketFactory ws_factory = Core::default_websocket_factory();
+    if (auto replayer = Core::session_market_replayer())
+      ws_factory = Core::replay_websocket_factory(replayer);
+    else if (auto recorder = Core::session_market_recorder())
+      ws_factory = Core::recording_websocket_factory(ws_factory, recorder);
+    this->ctx_->stream_mux = std::make_shared<Core::StreamMultiplexer>(
+        provider, data_service_.candle_manager(), ws_factory,
+        nullptr, std::chrono::milliseconds(1000), this->ctx_->market_data);
+    this->ctx_->stream_mux->set_live_update_interval(this->ctx_->live_bar_throttle);
+    // Bars that closed while the socket was down are fetched on reconnect,
+    // before live delivery resumes, instead of waiting for a poll.
+    this->ctx_->stream_mux->set_gap_fetcher(
+        [this](const std::string &symbol, const std::string &interval,
+               long long start_ms, long long end_ms) {
+          return data_service_.fetch_range(symbol, interval, start_ms, end_ms, 1,
+                                           this->ctx_->retry_delay);
+        });
+    this->ctx_->stream_mux->start();
+    sync_stream_subscriptions();
   } else {
     this->ctx_->streaming_enabled = false;
   }
@@ -554,12 +571,168 @@ void App::start_initial_fetch_and_streams() {
               [&](const AppContext::FetchTask &t) { return t.pair == pair; }),
           this->ctx_->fetch_queue.end());
     }
-    auto it = this->ctx_->streams.find(pair);
-    if (it != this->ctx_->streams.end()) {
-      it->second->stop();
-      this->ctx_->streams.erase(it);
+    if (prefetch_) {
+      for (const auto &interval : this->ctx_->intervals)
+        prefetch_->cancel(pair, interval);
+    }
+    if (this->ctx_->stream_mux) {
+      for (const auto &sub : this->ctx_->stream_mux->subscriptions())
+        if (sub.first == pair)
+          this->ctx_->stream_mux->unsubscribe(sub.first, sub.second);
+    }
+    for (auto it = this->ctx_->stream_queues.begin();
+         it != this->ctx_->stream_queues.end();) {
+      if (it->first.first != pair) {
+        ++it;
+        continue;
+      }
+      for (auto token : it->second.tokens)
+        this->ctx_->market_data->unsubscribe(token);
+      it = this->ctx_->stream_queues.erase(it);
     }
   };
+  plan_prefetch();
+}
+
+void App::sync_stream_subscriptions() {
+  auto mux = this->ctx_->stream_mux;
+  if (!mux)
+    return;
+  const std::string interval = this->ctx_->active_interval;
+  std::set<std::pair<std::string, std::string>> wanted;
+  for (const auto &p : this->ctx_->pairs)
+    wanted.insert({p.name, interval});
+  for (const auto &sub : mux->subscriptions()) {
+    if (!wanted.count(sub))
+      mux->unsubscribe(sub.first, sub.second);
+  }
+  auto &bus = *this->ctx_->market_data;
+  auto &queues = this->ctx_->stream_queues;
+  for (auto it = queues.begin(); it != queues.end();) {
+    if (wanted.count(it->first)) {
+      ++it;
+      continue;
+    }
+    // Handlers still in flight keep their queue alive through the capture.
+    for (auto token : it->second.tokens)
+      bus.unsubscribe(token);
+    it = queues.erase(it);
+  }
+  for (const auto &key : wanted) {
+    mux->subscribe(key.first, key.second);
+    auto &entry = queues[key];
+    if (entry.queue)
+      continue;
+    // The stream threads never touch candles_mutex; drain_stream_queues()
+    // applies the updates on the main thread.
+    auto queue = std::make_shared<Core::KlineQueue>();
+    entry.queue = queue;
+    entry.tokens.push_back(bus.on_candle_closed(
+        [queue](const Core::CandleEvent &e) {
+          queue->publish({e.candle, true, e.stamps ? *e.stamps : Core::LatencyStamps{}});
+        },
+        key.first, key.second));
+    if (this->ctx_->live_bars) {
+      entry.tokens.push_back(bus.on_candle_update(
+          [queue](const Core::CandleEvent &e) {
+            queue->publish({e.candle, false, e.stamps ? *e.stamps : Core::LatencyStamps{}});
+          },
+          key.first, key.second));
+    }
+  }
+}
+
+void App::drain_stream_queues() {
+  std::vector<std::pair<const std::pair<std::string, std::string> *,
+                        std::vector<Core::KlineUpdate>>>
+      batches;
+  for (const auto &[key, entry] : this->ctx_->stream_queues) {
+    const auto &queue = entry.queue;
+    std::vector<Core::KlineUpdate> updates;
+    if (queue->drain(updates) > 0)
+      batches.emplace_back(&key, std::move(updates));
+    if (queue->coalesced() > stream_queue_coalesced_reported_[key]) {
+      stream_queue_coalesced_reported_[key] = queue->coalesced();
+      Core::Logger::instance().warn(
+          "Stream queue " + key.first + " " + key.second + " overflowed (peak " +
+          std::to_string(queue->high_water()) + "), " +
+          std::to_string(queue->coalesced()) + " updates coalesced");
+    }
+  }
+  if (batches.empty())
+    return;
+  // One exclusive lock per frame for every stream. Closed and forming bars
+  // both land on the tail: a new open time appends, the current one is
+  // replaced in place.
+  {
+    std::lock_guard<std::shared_mutex> lock(this->ctx_->candles_mutex);
+    for (const auto &[key, updates] : batches) {
+      auto &vec = this->ctx_->all_candles[key->first][key->second];
+      for (const auto &u : updates) {
+        if (vec.empty() || u.candle.open_time > vec.back().open_time)
+          vec.push_back(u.candle);
+        else if (u.candle.open_time == vec.back().open_time)
+          vec.back() = u.candle;
+      }
+    }
+  }
+  const long long merged = Core::LatencyTracker::steady_us();
+  auto &tracker = Core::LatencyTracker::instance();
+  for (const auto &[key, updates] : batches) {
+    const bool on_screen = key->first == this->ctx_->active_pair &&
+                           key->second == this->ctx_->active_interval;
+    for (const auto &u : updates) {
+      if (u.stamps.parsed_us == 0)
+        continue;
+      tracker.record(Core::LatencyTracker::Stage::Merge, merged - u.stamps.parsed_us);
+      if (on_screen)
+        awaiting_render_.push_back({merged, u.stamps.exchange_ms});
+    }
+  }
+}
+
+void App::record_frame_latency() {
+  auto &tracker = Core::LatencyTracker::instance();
+  if (!awaiting_render_.empty()) {
+    const long long now_us = Core::LatencyTracker::steady_us();
+    const long long now_ms = Core::LatencyTracker::wall_ms();
+    for (const auto &bar : awaiting_render_) {
+      tracker.record(Core::LatencyTracker::Stage::Render, now_us - bar.merged_us);
+      if (bar.exchange_ms > 0)
+        tracker.record(Core::LatencyTracker::Stage::EndToEnd,
+                       (now_ms - bar.exchange_ms) * 1000);
+    }
+    awaiting_render_.clear();
+  }
+  const auto now = std::chrono::steady_clock::now();
+  if (now - latency_status_at_ >= std::chrono::seconds(1)) {
+    latency_status_at_ = now;
+    ui_manager_.set_latency_summary(tracker.status_line());
+  }
+}
+
+void App::push_live_bar() {
+  std::optional<Core::Candle> last;
+  {
+    std::shared_lock<std::shared_mutex> lock(this->ctx_->candles_mutex);
+    auto pit = this->ctx_->all_candles.find(this->ctx_->active_pair);
+    if (pit != this->ctx_->all_candles.end()) {
+      auto iit = pit->second.find(this->ctx_->active_interval);
+      if (iit != pit->second.end() && !iit->second.empty())
+        last = iit->second.back();
+    }
+  }
+  if (!last)
+    return;
+  const auto &prev = live_bar_pushed_;
+  if (prev && prev->open_time == last->open_time && prev->close == last->close &&
+      prev->high == last->high && prev->low == last->low &&
+      prev->volume == last->volume)
+    return;
+  live_bar_pushed_ = last;
+  // push_candle replaces the chart's last candle in place and throttles
+  // redraws (webview_throttle_ms).
+  ui_manager_.push_candle(*last);
 }
 
 void App::start_fetch_thread() {
@@ -583,6 +756,36 @@ void App::start_fetch_thread() {
           continue;
         }
 
+        if (!it->future.valid()) {
+          if (std::chrono::steady_clock::now() < it->retry_at) {
+            ++it;
+            continue;
+          }
+          int miss;
+          {
+            std::shared_lock<std::shared_mutex> lock_candles(
+                this->ctx_->candles_mutex);
+            miss = this->ctx_->candles_limit -
+                   static_cast<int>(
+                       this->ctx_->all_candles[it->pair][it->interval].size());
+          }
+          if (miss <= 0)
+            miss = this->ctx_->candles_limit;
+          int chunk = fetch_chunk_for(miss);
+          auto pair = it->pair;
+          auto interval = it->interval;
+          lock.unlock();
+          auto fut = data_service_.fetch_klines_async(
+              pair, interval, chunk, this->ctx_->max_retries,
+              this->ctx_->retry_delay);
+          auto now = std::chrono::steady_clock::now();
+          lock.lock();
+          it->future = std::move(fut);
+          it->start = now;
+          ++it;
+          continue;
+        }
+
         lock.unlock();
         auto status = it->future.wait_for(std::chrono::seconds(0));
         lock.lock();
@@ -604,14 +807,15 @@ void App::start_fetch_thread() {
                 long long gap_start = last_time + interval_ms;
                 long long gap_end = fetched.candles.front().open_time - interval_ms;
                 auto gap = data_service_.fetch_range(it->pair, it->interval, gap_start, gap_end);
-                if (gap.error == Core::FetchError::None && !gap.candles.empty()) {
-                  Core::merge_candles(vec, gap.candles);
-                }
+                if (gap.error == Core::FetchError::None && !gap.candles.empty() &&
+                    Core::merge_candles(vec, gap.candles))
+                  ++this->ctx_->series_versions[{it->pair, it->interval}];
               }
               // Merge fetched set
               const std::size_t before_n = vec.size();
               const long long before_last = before_n ? vec.back().open_time : 0LL;
-              Core::merge_candles(vec, fetched.candles);
+              if (Core::merge_candles(vec, fetched.candles))
+                ++this->ctx_->series_versions[{it->pair, it->interval}];
               const bool changed = vec.size() != before_n || (before_n && vec.back().open_time != before_last);
               if (changed) data_service_.overwrite_candles(it->pair, it->interval, vec);
             }
@@ -629,8 +833,7 @@ void App::start_fetch_thread() {
             }
             if (miss > 0) {
               // Schedule next chunk in the chain
-              int chunk = std::max(
-                  1, std::min(this->ctx_->fetch_chunk_size, miss));
+              int chunk = fetch_chunk_for(miss);
               auto pair = it->pair;
               auto interval = it->interval;
               lock.unlock();
@@ -646,6 +849,13 @@ void App::start_fetch_thread() {
             } else {
               it = this->ctx_->fetch_queue.erase(it);
             }
+          } else if (fetched.error == Core::FetchError::CircuitOpen) {
+            // Nothing was sent, so this is not a retry; ask again after
+            // retry_delay; once the cooldown has passed that is the probe.
+            lock.lock();
+            it->retry_at =
+                std::chrono::steady_clock::now() + this->ctx_->retry_delay;
+            ++it;
           } else {
             int miss;
             {
@@ -723,7 +933,7 @@ void App::start_fetch_thread() {
                 delay *= (1 << shift);
                 delay = std::min(delay, max_delay);
               }
-              int chunk = std::max(1, std::min(this->ctx_->fetch_chunk_size, miss));
+              int chunk = fetch_chunk_for(miss);
               auto pair = it->pair;
               auto interval = it->interval;
               lock.unlock();
@@ -779,6 +989,10 @@ void App::process_events() {
     schedule_http_updates(period, now_ms);
   if (use_http)
     handle_http_updates();
+  drain_stream_queues();
+  if (!use_http)
+    push_live_bar();
+  apply_prefetch_results();
   update_candle_progress();
 }
 
@@ -826,6 +1040,8 @@ void App::schedule_http_updates(std::chrono::milliseconds period,
       update_next_fetch_time(align_next_boundary(now_ms));
   }
   if (now_ms >= this->ctx_->next_fetch_time.load()) {
+    if (this->ctx_->provider_recovered.exchange(false))
+      clear_failed_fetches();
     for (const auto &item : this->ctx_->pairs) {
       const auto &pair = item.name;
       bool skip = false;
@@ -838,11 +1054,24 @@ void App::schedule_http_updates(std::chrono::milliseconds period,
         continue;
       if (this->ctx_->pending_fetches.find(pair) ==
           this->ctx_->pending_fetches.end()) {
-        this->ctx_->pending_fetches[pair] = {
-            this->ctx_->active_interval,
-            data_service_.fetch_klines_async(pair, this->ctx_->active_interval,
-                                             1, this->ctx_->max_retries,
-                                             this->ctx_->retry_delay)};
+        std::future<Core::KlinesResult> fut;
+        if (pair == this->ctx_->active_pair && data_service_.hedging_enabled()) {
+          // Active pair: race a slow provider against a secondary one.
+          fut = std::async(std::launch::async,
+                           [this, pair, interval = this->ctx_->active_interval,
+                            start = now_ms - period.count(), end = now_ms,
+                            retries = this->ctx_->max_retries,
+                            delay = this->ctx_->retry_delay]() {
+                             return data_service_.fetch_range_hedged(
+                                 pair, interval, start, end, retries, delay);
+                           });
+        } else {
+          fut = data_service_.fetch_klines_async(pair, this->ctx_->active_interval,
+                                                 1, this->ctx_->max_retries,
+                                                 this->ctx_->retry_delay);
+        }
+        this->ctx_->pending_fetches[pair] = {this->ctx_->active_interval,
+                                             std::move(fut)};
         add_status("Updating " + pair);
       }
     }
@@ -873,13 +1102,15 @@ void App::handle_http_updates() {
             long long gap_end = latest.candles.front().open_time - interval_ms;
             auto gap = data_service_.fetch_range(it->first, it->second.interval, gap_start, gap_end);
             if (gap.error == Core::FetchError::None && !gap.candles.empty()) {
-              Core::merge_candles(vec, gap.candles);
+              if (Core::merge_candles(vec, gap.candles))
+                ++this->ctx_->series_versions[{it->first, it->second.interval}];
               appended = true;
             }
           }
           const std::size_t before_n = vec.size();
           const long long before_last = before_n ? vec.back().open_time : 0LL;
-          Core::merge_candles(vec, latest.candles);
+          if (Core::merge_candles(vec, latest.candles))
+            ++this->ctx_->series_versions[{it->first, it->second.interval}];
           const bool changed = vec.size() != before_n || (before_n && vec.back().open_time != before_last);
           if (changed) {
             data_service_.overwrite_candles(it->first, it->second.interval, vec);
@@ -943,6 +1174,12 @@ void App::schedule_retry(long long now_ms, std::chrono::milliseconds delay,
   update_next_fetch_time(retry);
 }
 
+int App::fetch_chunk_for(int missing) const {
+  if (this->ctx_->fetch_chunk_size > 0)
+    missing = std::min(this->ctx_->fetch_chunk_size, missing);
+  return std::max(1, missing);
+}
+
 void App::update_next_fetch_time(long long candidate) {
   auto nft = this->ctx_->next_fetch_time.load();
   if (nft == 0 || candidate < nft)
@@ -964,6 +1201,8 @@ void App::render_ui() {
         auto &candles = this->ctx_->all_candles[this->ctx_->disk_load_pair]
                                                [this->ctx_->disk_load_interval];
         candles = std::move(loaded);
+        ++this->ctx_->series_versions[{this->ctx_->disk_load_pair,
+                                       this->ctx_->disk_load_interval}];
       }
       if (this->ctx_->disk_load_pair == this->ctx_->active_pair &&
           this->ctx_->disk_load_interval == this->ctx_->active_interval) {
@@ -993,6 +1232,7 @@ void App::render_ui() {
   render_main_windows();
   handle_active_pair_change();
   ui_manager_.end_frame(window_.get());
+  record_frame_latency();
 }
 
 void App::render_status_window() {
@@ -1026,7 +1266,7 @@ void App::render_main_windows() {
     DrawControlPanel(
         this->ctx_->pairs, this->ctx_->selected_pairs, this->ctx_->active_pair,
         this->ctx_->intervals, this->ctx_->selected_interval,
-        this->ctx_->all_candles, this->ctx_->save_pairs,
+        this->ctx_->all_candles, this->ctx_->series_versions, this->ctx_->save_pairs,
         this->ctx_->exchange_pairs, status_, status_mutex_, data_service_,
         this->ctx_->cancel_pair, this->ctx_->show_analytics_window,
         this->ctx_->show_journal_window, this->ctx_->show_backtest_window);
@@ -1092,8 +1332,8 @@ void App::render_main_windows() {
       ImGui::SetNextWindowSize(
           ImVec2(std::max(100.0f, vp->WorkSize.x - left_w), bottom_h),
           ImGuiCond_FirstUseEver);
-      DrawBacktestWindow(this->ctx_->all_candles, this->ctx_->active_pair,
-                         this->ctx_->selected_interval);
+      DrawBacktestWindow(this->ctx_->all_candles, this->ctx_->series_versions,
+                         this->ctx_->active_pair, this->ctx_->selected_interval);
     }
   }
 }
@@ -1101,6 +1341,8 @@ void App::render_main_windows() {
 void App::handle_active_pair_change() {
   if (this->ctx_->active_pair != this->ctx_->last_active_pair ||
       this->ctx_->active_interval != this->ctx_->last_active_interval) {
+    if (this->ctx_->active_interval != this->ctx_->last_active_interval)
+      sync_stream_subscriptions();
     this->ctx_->last_active_pair = this->ctx_->active_pair;
     this->ctx_->last_active_interval = this->ctx_->active_interval;
     int miss;
@@ -1149,7 +1391,7 @@ void App::handle_active_pair_change() {
       failed = this->ctx_->failed_fetches.count(
                    {this->ctx_->active_pair, this->ctx_->active_interval}) > 0;
       if (miss > 0 && !exists && !failed) {
-        int chunk = std::max(1, std::min(this->ctx_->fetch_chunk_size, miss));
+        int chunk = fetch_chunk_for(miss);
         this->ctx_->fetch_queue.push_back(
             {this->ctx_->active_pair, this->ctx_->active_interval,
              data_service_.fetch_klines_async(
@@ -1166,11 +1408,150 @@ void App::handle_active_pair_change() {
       add_status("Fetching " + this->ctx_->active_pair + " " +
                  this->ctx_->active_interval);
     }
+    plan_prefetch();
+  }
+}
+
+void App::plan_prefetch() {
+  if (!prefetch_)
+    return;
+  prefetch_->clear();
+  const std::string &active_pair = this->ctx_->active_pair;
+  const std::string &active_interval = this->ctx_->active_interval;
+
+  // Intervals as offered in the chart, ordered by duration for adjacency.
+  std::vector<std::string> intervals = this->ctx_->available_intervals.empty()
+                                           ? this->ctx_->intervals
+                                           : this->ctx_->available_intervals;
+  std::sort(intervals.begin(), intervals.end(),
+            [](const std::string &a, const std::string &b) {
+              return Core::parse_interval(a) < Core::parse_interval(b);
+            });
+  intervals.erase(std::unique(intervals.begin(), intervals.end()),
+                  intervals.end());
+
+  struct Job {
+    std::string pair;
+    std::string interval;
+    PrefetchPriority priority;
+  };
+  std::vector<Job> jobs;
+  for (const auto &pair : this->ctx_->selected_pairs)
+    jobs.push_back({pair, active_interval, PrefetchPriority::Visible});
+  auto pos = std::find(intervals.begin(), intervals.end(), active_interval);
+  if (pos != intervals.end()) {
+    if (pos != intervals.begin())
+      jobs.push_back({active_pair, *std::prev(pos), PrefetchPriority::Adjacent});
+    if (std::next(pos) != intervals.end())
+      jobs.push_back({active_pair, *std::next(pos), PrefetchPriority::Adjacent});
+  }
+  for (const auto &pair : this->ctx_->selected_pairs)
+    for (const auto &interval : intervals)
+      jobs.push_back({pair, interval, PrefetchPriority::Background});
+
+  const long long now_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                               std::chrono::system_clock::now().time_since_epoch())
+                               .count();
+  std::set<std::pair<std::string, std::string>> failed;
+  {
+    std::lock_guard<std::mutex> lock(this->ctx_->fetch_mutex);
+    failed = this->ctx_->failed_fetches;
+  }
+  std::shared_lock<std::shared_mutex> lock(this->ctx_->candles_mutex);
+  for (const auto &job : jobs) {
+    // The active series is fetched in the foreground.
+    if (job.pair == active_pair && job.interval == active_interval)
+      continue;
+    if (failed.count({job.pair, job.interval}))
+      continue;
+    const auto interval_ms = Core::parse_interval(job.interval).count();
+    if (interval_ms <= 0)
+      continue;
+    // Warm: full history whose newest bar is the current or previous one.
+    auto pit = this->ctx_->all_candles.find(job.pair);
+    if (pit != this->ctx_->all_candles.end()) {
+      auto iit = pit->second.find(job.interval);
+      if (iit != pit->second.end() && !iit->second.empty() &&
+          iit->second.size() >= static_cast<std::size_t>(this->ctx_->candles_limit) &&
+          iit->second.back().open_time + 2 * interval_ms > now_ms)
+        continue;
+    }
+    prefetch_->enqueue(job.pair, job.interval, job.priority);
+  }
+}
+
+void App::apply_prefetch_results() {
+  if (!prefetch_)
+    return;
+  auto results = prefetch_->take_results();
+  if (results.empty())
+    return;
+  std::lock_guard<std::shared_mutex> lock(this->ctx_->candles_mutex);
+  for (auto &r : results) {
+    if (r.candles.empty())
+      continue;
+    // Merge rather than replace: the fetch thread or an HTTP update may have
+    // added newer bars while the job ran. The chart picks up the change on
+    // the next frame if this series is now active. Bars inserted before
+    // the last one invalidate indicators cached for the series.
+    if (Core::merge_candles(this->ctx_->all_candles[r.pair][r.interval], r.candles))
+      ++this->ctx_->series_versions[{r.pair, r.interval}];
   }
 }
 
 void App::cleanup() {
+  if (prefetch_) {
+    prefetch_->stop();
+    Core::Logger::instance().info("Prefetched series: " +
+                                  std::to_string(prefetch_->completed()));
+  }
   stop_fetch_thread();
+  if (this->ctx_->stream_mux) {
+    this->ctx_->stream_mux->stop();
+    const auto writes = this->ctx_->stream_mux->writer_stats();
+    if (writes.commits > 0) {
+      Core::Logger::instance().info(
+          "Stream persistence: " + std::to_string(writes.candles) + " candles in " +
+          std::to_string(writes.commits) + " commits");
+    }
+  }
+  if (!this->ctx_->stream_queues.empty()) {
+    std::uint64_t published = 0, coalesced = 0;
+    std::size_t peak = 0;
+    for (const auto &entry : this->ctx_->stream_queues) {
+      published += entry.second.queue->published();
+      coalesced += entry.second.queue->coalesced();
+      peak = std::max(peak, entry.second.queue->high_water());
+    }
+    Core::Logger::instance().info(
+        "Stream queues: " + std::to_string(published) + " updates, peak depth " +
+        std::to_string(peak) + ", " + std::to_string(coalesced) + " coalesced");
+  }
+  if (const auto line = Core::LatencyTracker::instance().status_line(); !line.empty())
+    Core::Logger::instance().info("Latency p50/p99 ms: " + line);
+  if (const char *dump = std::getenv("CANDLE_LATENCY_DUMP")) {
+    if (!Core::LatencyTracker::instance().write_dump(dump))
+      Core::Logger::instance().error(std::string("Failed to write latency dump ") + dump);
+  }
+  if (auto recorder = Core::session_market_recorder()) {
+    recorder->flush();
+    Core::Logger::instance().info(
+        "Market-data recording: " + std::to_string(recorder->records()) + " records, " +
+        std::to_string(recorder->bytes()) + " bytes");
+  }
+  if (const auto ind = Signal::IndicatorCache::instance().stats();
+      ind.hits + ind.extensions + ind.misses > 0) {
+    Core::Logger::instance().info(
+        "Indicator cache: " + std::to_string(ind.hits) + " hits, " +
+        std::to_string(ind.extensions) + " extended, " + std::to_string(ind.misses) +
+        " misses, " + std::to_string(ind.evictions) + " evicted, " +
+        std::to_string(ind.bytes >> 10) + " KiB in " + std::to_string(ind.entries) +
+        " entries");
+  }
+  if (const auto hedges = data_service_.hedge_stats(); hedges.issued > 0) {
+    Core::Logger::instance().info("Hedged requests: " + std::to_string(hedges.issued) +
+                                  " issued, " + std::to_string(hedges.won) + " won");
+  }
   if (this->ctx_->save_pairs)
     this->ctx_->save_pairs();
   if (!journal_service_.save("journal.json")) {
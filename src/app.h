@@ -4,15 +4,18 @@
 #include "core/glfw_context.h"
 #include "services/data_service.h"
 #include "services/journal_service.h"
+#include "services/prefetch_scheduler.h"
 #include "ui/ui_manager.h"
 
 #include <chrono>
+#include <cstdint>
 #include <deque>
 #include <functional>
 #include <future>
 #include <map>
 #include <memory>
 #include <mutex>
+#include <optional>
 #include <string>
 #include <thread>
 #include <vector>
@@ -52,11 +55,22 @@ private:
   void render_ui();
   void cleanup();
   void update_next_fetch_time(long long candidate);
+  // Candles to request for `missing` candles, honouring fetch_chunk_size.
+  int fetch_chunk_for(int missing) const;
   void schedule_retry(long long now_ms, std::chrono::milliseconds delay,
                       const std::string &msg = "");
   void load_pairs(std::vector<std::string> &pair_names);
   void load_existing_candles();
   void start_initial_fetch_and_streams();
+  // Subscribes every pair on the active interval, dropping anything else.
+  void sync_stream_subscriptions();
+  // Forwards the tail of the active streamed series to the chart.
+  void push_live_bar();
+  // Applies queued stream updates to all_candles (main thread).
+  void drain_stream_queues();
+  // Records render/end-to-end latency for bars merged before this frame
+  // and refreshes the status-bar summary.
+  void record_frame_latency();
   void schedule_http_updates(std::chrono::milliseconds period,
                              long long now_ms);
   void handle_http_updates();
@@ -64,6 +78,9 @@ private:
   void render_status_window();
   void render_main_windows();
   void handle_active_pair_change();
+  // Re-queues background warm-up around the active pair/interval.
+  void plan_prefetch();
+  void apply_prefetch_results();
   void update_available_intervals();
   void start_fetch_thread();
   void stop_fetch_thread();
@@ -81,6 +98,16 @@ private:
   std::unique_ptr<GLFWwindow, WindowDeleter> window_{nullptr};
   UiManager ui_manager_;
   std::jthread fetch_thread_;
+  std::unique_ptr<PrefetchScheduler> prefetch_;
+  std::optional<Core::Candle> live_bar_pushed_; // last tail sent to the chart
+  std::map<std::pair<std::string, std::string>, std::uint64_t>
+      stream_queue_coalesced_reported_;
+  struct MergedBar {
+    long long merged_us;
+    long long exchange_ms;
+  };
+  std::vector<MergedBar> awaiting_render_; // active series, merged not drawn
+  std::chrono::steady_clock::time_point latency_status_at_{};
 
   // Fullscreen state (GLFW-driven)
   bool fullscreen_ = false;
@@ -3,6 +3,7 @@
 #include <atomic>
 #include <chrono>
 #include <condition_variable>
+#include <cstdint>
 #include <deque>
 #include <functional>
 #include <future>
@@ -15,8 +16,10 @@
 #include <vector>
 
 #include "core/candle.h"
+#include "core/kline_queue.h"
+#include "core/market_data_bus.h"
 #include "core/net/fetch_result.h"
-#include "core/kline_stream.h"
+#include "core/stream_multiplexer.h"
 #include "ui/control_panel.h"
 
 struct AppContext {
@@ -30,8 +33,24 @@ struct AppContext {
   std::string selected_interval;
   std::map<std::string, std::map<std::string, std::vector<Core::Candle>>>
       all_candles;
+  // IndicatorCache version of each (pair, interval) in all_candles: bumped,
+  // under candles_mutex, whenever a series changes other than by appending
+  // or replacing its last candle, so cached indicators are recomputed
+  // rather than extended from rewritten bars.
+  std::map<std::pair<std::string, std::string>, std::uint64_t> series_versions;
   std::shared_mutex candles_mutex;
-  std::map<std::string, std::shared_ptr<Core::KlineStream>> streams;
+  // Live candle and stream-status events; the stream publishes, the App and
+  // any other consumer subscribe.
+  std::shared_ptr<Core::MarketDataBus> market_data =
+      std::make_shared<Core::MarketDataBus>();
+  std::shared_ptr<Core::StreamMultiplexer> stream_mux;
+  // Per-series hand-off from the stream threads, drained once per frame,
+  // with the bus subscriptions feeding it. Main thread only.
+  struct StreamQueue {
+    std::shared_ptr<Core::KlineQueue> queue;
+    std::vector<Core::MarketDataBus::Token> tokens;
+  };
+  std::map<std::pair<std::string, std::string>, StreamQueue> stream_queues;
   std::atomic<bool> stream_failed{false};
   struct PendingFetch {
     std::string interval;
@@ -44,11 +63,16 @@ struct AppContext {
     std::future<Core::KlinesResult> future;
     std::chrono::steady_clock::time_point start;
     int retries = 0;
+    // Set, with no future, while waiting out an open provider circuit.
+    std::chrono::steady_clock::time_point retry_at{};
   };
   std::deque<FetchTask> fetch_queue;
   std::mutex fetch_mutex;
   std::condition_variable fetch_cv;
   std::set<std::pair<std::string, std::string>> failed_fetches;
+  // Raised by DataService when a provider's circuit closes again; the next
+  // poll then retries pairs that had been given up.
+  std::atomic<bool> provider_recovered{false};
   std::size_t total_fetches = 0;
   std::size_t completed_fetches = 0;
   std::atomic<long long> next_fetch_time{0};
@@ -66,9 +90,14 @@ struct AppContext {
   int max_retries = 3;
   bool exponential_backoff = true;
   const std::chrono::seconds request_timeout{10};
-  // Limit per network fetch to avoid long, blocking requests for large history.
-  // The app will fetch in chunks until reaching candles_limit.
-  int fetch_chunk_size = 1000;
+  // Optional cap on candles per fetch task. 0 requests the whole missing
+  // window at once; providers paginate internally at their server cap.
+  int fetch_chunk_size = 0;
+  // Background warm-up of non-active series (config `prefetch`).
+  bool prefetch_enabled = true;
+  // Forming-bar updates from the stream (config `live_bars`).
+  bool live_bars = true;
+  std::chrono::milliseconds live_bar_throttle{250};
 
   // Local/disk candle loading state for non-blocking UI when switching pairs
   std::atomic<bool> disk_loading{false};
@@ -145,6 +145,22 @@ std::optional<ConfigData> ConfigSchema::parse(const nlohmann::json &j,
     cfg.webview_throttle_ms = static_cast<int>(j["webview_throttle_ms"].get<unsigned int>());
   }
 
+  if (j.contains("symbols_cache_ttl_s")) {
+    if (!j["symbols_cache_ttl_s"].is_number_unsigned()) {
+      error = "'symbols_cache_ttl_s' must be an unsigned number";
+      return std::nullopt;
+    }
+    cfg.symbols_cache_ttl_s = static_cast<int>(j["symbols_cache_ttl_s"].get<unsigned int>());
+  }
+
+  if (j.contains("intervals_cache_ttl_s")) {
+    if (!j["intervals_cache_ttl_s"].is_number_unsigned()) {
+      error = "'intervals_cache_ttl_s' must be an unsigned number";
+      return std::nullopt;
+    }
+    cfg.intervals_cache_ttl_s = static_cast<int>(j["intervals_cache_ttl_s"].get<unsigned int>());
+  }
+
   if (j.contains("chart_html_path")) {
     if (!j["chart_html_path"].is_string()) {
       error = "'chart_html_path' must be a string";
@@ -185,6 +201,46 @@ std::optional<ConfigData> ConfigSchema::parse(const nlohmann::json &j,
     }
   }
 
+  if (j.contains("hedge_requests")) {
+    if (!j["hedge_requests"].is_boolean()) {
+      error = "'hedge_requests' must be a boolean";
+      return std::nullopt;
+    }
+    cfg.hedge_requests = j["hedge_requests"].get<bool>();
+  }
+
+  if (j.contains("prefetch")) {
+    if (!j["prefetch"].is_boolean()) {
+      error = "'prefetch' must be a boolean";
+      return std::nullopt;
+    }
+    cfg.prefetch = j["prefetch"].get<bool>();
+  }
+
+  if (j.contains("live_bars")) {
+    if (!j["live_bars"].is_boolean()) {
+      error = "'live_bars' must be a boolean";
+      return std::nullopt;
+    }
+    cfg.live_bars = j["live_bars"].get<bool>();
+  }
+
+  if (j.contains("live_bar_throttle_ms")) {
+    if (!j["live_bar_throttle_ms"].is_number_unsigned()) {
+      error = "'live_bar_throttle_ms' must be an unsigned number";
+      return std::nullopt;
+    }
+    cfg.live_bar_throttle_ms = static_cast<int>(j["live_bar_throttle_ms"].get<unsigned int>());
+  }
+
+  if (j.contains("indicator_cache_mb")) {
+    if (!j["indicator_cache_mb"].is_number_unsigned()) {
+      error = "'indicator_cache_mb' must be an unsigned number";
+      return std::nullopt;
+    }
+    cfg.indicator_cache_mb = static_cast<int>(j["indicator_cache_mb"].get<unsigned int>());
+  }
+
   if (j.contains("signal")) {
     if (!j["signal"].is_object()) {
       error = "'signal' must be an object";
@@ -225,6 +281,20 @@ std::optional<ConfigData> ConfigSchema::parse(const nlohmann::json &j,
         cfg.signal.params[it.key()] = it.value().get<double>();
       }
     }
+    if (s.contains("buy")) {
+      if (!s["buy"].is_string()) {
+        error = "'signal.buy' must be a string";
+        return std::nullopt;
+      }
+      cfg.signal.buy = s["buy"].get<std::string>();
+    }
+    if (s.contains("sell")) {
+      if (!s["sell"].is_string()) {
+        error = "'signal.sell' must be a string";
+        return std::nullopt;
+      }
+      cfg.signal.sell = s["sell"].get<std::string>();
+    }
   }
 
   return cfg;
@@ -14,6 +14,9 @@ struct SignalConfig {
   std::size_t short_period{0};
   std::size_t long_period{0};
   std::map<std::string, double> params{};
+  // Rules for type "expression" (see rule_program.h).
+  std::string buy{};
+  std::string sell{};
 };
 
 struct ConfigData {
@@ -34,9 +37,22 @@ struct ConfigData {
   int webview_ready_timeout_ms{5000};
   // Limit JS updates pushed into WebView; default 2000ms.
   int webview_throttle_ms{2000};
+  // Freshness windows for the on-disk provider metadata cache (seconds).
+  int symbols_cache_ttl_s{3600};
+  int intervals_cache_ttl_s{86400};
   SignalConfig signal{};
   std::string primary_provider{"hyperliquid"};
   std::optional<std::string> fallback_provider{};
+  // Race a slow active-provider request against a secondary provider.
+  bool hedge_requests{false};
+  // Warm non-active pairs/intervals in the background with idle capacity.
+  bool prefetch{true};
+  // Stream the forming bar (with enable_streaming) and update the last
+  // candle in place; at most one update per series per live_bar_throttle_ms.
+  bool live_bars{true};
+  int live_bar_throttle_ms{250};
+  // Memory cap of the shared indicator cache (MiB).
+  int indicator_cache_mb{128};
 };
 
 } // namespace Config
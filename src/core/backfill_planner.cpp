@@ -0,0 +1,134 @@
+#include "backfill_planner.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+
+namespace Core {
+
+namespace {
+
+// Merging is evaluated against at most this many preceding gaps; beyond that
+// a merged span is always more expensive than the separate requests.
+constexpr std::size_t kMaxMergeLookback = 256;
+
+long long align_down(long long t, long long step) {
+  long long r = t % step;
+  if (r < 0)
+    r += step;
+  return t - r;
+}
+
+std::size_t requests_for(std::size_t rows, std::size_t cap) {
+  return (rows + cap - 1) / cap;
+}
+
+} // namespace
+
+bool BackfillPlanner::is_synthetic(const Candle &c) { return c.synthetic; }
+
+BackfillPlan BackfillPlanner::plan(const std::vector<Candle> &candles,
+                                   const BackfillOptions &options) {
+  BackfillPlan out;
+  const long long step = options.interval_ms;
+  const std::size_t cap = std::max<std::size_t>(1, options.max_rows_per_request);
+  if (step <= 0)
+    return out;
+
+  long long ws = options.window_start_ms;
+  long long we = options.window_end_ms;
+  if (ws == 0)
+    ws = candles.empty() ? 0 : candles.front().open_time;
+  if (we == 0)
+    we = candles.empty() ? 0 : candles.back().open_time;
+  ws = align_down(ws, step);
+  we = align_down(we, step);
+  if (we < ws || (ws == 0 && we == 0))
+    return out;
+
+  // Coverage bitmap over the window, one slot per interval.
+  const auto slots = static_cast<std::size_t>((we - ws) / step + 1);
+  std::vector<std::uint8_t> present(slots, 0);
+  for (const auto &c : candles) {
+    if (c.open_time < ws || c.open_time > we)
+      continue;
+    if (options.treat_synthetic_as_gap && is_synthetic(c))
+      continue;
+    present[static_cast<std::size_t>((c.open_time - ws) / step)] = 1;
+  }
+  for (const auto &r : options.known_empty) {
+    const long long first = std::max(ws, r.start_ms);
+    const long long last = std::min(we, r.end_ms);
+    for (long long i = (first - ws + step - 1) / step; ws + i * step <= last; ++i)
+      present[static_cast<std::size_t>(i)] = 1;
+  }
+
+  struct Run {
+    std::size_t first;
+    std::size_t last;
+  };
+  std::vector<Run> runs;
+  for (std::size_t i = 0; i < slots;) {
+    if (present[i]) {
+      ++i;
+      continue;
+    }
+    std::size_t j = i;
+    while (j + 1 < slots && !present[j + 1])
+      ++j;
+    runs.push_back({i, j});
+    out.missing_candles += j - i + 1;
+    i = j + 1;
+  }
+  if (runs.empty())
+    return out;
+
+  auto to_range = [&](std::size_t first, std::size_t last) {
+    return BackfillRange{ws + static_cast<long long>(first) * step,
+                         ws + static_cast<long long>(last) * step,
+                         last - first + 1};
+  };
+  out.gaps.reserve(runs.size());
+  for (const auto &r : runs)
+    out.gaps.push_back(to_range(r.first, r.last));
+
+  // Partition runs into consecutive groups minimising the request count
+  // (ties broken by fewer downloaded rows). best[i] covers runs[0..i).
+  const std::size_t n = runs.size();
+  constexpr std::size_t kInf = std::numeric_limits<std::size_t>::max();
+  std::vector<std::size_t> best_requests(n + 1, kInf), best_rows(n + 1, kInf),
+      split(n + 1, 0);
+  best_requests[0] = 0;
+  best_rows[0] = 0;
+  for (std::size_t i = 1; i <= n; ++i) {
+    const std::size_t lo = i > kMaxMergeLookback ? i - kMaxMergeLookback : 0;
+    for (std::size_t j = i; j-- > lo;) {
+      const std::size_t rows = runs[i - 1].last - runs[j].first + 1;
+      const std::size_t reqs = best_requests[j] + requests_for(rows, cap);
+      const std::size_t total_rows = best_rows[j] + rows;
+      if (reqs < best_requests[i] ||
+          (reqs == best_requests[i] && total_rows < best_rows[i])) {
+        best_requests[i] = reqs;
+        best_rows[i] = total_rows;
+        split[i] = j;
+      }
+    }
+  }
+
+  std::vector<Run> groups;
+  for (std::size_t i = n; i > 0; i = split[i])
+    groups.push_back({runs[split[i]].first, runs[i - 1].last});
+  std::reverse(groups.begin(), groups.end());
+
+  out.requests.reserve(best_requests[n]);
+  for (const auto &g : groups) {
+    for (std::size_t first = g.first; first <= g.last; first += cap) {
+      const std::size_t last = std::min(g.last, first + cap - 1);
+      out.requests.push_back(to_range(first, last));
+      out.requested_candles += last - first + 1;
+    }
+  }
+  return out;
+}
+
+} // namespace Core
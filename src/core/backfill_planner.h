@@ -0,0 +1,52 @@
+#pragma once
+
+#include "candle.h"
+
+#include <cstddef>
+#include <vector>
+
+namespace Core {
+
+// Inclusive range of candle open times, [start_ms, end_ms].
+struct BackfillRange {
+  long long start_ms{0};
+  long long end_ms{0};
+  std::size_t candles{0};
+};
+
+struct BackfillOptions {
+  long long interval_ms{0};
+  // Provider row cap for one range request.
+  std::size_t max_rows_per_request{1000};
+  // Placeholders created by fill_missing() (Candle::synthetic) stand for
+  // data we never received; count them as missing.
+  bool treat_synthetic_as_gap{true};
+  // Ranges the venue already answered without candles (no trading, or
+  // before its history starts); planned as if present.
+  std::vector<BackfillRange> known_empty;
+  // Desired coverage window (open times). 0 means "series bounds"; a start
+  // before the first candle plans older history, an end after the last one
+  // plans the recent tail.
+  long long window_start_ms{0};
+  long long window_end_ms{0};
+};
+
+struct BackfillPlan {
+  std::vector<BackfillRange> gaps;     // missing runs in the window
+  std::vector<BackfillRange> requests; // merged and split to the row cap
+  std::size_t missing_candles{0};
+  std::size_t requested_candles{0};    // includes present candles bridged by merges
+};
+
+// Turns a candle series into the smallest set of range requests that covers
+// every missing candle. Gaps are merged when one request spanning both (and
+// re-downloading the candles in between) is cheaper than fetching them
+// separately; the merged ranges are then cut at the provider's row limit.
+class BackfillPlanner {
+public:
+  static BackfillPlan plan(const std::vector<Candle> &candles,
+                           const BackfillOptions &options);
+  static bool is_synthetic(const Candle &candle);
+};
+
+} // namespace Core
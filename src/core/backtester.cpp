@@ -17,8 +17,12 @@ BacktestResult Backtester::run() {
     double total_pnl = 0.0;
     size_t wins = 0;
 
+    // One call for the whole series rather than one per candle.
+    std::vector<int> signals(m_candles.size(), 0);
+    m_strategy.generate_signals(m_candles, signals);
+
     for (size_t i = 0; i < m_candles.size(); ++i) {
-        int signal = m_strategy.generate_signal(m_candles, i);
+        int signal = signals[i];
         if (!in_position && signal > 0) {
             // enter long
             in_position = true;
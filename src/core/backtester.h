@@ -1,8 +1,10 @@
 #pragma once
 
 #include "candle.h"
+#include "timeframe_alignment.h"
 #include <vector>
 #include <memory>
+#include <span>
 
 namespace Core {
 
@@ -12,6 +14,19 @@ public:
     virtual ~IStrategy() = default;
     // Return 1 for buy, -1 for sell, 0 for hold
     virtual int generate_signal(const std::vector<Candle>& candles, size_t index) = 0;
+    // Signals for every index (out has candles.size() elements). Strategies
+    // that evaluate a whole series at once override this; the default asks
+    // generate_signal for each index.
+    virtual void generate_signals(const std::vector<Candle>& candles, std::span<int> out) {
+        for (size_t i = 0; i < candles.size() && i < out.size(); ++i) {
+            out[i] = generate_signal(candles, i);
+        }
+    }
+    // Other intervals of the same pair, aligned to the candles passed next
+    // (see TimeframeAlignments). The views must outlive the calls that use
+    // them; strategies that mix intervals read frames[k].aligned[i] instead
+    // of searching by time. Ignored by default.
+    virtual void set_timeframes(std::span<const AlignedSeries> frames) { (void)frames; }
 };
 
 struct Trade {
@@ -0,0 +1,144 @@
+#include "bar_aggregator.h"
+
+#include <algorithm>
+
+#include "interval_utils.h"
+
+namespace Core {
+
+namespace {
+// Longer silent stretches are left to history repair rather than emitted
+// as a burst of flat bars.
+constexpr long long kMaxFlatBars = 1024;
+
+long long window_start(long long time, long long period) {
+  const long long q = time / period;
+  return (time % period < 0 ? q - 1 : q) * period;
+}
+} // namespace
+
+bool BarAggregator::add_interval(const std::string &interval) {
+  const long long period = parse_interval(interval).count();
+  if (period <= 0)
+    return false;
+  if (has_interval(interval))
+    return true;
+  Series s;
+  s.interval = interval;
+  s.period = period;
+  series_.push_back(std::move(s));
+  return true;
+}
+
+bool BarAggregator::remove_interval(const std::string &interval) {
+  auto it = std::find_if(series_.begin(), series_.end(),
+                         [&](const Series &s) { return s.interval == interval; });
+  if (it == series_.end())
+    return false;
+  series_.erase(it);
+  return true;
+}
+
+bool BarAggregator::has_interval(const std::string &interval) const {
+  return std::any_of(series_.begin(), series_.end(),
+                     [&](const Series &s) { return s.interval == interval; });
+}
+
+std::vector<std::string> BarAggregator::intervals() const {
+  std::vector<std::string> out;
+  out.reserve(series_.size());
+  for (const auto &s : series_)
+    out.push_back(s.interval);
+  return out;
+}
+
+void BarAggregator::fold(Candle &bar, const Trade &trade) {
+  bar.high = std::max(bar.high, trade.price);
+  bar.low = std::min(bar.low, trade.price);
+  bar.close = trade.price;
+  bar.volume += trade.qty;
+  bar.quote_asset_volume += trade.qty * trade.price;
+  bar.number_of_trades += trade.count;
+  if (trade.taker_buy) {
+    bar.taker_buy_base_asset_volume += trade.qty;
+    bar.taker_buy_quote_asset_volume += trade.qty * trade.price;
+  }
+}
+
+void BarAggregator::emit_flat(Series &s, long long until_open,
+                              std::vector<Bar> &closed) {
+  if (s.next_open < 0 || s.next_open >= until_open)
+    return;
+  if ((until_open - s.next_open) / s.period > kMaxFlatBars) {
+    s.next_open = until_open;
+    return;
+  }
+  for (; s.next_open < until_open; s.next_open += s.period) {
+    const double p = s.last_close;
+    closed.push_back({s.interval, Candle(s.next_open, p, p, p, p, 0.0,
+                                         s.next_open + s.period - 1)});
+  }
+}
+
+void BarAggregator::close_bar(Series &s, std::vector<Bar> &closed) {
+  closed.push_back({s.interval, s.bar});
+  s.open = false;
+  s.next_open = s.bar.open_time + s.period;
+  s.last_close = s.bar.close;
+}
+
+void BarAggregator::on_trade(const Trade &trade, std::vector<Bar> &closed) {
+  bool late = false;
+  for (auto &s : series_) {
+    const long long start = window_start(trade.time, s.period);
+    if (s.open && start < s.bar.open_time) {
+      late = true;
+      fold(s.bar, trade);
+      continue;
+    }
+    if (s.open && start == s.bar.open_time) {
+      fold(s.bar, trade);
+      continue;
+    }
+    if (s.open)
+      close_bar(s, closed);
+    else if (s.next_open > start) {
+      // The window was already closed by close_until().
+      late = true;
+      continue;
+    }
+    emit_flat(s, start, closed);
+    const double p = trade.price;
+    s.bar = Candle(start, p, p, p, p, 0.0, start + s.period - 1);
+    s.open = true;
+    fold(s.bar, trade);
+  }
+  if (late)
+    ++late_trades_;
+}
+
+void BarAggregator::close_until(long long time_ms, std::vector<Bar> &closed) {
+  for (auto &s : series_) {
+    if (s.open && s.bar.close_time < time_ms)
+      close_bar(s, closed);
+    // Windows that start before the one containing time_ms have ended.
+    if (!s.open)
+      emit_flat(s, window_start(time_ms, s.period), closed);
+  }
+}
+
+void BarAggregator::forming(std::vector<Bar> &out) const {
+  for (const auto &s : series_)
+    if (s.open)
+      out.push_back({s.interval, s.bar});
+}
+
+void BarAggregator::reset() {
+  for (auto &s : series_) {
+    s.open = false;
+    s.next_open = -1;
+    s.last_close = 0.0;
+  }
+}
+
+} // namespace Core
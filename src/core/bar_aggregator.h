@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "candle.h"
+#include "trade.h"
+
+namespace Core {
+
+// Builds time-based bars for any number of intervals from one symbol's
+// trade stream. Every trade is folded into the current bar of each interval
+// in O(1); a trade in a later window closes the current bar. Bars carry the
+// same derived fields as exchange klines (quote volume, trade count,
+// taker-buy base/quote volume), and windows without trades are emitted as
+// flat zero-volume bars at the previous close, as Binance does. Not
+// thread-safe.
+class BarAggregator {
+public:
+  struct Bar {
+    std::string interval;
+    Candle candle;
+  };
+
+  // Returns false for intervals parse_interval() rejects.
+  bool add_interval(const std::string &interval);
+  // Drops the interval and its forming bar; returns false if unknown.
+  bool remove_interval(const std::string &interval);
+  bool has_interval(const std::string &interval) const;
+  bool empty() const { return series_.empty(); }
+  std::vector<std::string> intervals() const;
+
+  // Folds the trade into every interval; bars it closes are appended to
+  // `closed` in time order. A trade older than the current bar (delivered
+  // late) is folded into the current bar and counted in late_trades().
+  void on_trade(const Trade &trade, std::vector<Bar> &closed);
+  // Closes bars (and fills empty windows) that end before `time_ms`, so
+  // quiet series still advance. Call with the clock minus a grace period
+  // that covers delivery latency.
+  void close_until(long long time_ms, std::vector<Bar> &closed);
+  // Appends the forming bar of every interval that has one.
+  void forming(std::vector<Bar> &out) const;
+  // Forgets forming bars and history (e.g. after a reconnect, when trades
+  // were missed); intervals are kept.
+  void reset();
+
+  std::uint64_t late_trades() const { return late_trades_; }
+
+private:
+  struct Series {
+    std::string interval;
+    long long period{0};
+    Candle bar;
+    bool open{false};
+    // Open time of the window after the last emitted bar, or -1.
+    long long next_open{-1};
+    double last_close{0.0};
+  };
+
+  static void fold(Candle &bar, const Trade &trade);
+  static void emit_flat(Series &s, long long until_open, std::vector<Bar> &closed);
+  static void close_bar(Series &s, std::vector<Bar> &closed);
+
+  std::vector<Series> series_;
+  std::uint64_t late_trades_{0};
+};
+
+} // namespace Core
@@ -0,0 +1,67 @@
+#include "bar_update_coalescer.h"
+
+namespace Core {
+
+BarUpdateCoalescer::BarUpdateCoalescer(std::chrono::milliseconds interval)
+    : interval_(interval) {}
+
+std::optional<Candle> BarUpdateCoalescer::offer(const std::string &series,
+                                                const Candle &bar,
+                                                Clock::time_point now) {
+  auto [it, inserted] = slots_.try_emplace(series);
+  Slot &slot = it->second;
+  if (inserted || now - slot.last_emit >= interval_) {
+    slot.last_emit = now;
+    slot.pending.reset();
+    return bar;
+  }
+  if (slot.pending && bar.open_time < slot.pending->open_time)
+    return std::nullopt; // late update of an older bar
+  slot.pending = bar;
+  return std::nullopt;
+}
+
+std::vector<std::pair<std::string, Candle>>
+BarUpdateCoalescer::take_due(Clock::time_point now) {
+  std::vector<std::pair<std::string, Candle>> out;
+  for (auto &[series, slot] : slots_) {
+    if (slot.pending && now - slot.last_emit >= interval_) {
+      out.emplace_back(series, *slot.pending);
+      slot.pending.reset();
+      slot.last_emit = now;
+    }
+  }
+  return out;
+}
+
+std::optional<BarUpdateCoalescer::Clock::time_point>
+BarUpdateCoalescer::next_due() const {
+  std::optional<Clock::time_point> due;
+  for (const auto &entry : slots_) {
+    if (!entry.second.pending)
+      continue;
+    auto t = entry.second.last_emit + interval_;
+    if (!due || t < *due)
+      due = t;
+  }
+  return due;
+}
+
+void BarUpdateCoalescer::on_closed(const std::string &series, long long open_time) {
+  auto it = slots_.find(series);
+  if (it != slots_.end() && it->second.pending &&
+      it->second.pending->open_time <= open_time)
+    it->second.pending.reset();
+}
+
+void BarUpdateCoalescer::erase(const std::string &series) { slots_.erase(series); }
+
+std::size_t BarUpdateCoalescer::pending() const {
+  std::size_t n = 0;
+  for (const auto &entry : slots_)
+    if (entry.second.pending)
+      ++n;
+  return n;
+}
+
+} // namespace Core
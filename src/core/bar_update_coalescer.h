@@ -0,0 +1,53 @@
+#pragma once
+
+#include "candle.h"
+
+#include <chrono>
+#include <map>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace Core {
+
+// Rate-limits in-progress bar updates per series. The first update after a
+// quiet period passes straight through; later ones within the interval
+// replace a single pending update, which becomes due once the interval has
+// elapsed. Only the newest state of a forming bar is ever kept, so memory
+// and downstream work are bounded by the number of series, not the message
+// rate. Not thread-safe: the owner serialises access.
+class BarUpdateCoalescer {
+public:
+  using Clock = std::chrono::steady_clock;
+
+  explicit BarUpdateCoalescer(
+      std::chrono::milliseconds interval = std::chrono::milliseconds(250));
+
+  void set_interval(std::chrono::milliseconds interval) { interval_ = interval; }
+  std::chrono::milliseconds interval() const { return interval_; }
+
+  // Returns the update when it may be forwarded now, otherwise keeps it as
+  // the pending update of the series.
+  std::optional<Candle> offer(const std::string &series, const Candle &bar,
+                              Clock::time_point now);
+  // Removes and returns the pending updates whose interval has elapsed.
+  std::vector<std::pair<std::string, Candle>> take_due(Clock::time_point now);
+  // Earliest time a pending update becomes due.
+  std::optional<Clock::time_point> next_due() const;
+  // A closed bar supersedes pending updates of the same or older bars.
+  void on_closed(const std::string &series, long long open_time);
+  void erase(const std::string &series);
+  std::size_t pending() const;
+
+private:
+  struct Slot {
+    Clock::time_point last_emit{};
+    std::optional<Candle> pending;
+  };
+
+  std::chrono::milliseconds interval_;
+  std::map<std::string, Slot> slots_;
+};
+
+} // namespace Core
@@ -19,6 +19,9 @@ struct Candle {
     double taker_buy_base_asset_volume;
     double taker_buy_quote_asset_volume;
     double ignore; // Unused field, often present in kline data
+    // Placeholder inserted by fill_missing() for a bar that was never
+    // received. Never written to disk: holes are filled again on load.
+    bool synthetic = false;
 
     // Constructor
     Candle(long long ot = 0, double o = 0.0, double h = 0.0, double l = 0.0, double c = 0.0, double v = 0.0,
@@ -0,0 +1,110 @@
+#include "candle_batch_writer.h"
+
+#include <algorithm>
+
+#include "latency_tracker.h"
+
+namespace Core {
+
+CandleBatchWriter::CandleBatchWriter(CandleManager &manager,
+                                     std::chrono::milliseconds commit_delay)
+    : manager_(manager), commit_delay_(commit_delay) {}
+
+CandleBatchWriter::~CandleBatchWriter() { stop(); }
+
+void CandleBatchWriter::start() {
+  if (worker_.joinable())
+    return;
+  worker_ = std::jthread([this](std::stop_token stoken) { run(stoken); });
+}
+
+void CandleBatchWriter::stop() {
+  if (worker_.joinable()) {
+    worker_.request_stop();
+    cv_.notify_all();
+    worker_ = std::jthread();
+  }
+  flush();
+}
+
+void CandleBatchWriter::enqueue(const std::string &symbol,
+                                const std::string &interval,
+                                const Candle &candle, long long received_us) {
+  bool first = false;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto &series = pending_[{symbol, interval}];
+    if (!series.empty() && series.back().candle.open_time == candle.open_time)
+      series.back() = {candle, received_us};
+    else {
+      series.push_back({candle, received_us});
+      first = buffered_++ == 0;
+    }
+  }
+  if (first)
+    cv_.notify_one();
+}
+
+std::size_t CandleBatchWriter::flush() {
+  std::lock_guard<std::mutex> commit(commit_mutex_);
+  std::map<Key, std::vector<Pending>> round;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    round.swap(pending_);
+    buffered_ = 0;
+  }
+  if (round.empty())
+    return 0;
+  std::vector<CandleManager::SeriesAppend> batch;
+  batch.reserve(round.size());
+  for (auto &[key, entries] : round) {
+    std::sort(entries.begin(), entries.end(), [](const Pending &a, const Pending &b) {
+      return a.candle.open_time < b.candle.open_time;
+    });
+    std::vector<Candle> candles;
+    candles.reserve(entries.size());
+    for (const auto &e : entries)
+      candles.push_back(e.candle);
+    batch.push_back({key.first, key.second, std::move(candles)});
+  }
+  const std::size_t written = manager_.append_batch(batch);
+  const long long now = LatencyTracker::steady_us();
+  for (const auto &entry : round)
+    for (const auto &e : entry.second)
+      if (e.received_us > 0)
+        LatencyTracker::instance().record(LatencyTracker::Stage::Persist,
+                                          now - e.received_us);
+  std::lock_guard<std::mutex> lock(mutex_);
+  stats_.candles += written;
+  stats_.commits += 1;
+  stats_.series_writes += batch.size();
+  return written;
+}
+
+void CandleBatchWriter::run(std::stop_token stoken) {
+  while (!stoken.stop_requested()) {
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      if (!cv_.wait(lock, stoken, [this] { return buffered_ > 0; }))
+        return;
+    }
+    // Let the rest of the boundary burst arrive, then commit it together.
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      cv_.wait_for(lock, stoken, commit_delay_, [] { return false; });
+    }
+    flush();
+  }
+}
+
+std::size_t CandleBatchWriter::buffered() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return buffered_;
+}
+
+CandleBatchWriter::Stats CandleBatchWriter::stats() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return stats_;
+}
+
+} // namespace Core
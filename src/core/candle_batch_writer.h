@@ -0,0 +1,74 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "candle.h"
+#include "candle_manager.h"
+
+namespace Core {
+
+// Group-commit persistence for streamed candles. enqueue() only buffers;
+// a writer thread commits everything buffered across all series in one
+// CandleManager::append_batch call, commit_delay after the first candle of
+// a round arrives. The candles that close together at a bar boundary
+// therefore share one commit and each series costs one write, not a full
+// open/read/append/rewrite cycle per candle.
+class CandleBatchWriter {
+public:
+  struct Stats {
+    std::uint64_t candles{0}; // rows written
+    std::uint64_t commits{0};
+    std::uint64_t series_writes{0};
+  };
+
+  explicit CandleBatchWriter(
+      CandleManager &manager,
+      std::chrono::milliseconds commit_delay = std::chrono::milliseconds(200));
+  ~CandleBatchWriter();
+  CandleBatchWriter(const CandleBatchWriter &) = delete;
+  CandleBatchWriter &operator=(const CandleBatchWriter &) = delete;
+
+  void start();
+  // Commits whatever is still buffered, then joins the writer thread.
+  void stop();
+
+  // received_us (steady clock, 0 if unknown) feeds the persist latency
+  // stage once the candle is committed.
+  void enqueue(const std::string &symbol, const std::string &interval,
+               const Candle &candle, long long received_us = 0);
+  // Commits the buffer on the calling thread; returns rows written.
+  std::size_t flush();
+
+  std::size_t buffered() const;
+  Stats stats() const;
+
+private:
+  using Key = std::pair<std::string, std::string>;
+  struct Pending {
+    Candle candle;
+    long long received_us{0};
+  };
+
+  void run(std::stop_token stoken);
+
+  CandleManager &manager_;
+  const std::chrono::milliseconds commit_delay_;
+
+  mutable std::mutex mutex_;
+  std::condition_variable_any cv_;
+  std::map<Key, std::vector<Pending>> pending_;
+  std::size_t buffered_{0};
+  Stats stats_;
+  std::mutex commit_mutex_; // one commit at a time
+  std::jthread worker_;
+};
+
+} // namespace Core
@@ -14,6 +14,25 @@
 
 namespace Core {
 
+namespace {
+constexpr const char* kCsvHeader =
+    "open_time,open,high,low,close,volume,close_time,quote_asset_volume,number_of_trades,taker_buy_base_asset_volume,taker_buy_quote_asset_volume,ignore\n";
+
+void write_row(std::ostream& out, const Candle& c) {
+    out << c.open_time << ","
+        << c.open << ","
+        << c.high << ","
+        << c.low << ","
+        << c.close << ","
+        << c.volume << ","
+        << c.close_time << ","
+        << c.quote_asset_volume << ","
+        << c.number_of_trades << ","
+        << c.taker_buy_base_asset_volume << ","
+        << c.taker_buy_quote_asset_volume << ","
+        << c.ignore << "\n";
+}
+} // namespace
 
 CandleManager::CandleManager() : data_dir_(resolve_data_dir()) {}
 
@@ -21,8 +40,11 @@ CandleManager::CandleManager(const std::filesystem::path& dir) : data_dir_(dir)
     std::filesystem::create_directories(data_dir_);
 }
 
+CandleManager::~CandleManager() { drop_append_handles(); }
+
 void CandleManager::set_data_dir(const std::filesystem::path& dir) {
     std::lock_guard<std::recursive_mutex> lock(mutex_);
+    drop_append_handles();
     data_dir_ = dir;
     std::filesystem::create_directories(data_dir_);
 }
@@ -114,6 +136,7 @@ bool CandleManager::save_candles(const std::string& symbol, const std::string& i
     Logger::instance().info("Saving " + std::to_string(candles.size()) + " candles to " + path_to_save.string());
     {
         std::lock_guard<std::recursive_mutex> lock(mutex_);
+        drop_append_handle(symbol, interval);
         std::ofstream file(path_to_save);
 
         if (!file.is_open()) {
@@ -122,24 +145,14 @@ bool CandleManager::save_candles(const std::string& symbol, const std::string& i
         }
 
         // Write header (ensure newline so first data row isn't merged)
-        file << "open_time,open,high,low,close,volume,close_time,quote_asset_volume,number_of_trades,taker_buy_base_asset_volume,taker_buy_quote_asset_volume,ignore\n";
+        file << kCsvHeader;
         file.setf(std::ios::fixed);
         file << std::setprecision(8);
 
-        // Write candle data
+        // Write candle data; fill_missing() placeholders are recreated on load
         for (const auto& candle : candles) {
-            file << candle.open_time << ","
-                 << candle.open << ","
-                 << candle.high << ","
-                 << candle.low << ","
-                 << candle.close << ","
-                 << candle.volume << ","
-                 << candle.close_time << ","
-                 << candle.quote_asset_volume << ","
-                 << candle.number_of_trades << ","
-                 << candle.taker_buy_base_asset_volume << ","
-                 << candle.taker_buy_quote_asset_volume << ","
-                 << candle.ignore << "\n";
+            if (!candle.synthetic)
+                write_row(file, candle);
         }
 
         file.flush();
@@ -191,6 +204,7 @@ bool CandleManager::append_candles(const std::string& symbol, const std::string&
 
     {
         std::lock_guard<std::recursive_mutex> lock(mutex_);
+        drop_append_handle(symbol, interval);
         last_open_time = read_last_open_time(symbol, interval);
 
         bool file_exists = std::filesystem::exists(path_to_save);
@@ -201,32 +215,22 @@ bool CandleManager::append_candles(const std::string& symbol, const std::string&
         }
 
         if (!file_exists || std::filesystem::file_size(path_to_save) == 0) {
-            file << "open_time,open,high,low,close,volume,close_time,quote_asset_volume,number_of_trades,taker_buy_base_asset_volume,taker_buy_quote_asset_volume,ignore\n";
+            file << kCsvHeader;
         }
 
         file.setf(std::ios::fixed);
         file << std::setprecision(8);
 
         for (const auto& c : candles) {
+            if (c.synthetic)
+                continue;
             if (last_open_time >= 0 && c.open_time <= last_open_time) {
                 if (c.open_time < last_open_time) { ++overlaps; }
                 else { ++duplicates; }
                 continue;
             }
 
-            file << c.open_time << ","
-                 << c.open << ","
-                 << c.high << ","
-                 << c.low << ","
-                 << c.close << ","
-                 << c.volume << ","
-                 << c.close_time << ","
-                 << c.quote_asset_volume << ","
-                 << c.number_of_trades << ","
-                 << c.taker_buy_base_asset_volume << ","
-                 << c.taker_buy_quote_asset_volume << ","
-                 << c.ignore << "\n";
-
+            write_row(file, c);
             last_open_time = c.open_time;
             ++written;
         }
@@ -246,6 +250,97 @@ bool CandleManager::append_candles(const std::string& symbol, const std::string&
     return true;
 }
 
+CandleManager::AppendHandle* CandleManager::append_handle(const std::string& symbol, const std::string& interval) const {
+    const std::string key = symbol + "_" + interval;
+    auto it = append_handles_.find(key);
+    if (it != append_handles_.end())
+        return &it->second;
+
+    AppendHandle handle;
+    handle.last_open_time = read_last_open_time(symbol, interval);
+    const auto csv_path = get_candle_path(symbol, interval);
+    const auto idx_path = get_index_path(symbol, interval);
+    std::error_code ec;
+    const bool needs_header = !std::filesystem::exists(csv_path, ec) ||
+                              std::filesystem::file_size(csv_path, ec) == 0;
+    handle.file = std::fopen(csv_path.string().c_str(), "ab");
+    // An empty index (crash between truncate and write) makes
+    // read_last_open_time fall back to the CSV tail.
+    handle.idx = handle.file ? std::fopen(idx_path.string().c_str(), "wb") : nullptr;
+    if (!handle.file || !handle.idx) {
+        Logger::instance().error("Could not open file for appending: " + csv_path.string());
+        if (handle.file)
+            std::fclose(handle.file);
+        return nullptr;
+    }
+    if (needs_header)
+        std::fputs(kCsvHeader, handle.file);
+    if (handle.last_open_time >= 0) {
+        std::fprintf(handle.idx, "%20lld", handle.last_open_time);
+        std::fflush(handle.idx);
+    }
+    return &append_handles_.emplace(key, std::move(handle)).first->second;
+}
+
+void CandleManager::drop_append_handle(const std::string& symbol, const std::string& interval) const {
+    auto it = append_handles_.find(symbol + "_" + interval);
+    if (it == append_handles_.end())
+        return;
+    std::fclose(it->second.file);
+    std::fclose(it->second.idx);
+    append_handles_.erase(it);
+}
+
+void CandleManager::drop_append_handles() const {
+    for (auto& entry : append_handles_) {
+        std::fclose(entry.second.file);
+        std::fclose(entry.second.idx);
+    }
+    append_handles_.clear();
+}
+
+std::size_t CandleManager::append_batch(const std::vector<SeriesAppend>& batch) const {
+    std::size_t total = 0;
+    std::lock_guard<std::recursive_mutex> lock(mutex_);
+    std::ostringstream rows;
+    rows.setf(std::ios::fixed);
+    rows << std::setprecision(8);
+    for (const auto& series : batch) {
+        if (series.candles.empty())
+            continue;
+        AppendHandle* handle = append_handle(series.symbol, series.interval);
+        if (!handle)
+            continue;
+        rows.str(std::string());
+        std::size_t written = 0;
+        long long last = handle->last_open_time;
+        for (const auto& c : series.candles) {
+            if (c.synthetic || (last >= 0 && c.open_time <= last))
+                continue;
+            write_row(rows, c);
+            last = c.open_time;
+            ++written;
+        }
+        if (written == 0)
+            continue;
+        const std::string out = rows.str();
+        if (std::fwrite(out.data(), 1, out.size(), handle->file) != out.size() ||
+            std::fflush(handle->file) != 0) {
+            Logger::instance().error("Failed to append candles for " + series.symbol + " " + series.interval);
+            drop_append_handle(series.symbol, series.interval);
+            continue;
+        }
+        handle->last_open_time = last;
+        // Fixed width, so the previous value is always fully overwritten;
+        // the leading spaces are skipped when the index is read back.
+        std::fseek(handle->idx, 0, SEEK_SET);
+        std::fprintf(handle->idx, "%20lld", last);
+        std::fflush(handle->idx);
+        total += written;
+    }
+    return total;
+}
+
 bool CandleManager::validate_candles(const std::string& symbol, const std::string& interval) const {
     std::lock_guard<std::recursive_mutex> lock(mutex_);
     std::filesystem::path path = get_candle_path(symbol, interval);
@@ -327,6 +422,8 @@ bool CandleManager::save_candles_json(const std::string& symbol, const std::stri
         }
         nlohmann::json j = nlohmann::json::array();
         for (const auto& c : candles) {
+            if (c.synthetic)
+                continue;
             j.push_back({
                 {"open_time", c.open_time},
                 {"open", c.open},
@@ -525,6 +622,15 @@ nlohmann::json CandleManager::load_candles_tradingview(const std::string& symbol
 
 bool CandleManager::remove_candles(const std::string& symbol) const {
     std::lock_guard<std::recursive_mutex> lock(mutex_);
+    for (auto it = append_handles_.begin(); it != append_handles_.end();) {
+        if (it->first.rfind(symbol + "_", 0) == 0) {
+            std::fclose(it->second.file);
+            std::fclose(it->second.idx);
+            it = append_handles_.erase(it);
+        } else {
+            ++it;
+        }
+    }
     bool success = true;
     if (std::filesystem::exists(data_dir_) && std::filesystem::is_directory(data_dir_)) {
         std::string prefix = symbol + "_";
@@ -547,6 +653,7 @@ bool CandleManager::remove_candles(const std::string& symbol) const {
 
 bool CandleManager::clear_interval(const std::string& symbol, const std::string& interval) const {
     std::lock_guard<std::recursive_mutex> lock(mutex_);
+    drop_append_handle(symbol, interval);
     bool success = true;
     std::error_code ec;
     std::filesystem::path csv_path = get_candle_path(symbol, interval);
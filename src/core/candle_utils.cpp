@@ -20,6 +20,7 @@ void fill_missing(std::vector<Candle> &candles, long long interval_ms) {
       filled.emplace_back(expected, cur.close, cur.close, cur.close, cur.close,
                          0.0, expected + interval_ms - 1, 0.0, 0, 0.0, 0.0,
                          0.0);
+      filled.back().synthetic = true;
       expected += interval_ms;
     }
   }
@@ -54,14 +55,20 @@ void normalize_candles(std::vector<Candle> &candles) {
   candles.swap(out);
 }
 
-void merge_candles(std::vector<Candle> &base, const std::vector<Candle> &add) {
-  if (add.empty()) { normalize_candles(base); return; }
+bool merge_candles(std::vector<Candle> &base, const std::vector<Candle> &add) {
+  if (add.empty()) { normalize_candles(base); return false; }
+  const bool rewrites =
+      !base.empty() &&
+      std::any_of(add.begin(), add.end(), [last = base.back().open_time](const Candle &c) {
+        return c.open_time < last;
+      });
   std::vector<Candle> merged;
   merged.reserve(base.size() + add.size());
   merged.insert(merged.end(), base.begin(), base.end());
   merged.insert(merged.end(), add.begin(), add.end());
   normalize_candles(merged);
   base.swap(merged);
+  return rewrites;
 }
 
 bool ParseLong(std::string_view s, long long &out) {
@@ -6,6 +6,8 @@
 
 namespace Core {
 
+// Inserts flat zero-volume placeholders (Candle::synthetic) for every bar
+// missing between two candles.
 void fill_missing(std::vector<Candle> &candles, long long interval_ms);
 
 // Ensure candles are sorted by open_time ascending, deduplicated (keep last
@@ -13,8 +15,10 @@ void fill_missing(std::vector<Candle> &candles, long long interval_ms);
 void normalize_candles(std::vector<Candle> &candles);
 
 // Merge 'add' into 'base' by open_time; values from 'add' override on
-// duplicates. Result is normalized and sorted.
-void merge_candles(std::vector<Candle> &base, const std::vector<Candle> &add);
+// duplicates. Result is normalized and sorted. Returns true when 'add'
+// reached before the last candle of 'base', i.e. the merge may have changed
+// more than an append or the last (forming) candle.
+bool merge_candles(std::vector<Candle> &base, const std::vector<Candle> &add);
 
 bool ParseLong(std::string_view s, long long &out);
 bool ParseInt(std::string_view s, int &out);
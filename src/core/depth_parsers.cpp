@@ -0,0 +1,272 @@
+#include "depth_parsers.h"
+
+#include <charconv>
+#include <cstdint>
+#include <cstdlib>
+
+namespace Core {
+
+namespace {
+
+double as_double(const nlohmann::json &v) {
+  if (v.is_string())
+    return std::strtod(v.get_ref<const std::string &>().c_str(), nullptr);
+  if (v.is_number())
+    return v.get<double>();
+  return 0.0;
+}
+
+// [["price", "qty"], ...]
+bool parse_pairs(const nlohmann::json &arr, std::vector<PriceLevel> &out) {
+  if (!arr.is_array())
+    return false;
+  out.reserve(arr.size());
+  for (const auto &l : arr) {
+    if (!l.is_array() || l.size() < 2)
+      return false;
+    out.push_back({as_double(l[0]), as_double(l[1])});
+  }
+  return true;
+}
+
+// [{"px": "...", "sz": "...", "n": k}, ...]
+bool parse_objects(const nlohmann::json &arr, std::vector<PriceLevel> &out) {
+  if (!arr.is_array())
+    return false;
+  out.reserve(arr.size());
+  for (const auto &l : arr) {
+    if (!l.is_object() || !l.contains("px") || !l.contains("sz"))
+      return false;
+    out.push_back({as_double(l["px"]), as_double(l["sz"])});
+  }
+  return true;
+}
+
+// Forward-only reader over JSON text for the fields a depth message needs;
+// anything else is skipped without being decoded.
+class Scanner {
+public:
+  explicit Scanner(std::string_view text)
+      : p_(text.data()), end_(text.data() + text.size()) {}
+
+  bool eat(char c) {
+    skip_ws();
+    if (p_ == end_ || *p_ != c)
+      return false;
+    ++p_;
+    return true;
+  }
+
+  // Key or string value, returned without unescaping.
+  bool string(std::string_view &out) {
+    if (!eat('"'))
+      return false;
+    const char *start = p_;
+    while (p_ != end_ && *p_ != '"')
+      p_ += (*p_ == '\\' && p_ + 1 != end_) ? 2 : 1;
+    if (p_ == end_)
+      return false;
+    out = {start, static_cast<std::size_t>(p_ - start)};
+    ++p_;
+    return true;
+  }
+
+  // Bare or quoted ("0.0024") decimal. Plain decimals of up to 15 digits,
+  // which is what venues send, take the exact fast path (an integer
+  // mantissa divided by a power of ten rounds correctly); anything else
+  // goes through from_chars.
+  bool number(double &out) {
+    skip_ws();
+    const bool quoted = p_ != end_ && *p_ == '"';
+    const char *q = p_ + quoted;
+    const bool negative = q != end_ && *q == '-';
+    q += negative;
+    std::uint64_t mantissa = 0;
+    const char *first = q;
+    q = digits_of(q, mantissa);
+    int digits = static_cast<int>(q - first);
+    int decimals = 0;
+    if (q != end_ && *q == '.') {
+      first = ++q;
+      q = digits_of(q, mantissa);
+      decimals = static_cast<int>(q - first);
+      digits += decimals;
+    }
+    const bool plain = digits > 0 && digits <= 15 &&
+                       (q == end_ || (*q != 'e' && *q != 'E'));
+    if (!plain)
+      return number<double>(out);
+    static constexpr double kPow10[] = {1e0, 1e1, 1e2,  1e3,  1e4,  1e5,  1e6,  1e7,
+                                        1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15};
+    out = static_cast<double>(mantissa) / kPow10[decimals];
+    if (negative)
+      out = -out;
+    p_ = q;
+    return !quoted || eat('"');
+  }
+
+  // Bare or quoted integer, or a number from_chars has to handle.
+  template <typename T> bool number(T &out) {
+    skip_ws();
+    const bool quoted = p_ != end_ && *p_ == '"';
+    if (quoted)
+      ++p_;
+    const auto res = std::from_chars(p_, end_, out);
+    if (res.ec != std::errc())
+      return false;
+    p_ = res.ptr;
+    return !quoted || eat('"');
+  }
+
+  bool skip_value() {
+    skip_ws();
+    if (p_ == end_)
+      return false;
+    if (*p_ == '"') {
+      std::string_view ignored;
+      return string(ignored);
+    }
+    if (*p_ != '{' && *p_ != '[') {
+      while (p_ != end_ && *p_ != ',' && *p_ != '}' && *p_ != ']')
+        ++p_;
+      return true;
+    }
+    int nesting = 0;
+    do {
+      if (*p_ == '"') {
+        std::string_view ignored;
+        if (!string(ignored))
+          return false;
+        continue;
+      }
+      if (*p_ == '{' || *p_ == '[')
+        ++nesting;
+      else if (*p_ == '}' || *p_ == ']')
+        --nesting;
+      ++p_;
+    } while (nesting > 0 && p_ != end_);
+    return nesting == 0;
+  }
+
+private:
+  // Accumulates decimal digits into `value`; returns the first non-digit.
+  const char *digits_of(const char *q, std::uint64_t &value) const {
+    for (; q != end_ && static_cast<unsigned>(*q - '0') < 10; ++q)
+      value = value * 10 + static_cast<unsigned>(*q - '0');
+    return q;
+  }
+
+  void skip_ws() {
+    while (p_ != end_ && (*p_ == ' ' || *p_ == '\n' || *p_ == '\r' || *p_ == '\t'))
+      ++p_;
+  }
+
+  const char *p_;
+  const char *end_;
+};
+
+// [["price", "qty"], ...]
+bool scan_pairs(Scanner &in, std::vector<PriceLevel> &out) {
+  out.clear();
+  if (!in.eat('['))
+    return false;
+  if (in.eat(']'))
+    return true;
+  do {
+    PriceLevel level;
+    if (!in.eat('[') || !in.number(level.price) || !in.eat(',') ||
+        !in.number(level.qty))
+      return false;
+    while (in.eat(','))
+      if (!in.skip_value())
+        return false;
+    if (!in.eat(']'))
+      return false;
+    out.push_back(level);
+  } while (in.eat(','));
+  return in.eat(']');
+}
+
+bool scan_depth_update(Scanner &in, DepthDiff &out, bool &has_first, bool &has_final) {
+  if (!in.eat('{'))
+    return false;
+  if (in.eat('}'))
+    return true;
+  do {
+    std::string_view key;
+    if (!in.string(key) || !in.eat(':'))
+      return false;
+    bool ok = true;
+    if (key == "data") {
+      ok = scan_depth_update(in, out, has_first, has_final);
+    } else if (key == "U") {
+      ok = in.number(out.first_update_id);
+      has_first = ok;
+    } else if (key == "u") {
+      ok = in.number(out.final_update_id);
+      has_final = ok;
+    } else if (key == "E") {
+      ok = in.number(out.event_time);
+    } else if (key == "b") {
+      ok = scan_pairs(in, out.bids);
+    } else if (key == "a") {
+      ok = scan_pairs(in, out.asks);
+    } else {
+      ok = in.skip_value();
+    }
+    if (!ok)
+      return false;
+  } while (in.eat(','));
+  return in.eat('}');
+}
+
+} // namespace
+
+std::optional<DepthSnapshot> parse_binance_depth_snapshot(const nlohmann::json &j) {
+  if (!j.is_object() || !j.contains("lastUpdateId"))
+    return std::nullopt;
+  DepthSnapshot s;
+  s.last_update_id = j["lastUpdateId"].get<std::uint64_t>();
+  if (!parse_pairs(j.value("bids", nlohmann::json::array()), s.bids) ||
+      !parse_pairs(j.value("asks", nlohmann::json::array()), s.asks))
+    return std::nullopt;
+  return s;
+}
+
+std::optional<DepthDiff> parse_binance_depth_update(const nlohmann::json &d) {
+  if (!d.is_object() || !d.contains("U") || !d.contains("u"))
+    return std::nullopt;
+  DepthDiff diff;
+  diff.first_update_id = d["U"].get<std::uint64_t>();
+  diff.final_update_id = d["u"].get<std::uint64_t>();
+  diff.event_time = d.value("E", 0LL);
+  if (!parse_pairs(d.value("b", nlohmann::json::array()), diff.bids) ||
+      !parse_pairs(d.value("a", nlohmann::json::array()), diff.asks))
+    return std::nullopt;
+  return diff;
+}
+
+bool parse_binance_depth_update(std::string_view text, DepthDiff &out) {
+  out.first_update_id = out.final_update_id = 0;
+  out.event_time = 0;
+  out.bids.clear();
+  out.asks.clear();
+  Scanner in(text);
+  bool has_first = false, has_final = false;
+  return scan_depth_update(in, out, has_first, has_final) && has_first && has_final;
+}
+
+std::optional<DepthSnapshot> parse_hyperliquid_l2_book(const nlohmann::json &data) {
+  if (!data.is_object() || !data.contains("levels"))
+    return std::nullopt;
+  const auto &levels = data["levels"];
+  if (!levels.is_array() || levels.size() != 2)
+    return std::nullopt;
+  DepthSnapshot s;
+  s.last_update_id = data.value("time", 0ULL);
+  if (!parse_objects(levels[0], s.bids) || !parse_objects(levels[1], s.asks))
+    return std::nullopt;
+  return s;
+}
+
+} // namespace Core
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <optional>
+#include <string_view>
+
+#include <nlohmann/json.hpp>
+
+#include "order_book.h"
+
+namespace Core {
+
+// Binance REST depth snapshot ({lastUpdateId, bids, asks}).
+std::optional<DepthSnapshot> parse_binance_depth_snapshot(const nlohmann::json &j);
+
+// Binance "depthUpdate" event payload ({U, u, E, b, a}).
+std::optional<DepthDiff> parse_binance_depth_update(const nlohmann::json &d);
+
+// The same, straight from the message text, bare or in a combined-stream
+// envelope ({"stream", "data"}). Scans the text once without building a
+// DOM and reuses the level vectors of `out`; this is the per-message path.
+// Returns false for anything that is not a well-formed depthUpdate.
+bool parse_binance_depth_update(std::string_view text, DepthDiff &out);
+
+// Hyperliquid "l2Book" channel data ({coin, time, levels: [bids, asks]},
+// each level {px, sz, n}). Every message is a full snapshot; `time` becomes
+// the snapshot id.
+std::optional<DepthSnapshot> parse_hyperliquid_l2_book(const nlohmann::json &data);
+
+} // namespace Core
@@ -1,5 +1,7 @@
 #include "exchange_utils.h"
 
+#include <cstring>
+
 std::string to_gate_symbol(const std::string &symbol) {
   if (symbol.size() < 6)
     return symbol;
@@ -8,3 +10,13 @@ std::string to_gate_symbol(const std::string &symbol) {
   return base + "_" + quote;
 }
 
+std::string to_hyperliquid_coin(const std::string &symbol) {
+  const std::string s = symbol;
+  auto ends_with = [&](const char* suf) {
+    size_t n = std::strlen(suf);
+    return s.size() >= n && s.compare(s.size()-n, n, suf) == 0;
+  };
+  if (ends_with("USDT")) return s.substr(0, s.size()-4);
+  if (ends_with("USD")) return s.substr(0, s.size()-3);
+  return s;
+}
@@ -4,3 +4,5 @@
 
 std::string to_gate_symbol(const std::string &symbol);
 
+// Hyperliquid coin name: strips a USDT/USD quote suffix ("BTCUSDT" -> "BTC").
+std::string to_hyperliquid_coin(const std::string &symbol);
@@ -0,0 +1,134 @@
+#include "kline_parsers.h"
+
+namespace Core {
+
+namespace {
+
+double as_double(const nlohmann::json &v) {
+  try {
+    if (v.is_string()) return std::stod(v.get<std::string>());
+    if (v.is_number_float()) return v.get<double>();
+    if (v.is_number_integer()) return static_cast<double>(v.get<long long>());
+  } catch (...) {
+  }
+  return 0.0;
+}
+
+std::optional<KlineUpdate> parse_gate_entry(const nlohmann::json &e) {
+  long long t = 0;
+  double o = 0, h = 0, l = 0, c = 0, v = 0;
+  bool closed = true;
+  if (e.is_object()) {
+    t = static_cast<long long>(std::stoll(e.value("t", std::string("0")))) * 1000LL;
+    o = std::stod(e.value("o", std::string("0")));
+    h = std::stod(e.value("h", std::string("0")));
+    l = std::stod(e.value("l", std::string("0")));
+    c = std::stod(e.value("c", std::string("0")));
+    v = std::stod(e.value("v", std::string("0")));
+    closed = e.value("w", true);
+  } else if (e.is_array()) {
+    // Gate WS format: typically [t, o, h, l, c, v] or [t, v, c, h, l, o]
+    // We'll first try REST-like [t, v, c, h, l, o]
+    try {
+      t = std::stoll(e.at(0).get<std::string>()) * 1000LL;
+      v = std::stod(e.at(1).get<std::string>());
+      c = std::stod(e.at(2).get<std::string>());
+      h = std::stod(e.at(3).get<std::string>());
+      l = std::stod(e.at(4).get<std::string>());
+      o = std::stod(e.at(5).get<std::string>());
+    } catch (...) {
+      // Fallback: [t, o, h, l, c, v]
+      try {
+        t = std::stoll(e.at(0).get<std::string>()) * 1000LL;
+        o = std::stod(e.at(1).get<std::string>());
+        h = std::stod(e.at(2).get<std::string>());
+        l = std::stod(e.at(3).get<std::string>());
+        c = std::stod(e.at(4).get<std::string>());
+        v = std::stod(e.at(5).get<std::string>());
+      } catch (...) {
+        t = 0; // parsing failed
+      }
+    }
+  }
+  if (t <= 0)
+    return std::nullopt;
+  return KlineUpdate{Candle(t, o, h, l, c, v, t, 0.0, 0, 0.0, 0.0, 0.0), closed};
+}
+
+} // namespace
+
+std::optional<KlineUpdate> parse_binance_kline(const nlohmann::json &k) {
+  if (!k.is_object())
+    return std::nullopt;
+  long long t = k.value("t", 0LL);
+  long long T = k.value("T", 0LL);
+  auto num = [&](const char *key) { return as_double(k.value(key, nlohmann::json())); };
+  Candle c(t, num("o"), num("h"), num("l"), num("c"), num("v"), T, num("q"),
+           k.value("n", 0), num("V"), num("Q"), 0.0);
+  return KlineUpdate{c, k.value("x", false)};
+}
+
+std::optional<KlineUpdate> parse_hyperliquid_candle(const nlohmann::json &e) {
+  if (!e.is_object() || !e.contains("t"))
+    return std::nullopt;
+  auto num = [&](const char *key) { return as_double(e.value(key, nlohmann::json())); };
+  const long long t = e.value("t", 0LL);
+  Candle c(t, num("o"), num("h"), num("l"), num("c"), num("v"), e.value("T", 0LL),
+           0.0, e.value("n", 0), 0.0, 0.0, 0.0);
+  return KlineUpdate{c, false};
+}
+
+std::optional<Trade> parse_binance_trade(const nlohmann::json &d) {
+  if (!d.is_object() || !d.contains("T") || !d.contains("p"))
+    return std::nullopt;
+  Trade t;
+  t.time = d.value("T", 0LL);
+  t.price = as_double(d["p"]);
+  t.qty = as_double(d.value("q", nlohmann::json()));
+  t.taker_buy = !d.value("m", false);
+  if (d.contains("f") && d.contains("l"))
+    t.count = static_cast<int>(d.value("l", 0LL) - d.value("f", 0LL) + 1);
+  return t;
+}
+
+std::optional<Trade> parse_hyperliquid_trade(const nlohmann::json &e) {
+  if (!e.is_object() || !e.contains("time") || !e.contains("px"))
+    return std::nullopt;
+  Trade t;
+  t.time = e.value("time", 0LL);
+  t.price = as_double(e["px"]);
+  t.qty = as_double(e.value("sz", nlohmann::json()));
+  t.taker_buy = e.value("side", std::string()) == "B";
+  return t;
+}
+
+std::optional<Trade> parse_gate_trade(const nlohmann::json &result) {
+  if (!result.is_object() || !result.contains("price"))
+    return std::nullopt;
+  Trade t;
+  if (result.contains("create_time_ms"))
+    t.time = static_cast<long long>(as_double(result["create_time_ms"]));
+  else
+    t.time = result.value("create_time", 0LL) * 1000LL;
+  t.price = as_double(result["price"]);
+  t.qty = as_double(result.value("amount", nlohmann::json()));
+  t.taker_buy = result.value("side", std::string()) == "buy";
+  return t;
+}
+
+std::vector<KlineUpdate> parse_gate_candles(const nlohmann::json &result) {
+  std::vector<KlineUpdate> out;
+  auto add = [&](const nlohmann::json &e) {
+    if (auto u = parse_gate_entry(e))
+      out.push_back(*u);
+  };
+  if (result.is_array() && !result.empty() && result[0].is_array()) {
+    for (const auto &e : result)
+      add(e);
+  } else if (result.is_array() || result.is_object()) {
+    add(result);
+  }
+  return out;
+}
+
+} // namespace Core
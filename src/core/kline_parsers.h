@@ -0,0 +1,45 @@
+#pragma once
+
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+#include "candle.h"
+#include "latency_tracker.h"
+#include "trade.h"
+
+namespace Core {
+
+// One kline event from a venue stream. `closed` is set once the bar is final.
+struct KlineUpdate {
+  Candle candle;
+  bool closed{false};
+  LatencyStamps stamps{};
+};
+
+// Binance kline object (the "k" member of a kline event).
+std::optional<KlineUpdate> parse_binance_kline(const nlohmann::json &k);
+
+// Gate.io spot.candlesticks "result": a single entry (object or array) or an
+// array of array entries. Entries without a window flag count as closed.
+std::vector<KlineUpdate> parse_gate_candles(const nlohmann::json &result);
+
+// Hyperliquid "candle" channel entry ({t, T, s, i, o, h, l, c, v, n}). The
+// feed has no close flag: a bar is final once a later `t` arrives for the
+// same coin/interval, so the returned update is never marked closed.
+std::optional<KlineUpdate> parse_hyperliquid_candle(const nlohmann::json &e);
+
+// Binance "aggTrade" or "trade" event payload. `m` (buyer is maker) marks a
+// taker sell; an aggTrade counts as l - f + 1 trades.
+std::optional<Trade> parse_binance_trade(const nlohmann::json &d);
+
+// Hyperliquid "trades" channel entry ({coin, side, px, sz, time}); side "B"
+// is a taker buy.
+std::optional<Trade> parse_hyperliquid_trade(const nlohmann::json &e);
+
+// Gate.io spot.trades "result"; `side` is the taker side.
+std::optional<Trade> parse_gate_trade(const nlohmann::json &result);
+
+} // namespace Core
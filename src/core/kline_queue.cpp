@@ -0,0 +1,65 @@
+#include "kline_queue.h"
+
+#include <algorithm>
+
+namespace Core {
+
+KlineQueue::KlineQueue(std::size_t capacity) : ring_(capacity) {}
+
+void KlineQueue::publish(const KlineUpdate &update) {
+  published_.fetch_add(1, std::memory_order_relaxed);
+  std::size_t depth = 0;
+  if (!spilled_.load(std::memory_order_acquire) && ring_.try_push(update)) {
+    depth = ring_.size();
+  } else {
+    std::lock_guard<std::mutex> lock(spill_mutex_);
+    std::size_t moved = 0;
+    while (moved < spill_.size() && ring_.try_push(spill_[moved]))
+      ++moved;
+    spill_.erase(spill_.begin(), spill_.begin() + static_cast<std::ptrdiff_t>(moved));
+    // Keep order: once anything is spilled, later updates queue behind it.
+    if (!spill_.empty() || !ring_.try_push(update))
+      spill(update);
+    spilled_.store(!spill_.empty(), std::memory_order_release);
+    depth = ring_.size() + spill_.size();
+  }
+
+  std::size_t seen = high_water_.load(std::memory_order_relaxed);
+  while (depth > seen &&
+         !high_water_.compare_exchange_weak(seen, depth, std::memory_order_relaxed)) {
+  }
+}
+
+void KlineQueue::spill(const KlineUpdate &update) {
+  auto it = std::lower_bound(spill_.begin(), spill_.end(), update.candle.open_time,
+                             [](const KlineUpdate &u, long long t) {
+                               return u.candle.open_time < t;
+                             });
+  if (it != spill_.end() && it->candle.open_time == update.candle.open_time) {
+    // A forming update never replaces the final bar.
+    if (update.closed || !it->closed)
+      *it = update;
+    coalesced_.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+  spill_.insert(it, update);
+}
+
+std::size_t KlineQueue::drain(std::vector<KlineUpdate> &out) {
+  const std::size_t before = out.size();
+  KlineUpdate update;
+  while (ring_.try_pop(update))
+    out.push_back(update);
+  if (spilled_.load(std::memory_order_acquire)) {
+    std::lock_guard<std::mutex> lock(spill_mutex_);
+    // The producer may have moved part of the spill into the ring since.
+    while (ring_.try_pop(update))
+      out.push_back(update);
+    out.insert(out.end(), spill_.begin(), spill_.end());
+    spill_.clear();
+    spilled_.store(false, std::memory_order_release);
+  }
+  return out.size() - before;
+}
+
+} // namespace Core
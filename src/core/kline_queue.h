@@ -0,0 +1,51 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+#include "kline_parsers.h"
+#include "spsc_ring.h"
+
+namespace Core {
+
+// Hand-off of one stream's kline updates from the network thread to the
+// application thread, lock-free while the ring has room. When the ring is
+// full the producer keeps the overflow in a spill list coalesced by
+// open_time: a newer update of the same bar replaces the spilled one, and
+// closed bars are never dropped. The spill is guarded by a mutex that only
+// the overflow path takes; the producer moves it back into the ring once
+// there is room, and drain() takes what is left so a spilled bar never
+// waits for the next publish.
+class KlineQueue {
+public:
+  explicit KlineQueue(std::size_t capacity = 256);
+
+  // Producer side (one producer at a time).
+  void publish(const KlineUpdate &update);
+  // Consumer side: appends every available update to out, oldest first.
+  std::size_t drain(std::vector<KlineUpdate> &out);
+
+  std::size_t depth() const { return ring_.size(); }
+  std::size_t capacity() const { return ring_.capacity(); }
+  std::size_t high_water() const { return high_water_.load(std::memory_order_relaxed); }
+  std::uint64_t published() const { return published_.load(std::memory_order_relaxed); }
+  // Updates merged into a spilled update of the same bar.
+  std::uint64_t coalesced() const { return coalesced_.load(std::memory_order_relaxed); }
+
+private:
+  void spill(const KlineUpdate &update);
+
+  SpscRing<KlineUpdate> ring_;
+  std::mutex spill_mutex_;
+  std::vector<KlineUpdate> spill_; // ascending open_time, under spill_mutex_
+  // Set while spill_ is non-empty: later updates must queue behind it.
+  std::atomic<bool> spilled_{false};
+  std::atomic<std::size_t> high_water_{0};
+  std::atomic<std::uint64_t> published_{0};
+  std::atomic<std::uint64_t> coalesced_{0};
+};
+
+} // namespace Core
@@ -9,6 +9,7 @@
 
 #include "core/logger.h"
 #include "exchange_utils.h"
+#include "kline_parsers.h"
 
 namespace Core {
 
@@ -16,25 +17,23 @@ KlineStream::KlineStream(const std::string &symbol, const std::string &interval,
                          CandleManager &manager, WebSocketFactory ws_factory,
                          SleepFunc sleep_func,
                          std::chrono::milliseconds base_delay,
-                         const std::string &provider)
+                         const std::string &provider,
+                         std::shared_ptr<MarketDataBus> bus)
     : symbol_(symbol), interval_(interval), provider_(provider), candle_manager_(manager),
       ws_factory_(std::move(ws_factory)),
       sleep_func_(sleep_func ? std::move(sleep_func)
                              : [](std::chrono::milliseconds
                                       d) { std::this_thread::sleep_for(d); }),
-      base_delay_(base_delay) {}
+      base_delay_(base_delay), bus_(std::move(bus)) {}
 
 KlineStream::~KlineStream() { stop(); }
 
-void KlineStream::start(CandleCallback cb, ErrorCallback err_cb,
-                        UICallback ui_cb) {
+void KlineStream::start(CandleCallback cb, ErrorCallback err_cb) {
   if (running_)
     return;
   running_ = true;
   auto self = shared_from_this();
-  thread_ = std::thread([self, cb, err_cb, ui_cb]() {
-    self->run(cb, err_cb, ui_cb);
-  });
+  thread_ = std::thread([self, cb, err_cb]() { self->run(cb, err_cb); });
 }
 
 void KlineStream::stop() {
@@ -50,8 +49,7 @@ void KlineStream::stop() {
   cb_cv_.wait(lk, [this] { return callbacks_inflight_.load() == 0; });
 }
 
-void KlineStream::run(CandleCallback cb, ErrorCallback err_cb,
-                      UICallback ui_cb) {
+void KlineStream::run(CandleCallback cb, ErrorCallback err_cb) {
   std::string url;
   const bool is_binance = (provider_ == "binance");
   const bool is_gateio = (provider_ == "gateio");
@@ -63,6 +61,7 @@ void KlineStream::run(CandleCallback cb, ErrorCallback err_cb,
     url = "wss://api.gateio.ws/ws/v4/";
   } else {
     Logger::instance().warn("Streaming provider '" + provider_ + "' not supported; Kline streaming disabled");
+    if (bus_) bus_->publish_stream_status(provider_, StreamStatus::Failed);
     if (err_cb) err_cb();
     running_ = false;
     return;
@@ -77,6 +76,7 @@ void KlineStream::run(CandleCallback cb, ErrorCallback err_cb,
     if (!ws_) {
       Logger::instance().warn(
           "WebSocket support not available; Kline streaming disabled");
+      if (bus_) bus_->publish_stream_status(provider_, StreamStatus::Failed);
       if (err_cb)
         err_cb();
       running_ = false;
@@ -96,6 +96,8 @@ void KlineStream::run(CandleCallback cb, ErrorCallback err_cb,
         Logger::instance().info(
             std::string("WS open (") + self->provider_ + ") for " + self->symbol_ +
             " " + self->interval_);
+        if (self->bus_)
+          self->bus_->publish_stream_status(self->provider_, StreamStatus::Connected);
       }
     });
     if (is_gateio) {
@@ -116,110 +118,25 @@ void KlineStream::run(CandleCallback cb, ErrorCallback err_cb,
         }
       });
     }
-    ws_->setOnMessage([this, cb, err_cb, ui_cb, is_binance, is_gateio](const std::string &msg) {
+    ws_->setOnMessage([this, cb, err_cb, is_binance, is_gateio](const std::string &msg) {
       try {
         auto j = nlohmann::json::parse(msg);
+        auto deliver = [&](const Candle &c) {
+          candle_manager_.append_candles(symbol_, interval_, {c});
+          if (cb) cb(c);
+          if (bus_) bus_->publish_candle_closed(symbol_, interval_, c);
+        };
         if (is_binance) {
           if (j.contains("k")) {
-            auto k = j["k"];
-            bool closed = k.value("x", false);
-            if (closed) {
-              auto as_double = [](const nlohmann::json &v) -> double {
-                try {
-                  if (v.is_string()) return std::stod(v.get<std::string>());
-                  if (v.is_number_float()) return v.get<double>();
-                  if (v.is_number_integer()) return static_cast<double>(v.get<long long>());
-                } catch (...) {
-                }
-                return 0.0;
-              };
-              long long t = k.value("t", 0LL);
-              long long T = k.value("T", 0LL);
-              double o = as_double(k["o"]);
-              double h = as_double(k["h"]);
-              double l = as_double(k["l"]);
-              double cpx = as_double(k["c"]);
-              double v = as_double(k["v"]);
-              double q = as_double(k["q"]);
-              double V = as_double(k["V"]);
-              double Q = as_double(k["Q"]);
-              Candle c(t, o, h, l, cpx, v, T, q, k.value("n", 0), V, Q, 0.0);
-              candle_manager_.append_candles(symbol_, interval_, {c});
-              if (cb) cb(c);
-              if (ui_cb) {
-                nlohmann::json out{{"time", c.open_time / 1000},
-                                   {"open", c.open},
-                                   {"high", c.high},
-                                   {"low", c.low},
-                                   {"close", c.close},
-                                   {"volume", c.volume}};
-                ui_cb(out.dump());
-              }
-            }
+            auto update = parse_binance_kline(j["k"]);
+            if (update && update->closed)
+              deliver(update->candle);
           }
         } else if (is_gateio) {
           if (j.value("channel", std::string()) == std::string("spot.candlesticks") &&
               j.value("event", std::string()) == std::string("update")) {
-            auto res = j["result"];
-            auto process_entry = [&](const nlohmann::json &e) {
-              long long t = 0;
-              double o=0,h=0,l=0,c=0,v=0;
-              std::string pair;
-              if (e.is_object()) {
-                t = static_cast<long long>(std::stoll(e.value("t", std::string("0")))) * 1000LL;
-                o = std::stod(e.value("o", std::string("0")));
-                h = std::stod(e.value("h", std::string("0")));
-                l = std::stod(e.value("l", std::string("0")));
-                c = std::stod(e.value("c", std::string("0")));
-                v = std::stod(e.value("v", std::string("0")));
-              } else if (e.is_array()) {
-                // Gate WS format: typically [t, o, h, l, c, v] or [t, v, c, h, l, o]
-                // We'll first try REST-like [t, v, c, h, l, o]
-                try {
-                  t = std::stoll(e.at(0).get<std::string>()) * 1000LL;
-                  v = std::stod(e.at(1).get<std::string>());
-                  c = std::stod(e.at(2).get<std::string>());
-                  h = std::stod(e.at(3).get<std::string>());
-                  l = std::stod(e.at(4).get<std::string>());
-                  o = std::stod(e.at(5).get<std::string>());
-                } catch (...) {
-                  // Fallback: [t, o, h, l, c, v]
-                  try {
-                    t = std::stoll(e.at(0).get<std::string>()) * 1000LL;
-                    o = std::stod(e.at(1).get<std::string>());
-                    h = std::stod(e.at(2).get<std::string>());
-                    l = std::stod(e.at(3).get<std::string>());
-                    c = std::stod(e.at(4).get<std::string>());
-                    v = std::stod(e.at(5).get<std::string>());
-                  } catch (...) {
-                    t = 0; // parsing failed
-                  }
-                }
-              }
-              if (t > 0) {
-                Candle cd(t, o, h, l, c, v, t, 0.0, 0, 0.0, 0.0, 0.0);
-                candle_manager_.append_candles(symbol_, interval_, {cd});
-                if (cb) cb(cd);
-                if (ui_cb) {
-                  nlohmann::json out{{"time", cd.open_time / 1000},
-                                     {"open", cd.open},
-                                     {"high", cd.high},
-                                     {"low", cd.low},
-                                     {"close", cd.close},
-                                     {"volume", cd.volume}};
-                  ui_cb(out.dump());
-                }
-              }
-            };
-            if (res.is_array()) {
-              if (!res.empty() && res[0].is_array()) {
-                for (const auto &e : res) process_entry(e);
-              } else {
-                process_entry(res);
-              }
-            } else if (res.is_object()) {
-              process_entry(res);
-            }
+            for (const auto &update : parse_gate_candles(j["result"]))
+              deliver(update.candle);
           }
         }
       } catch (const std::exception &e) {
@@ -278,6 +195,9 @@ void KlineStream::run(CandleCallback cb, ErrorCallback err_cb,
       }
     }
 
+    if (bus_)
+      bus_->publish_stream_status(provider_, error->load() ? StreamStatus::Failed
+                                                           : StreamStatus::Disconnected);
     if (error->load() && err_cb)
       err_cb();
 
@@ -12,13 +12,15 @@
 #include "candle.h"
 #include "candle_manager.h"
 #include "iwebsocket.h"
+#include "market_data_bus.h"
 
 namespace Core {
+// Single-series stream. Candles are persisted, passed to the start() callback
+// and, when a bus is given, published on it together with connection status.
 class KlineStream : public std::enable_shared_from_this<KlineStream> {
 public:
   using CandleCallback = std::function<void(const Candle &)>;
   using ErrorCallback = std::function<void()>;
-  using UICallback = std::function<void(const std::string &)>;
   using SleepFunc = std::function<void(std::chrono::milliseconds)>;
 
   KlineStream(
@@ -27,16 +29,16 @@ public:
       WebSocketFactory ws_factory = default_websocket_factory(),
       SleepFunc sleep_func = nullptr,
       std::chrono::milliseconds base_delay = std::chrono::milliseconds(1000),
-      const std::string &provider = std::string("binance"));
+      const std::string &provider = std::string("binance"),
+      std::shared_ptr<MarketDataBus> bus = nullptr);
   ~KlineStream();
 
-  void start(CandleCallback cb, ErrorCallback err_cb = nullptr,
-             UICallback ui_cb = nullptr);
+  void start(CandleCallback cb, ErrorCallback err_cb = nullptr);
   void stop();
   bool running() const { return running_; }
 
 private:
-  void run(CandleCallback cb, ErrorCallback err_cb, UICallback ui_cb);
+  void run(CandleCallback cb, ErrorCallback err_cb);
 
   std::string symbol_;
   std::string interval_;
@@ -45,6 +47,7 @@ private:
   WebSocketFactory ws_factory_;
   SleepFunc sleep_func_;
   std::chrono::milliseconds base_delay_;
+  std::shared_ptr<MarketDataBus> bus_;
   std::thread thread_;
   std::atomic<bool> running_{false};
   std::mutex ws_mutex_;
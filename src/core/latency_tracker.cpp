@@ -0,0 +1,172 @@
+#include "latency_tracker.h"
+
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <utility>
+
+#include <nlohmann/json.hpp>
+
+namespace Core {
+
+namespace {
+constexpr long long kLinear = 64;
+constexpr int kSubBits = 5; // 32 sub-buckets per power of two
+constexpr long long kMaxValue = (1LL << 32) - 1;
+} // namespace
+
+std::size_t LatencyHistogram::bucket_of(long long micros) {
+  if (micros < 0)
+    micros = 0;
+  if (micros > kMaxValue)
+    micros = kMaxValue;
+  if (micros < kLinear)
+    return static_cast<std::size_t>(micros);
+  const auto v = static_cast<std::uint64_t>(micros);
+  const int exp = std::bit_width(v) - 1; // >= 6
+  const int shift = exp - kSubBits;
+  const auto sub = static_cast<std::size_t>(v >> shift) - 32;
+  return static_cast<std::size_t>(kLinear) + static_cast<std::size_t>(exp - 6) * 32 + sub;
+}
+
+double LatencyHistogram::bucket_mid(std::size_t index) {
+  if (index < static_cast<std::size_t>(kLinear))
+    return static_cast<double>(index);
+  const std::size_t off = index - static_cast<std::size_t>(kLinear);
+  const int exp = static_cast<int>(off / 32) + 6;
+  const long long width = 1LL << (exp - kSubBits);
+  const long long lower = static_cast<long long>(off % 32 + 32) * width;
+  return static_cast<double>(lower) + static_cast<double>(width - 1) / 2.0;
+}
+
+void LatencyHistogram::record(long long micros) {
+  buckets_[bucket_of(micros)].fetch_add(1, std::memory_order_relaxed);
+  count_.fetch_add(1, std::memory_order_relaxed);
+  long long prev = max_.load(std::memory_order_relaxed);
+  while (micros > prev &&
+         !max_.compare_exchange_weak(prev, micros, std::memory_order_relaxed)) {
+  }
+}
+
+double LatencyHistogram::percentile(double q) const {
+  const std::uint64_t total = count();
+  if (total == 0)
+    return 0.0;
+  q = q < 0.0 ? 0.0 : (q > 1.0 ? 1.0 : q);
+  auto rank = static_cast<std::uint64_t>(q * static_cast<double>(total) + 0.5);
+  if (rank == 0)
+    rank = 1;
+  std::uint64_t seen = 0;
+  for (std::size_t i = 0; i < kBuckets; ++i) {
+    seen += buckets_[i].load(std::memory_order_relaxed);
+    if (seen >= rank)
+      return std::min(bucket_mid(i), static_cast<double>(max()));
+  }
+  return static_cast<double>(max());
+}
+
+void LatencyHistogram::reset() {
+  for (auto &b : buckets_)
+    b.store(0, std::memory_order_relaxed);
+  count_.store(0, std::memory_order_relaxed);
+  max_.store(0, std::memory_order_relaxed);
+}
+
+LatencyTracker &LatencyTracker::instance() {
+  static LatencyTracker tracker;
+  return tracker;
+}
+
+const char *LatencyTracker::stage_name(Stage stage) {
+  switch (stage) {
+  case Stage::Network:
+    return "network";
+  case Stage::Parse:
+    return "parse";
+  case Stage::Merge:
+    return "merge";
+  case Stage::Persist:
+    return "persist";
+  case Stage::Render:
+    return "render";
+  case Stage::EndToEnd:
+    return "end_to_end";
+  default:
+    return "?";
+  }
+}
+
+long long LatencyTracker::steady_us() {
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+long long LatencyTracker::wall_ms() {
+  return std::chrono::duration_cast<std::chrono::milliseconds>(
+             std::chrono::system_clock::now().time_since_epoch())
+      .count();
+}
+
+void LatencyTracker::record(Stage stage, long long micros) {
+  stages_[static_cast<std::size_t>(stage)].record(micros);
+}
+
+const LatencyHistogram &LatencyTracker::histogram(Stage stage) const {
+  return stages_[static_cast<std::size_t>(stage)];
+}
+
+LatencyTracker::Summary LatencyTracker::summary(Stage stage) const {
+  const auto &h = histogram(stage);
+  return {h.count(), h.percentile(0.50) / 1000.0, h.percentile(0.99) / 1000.0,
+          static_cast<double>(h.max()) / 1000.0};
+}
+
+std::string LatencyTracker::status_line() const {
+  static constexpr std::pair<Stage, const char *> kShown[] = {
+      {Stage::EndToEnd, "e2e"}, {Stage::Network, "net"},   {Stage::Parse, "parse"},
+      {Stage::Merge, "merge"},  {Stage::Render, "render"}, {Stage::Persist, "disk"}};
+  std::string out;
+  char buf[64];
+  for (const auto &[stage, label] : kShown) {
+    const auto s = summary(stage);
+    if (s.count == 0)
+      continue;
+    std::snprintf(buf, sizeof(buf), "%s%s %.3g/%.3g", out.empty() ? "" : " ", label,
+                  s.p50_ms, s.p99_ms);
+    out += buf;
+  }
+  return out;
+}
+
+std::string LatencyTracker::dump_json() const {
+  nlohmann::json j = nlohmann::json::object();
+  for (std::size_t i = 0; i < kStages; ++i) {
+    const auto &h = stages_[i];
+    j[stage_name(static_cast<Stage>(i))] = {
+        {"count", h.count()},
+        {"p50_ms", h.percentile(0.50) / 1000.0},
+        {"p90_ms", h.percentile(0.90) / 1000.0},
+        {"p99_ms", h.percentile(0.99) / 1000.0},
+        {"p999_ms", h.percentile(0.999) / 1000.0},
+        {"max_ms", static_cast<double>(h.max()) / 1000.0}};
+  }
+  return j.dump(2);
+}
+
+bool LatencyTracker::write_dump(const std::filesystem::path &path) const {
+  std::ofstream out(path, std::ios::trunc);
+  if (!out)
+    return false;
+  out << dump_json() << '\n';
+  return static_cast<bool>(out);
+}
+
+void LatencyTracker::reset() {
+  for (auto &h : stages_)
+    h.reset();
+}
+
+} // namespace Core
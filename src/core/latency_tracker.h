@@ -0,0 +1,83 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+
+namespace Core {
+
+// Timestamps carried with a streamed candle from the socket to the screen.
+struct LatencyStamps {
+  long long exchange_ms{0}; // venue event time (wall clock); 0 if not sent
+  long long received_us{0}; // socket receive (steady clock)
+  long long parsed_us{0};   // parse done (steady clock)
+};
+
+// HDR-style histogram of microsecond values: exact below 64 us, then 32
+// sub-buckets per power of two (<= 3.2% relative error) up to ~71 minutes.
+// Recording is one relaxed atomic increment, safe from any thread.
+class LatencyHistogram {
+public:
+  static constexpr std::size_t kBuckets = 64 + 26 * 32;
+
+  void record(long long micros);
+  // Value at quantile q in [0, 1], in microseconds (bucket midpoint).
+  double percentile(double q) const;
+  std::uint64_t count() const { return count_.load(std::memory_order_relaxed); }
+  long long max() const { return max_.load(std::memory_order_relaxed); }
+  void reset();
+
+  static std::size_t bucket_of(long long micros);
+  static double bucket_mid(std::size_t index);
+
+private:
+  std::array<std::atomic<std::uint64_t>, kBuckets> buckets_{};
+  std::atomic<std::uint64_t> count_{0};
+  std::atomic<long long> max_{0};
+};
+
+// Per-stage latency of the streaming path:
+//   network    venue event time -> socket receive (includes clock skew)
+//   parse      socket receive -> candle parsed
+//   merge      parsed -> merged into AppContext on the UI thread
+//   persist    socket receive -> written to disk by the batch writer
+//   render     merged -> end of the first frame that draws it
+//   end_to_end venue event time -> that frame
+class LatencyTracker {
+public:
+  enum class Stage { Network, Parse, Merge, Persist, Render, EndToEnd, Count };
+  static constexpr std::size_t kStages = static_cast<std::size_t>(Stage::Count);
+
+  struct Summary {
+    std::uint64_t count{0};
+    double p50_ms{0.0};
+    double p99_ms{0.0};
+    double max_ms{0.0};
+  };
+
+  static LatencyTracker &instance();
+  static const char *stage_name(Stage stage);
+  static long long steady_us();
+  static long long wall_ms();
+
+  void record(Stage stage, long long micros);
+  Summary summary(Stage stage) const;
+  const LatencyHistogram &histogram(Stage stage) const;
+  // One line for the status bar, e.g. "e2e 41/180 net 38/170 render 3/16"
+  // (p50/p99 ms); stages without samples are left out.
+  std::string status_line() const;
+  // JSON object keyed by stage name: count, p50/p90/p99/p999/max in ms.
+  std::string dump_json() const;
+  bool write_dump(const std::filesystem::path &path) const;
+  void reset();
+
+private:
+  LatencyTracker() = default;
+
+  std::array<LatencyHistogram, kStages> stages_;
+};
+
+} // namespace Core
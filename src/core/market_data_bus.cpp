@@ -0,0 +1,108 @@
+#include "market_data_bus.h"
+
+#include <algorithm>
+#include <type_traits>
+
+namespace Core {
+
+MarketDataBus::Token MarketDataBus::add_candle_handler(CandleList &list,
+                                                       CandleHandler handler,
+                                                       std::string symbol,
+                                                       std::string interval) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto next = std::make_shared<std::vector<CandleEntry>>(*list);
+  const Token token = next_token_++;
+  next->push_back({token, std::move(symbol), std::move(interval), std::move(handler)});
+  list = std::move(next);
+  return token;
+}
+
+MarketDataBus::Token MarketDataBus::on_candle_update(CandleHandler handler,
+                                                     std::string symbol,
+                                                     std::string interval) {
+  return add_candle_handler(updates_, std::move(handler), std::move(symbol),
+                            std::move(interval));
+}
+
+MarketDataBus::Token MarketDataBus::on_candle_closed(CandleHandler handler,
+                                                     std::string symbol,
+                                                     std::string interval) {
+  return add_candle_handler(closed_, std::move(handler), std::move(symbol),
+                            std::move(interval));
+}
+
+MarketDataBus::Token MarketDataBus::on_stream_status(StatusHandler handler) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto next = std::make_shared<std::vector<StatusEntry>>(*status_);
+  const Token token = next_token_++;
+  next->push_back({token, std::move(handler)});
+  status_ = std::move(next);
+  return token;
+}
+
+void MarketDataBus::unsubscribe(Token token) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto drop = [token](auto &list) {
+    auto it = std::find_if(list->begin(), list->end(),
+                           [token](const auto &e) { return e.token == token; });
+    if (it == list->end())
+      return false;
+    auto next = std::make_shared<std::decay_t<decltype(*list)>>(*list);
+    next->erase(next->begin() + (it - list->begin()));
+    list = std::move(next);
+    return true;
+  };
+  if (!drop(updates_) && !drop(closed_))
+    drop(status_);
+}
+
+void MarketDataBus::publish_candle(const CandleList &list, const std::string &symbol,
+                                   const std::string &interval, const Candle &candle,
+                                   const LatencyStamps *stamps) const {
+  CandleList snapshot;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    snapshot = list;
+  }
+  const CandleEvent event{symbol, interval, candle, stamps};
+  for (const auto &entry : *snapshot) {
+    if (!entry.symbol.empty() && entry.symbol != symbol)
+      continue;
+    if (!entry.interval.empty() && entry.interval != interval)
+      continue;
+    entry.handler(event);
+  }
+}
+
+void MarketDataBus::publish_candle_update(const std::string &symbol,
+                                          const std::string &interval,
+                                          const Candle &candle,
+                                          const LatencyStamps *stamps) const {
+  publish_candle(updates_, symbol, interval, candle, stamps);
+}
+
+void MarketDataBus::publish_candle_closed(const std::string &symbol,
+                                          const std::string &interval,
+                                          const Candle &candle,
+                                          const LatencyStamps *stamps) const {
+  publish_candle(closed_, symbol, interval, candle, stamps);
+}
+
+void MarketDataBus::publish_stream_status(const std::string &provider,
+                                          StreamStatus status) const {
+  StatusList snapshot;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    snapshot = status_;
+  }
+  const StreamStatusEvent event{provider, status};
+  for (const auto &entry : *snapshot)
+    entry.handler(event);
+}
+
+bool MarketDataBus::has_candle_update_handlers() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return !updates_->empty();
+}
+
+} // namespace Core
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "candle.h"
+#include "latency_tracker.h"
+
+namespace Core {
+
+// Events are passed by reference to every handler; the referenced data is
+// only valid for the duration of the call.
+struct CandleEvent {
+  const std::string &symbol;
+  const std::string &interval;
+  const Candle &candle;
+  const LatencyStamps *stamps = nullptr; // set for bars straight off the socket
+};
+
+enum class StreamStatus { Connected, Disconnected, Failed };
+
+struct StreamStatusEvent {
+  const std::string &provider;
+  StreamStatus status;
+};
+
+// Typed publish/subscribe hub for live market data: forming bars ("update"),
+// final bars ("closed") and stream connection status. Producers publish once
+// and every attached consumer (persistence, chart hand-off, signals, alerts)
+// sees the same event object. Handlers run on the publishing thread, in
+// subscription order, and must not block. Subscribing swaps in a new
+// handler list; publishing only copies the current list pointer, so the hot
+// path allocates nothing. A handler may still run once for a publish that
+// was already in progress when it was unsubscribed.
+class MarketDataBus {
+public:
+  using CandleHandler = std::function<void(const CandleEvent &)>;
+  using StatusHandler = std::function<void(const StreamStatusEvent &)>;
+  using Token = std::uint64_t;
+
+  // Empty symbol/interval filters match every series.
+  Token on_candle_update(CandleHandler handler, std::string symbol = {},
+                         std::string interval = {});
+  Token on_candle_closed(CandleHandler handler, std::string symbol = {},
+                         std::string interval = {});
+  Token on_stream_status(StatusHandler handler);
+  void unsubscribe(Token token);
+
+  void publish_candle_update(const std::string &symbol, const std::string &interval,
+                             const Candle &candle,
+                             const LatencyStamps *stamps = nullptr) const;
+  void publish_candle_closed(const std::string &symbol, const std::string &interval,
+                             const Candle &candle,
+                             const LatencyStamps *stamps = nullptr) const;
+  void publish_stream_status(const std::string &provider, StreamStatus status) const;
+
+  // Lets producers skip work for forming bars nobody listens to.
+  bool has_candle_update_handlers() const;
+
+private:
+  struct CandleEntry {
+    Token token;
+    std::string symbol;
+    std::string interval;
+    CandleHandler handler;
+  };
+  struct StatusEntry {
+    Token token;
+    StatusHandler handler;
+  };
+  using CandleList = std::shared_ptr<const std::vector<CandleEntry>>;
+  using StatusList = std::shared_ptr<const std::vector<StatusEntry>>;
+
+  Token add_candle_handler(CandleList &list, CandleHandler handler,
+                           std::string symbol, std::string interval);
+  void publish_candle(const CandleList &list, const std::string &symbol,
+                      const std::string &interval, const Candle &candle,
+                      const LatencyStamps *stamps) const;
+
+  mutable std::mutex mutex_;
+  Token next_token_{1};
+  CandleList updates_ = std::make_shared<const std::vector<CandleEntry>>();
+  CandleList closed_ = std::make_shared<const std::vector<CandleEntry>>();
+  StatusList status_ = std::make_shared<const std::vector<StatusEntry>>();
+};
+
+} // namespace Core
@@ -0,0 +1,503 @@
+#include "market_data_recorder.h"
+
+#include "core/logger.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdlib>
+#include <cstring>
+#include <stop_token>
+#include <thread>
+
+namespace Core {
+
+namespace {
+
+constexpr char kMagic[4] = {'C', 'M', 'D', 'R'};
+constexpr std::uint32_t kVersion = 1;
+constexpr std::size_t kBufferSize = 1 << 20;
+
+void put_u32(std::string &out, std::uint32_t v) {
+  out.append(reinterpret_cast<const char *>(&v), sizeof(v));
+}
+void put_i64(std::string &out, long long v) {
+  const std::int64_t x = v;
+  out.append(reinterpret_cast<const char *>(&x), sizeof(x));
+}
+void put_str(std::string &out, const std::string &s) {
+  put_u32(out, static_cast<std::uint32_t>(s.size()));
+  out += s;
+}
+
+// Bounds-checked reader over one record payload.
+struct Reader {
+  const char *p;
+  const char *end;
+  template <typename T> bool get(T &v) {
+    if (static_cast<std::size_t>(end - p) < sizeof(T))
+      return false;
+    std::memcpy(&v, p, sizeof(T));
+    p += sizeof(T);
+    return true;
+  }
+  bool get_str(std::string &s) {
+    std::uint32_t n = 0;
+    if (!get(n) || static_cast<std::size_t>(end - p) < n)
+      return false;
+    s.assign(p, n);
+    p += n;
+    return true;
+  }
+};
+
+std::string encode_http(const HttpExchange &e) {
+  std::string out;
+  put_str(out, e.method);
+  put_str(out, e.url);
+  put_str(out, e.body);
+  put_u32(out, static_cast<std::uint32_t>(e.response.status_code));
+  put_str(out, e.response.text);
+  put_str(out, e.response.error_message);
+  out.push_back(e.response.network_error ? 1 : 0);
+  put_i64(out, e.latency_ms);
+  put_u32(out, static_cast<std::uint32_t>(e.response.headers.size()));
+  for (const auto &[name, value] : e.response.headers) {
+    put_str(out, name);
+    put_str(out, value);
+  }
+  return out;
+}
+
+bool decode_http(const std::string &payload, HttpExchange &e) {
+  Reader r{payload.data(), payload.data() + payload.size()};
+  std::uint32_t status = 0, headers = 0;
+  char network_error = 0;
+  std::int64_t latency = 0;
+  if (!r.get_str(e.method) || !r.get_str(e.url) || !r.get_str(e.body) ||
+      !r.get(status) || !r.get_str(e.response.text) ||
+      !r.get_str(e.response.error_message) || !r.get(network_error) ||
+      !r.get(latency) || !r.get(headers))
+    return false;
+  e.response.status_code = static_cast<int>(status);
+  e.response.network_error = network_error != 0;
+  e.latency_ms = latency;
+  for (std::uint32_t i = 0; i < headers; ++i) {
+    std::string name, value;
+    if (!r.get_str(name) || !r.get_str(value))
+      return false;
+    e.response.headers[name] = value;
+  }
+  return true;
+}
+
+class RecordingWebSocket : public IWebSocket {
+public:
+  RecordingWebSocket(std::unique_ptr<IWebSocket> inner,
+                     std::shared_ptr<MarketDataRecorder> recorder)
+      : inner_(std::move(inner)), recorder_(std::move(recorder)),
+        connection_(recorder_->next_connection()) {}
+
+  void setUrl(const std::string &url) override {
+    url_ = url;
+    inner_->setUrl(url);
+  }
+  void setOnMessage(MessageCallback cb) override {
+    inner_->setOnMessage([this, cb = std::move(cb)](const std::string &msg) {
+      recorder_->record_ws(MarketDataRecord::Kind::Message, connection_, msg);
+      if (cb)
+        cb(msg);
+    });
+  }
+  void setOnError(ErrorCallback cb) override {
+    inner_->setOnError([this, cb = std::move(cb)]() {
+      recorder_->record_ws(MarketDataRecord::Kind::Error, connection_);
+      if (cb)
+        cb();
+    });
+  }
+  void setOnClose(CloseCallback cb) override {
+    inner_->setOnClose([this, cb = std::move(cb)]() {
+      if (!stopping_)
+        recorder_->record_ws(MarketDataRecord::Kind::Close, connection_);
+      if (cb)
+        cb();
+    });
+  }
+  void setOnOpen(OpenCallback cb) override {
+    inner_->setOnOpen([this, cb = std::move(cb)]() {
+      recorder_->record_ws(MarketDataRecord::Kind::Open, connection_, url_);
+      if (cb)
+        cb();
+    });
+  }
+  void sendText(const std::string &text) override {
+    recorder_->record_ws(MarketDataRecord::Kind::Send, connection_, text);
+    inner_->sendText(text);
+  }
+  void start() override { inner_->start(); }
+  void stop() override {
+    stopping_ = true;
+    inner_->stop();
+  }
+
+private:
+  std::unique_ptr<IWebSocket> inner_;
+  std::shared_ptr<MarketDataRecorder> recorder_;
+  std::uint32_t connection_;
+  std::string url_;
+  std::atomic<bool> stopping_{false};
+};
+
+} // namespace
+
+MarketDataRecorder::MarketDataRecorder(const std::filesystem::path &file)
+    : buffer_(kBufferSize), started_(std::chrono::steady_clock::now()) {
+  std::error_code ec;
+  if (file.has_parent_path())
+    std::filesystem::create_directories(file.parent_path(), ec);
+  file_ = std::fopen(file.string().c_str(), "wb");
+  if (!file_) {
+    Logger::instance().error("Could not open market-data recording: " + file.string());
+    return;
+  }
+  std::setvbuf(file_, buffer_.data(), _IOFBF, buffer_.size());
+  std::string header(kMagic, sizeof(kMagic));
+  put_u32(header, kVersion);
+  put_i64(header, std::chrono::duration_cast<std::chrono::milliseconds>(
+                      std::chrono::system_clock::now().time_since_epoch())
+                      .count());
+  std::fwrite(header.data(), 1, header.size(), file_);
+  bytes_ = header.size();
+}
+
+MarketDataRecorder::~MarketDataRecorder() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (file_)
+    std::fclose(file_);
+}
+
+std::uint32_t MarketDataRecorder::next_connection() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return ++connections_;
+}
+
+void MarketDataRecorder::record_ws(MarketDataRecord::Kind kind,
+                                   std::uint32_t connection,
+                                   const std::string &payload) {
+  MarketDataRecord record;
+  record.kind = kind;
+  record.connection = connection;
+  record.payload = payload;
+  write(record);
+}
+
+void MarketDataRecorder::record_http(const HttpExchange &exchange) {
+  MarketDataRecord record;
+  record.kind = MarketDataRecord::Kind::Http;
+  record.payload = encode_http(exchange);
+  write(record);
+}
+
+void MarketDataRecorder::write(const MarketDataRecord &record) {
+  const long long now = std::chrono::duration_cast<std::chrono::microseconds>(
+                            std::chrono::steady_clock::now() - started_)
+                            .count();
+  std::string head;
+  head.push_back(static_cast<char>(record.kind));
+  put_u32(head, record.connection);
+  put_i64(head, now);
+  put_u32(head, static_cast<std::uint32_t>(record.payload.size()));
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!file_)
+    return;
+  std::fwrite(head.data(), 1, head.size(), file_);
+  std::fwrite(record.payload.data(), 1, record.payload.size(), file_);
+  ++records_;
+  bytes_ += head.size() + record.payload.size();
+}
+
+void MarketDataRecorder::flush() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (file_)
+    std::fflush(file_);
+}
+
+std::size_t MarketDataRecorder::records() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return records_;
+}
+
+std::size_t MarketDataRecorder::bytes() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return bytes_;
+}
+
+WebSocketFactory recording_websocket_factory(WebSocketFactory inner,
+                                             std::shared_ptr<MarketDataRecorder> recorder) {
+  return [inner = std::move(inner),
+          recorder = std::move(recorder)]() -> std::unique_ptr<IWebSocket> {
+    auto ws = inner();
+    if (!ws || !recorder)
+      return ws;
+    return std::make_unique<RecordingWebSocket>(std::move(ws), recorder);
+  };
+}
+
+// Plays one recorded connection on its own thread, calling the owner's
+// callbacks the way a live socket would.
+class ReplayWebSocket : public IWebSocket {
+public:
+  explicit ReplayWebSocket(std::shared_ptr<MarketDataReplayer> replayer)
+      : replayer_(std::move(replayer)) {}
+  ~ReplayWebSocket() override { halt(); }
+
+  void setUrl(const std::string &) override {}
+  void setOnMessage(MessageCallback cb) override { msg_cb_ = std::move(cb); }
+  void setOnError(ErrorCallback cb) override { err_cb_ = std::move(cb); }
+  void setOnClose(CloseCallback cb) override { close_cb_ = std::move(cb); }
+  void setOnOpen(OpenCallback cb) override { open_cb_ = std::move(cb); }
+  void sendText(const std::string &) override {}
+  void start() override {
+    std::uint32_t connection = 0;
+    const auto *records = replayer_->claim(connection);
+    if (!records) {
+      Logger::instance().warn("Market-data replay has no more recorded connections");
+      return;
+    }
+    worker_ = std::jthread(
+        [this, records](std::stop_token stoken) { play(*records, stoken); });
+  }
+  void stop() override {
+    halt();
+    if (close_cb_)
+      close_cb_();
+  }
+
+private:
+  void halt() {
+    if (!worker_.joinable())
+      return;
+    worker_.request_stop();
+    if (worker_.get_id() == std::this_thread::get_id())
+      worker_.detach();
+    else
+      worker_ = std::jthread();
+  }
+
+  void play(const std::vector<MarketDataRecord> &records, std::stop_token stoken) {
+    std::mutex mutex;
+    std::condition_variable_any cv;
+    const bool paced = replayer_->speed() > 0;
+    bool ended = false;
+    for (const auto &record : records) {
+      if (paced) {
+        const auto due = replayer_->due(record.time_us);
+        std::unique_lock<std::mutex> lock(mutex);
+        cv.wait_until(lock, stoken, due, [] { return false; });
+      }
+      if (stoken.stop_requested())
+        return;
+      switch (record.kind) {
+      case MarketDataRecord::Kind::Open:
+        if (open_cb_)
+          open_cb_();
+        break;
+      case MarketDataRecord::Kind::Message:
+        if (msg_cb_)
+          msg_cb_(record.payload);
+        replayer_->on_delivered();
+        break;
+      case MarketDataRecord::Kind::Error:
+        if (err_cb_)
+          err_cb_();
+        break;
+      case MarketDataRecord::Kind::Close:
+        ended = true;
+        break;
+      default:
+        break;
+      }
+      if (ended)
+        break;
+    }
+    replayer_->on_connection_done();
+    if (ended && close_cb_)
+      close_cb_();
+  }
+
+  std::shared_ptr<MarketDataReplayer> replayer_;
+  std::jthread worker_;
+  MessageCallback msg_cb_;
+  ErrorCallback err_cb_;
+  CloseCallback close_cb_;
+  OpenCallback open_cb_;
+};
+
+MarketDataReplayer::MarketDataReplayer() : MarketDataReplayer(Options{}) {}
+
+MarketDataReplayer::MarketDataReplayer(Options options) : options_(options) {}
+
+bool MarketDataReplayer::read_file(const std::filesystem::path &file,
+                                   std::vector<MarketDataRecord> &out) {
+  std::FILE *f = std::fopen(file.string().c_str(), "rb");
+  if (!f)
+    return false;
+  std::string data;
+  char chunk[1 << 16];
+  std::size_t n = 0;
+  while ((n = std::fread(chunk, 1, sizeof(chunk), f)) > 0)
+    data.append(chunk, n);
+  std::fclose(f);
+
+  Reader r{data.data(), data.data() + data.size()};
+  char magic[4];
+  std::uint32_t version = 0;
+  std::int64_t started_ms = 0;
+  if (!r.get(magic) || std::memcmp(magic, kMagic, sizeof(kMagic)) != 0 ||
+      !r.get(version) || version != kVersion || !r.get(started_ms))
+    return false;
+  while (r.p < r.end) {
+    std::uint8_t kind = 0;
+    MarketDataRecord record;
+    std::int64_t time_us = 0;
+    // A truncated tail (e.g. the process was killed) ends the recording.
+    if (!r.get(kind) || !r.get(record.connection) || !r.get(time_us) ||
+        !r.get_str(record.payload))
+      break;
+    record.kind = static_cast<MarketDataRecord::Kind>(kind);
+    record.time_us = time_us;
+    if (record.kind == MarketDataRecord::Kind::Http) {
+      HttpExchange exchange;
+      if (!decode_http(record.payload, exchange))
+        continue;
+      record.http = std::move(exchange);
+      record.payload.clear();
+    }
+    out.push_back(std::move(record));
+  }
+  return true;
+}
+
+std::size_t MarketDataReplayer::load(const std::filesystem::path &file) {
+  std::vector<MarketDataRecord> records;
+  if (!read_file(file, records)) {
+    Logger::instance().error("Could not read market-data recording: " + file.string());
+    return 0;
+  }
+  for (auto &record : records)
+    add(std::move(record));
+  return records.size();
+}
+
+void MarketDataReplayer::add(MarketDataRecord record) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (record.kind == MarketDataRecord::Kind::Http) {
+    if (record.http)
+      http_.push_back(std::move(*record.http));
+    return;
+  }
+  if (record.connection == 0)
+    return;
+  if (connections_.size() < record.connection)
+    connections_.resize(record.connection);
+  connections_[record.connection - 1].push_back(std::move(record));
+}
+
+std::size_t MarketDataReplayer::connections() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return connections_.size();
+}
+
+std::vector<HttpExchange> MarketDataReplayer::http_exchanges() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return http_;
+}
+
+std::size_t MarketDataReplayer::delivered() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return delivered_;
+}
+
+bool MarketDataReplayer::finished() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return done_ >= connections_.size();
+}
+
+bool MarketDataReplayer::wait_finished(std::chrono::milliseconds timeout) const {
+  std::unique_lock<std::mutex> lock(mutex_);
+  return cv_.wait_for(lock, timeout, [this] { return done_ >= connections_.size(); });
+}
+
+const std::vector<MarketDataRecord> *MarketDataReplayer::claim(std::uint32_t &connection) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (claimed_ >= connections_.size())
+    return nullptr;
+  connection = ++claimed_;
+  return &connections_[connection - 1];
+}
+
+std::chrono::steady_clock::time_point MarketDataReplayer::due(long long time_us) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!origin_) {
+    origin_ = std::chrono::steady_clock::now();
+    origin_us_ = time_us;
+  }
+  const double offset = static_cast<double>(time_us - origin_us_) / options_.speed;
+  return *origin_ + std::chrono::microseconds(static_cast<long long>(offset));
+}
+
+void MarketDataReplayer::on_delivered() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  ++delivered_;
+}
+
+void MarketDataReplayer::on_connection_done() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ++done_;
+  }
+  cv_.notify_all();
+}
+
+WebSocketFactory replay_websocket_factory(std::shared_ptr<MarketDataReplayer> replayer) {
+  return [replayer = std::move(replayer)]() -> std::unique_ptr<IWebSocket> {
+    return std::make_unique<ReplayWebSocket>(replayer);
+  };
+}
+
+std::shared_ptr<MarketDataRecorder> session_market_recorder() {
+  static const std::shared_ptr<MarketDataRecorder> recorder =
+      []() -> std::shared_ptr<MarketDataRecorder> {
+    const char *path = std::getenv("CANDLE_MARKET_RECORD");
+    if (!path || !*path)
+      return nullptr;
+    auto r = std::make_shared<MarketDataRecorder>(path);
+    if (!r->is_open())
+      return nullptr;
+    Logger::instance().info(std::string("Recording market data to ") + path);
+    return r;
+  }();
+  return recorder;
+}
+
+std::shared_ptr<MarketDataReplayer> session_market_replayer() {
+  static const std::shared_ptr<MarketDataReplayer> replayer =
+      []() -> std::shared_ptr<MarketDataReplayer> {
+    const char *path = std::getenv("CANDLE_MARKET_REPLAY");
+    if (!path || !*path)
+      return nullptr;
+    MarketDataReplayer::Options options;
+    if (const char *speed = std::getenv("CANDLE_MARKET_REPLAY_SPEED"))
+      options.speed = std::atof(speed);
+    auto r = std::make_shared<MarketDataReplayer>(options);
+    const auto n = r->load(path);
+    if (n == 0)
+      return nullptr;
+    Logger::instance().info("Replaying " + std::to_string(n) +
+                            " market-data records from " + path);
+    return r;
+  }();
+  return replayer;
+}
+
+} // namespace Core
@@ -0,0 +1,129 @@
+#pragma once
+
+#include "iwebsocket.h"
+#include "net/recording_http_client.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace Core {
+
+// One entry of a market-data recording. `time_us` is the receive time in
+// microseconds since the recorder was opened (steady clock); `connection`
+// numbers WebSockets in creation order, HTTP exchanges use 0.
+struct MarketDataRecord {
+  enum class Kind : std::uint8_t { Open = 1, Message, Send, Error, Close, Http };
+  Kind kind{Kind::Message};
+  std::uint32_t connection{0};
+  long long time_us{0};
+  std::string payload;           // frame text, sent text or URL (Open)
+  std::optional<HttpExchange> http;
+};
+
+// Appends raw WebSocket frames and HTTP exchanges to a compact binary file
+// ("CMDR" header, then kind/connection/time/length-prefixed records). Writes
+// go through a 1 MB stdio buffer; flush() or destruction makes them durable.
+class MarketDataRecorder {
+public:
+  explicit MarketDataRecorder(const std::filesystem::path &file);
+  ~MarketDataRecorder();
+  MarketDataRecorder(const MarketDataRecorder &) = delete;
+  MarketDataRecorder &operator=(const MarketDataRecorder &) = delete;
+
+  bool is_open() const { return file_ != nullptr; }
+  std::uint32_t next_connection();
+  void record_ws(MarketDataRecord::Kind kind, std::uint32_t connection,
+                 const std::string &payload = {});
+  void record_http(const HttpExchange &exchange);
+  void flush();
+
+  std::size_t records() const;
+  std::size_t bytes() const;
+
+private:
+  void write(const MarketDataRecord &record);
+
+  mutable std::mutex mutex_;
+  std::FILE *file_{nullptr};
+  std::vector<char> buffer_;
+  std::chrono::steady_clock::time_point started_;
+  std::uint32_t connections_{0};
+  std::size_t records_{0};
+  std::size_t bytes_{0};
+};
+
+// Wraps every socket made by `inner` so its traffic is recorded. Closes
+// caused by the owner's own stop() are not recorded, only those coming from
+// the peer or the network.
+WebSocketFactory recording_websocket_factory(WebSocketFactory inner,
+                                             std::shared_ptr<MarketDataRecorder> recorder);
+
+// Loads a recording and plays it back through fake sockets: the n-th socket
+// created by replay_websocket_factory() replays the n-th recorded connection
+// (open, frames, error/close) at the recorded pace divided by `speed`, or
+// as fast as possible when `speed` <= 0. The clock starts when the first
+// socket starts. Sockets beyond the recorded ones open nothing and stay idle.
+class MarketDataReplayer {
+public:
+  struct Options {
+    double speed{1.0};
+  };
+
+  MarketDataReplayer();
+  explicit MarketDataReplayer(Options options);
+
+  // Reads a recording file; returns the number of records loaded.
+  std::size_t load(const std::filesystem::path &file);
+  void add(MarketDataRecord record);
+
+  double speed() const { return options_.speed; }
+  std::size_t connections() const;
+  std::vector<HttpExchange> http_exchanges() const;
+
+  // Frames delivered so far and whether every recorded connection has been
+  // played to its end.
+  std::size_t delivered() const;
+  bool finished() const;
+  bool wait_finished(std::chrono::milliseconds timeout) const;
+
+  static bool read_file(const std::filesystem::path &file,
+                        std::vector<MarketDataRecord> &out);
+
+private:
+  friend class ReplayWebSocket;
+
+  const std::vector<MarketDataRecord> *claim(std::uint32_t &connection);
+  std::chrono::steady_clock::time_point due(long long time_us);
+  void on_delivered();
+  void on_connection_done();
+
+  Options options_;
+  mutable std::mutex mutex_;
+  mutable std::condition_variable cv_;
+  std::vector<std::vector<MarketDataRecord>> connections_;
+  std::vector<HttpExchange> http_;
+  std::uint32_t claimed_{0};
+  std::size_t done_{0};
+  std::size_t delivered_{0};
+  std::optional<std::chrono::steady_clock::time_point> origin_;
+  long long origin_us_{0};
+};
+
+WebSocketFactory replay_websocket_factory(std::shared_ptr<MarketDataReplayer> replayer);
+
+// Process-wide recorder/replayer selected by CANDLE_MARKET_RECORD=<file> and
+// CANDLE_MARKET_REPLAY=<file> (CANDLE_MARKET_REPLAY_SPEED, default 1, 0 = as
+// fast as possible). Null when the variable is unset or the file is unusable.
+std::shared_ptr<MarketDataRecorder> session_market_recorder();
+std::shared_ptr<MarketDataReplayer> session_market_replayer();
+
+} // namespace Core
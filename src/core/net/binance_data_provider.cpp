@@ -4,6 +4,8 @@
 #include "core/interval_utils.h"
 #include "core/candle_utils.h"
 #include <future>
+#include <map>
+#include <optional>
 #include <set>
 #include <nlohmann/json.hpp>
 #include <algorithm>
@@ -25,7 +27,7 @@ KlinesResult BinanceDataProvider::fetch_klines(
     return {FetchError::NetworkError, 0, "BinanceDataProvider not initialized", {}};
   }
 
-  const std::string base_url = "https://api.binance.com/api/v3/klines?symbol=" + symbol + "&interval=" + interval;
+  const std::string base_url = base_url_ + "/api/v3/klines?symbol=" + symbol + "&interval=" + interval;
   std::vector<Candle> all_candles;
   all_candles.reserve(limit);
   auto interval_ms = parse_interval(interval).count();
@@ -144,7 +146,7 @@ KlinesResult BinanceDataProvider::fetch_range(
   }
 
   const std::string base_url =
-      "https://api.binance.com/api/v3/klines?symbol=" + symbol +
+      base_url_ + "/api/v3/klines?symbol=" + symbol +
       "&interval=" + interval;
 
   std::vector<Candle> all_candles;
@@ -245,6 +247,86 @@ KlinesResult BinanceDataProvider::fetch_range(
   return {FetchError::None, http_status, "", all_candles};
 }
 
+BinanceDataProvider::ExchangeInfoResult BinanceDataProvider::fetch_exchange_info(
+    int max_retries, std::chrono::milliseconds retry_delay) const {
+  const std::string url = base_url_ + "/api/v3/exchangeInfo";
+  const std::string cache_key = "binance|exchangeInfo";
+
+  std::optional<MetadataCache::Entry> cached;
+  if (metadata_cache_)
+    cached = metadata_cache_->get(cache_key);
+  std::map<std::string, std::string> headers;
+  if (cached && cached->value.is_object()) {
+    if (!cached->etag.empty())
+      headers["If-None-Match"] = cached->etag;
+    if (!cached->last_modified.empty())
+      headers["If-Modified-Since"] = cached->last_modified;
+  } else {
+    cached.reset();
+  }
+
+  for (int attempt = 0; attempt < max_retries; ++attempt) {
+    rate_limiter_->acquire();
+    HttpResponse r = http_client_->get(url, http_timeout_, headers);
+    if (r.network_error) {
+      Logger::instance().error("Request error: " + r.error_message);
+      if (attempt < max_retries - 1) {
+        std::this_thread::sleep_for(retry_delay);
+        continue;
+      }
+      return {FetchError::NetworkError, 0, r.error_message, {}, {}};
+    }
+    if (r.status_code == 304 && cached) {
+      metadata_cache_->touch(cache_key);
+      metadata_cache_->save();
+      return {FetchError::None, r.status_code, "",
+              MetadataCache::to_strings(cached->value.value("symbols", nlohmann::json::array())),
+              MetadataCache::to_strings(cached->value.value("intervals", nlohmann::json::array()))};
+    }
+    if (r.status_code == 200) {
+      ExchangeInfoResult out{FetchError::None, r.status_code, "", {}, {}};
+      try {
+        std::set<std::string> intervals;
+        auto json_data = nlohmann::json::parse(r.text);
+        if (json_data.contains("symbols")) {
+          for (const auto &item : json_data["symbols"]) {
+            out.symbols.push_back(item["symbol"].get<std::string>());
+            if (item.contains("klineIntervals")) {
+              for (const auto &iv : item["klineIntervals"]) {
+                intervals.insert(iv.get<std::string>());
+              }
+            }
+          }
+        }
+        out.intervals.assign(intervals.begin(), intervals.end());
+      } catch (const std::exception &e) {
+        Logger::instance().error(
+            std::string("Error processing exchange info: ") + e.what());
+        return {FetchError::ParseError, r.status_code, e.what(), {}, {}};
+      }
+      if (metadata_cache_) {
+        MetadataCache::Entry entry;
+        entry.value = {{"symbols", out.symbols}, {"intervals", out.intervals}};
+        if (auto it = r.headers.find("etag"); it != r.headers.end())
+          entry.etag = it->second;
+        if (auto it = r.headers.find("last-modified"); it != r.headers.end())
+          entry.last_modified = it->second;
+        metadata_cache_->put(cache_key, std::move(entry));
+        metadata_cache_->save();
+      }
+      return out;
+    }
+    Logger::instance().error("HTTP Request failed with status code: " +
+                             std::to_string(r.status_code));
+    if (attempt < max_retries - 1) {
+      std::this_thread::sleep_for(retry_delay);
+    } else {
+      return {FetchError::HttpError, r.status_code, r.error_message, {}, {}};
+    }
+  }
+  return {FetchError::HttpError, 0, "Max retries exceeded", {}, {}};
+}
+
 SymbolsResult BinanceDataProvider::fetch_all_symbols(
     int max_retries, std::chrono::milliseconds retry_delay,
     std::size_t top_n) const {
@@ -253,8 +335,7 @@ SymbolsResult BinanceDataProvider::fetch_all_symbols(
         "BinanceDataProvider not initialized with http_client or rate_limiter");
     return {FetchError::NetworkError, 0, "BinanceDataProvider not initialized", {}};
   }
-  const std::string info_url = "https://api.binance.com/api/v3/exchangeInfo";
-  const std::string ticker_url = "https://api.binance.com/api/v3/ticker/24hr";
+  const std::string ticker_url = base_url_ + "/api/v3/ticker/24hr";
 
   for (int attempt = 0; attempt < max_retries; ++attempt) {
     auto ticker_future = std::async(std::launch::async, [this, &ticker_url]() {
@@ -262,41 +343,22 @@ SymbolsResult BinanceDataProvider::fetch_all_symbols(
       return http_client_->get(ticker_url, http_timeout_, {});
     });
 
-    rate_limiter_->acquire();
-    HttpResponse info_resp =
-        http_client_->get(info_url, http_timeout_, {});
+    ExchangeInfoResult info = fetch_exchange_info(1, retry_delay);
     HttpResponse ticker_resp = ticker_future.get();
 
-    if (info_resp.network_error) {
-      Logger::instance().error("Request error: " + info_resp.error_message);
+    if (info.error == FetchError::NetworkError ||
+        info.error == FetchError::HttpError) {
       if (attempt < max_retries - 1) {
         std::this_thread::sleep_for(retry_delay);
         continue;
       }
-      return {FetchError::NetworkError, 0, info_resp.error_message, {}};
+      return {info.error, info.http_status, info.message, {}};
     }
-    if (info_resp.status_code != 200) {
-      Logger::instance().error("HTTP Request failed with status code: " +
-                               std::to_string(info_resp.status_code));
-      if (attempt < max_retries - 1) {
-        std::this_thread::sleep_for(retry_delay);
-        continue;
-      }
-      return {FetchError::HttpError, info_resp.status_code,
-              info_resp.error_message, {}};
+    if (info.error == FetchError::ParseError) {
+      return {FetchError::ParseError, info.http_status, info.message, {}};
     }
 
-    std::vector<std::string> symbols;
-    try {
-      auto json_data = nlohmann::json::parse(info_resp.text);
-      for (const auto &item : json_data["symbols"]) {
-        symbols.push_back(item["symbol"].get<std::string>());
-      }
-    } catch (const std::exception &e) {
-      Logger::instance().error(
-          std::string("Error processing symbol list: ") + e.what());
-      return {FetchError::ParseError, info_resp.status_code, e.what(), {}};
-    }
+    std::vector<std::string> symbols = std::move(info.symbols);
 
     if (ticker_resp.network_error) {
       Logger::instance().error("Ticker request failed: " +
@@ -332,11 +394,11 @@ SymbolsResult BinanceDataProvider::fetch_all_symbols(
       for (size_t i = 0; i < std::min(top_n, vols.size()); ++i) {
         top_symbols.push_back(vols[i].first);
       }
-      return {FetchError::None, info_resp.status_code, "", top_symbols};
+      return {FetchError::None, info.http_status, "", top_symbols};
     } catch (const std::exception &e) {
       Logger::instance().error(
           std::string("Error processing ticker data: ") + e.what());
-      return {FetchError::ParseError, info_resp.status_code,
+      return {FetchError::ParseError, info.http_status,
               "Ticker parse error", {}};
     }
   }
@@ -351,48 +413,10 @@ IntervalsResult BinanceDataProvider::fetch_intervals(
         "BinanceDataProvider not initialized with http_client or rate_limiter");
     return {FetchError::NetworkError, 0, "BinanceDataProvider not initialized", {}};
   }
-  const std::string url = "https://api.binance.com/api/v3/exchangeInfo";
-  for (int attempt = 0; attempt < max_retries; ++attempt) {
-    rate_limiter_->acquire();
-    HttpResponse r = http_client_->get(url, http_timeout_, {});
-    if (r.network_error) {
-      Logger::instance().error("Request error: " + r.error_message);
-      if (attempt < max_retries - 1) {
-        std::this_thread::sleep_for(retry_delay);
-        continue;
-      }
-      return {FetchError::NetworkError, 0, r.error_message, {}};
-    }
-    if (r.status_code == 200) {
-      try {
-        std::set<std::string> intervals;
-        auto json_data = nlohmann::json::parse(r.text);
-        if (json_data.contains("symbols")) {
-          for (const auto &item : json_data["symbols"]) {
-            if (item.contains("klineIntervals")) {
-              for (const auto &iv : item["klineIntervals"]) {
-                intervals.insert(iv.get<std::string>());
-              }
-            }
-          }
-        }
-        return {FetchError::None, r.status_code, "",
-                std::vector<std::string>(intervals.begin(), intervals.end())};
-      } catch (const std::exception &e) {
-        Logger::instance().error(
-            std::string("Error processing interval list: ") + e.what());
-        return {FetchError::ParseError, r.status_code, e.what(), {}};
-      }
-    }
-    Logger::instance().error("HTTP Request failed with status code: " +
-                             std::to_string(r.status_code));
-    if (attempt < max_retries - 1) {
-      std::this_thread::sleep_for(retry_delay);
-    } else {
-      return {FetchError::HttpError, r.status_code, r.error_message, {}};
-    }
-  }
-  return {FetchError::HttpError, 0, "Max retries exceeded", {}};
+  ExchangeInfoResult info = fetch_exchange_info(max_retries, retry_delay);
+  if (info.error != FetchError::None)
+    return {info.error, info.http_status, info.message, {}};
+  return {FetchError::None, info.http_status, "", std::move(info.intervals)};
 }
 
 } // namespace Core
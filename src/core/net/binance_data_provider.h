@@ -3,7 +3,10 @@
 #include "idata_provider.h"
 #include "ihttp_client.h"
 #include "irate_limiter.h"
+#include "metadata_cache.h"
 #include <memory>
+#include <string>
+#include <vector>
 
 namespace Core {
 
@@ -32,10 +35,37 @@ public:
                                   std::chrono::milliseconds retry_delay =
                                       std::chrono::milliseconds(1000)) const override;
 
+  // /api/v3/klines limit cap.
+  std::size_t max_candles_per_request() const override { return 1000; }
+
+  // Enables conditional revalidation of exchangeInfo. The parsed projection
+  // (symbols and kline intervals) is stored together with the ETag and
+  // Last-Modified validators; HTTP 304 answers reuse the cached projection.
+  void set_metadata_cache(std::shared_ptr<MetadataCache> cache) {
+    metadata_cache_ = std::move(cache);
+  }
+
+  // REST root, e.g. "https://api.binance.com" or a local mock server.
+  void set_base_url(std::string url) { base_url_ = std::move(url); }
+  const std::string &base_url() const { return base_url_; }
+
 private:
+  struct ExchangeInfoResult {
+    FetchError error{FetchError::None};
+    int http_status{0};
+    std::string message;
+    std::vector<std::string> symbols;
+    std::vector<std::string> intervals;
+  };
+
+  ExchangeInfoResult fetch_exchange_info(int max_retries,
+                                         std::chrono::milliseconds retry_delay) const;
+
   std::shared_ptr<IHttpClient> http_client_;
   std::shared_ptr<IRateLimiter> rate_limiter_;
   std::chrono::milliseconds http_timeout_{std::chrono::milliseconds(15000)};
+  std::shared_ptr<MetadataCache> metadata_cache_;
+  std::string base_url_{"https://api.binance.com"};
 };
 
 } // namespace Core
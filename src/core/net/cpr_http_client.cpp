@@ -1,9 +1,24 @@
 #include "cpr_http_client.h"
 #include <cpr/cpr.h>
+#include <cctype>
 #include <exception>
 
 namespace Core {
 
+namespace {
+
+void copy_headers(const cpr::Header &src,
+                  std::map<std::string, std::string> &dst) {
+  for (const auto &[name, value] : src) {
+    std::string key = name;
+    for (auto &c : key)
+      c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    dst[key] = value;
+  }
+}
+
+} // namespace
+
 HttpResponse CprHttpClient::get(const std::string &url,
                                 std::chrono::milliseconds timeout,
                                 const std::map<std::string, std::string> &headers) {
@@ -16,6 +31,7 @@ HttpResponse CprHttpClient::get(const std::string &url,
     auto r = cpr::Get(cpr::Url{url}, to, cto, low, hdr);
     resp.status_code = static_cast<int>(r.status_code);
     resp.text = std::move(r.text);
+    copy_headers(r.header, resp.headers);
     if (r.error.code != cpr::ErrorCode::OK) {
       resp.network_error = true;
       resp.error_message = r.error.message;
@@ -40,6 +56,7 @@ HttpResponse CprHttpClient::post(const std::string &url, const std::string &body
     auto r = cpr::Post(cpr::Url{url}, to, cto, low, hdr, b);
     resp.status_code = static_cast<int>(r.status_code);
     resp.text = std::move(r.text);
+    copy_headers(r.header, resp.headers);
     if (r.error.code != cpr::ErrorCode::OK) {
       resp.network_error = true;
       resp.error_message = r.error.message;
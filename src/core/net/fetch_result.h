@@ -11,7 +11,9 @@ enum class FetchError {
   HttpError = 1,
   ParseError = 2,
   NetworkError = 3,
-  InvalidInterval = 4
+  InvalidInterval = 4,
+  // Rejected without a request because the provider's circuit is open.
+  CircuitOpen = 5
 };
 
 struct KlinesResult {
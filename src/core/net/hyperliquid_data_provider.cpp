@@ -3,24 +3,15 @@
 #include "core/logger.h"
 #include "core/interval_utils.h"
 #include "core/candle_utils.h"
+#include "core/exchange_utils.h"
 #include <nlohmann/json.hpp>
+#include <future>
+#include <iterator>
+#include <optional>
+#include <thread>
 
 namespace Core {
 
-namespace {
-// Basic mapping: strip common quote suffixes to obtain Hyperliquid coin name.
-std::string to_hyperliquid_coin(const std::string &symbol) {
-  const std::string s = symbol;
-  auto ends_with = [&](const char* suf) {
-    size_t n = std::strlen(suf);
-    return s.size() >= n && s.compare(s.size()-n, n, suf) == 0;
-  };
-  if (ends_with("USDT")) return s.substr(0, s.size()-4);
-  if (ends_with("USD")) return s.substr(0, s.size()-3);
-  return s;
-}
-}
-
 HyperliquidDataProvider::HyperliquidDataProvider(std::shared_ptr<IHttpClient> http_client,
                                              std::shared_ptr<IRateLimiter> rate_limiter)
     : http_client_(std::move(http_client)),
@@ -29,42 +20,54 @@ HyperliquidDataProvider::HyperliquidDataProvider(std::shared_ptr<IHttpClient> ht
 KlinesResult HyperliquidDataProvider::fetch_klines(
     const std::string &symbol, const std::string &interval, int limit,
     int max_retries, std::chrono::milliseconds retry_delay) const {
-
-  if (!http_client_ || !rate_limiter_) {
-    Logger::instance().error(
-        "HyperliquidDataProvider not initialized with http_client or rate_limiter");
-    return {FetchError::NetworkError, 0, "HyperliquidDataProvider not initialized", {}};
-  }
-
   auto interval_ms = parse_interval(interval).count();
   if (interval_ms <= 0) {
     Logger::instance().error("Invalid interval: " + interval);
     return {FetchError::InvalidInterval, 0, "Invalid interval", {}};
   }
+  if (limit <= 0) {
+    return {FetchError::None, 0, "", {}};
+  }
 
   long long end_time = std::chrono::duration_cast<std::chrono::milliseconds>(
                          std::chrono::system_clock::now().time_since_epoch())
                          .count();
-  long long start_time = end_time - interval_ms * limit;
+  // Exactly `limit` bars ending with the one currently forming.
+  long long last_open = end_time - end_time % interval_ms;
+  long long start_time = last_open - interval_ms * (limit - 1);
+  auto res = fetch_range(symbol, interval, start_time, end_time, max_retries,
+                         retry_delay);
+  if (res.error == FetchError::None &&
+      res.candles.size() > static_cast<std::size_t>(limit)) {
+    res.candles.erase(res.candles.begin(),
+                      res.candles.end() - static_cast<std::ptrdiff_t>(limit));
+  }
+  return res;
+}
 
+KlinesResult HyperliquidDataProvider::fetch_page(
+    const std::string &coin, const std::string &interval, long long start_ms,
+    long long end_ms, int max_retries,
+    std::chrono::milliseconds retry_delay) const {
   nlohmann::json req_body = {
       {"type", "candleSnapshot"},
       {"req",
        {
-           {"coin", to_hyperliquid_coin(symbol)},
+           {"coin", coin},
            {"interval", interval},
-           {"startTime", start_time},
-           {"endTime", end_time},
+           {"startTime", start_ms},
+           {"endTime", end_ms},
        }},
   };
 
-  const std::string url = "https://api.hyperliquid.xyz/info";
+  const std::string url = base_url_ + "/info";
   std::vector<Candle> candles;
   int http_status = 0;
 
   for (int attempt = 0; attempt < max_retries; ++attempt) {
     rate_limiter_->acquire();
-    HttpResponse r = http_client_->post(url, req_body.dump(), http_timeout_, {{"Content-Type", "application/json"}});
+    HttpResponse r =
+        http_client_->post(url, req_body.dump(), http_timeout_, {{"Content-Type", "application/json"}});
 
     if (r.network_error) {
       Logger::instance().error("Request error: " + r.error_message);
@@ -79,6 +82,7 @@ KlinesResult HyperliquidDataProvider::fetch_klines(
     if (r.status_code == 200) {
       try {
         auto json_data = nlohmann::json::parse(r.text);
+        candles.reserve(json_data.size());
         for (const auto &kline : json_data) {
           candles.emplace_back(
               kline["t"].get<long long>(),
@@ -95,7 +99,7 @@ KlinesResult HyperliquidDataProvider::fetch_klines(
               0.0  // ignore
           );
         }
-        return {FetchError::None, http_status, "", candles};
+        return {FetchError::None, http_status, "", std::move(candles)};
       } catch (const std::exception &e) {
         Logger::instance().error(
             std::string("Error processing Hyperliquid kline data: ") + e.what());
@@ -130,73 +134,70 @@ KlinesResult HyperliquidDataProvider::fetch_range(
     Logger::instance().error("Invalid interval: " + interval);
     return {FetchError::InvalidInterval, 0, "Invalid interval", {}};
   }
+  if (end_ms < start_ms) {
+    return {FetchError::None, 0, "", {}};
+  }
 
-  nlohmann::json req_body = {
-      {"type", "candleSnapshot"},
-      {"req",
-       {
-           {"coin", to_hyperliquid_coin(symbol)},
-           {"interval", interval},
-           {"startTime", start_ms},
-           {"endTime", end_ms},
-       }},
+  // Split the window on bar boundaries so every page holds at most the
+  // server cap; the first page starts at the first bar opening at/after
+  // start_ms.
+  const long long first_open =
+      start_ms % interval_ms == 0 ? start_ms : start_ms - start_ms % interval_ms + interval_ms;
+  const long long page_span =
+      static_cast<long long>(max_candles_per_request()) * interval_ms;
+  struct Page {
+    long long start;
+    long long end;
   };
+  std::vector<Page> pages;
+  for (long long s = first_open; s <= end_ms; s += page_span)
+    pages.push_back({s, std::min(end_ms, s + page_span - 1)});
+  if (pages.empty()) {
+    return {FetchError::None, 0, "", {}};
+  }
 
-  const std::string url = "https://api.hyperliquid.xyz/info";
-  std::vector<Candle> candles;
-  int http_status = 0;
-
-  for (int attempt = 0; attempt < max_retries; ++attempt) {
-    rate_limiter_->acquire();
-    HttpResponse r =
-        http_client_->post(url, req_body.dump(), http_timeout_, {{"Content-Type", "application/json"}});
+  const std::string coin = to_hyperliquid_coin(symbol);
+  if (pages.size() == 1) {
+    auto res = fetch_page(coin, interval, pages[0].start, pages[0].end,
+                          max_retries, retry_delay);
+    if (res.error == FetchError::None)
+      normalize_candles(res.candles);
+    return res;
+  }
 
-    if (r.network_error) {
-      Logger::instance().error("Request error: " + r.error_message);
-      if (attempt < max_retries - 1) {
-        std::this_thread::sleep_for(retry_delay);
-        continue;
-      }
-      return {FetchError::NetworkError, 0, r.error_message, {}};
+  // Pages run concurrently in bounded waves; the shared rate limiter paces
+  // the actual POSTs. Pages inherit the caller's request priority.
+  const RequestPriority priority = current_request_priority();
+  std::vector<Candle> all;
+  int http_status = 0;
+  for (std::size_t i = 0; i < pages.size(); i += kMaxInFlightPages) {
+    const std::size_t wave_end = std::min(pages.size(), i + kMaxInFlightPages);
+    std::vector<std::future<KlinesResult>> wave;
+    wave.reserve(wave_end - i);
+    for (std::size_t j = i; j < wave_end; ++j) {
+      wave.push_back(std::async(std::launch::async, [&, page = pages[j]]() {
+        ScopedRequestPriority scope(priority);
+        return fetch_page(coin, interval, page.start, page.end, max_retries,
+                          retry_delay);
+      }));
     }
-
-    http_status = r.status_code;
-    if (r.status_code == 200) {
-      try {
-        auto json_data = nlohmann::json::parse(r.text);
-        for (const auto &kline : json_data) {
-          candles.emplace_back(
-              kline["t"].get<long long>(),
-              std::stod(kline["o"].get<std::string>()),
-              std::stod(kline["h"].get<std::string>()),
-              std::stod(kline["l"].get<std::string>()),
-              std::stod(kline["c"].get<std::string>()),
-              std::stod(kline["v"].get<std::string>()),
-              kline["T"].get<long long>(),
-              0.0,
-              kline["n"].get<int>(),
-              0.0,
-              0.0,
-              0.0);
-        }
-        return {FetchError::None, http_status, "", candles};
-      } catch (const std::exception &e) {
-        Logger::instance().error(
-            std::string("Error processing Hyperliquid kline data: ") + e.what());
-        return {FetchError::ParseError, http_status, e.what(), {}};
+    std::optional<KlinesResult> failure;
+    for (auto &f : wave) {
+      auto res = f.get();
+      if (res.error != FetchError::None) {
+        if (!failure)
+          failure = std::move(res);
+        continue;
       }
+      http_status = res.http_status;
+      all.insert(all.end(), std::make_move_iterator(res.candles.begin()),
+                 std::make_move_iterator(res.candles.end()));
     }
-
-    Logger::instance().error("Hyperliquid HTTP Request failed with status code: " +
-                             std::to_string(r.status_code));
-    if (attempt < max_retries - 1) {
-      std::this_thread::sleep_for(retry_delay);
-    } else {
-      return {FetchError::HttpError, r.status_code, r.error_message, {}};
-    }
+    if (failure)
+      return std::move(*failure);
   }
-
-  return {FetchError::HttpError, http_status, "Max retries exceeded", {}};
+  normalize_candles(all);
+  return {FetchError::None, http_status, "", std::move(all)};
 }
 
 SymbolsResult HyperliquidDataProvider::fetch_all_symbols(int /*max_retries*/,
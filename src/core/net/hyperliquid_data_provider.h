@@ -39,10 +39,26 @@ public:
                                   std::chrono::milliseconds retry_delay =
                                       std::chrono::milliseconds(1000)) const override;
 
+  // candleSnapshot returns at most 5000 rows.
+  std::size_t max_candles_per_request() const override { return 5000; }
+
+  // API root, e.g. "https://api.hyperliquid.xyz" or a local mock server.
+  void set_base_url(std::string url) { base_url_ = std::move(url); }
+  const std::string &base_url() const { return base_url_; }
+
 private:
+  // Candle pages requested concurrently by one fetch_range call.
+  static constexpr std::size_t kMaxInFlightPages = 4;
+
+  // Single candleSnapshot POST; the window must fit the server cap.
+  KlinesResult fetch_page(const std::string &coin, const std::string &interval,
+                          long long start_ms, long long end_ms, int max_retries,
+                          std::chrono::milliseconds retry_delay) const;
+
   std::shared_ptr<IHttpClient> http_client_;
   std::shared_ptr<IRateLimiter> rate_limiter_;
   std::chrono::milliseconds http_timeout_{std::chrono::milliseconds(15000)};
+  std::string base_url_{"https://api.hyperliquid.xyz"};
 };
 
 } // namespace Core
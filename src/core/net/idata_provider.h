@@ -32,6 +32,10 @@ public:
   virtual IntervalsResult fetch_intervals(int max_retries = 3,
                                           std::chrono::milliseconds retry_delay =
                                               std::chrono::milliseconds(1000)) const = 0;
+
+  // Largest number of candles a single range request returns; used to size
+  // backfill requests so each maps to one HTTP call.
+  virtual std::size_t max_candles_per_request() const { return 1000; }
 };
 
 } // namespace Core
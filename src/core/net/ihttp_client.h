@@ -11,6 +11,8 @@ struct HttpResponse {
   std::string text;
   std::string error_message;
   bool network_error{false};
+  // Response headers with lower-cased names (e.g. "etag", "last-modified").
+  std::map<std::string, std::string> headers;
 };
 
 class IHttpClient {
@@ -4,11 +4,38 @@
 
 namespace Core {
 
+// Foreground requests serve what the user is looking at; background ones
+// (prefetch) may only use capacity foreground callers leave idle.
+enum class RequestPriority { Foreground, Background };
+
+// Priority of requests issued from the calling thread. Work handed to other
+// threads must re-establish it with a ScopedRequestPriority.
+inline RequestPriority &current_request_priority() {
+  thread_local RequestPriority priority = RequestPriority::Foreground;
+  return priority;
+}
+
+class ScopedRequestPriority {
+public:
+  explicit ScopedRequestPriority(RequestPriority priority)
+      : previous_(current_request_priority()) {
+    current_request_priority() = priority;
+  }
+  ~ScopedRequestPriority() { current_request_priority() = previous_; }
+  ScopedRequestPriority(const ScopedRequestPriority &) = delete;
+  ScopedRequestPriority &operator=(const ScopedRequestPriority &) = delete;
+
+private:
+  RequestPriority previous_;
+};
+
 class IRateLimiter {
 public:
   virtual ~IRateLimiter() = default;
   virtual void acquire() = 0;
+  // True when a background request could take a token right now without
+  // delaying a foreground one.
+  virtual bool has_idle_capacity() { return true; }
 };
 
 } // namespace Core
-
@@ -0,0 +1,152 @@
+#include "metadata_cache.h"
+
+#include "core/logger.h"
+
+#include <fstream>
+#include <system_error>
+
+namespace Core {
+
+MetadataCache::MetadataCache(std::filesystem::path file) : file_(std::move(file)) {}
+
+long long MetadataCache::now_ms() {
+  return std::chrono::duration_cast<std::chrono::milliseconds>(
+             std::chrono::system_clock::now().time_since_epoch())
+      .count();
+}
+
+bool MetadataCache::is_fresh(const Entry &entry, std::chrono::seconds ttl,
+                             long long now) {
+  if (ttl.count() <= 0 || entry.fetched_at_ms <= 0)
+    return false;
+  const long long age = now - entry.fetched_at_ms;
+  return age >= 0 &&
+         age < std::chrono::duration_cast<std::chrono::milliseconds>(ttl).count();
+}
+
+nlohmann::json MetadataCache::from_strings(const std::vector<std::string> &values) {
+  return nlohmann::json(values);
+}
+
+std::vector<std::string> MetadataCache::to_strings(const nlohmann::json &value) {
+  std::vector<std::string> out;
+  if (!value.is_array())
+    return out;
+  out.reserve(value.size());
+  for (const auto &v : value) {
+    if (v.is_string())
+      out.push_back(v.get<std::string>());
+  }
+  return out;
+}
+
+void MetadataCache::ensure_loaded() const {
+  if (loaded_)
+    return;
+  loaded_ = true;
+  std::error_code ec;
+  if (!std::filesystem::exists(file_, ec))
+    return;
+  std::ifstream in(file_);
+  if (!in.is_open()) {
+    Logger::instance().warn("Could not open metadata cache: " + file_.string());
+    return;
+  }
+  try {
+    nlohmann::json j;
+    in >> j;
+    if (!j.is_object())
+      return;
+    for (auto it = j.begin(); it != j.end(); ++it) {
+      const auto &e = it.value();
+      if (!e.is_object() || !e.contains("value"))
+        continue;
+      Entry entry;
+      entry.value = e["value"];
+      entry.fetched_at_ms = e.value("fetched_at_ms", 0LL);
+      entry.etag = e.value("etag", std::string());
+      entry.last_modified = e.value("last_modified", std::string());
+      entries_[it.key()] = std::move(entry);
+    }
+  } catch (const std::exception &e) {
+    Logger::instance().warn("Failed to parse metadata cache " + file_.string() +
+                            ": " + e.what());
+    entries_.clear();
+  }
+}
+
+std::optional<MetadataCache::Entry> MetadataCache::get(const std::string &key) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  ensure_loaded();
+  auto it = entries_.find(key);
+  if (it == entries_.end())
+    return std::nullopt;
+  return it->second;
+}
+
+void MetadataCache::put(const std::string &key, Entry entry) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  ensure_loaded();
+  if (entry.fetched_at_ms <= 0)
+    entry.fetched_at_ms = now_ms();
+  entries_[key] = std::move(entry);
+  dirty_ = true;
+}
+
+bool MetadataCache::touch(const std::string &key) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  ensure_loaded();
+  auto it = entries_.find(key);
+  if (it == entries_.end())
+    return false;
+  it->second.fetched_at_ms = now_ms();
+  dirty_ = true;
+  return true;
+}
+
+void MetadataCache::erase(const std::string &key) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  ensure_loaded();
+  if (entries_.erase(key) > 0)
+    dirty_ = true;
+}
+
+bool MetadataCache::save() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!dirty_)
+    return true;
+  nlohmann::json j = nlohmann::json::object();
+  for (const auto &[key, entry] : entries_) {
+    j[key] = {{"value", entry.value},
+              {"fetched_at_ms", entry.fetched_at_ms},
+              {"etag", entry.etag},
+              {"last_modified", entry.last_modified}};
+  }
+  std::error_code ec;
+  if (file_.has_parent_path())
+    std::filesystem::create_directories(file_.parent_path(), ec);
+  auto tmp = file_;
+  tmp += ".tmp";
+  {
+    std::ofstream out(tmp, std::ios::trunc);
+    if (!out.is_open()) {
+      Logger::instance().error("Could not open metadata cache for writing: " + tmp.string());
+      return false;
+    }
+    out << j.dump();
+    if (!out) {
+      Logger::instance().error("Failed to write metadata cache: " + tmp.string());
+      return false;
+    }
+  }
+  std::filesystem::rename(tmp, file_, ec);
+  if (ec) {
+    Logger::instance().error("Failed to replace metadata cache " + file_.string() +
+                             ": " + ec.message());
+    return false;
+  }
+  dirty_ = false;
+  return true;
+}
+
+} // namespace Core
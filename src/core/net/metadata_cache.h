@@ -0,0 +1,63 @@
+#pragma once
+
+#include <chrono>
+#include <filesystem>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+namespace Core {
+
+// Small persistent key/value store for provider metadata (symbol lists,
+// supported intervals, exchange info projections). Entries remember when they
+// were fetched and the HTTP validators (ETag / Last-Modified) returned by the
+// venue so stale data can be revalidated with a conditional request instead
+// of downloading the full payload again. The backing file lives in the data
+// directory and is loaded lazily on first access.
+class MetadataCache {
+public:
+  struct Entry {
+    nlohmann::json value;
+    long long fetched_at_ms{0};
+    std::string etag;
+    std::string last_modified;
+  };
+
+  explicit MetadataCache(std::filesystem::path file);
+
+  std::optional<Entry> get(const std::string &key) const;
+  void put(const std::string &key, Entry entry);
+  // Marks an entry as revalidated (e.g. after HTTP 304). Returns false when
+  // the key is unknown.
+  bool touch(const std::string &key);
+  void erase(const std::string &key);
+
+  // Writes all entries to disk (temporary file + rename). No-op when nothing
+  // changed since the last save.
+  bool save() const;
+
+  const std::filesystem::path &file() const { return file_; }
+
+  static long long now_ms();
+  static bool is_fresh(const Entry &entry, std::chrono::seconds ttl,
+                       long long now = now_ms());
+
+  // Helpers for the common "list of strings" payload.
+  static nlohmann::json from_strings(const std::vector<std::string> &values);
+  static std::vector<std::string> to_strings(const nlohmann::json &value);
+
+private:
+  void ensure_loaded() const;
+
+  std::filesystem::path file_;
+  mutable std::mutex mutex_;
+  mutable bool loaded_ = false;
+  mutable bool dirty_ = false;
+  mutable std::map<std::string, Entry> entries_;
+};
+
+} // namespace Core
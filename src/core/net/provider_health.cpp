@@ -0,0 +1,158 @@
+#include "provider_health.h"
+
+#include <algorithm>
+
+namespace Core {
+
+const char *to_string(CircuitState state) {
+  switch (state) {
+  case CircuitState::Closed:
+    return "closed";
+  case CircuitState::Open:
+    return "open";
+  case CircuitState::HalfOpen:
+    return "half-open";
+  }
+  return "unknown";
+}
+
+ProviderHealth::ProviderHealth() : ProviderHealth(Options{}) {}
+
+ProviderHealth::ProviderHealth(Options options)
+    : options_(options), cooldown_(options.open_cooldown) {}
+
+bool ProviderHealth::allow_request(Clock::time_point now) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  switch (state_) {
+  case CircuitState::Closed:
+    return true;
+  case CircuitState::Open:
+    if (now - opened_at_ < cooldown_)
+      return false;
+    state_ = CircuitState::HalfOpen;
+    probe_in_flight_ = true;
+    return true;
+  case CircuitState::HalfOpen:
+    if (probe_in_flight_)
+      return false;
+    probe_in_flight_ = true;
+    return true;
+  }
+  return true;
+}
+
+void ProviderHealth::update_latency(std::chrono::milliseconds latency) {
+  const double ms = static_cast<double>(latency.count());
+  if (total_requests_ == 0)
+    latency_ewma_ms_ = ms;
+  else
+    latency_ewma_ms_ += options_.ewma_alpha * (ms - latency_ewma_ms_);
+}
+
+void ProviderHealth::record_success(std::chrono::milliseconds latency,
+                                    Clock::time_point) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  update_latency(latency);
+  ++total_requests_;
+  if (options_.latency_window > 0) {
+    if (latency_samples_.size() < options_.latency_window) {
+      latency_samples_.push_back(latency.count());
+    } else {
+      latency_samples_[latency_next_] = latency.count();
+      latency_next_ = (latency_next_ + 1) % options_.latency_window;
+    }
+  }
+  error_rate_ += options_.ewma_alpha * (0.0 - error_rate_);
+  consecutive_failures_ = 0;
+  probe_in_flight_ = false;
+  if (state_ != CircuitState::Closed) {
+    state_ = CircuitState::Closed;
+    cooldown_ = options_.open_cooldown;
+    // Forget the outage so a single failure right after recovery does not
+    // immediately re-open the circuit on the stale rate.
+    error_rate_ = 0.0;
+  }
+}
+
+void ProviderHealth::record_failure(std::chrono::milliseconds latency,
+                                    Clock::time_point now) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  update_latency(latency);
+  ++total_requests_;
+  ++total_failures_;
+  error_rate_ += options_.ewma_alpha * (1.0 - error_rate_);
+  ++consecutive_failures_;
+  probe_in_flight_ = false;
+  if (state_ == CircuitState::HalfOpen) {
+    // Failed probe: back off further before the next one.
+    cooldown_ = std::min(cooldown_ * 2, options_.max_cooldown);
+    open_circuit(now);
+    return;
+  }
+  if (state_ == CircuitState::Closed &&
+      (consecutive_failures_ >= options_.failure_threshold ||
+       (total_requests_ >= static_cast<std::size_t>(options_.min_samples) &&
+        error_rate_ >= options_.error_rate_threshold))) {
+    open_circuit(now);
+  }
+}
+
+void ProviderHealth::open_circuit(Clock::time_point now) {
+  state_ = CircuitState::Open;
+  opened_at_ = now;
+}
+
+CircuitState ProviderHealth::state() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return state_;
+}
+
+std::optional<std::chrono::milliseconds>
+ProviderHealth::quantile_locked(double q) const {
+  constexpr std::size_t kMinSamples = 5;
+  if (latency_samples_.size() < kMinSamples)
+    return std::nullopt;
+  std::vector<long long> sorted = latency_samples_;
+  q = std::clamp(q, 0.0, 1.0);
+  const auto rank = static_cast<std::size_t>(q * static_cast<double>(sorted.size() - 1) + 0.5);
+  std::nth_element(sorted.begin(), sorted.begin() + static_cast<std::ptrdiff_t>(rank),
+                   sorted.end());
+  return std::chrono::milliseconds(sorted[rank]);
+}
+
+std::optional<std::chrono::milliseconds>
+ProviderHealth::latency_quantile(double q) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return quantile_locked(q);
+}
+
+ProviderHealth::Snapshot ProviderHealth::snapshot() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  const auto p95 = quantile_locked(0.95);
+  return {state_,
+          latency_ewma_ms_,
+          error_rate_,
+          p95 ? static_cast<double>(p95->count()) : 0.0,
+          consecutive_failures_,
+          total_requests_,
+          total_failures_};
+}
+
+bool ProviderHealth::is_provider_failure(FetchError error, int http_status) {
+  switch (error) {
+  case FetchError::None:
+  case FetchError::InvalidInterval:
+  case FetchError::CircuitOpen:
+    return false;
+  case FetchError::NetworkError:
+  case FetchError::ParseError:
+    return true;
+  case FetchError::HttpError:
+    if (http_status == 0 || http_status == 408 || http_status == 429)
+      return true;
+    return http_status >= 500;
+  }
+  return true;
+}
+
+} // namespace Core
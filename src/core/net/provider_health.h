@@ -0,0 +1,89 @@
+#pragma once
+
+#include "fetch_result.h"
+
+#include <chrono>
+#include <cstddef>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+namespace Core {
+
+enum class CircuitState { Closed, Open, HalfOpen };
+
+const char *to_string(CircuitState state);
+
+// Per-provider health score (latency and error-rate EWMAs) combined with a
+// circuit breaker. While the circuit is Open, requests are rejected without
+// touching the network; after the cooldown a single probe is let through
+// (HalfOpen) and its outcome decides whether the circuit closes again.
+// Timestamps are injectable so the state machine can be tested without
+// sleeping.
+class ProviderHealth {
+public:
+  using Clock = std::chrono::steady_clock;
+
+  struct Options {
+    double ewma_alpha{0.2};
+    int failure_threshold{3};          // consecutive failures that open the circuit
+    double error_rate_threshold{0.5};  // EWMA error rate that opens the circuit
+    int min_samples{5};                // samples required before the rate is trusted
+    std::chrono::milliseconds open_cooldown{std::chrono::milliseconds(5000)};
+    std::chrono::milliseconds max_cooldown{std::chrono::milliseconds(60000)};
+    std::size_t latency_window{128};   // successful samples kept for quantiles
+  };
+
+  struct Snapshot {
+    CircuitState state{CircuitState::Closed};
+    double latency_ewma_ms{0.0};
+    double error_rate{0.0};
+    double p95_ms{0.0};
+    int consecutive_failures{0};
+    std::size_t total_requests{0};
+    std::size_t total_failures{0};
+  };
+
+  ProviderHealth();
+  explicit ProviderHealth(Options options);
+
+  // Returns false when the circuit is Open (or a HalfOpen probe is already
+  // in flight). A true result in HalfOpen reserves the probe slot; the caller
+  // must report the outcome via record_success/record_failure.
+  bool allow_request(Clock::time_point now = Clock::now());
+  void record_success(std::chrono::milliseconds latency,
+                      Clock::time_point now = Clock::now());
+  void record_failure(std::chrono::milliseconds latency,
+                      Clock::time_point now = Clock::now());
+
+  CircuitState state() const;
+  Snapshot snapshot() const;
+  // Latency quantile (0..1) over the recent successful requests; empty until
+  // a handful of samples has been collected.
+  std::optional<std::chrono::milliseconds> latency_quantile(double q) const;
+
+  // Whether a fetch outcome reflects a provider problem (network, 5xx, 429,
+  // malformed payload) rather than a bad request from our side.
+  static bool is_provider_failure(FetchError error, int http_status);
+
+private:
+  void open_circuit(Clock::time_point now);
+  void update_latency(std::chrono::milliseconds latency);
+  std::optional<std::chrono::milliseconds> quantile_locked(double q) const;
+
+  Options options_;
+  mutable std::mutex mutex_;
+  CircuitState state_{CircuitState::Closed};
+  Clock::time_point opened_at_{};
+  std::chrono::milliseconds cooldown_{0};
+  bool probe_in_flight_{false};
+  double latency_ewma_ms_{0.0};
+  double error_rate_{0.0};
+  int consecutive_failures_{0};
+  std::size_t total_requests_{0};
+  std::size_t total_failures_{0};
+  std::vector<long long> latency_samples_;
+  std::size_t latency_next_{0};
+};
+
+} // namespace Core
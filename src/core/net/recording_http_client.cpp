@@ -0,0 +1,93 @@
+#include "recording_http_client.h"
+
+#include "core/logger.h"
+#include "core/market_data_recorder.h"
+
+#include <nlohmann/json.hpp>
+
+namespace Core {
+
+RecordingHttpClient::RecordingHttpClient(std::shared_ptr<IHttpClient> inner,
+                                         const std::filesystem::path &fixture)
+    : inner_(std::move(inner)) {
+  std::error_code ec;
+  if (fixture.has_parent_path())
+    std::filesystem::create_directories(fixture.parent_path(), ec);
+  out_.open(fixture, std::ios::app);
+  if (!out_.is_open())
+    Logger::instance().error("Could not open HTTP fixture for recording: " +
+                             fixture.string());
+}
+
+RecordingHttpClient::RecordingHttpClient(std::shared_ptr<IHttpClient> inner,
+                                         std::shared_ptr<MarketDataRecorder> recorder)
+    : inner_(std::move(inner)), recorder_(std::move(recorder)) {}
+
+HttpResponse RecordingHttpClient::get(const std::string &url,
+                                      std::chrono::milliseconds timeout,
+                                      const std::map<std::string, std::string> &headers) {
+  const auto started = std::chrono::steady_clock::now();
+  HttpResponse resp = inner_->get(url, timeout, headers);
+  const auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+      std::chrono::steady_clock::now() - started);
+  record({"GET", url, "", resp, elapsed.count()});
+  return resp;
+}
+
+HttpResponse RecordingHttpClient::post(const std::string &url, const std::string &body,
+                                       std::chrono::milliseconds timeout,
+                                       const std::map<std::string, std::string> &headers) {
+  const auto started = std::chrono::steady_clock::now();
+  HttpResponse resp = inner_->post(url, body, timeout, headers);
+  const auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+      std::chrono::steady_clock::now() - started);
+  record({"POST", url, body, resp, elapsed.count()});
+  return resp;
+}
+
+void RecordingHttpClient::record(HttpExchange exchange) {
+  if (recorder_) {
+    recorder_->record_http(exchange);
+    return;
+  }
+  const std::string line = serialize(exchange);
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!out_.is_open())
+    return;
+  out_ << line << '\n';
+  out_.flush();
+}
+
+std::string RecordingHttpClient::serialize(const HttpExchange &exchange) {
+  nlohmann::json j = {{"method", exchange.method},
+                      {"url", exchange.url},
+                      {"body", exchange.body},
+                      {"status", exchange.response.status_code},
+                      {"text", exchange.response.text},
+                      {"error", exchange.response.error_message},
+                      {"network_error", exchange.response.network_error},
+                      {"headers", exchange.response.headers},
+                      {"latency_ms", exchange.latency_ms}};
+  return j.dump();
+}
+
+bool RecordingHttpClient::deserialize(const std::string &line, HttpExchange &exchange) {
+  try {
+    auto j = nlohmann::json::parse(line);
+    exchange.method = j.value("method", std::string("GET"));
+    exchange.url = j.value("url", std::string());
+    exchange.body = j.value("body", std::string());
+    exchange.response.status_code = j.value("status", 0);
+    exchange.response.text = j.value("text", std::string());
+    exchange.response.error_message = j.value("error", std::string());
+    exchange.response.network_error = j.value("network_error", false);
+    exchange.response.headers =
+        j.value("headers", std::map<std::string, std::string>{});
+    exchange.latency_ms = j.value("latency_ms", 0LL);
+    return !exchange.url.empty();
+  } catch (const std::exception &) {
+    return false;
+  }
+}
+
+} // namespace Core
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "ihttp_client.h"
+
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <mutex>
+
+namespace Core {
+
+class MarketDataRecorder;
+
+// One request/response pair as stored in a fixture file (JSON lines).
+struct HttpExchange {
+  std::string method;
+  std::string url;
+  std::string body;
+  HttpResponse response;
+  long long latency_ms{0};
+};
+
+// Decorator that forwards every request to an inner client and appends the
+// exchange (including measured latency) to a JSON-lines fixture. Fixtures are
+// served back by ReplayHttpClient. The second form writes the exchanges into
+// a binary market-data recording instead, next to the WebSocket frames.
+class RecordingHttpClient : public IHttpClient {
+public:
+  RecordingHttpClient(std::shared_ptr<IHttpClient> inner,
+                      const std::filesystem::path &fixture);
+  RecordingHttpClient(std::shared_ptr<IHttpClient> inner,
+                      std::shared_ptr<MarketDataRecorder> recorder);
+
+  HttpResponse get(const std::string &url,
+                   std::chrono::milliseconds timeout,
+                   const std::map<std::string, std::string> &headers) override;
+  HttpResponse post(const std::string &url, const std::string &body,
+                    std::chrono::milliseconds timeout,
+                    const std::map<std::string, std::string> &headers) override;
+
+  bool is_open() const { return recorder_ || out_.is_open(); }
+
+  static std::string serialize(const HttpExchange &exchange);
+  static bool deserialize(const std::string &line, HttpExchange &exchange);
+
+private:
+  void record(HttpExchange exchange);
+
+  std::shared_ptr<IHttpClient> inner_;
+  std::shared_ptr<MarketDataRecorder> recorder_;
+  std::mutex mutex_;
+  std::ofstream out_;
+};
+
+} // namespace Core
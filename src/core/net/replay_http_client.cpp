@@ -0,0 +1,182 @@
+#include "replay_http_client.h"
+
+#include "core/logger.h"
+
+#include <cctype>
+#include <fstream>
+#include <nlohmann/json.hpp>
+#include <thread>
+
+namespace Core {
+
+ReplayHttpClient::ReplayHttpClient() : ReplayHttpClient(Options{}) {}
+
+ReplayHttpClient::ReplayHttpClient(Options options) : options_(options) {}
+
+namespace {
+
+bool is_number(const std::string &s) {
+  if (s.empty())
+    return false;
+  for (unsigned char c : s) {
+    if (!std::isdigit(c) && c != '-' && c != '.')
+      return false;
+  }
+  return true;
+}
+
+// "type=candleSnapshot;req.coin=BTC;req.interval=1m;" for a candleSnapshot
+// body: string leaves only, so timestamps and limits do not take part.
+void append_string_fields(const nlohmann::json &j, const std::string &prefix,
+                          std::string &out) {
+  if (j.is_object()) {
+    for (auto it = j.begin(); it != j.end(); ++it)
+      append_string_fields(it.value(), prefix + it.key() + '.', out);
+  } else if (j.is_string()) {
+    const auto &value = j.get_ref<const std::string &>();
+    if (!is_number(value))
+      out += prefix.substr(0, prefix.size() - 1) + '=' + value + ';';
+  }
+}
+
+} // namespace
+
+std::string ReplayHttpClient::exact_key(const std::string &method,
+                                        const std::string &url,
+                                        const std::string &body) {
+  return method + ' ' + url + '\n' + body;
+}
+
+std::string ReplayHttpClient::fallback_key(const std::string &method,
+                                           const std::string &url,
+                                           const std::string &body) {
+  const auto q = url.find('?');
+  std::string key = method + ' ' + url.substr(0, q) + '\n';
+  if (q != std::string::npos) {
+    std::size_t pos = q + 1;
+    while (pos <= url.size()) {
+      auto amp = url.find('&', pos);
+      if (amp == std::string::npos)
+        amp = url.size();
+      const auto param = url.substr(pos, amp - pos);
+      const auto eq = param.find('=');
+      if (eq == std::string::npos || !is_number(param.substr(eq + 1)))
+        key += param + ';';
+      pos = amp + 1;
+    }
+  }
+  key += '\n';
+  if (!body.empty()) {
+    const auto j = nlohmann::json::parse(body, nullptr, false);
+    if (j.is_discarded())
+      key += body;
+    else
+      append_string_fields(j, "", key);
+  }
+  return key;
+}
+
+std::size_t ReplayHttpClient::load(const std::filesystem::path &fixture) {
+  std::ifstream in(fixture);
+  if (!in.is_open()) {
+    Logger::instance().error("Could not open HTTP fixture: " + fixture.string());
+    return 0;
+  }
+  std::size_t count = 0;
+  std::string line;
+  while (std::getline(in, line)) {
+    if (line.empty())
+      continue;
+    HttpExchange exchange;
+    if (!RecordingHttpClient::deserialize(line, exchange)) {
+      Logger::instance().warn("Skipping malformed HTTP fixture line in " +
+                              fixture.string());
+      continue;
+    }
+    add(exchange);
+    ++count;
+  }
+  return count;
+}
+
+void ReplayHttpClient::add(const HttpExchange &exchange) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  const std::size_t index = records_.size();
+  records_.push_back({exchange, exact_key(exchange.method, exchange.url, exchange.body),
+                      fallback_key(exchange.method, exchange.url, exchange.body)});
+  exact_[records_.back().exact_key].pending.push_back(index);
+  fallback_[records_.back().fallback_key].pending.push_back(index);
+}
+
+HttpResponse ReplayHttpClient::serve(const std::string &method,
+                                     const std::string &url,
+                                     const std::string &body) {
+  HttpExchange hit;
+  bool found = false;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto take = [&](std::map<std::string, Slot> &slots, const std::string &key) {
+      auto it = slots.find(key);
+      if (it == slots.end())
+        return false;
+      auto &slot = it->second;
+      // Entries served through the other index are skipped here.
+      while (!slot.pending.empty() && records_[slot.pending.front()].served)
+        slot.pending.pop_front();
+      std::size_t index;
+      if (!slot.pending.empty()) {
+        index = slot.pending.front();
+        auto &record = records_[index];
+        record.served = true;
+        exact_[record.exact_key].last = index;
+        fallback_[record.fallback_key].last = index;
+      } else if (slot.last) {
+        index = *slot.last;
+      } else {
+        return false;
+      }
+      hit = records_[index].exchange;
+      return true;
+    };
+    found = take(exact_, exact_key(method, url, body));
+    if (!found && !options_.strict)
+      found = take(fallback_, fallback_key(method, url, body));
+    if (found)
+      ++served_;
+    else
+      ++misses_;
+  }
+  if (!found) {
+    Logger::instance().warn("No recorded response for " + method + " " + url);
+    return {0, "", "No recorded response for " + method + " " + url, true, {}};
+  }
+  if (options_.simulate_latency && hit.latency_ms > 0) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(static_cast<long long>(
+        static_cast<double>(hit.latency_ms) * options_.latency_scale)));
+  }
+  return hit.response;
+}
+
+HttpResponse ReplayHttpClient::get(const std::string &url,
+                                   std::chrono::milliseconds,
+                                   const std::map<std::string, std::string> &) {
+  return serve("GET", url, "");
+}
+
+HttpResponse ReplayHttpClient::post(const std::string &url, const std::string &body,
+                                    std::chrono::milliseconds,
+                                    const std::map<std::string, std::string> &) {
+  return serve("POST", url, body);
+}
+
+std::size_t ReplayHttpClient::served() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return served_;
+}
+
+std::size_t ReplayHttpClient::misses() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return misses_;
+}
+
+} // namespace Core
@@ -0,0 +1,81 @@
+#pragma once
+
+#include "ihttp_client.h"
+#include "recording_http_client.h"
+
+#include <cstddef>
+#include <deque>
+#include <filesystem>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace Core {
+
+// Serves responses from a fixture written by RecordingHttpClient. Requests are
+// matched on method + URL + body; repeated requests get the recorded answers
+// in order, and the last one is repeated once the queue is drained. Provider
+// requests usually embed "now"-derived timestamps, so in non-strict mode a
+// request with no exact match falls back to the next unserved recording with
+// the same method, path and non-numeric request fields: query parameters and
+// JSON body strings such as Hyperliquid's type, coin and interval. Each
+// recording is served at most once through either route. Unmatched requests
+// are reported as network errors.
+class ReplayHttpClient : public IHttpClient {
+public:
+  struct Options {
+    bool strict{false};
+    bool simulate_latency{false};
+    double latency_scale{1.0};
+  };
+
+  ReplayHttpClient();
+  explicit ReplayHttpClient(Options options);
+
+  // Loads a fixture file; returns the number of exchanges read.
+  std::size_t load(const std::filesystem::path &fixture);
+  void add(const HttpExchange &exchange);
+
+  HttpResponse get(const std::string &url,
+                   std::chrono::milliseconds timeout,
+                   const std::map<std::string, std::string> &headers) override;
+  HttpResponse post(const std::string &url, const std::string &body,
+                    std::chrono::milliseconds timeout,
+                    const std::map<std::string, std::string> &headers) override;
+
+  std::size_t served() const;
+  std::size_t misses() const;
+
+private:
+  struct Record {
+    HttpExchange exchange;
+    std::string exact_key;
+    std::string fallback_key;
+    bool served{false};
+  };
+  // Indices into records_, in recorded order.
+  struct Slot {
+    std::deque<std::size_t> pending;
+    std::optional<std::size_t> last;
+  };
+
+  HttpResponse serve(const std::string &method, const std::string &url,
+                     const std::string &body);
+  static std::string exact_key(const std::string &method, const std::string &url,
+                               const std::string &body);
+  // Method and path plus the request fields that are not numbers.
+  static std::string fallback_key(const std::string &method, const std::string &url,
+                                  const std::string &body);
+
+  Options options_;
+  mutable std::mutex mutex_;
+  std::vector<Record> records_;
+  std::map<std::string, Slot> exact_;
+  std::map<std::string, Slot> fallback_;
+  std::size_t served_{0};
+  std::size_t misses_{0};
+};
+
+} // namespace Core
@@ -1,5 +1,7 @@
 #include "token_bucket_rate_limiter.h"
 
+#include <algorithm>
+
 namespace Core {
 
 TokenBucketRateLimiter::TokenBucketRateLimiter(
@@ -18,9 +20,31 @@ void TokenBucketRateLimiter::refill() {
   }
 }
 
+bool TokenBucketRateLimiter::background_may_take(
+    std::chrono::steady_clock::time_point now) const {
+  return tokens_ > 0 && foreground_waiting_ == 0 &&
+         now - last_foreground_ >= refill_interval_;
+}
+
 void TokenBucketRateLimiter::acquire() {
   std::unique_lock<std::mutex> lock(mutex_);
   refill();
+  if (current_request_priority() == RequestPriority::Background) {
+    while (!background_may_take(std::chrono::steady_clock::now())) {
+      if (foreground_waiting_ > 0) {
+        // Woken once the foreground caller has taken its token.
+        cv_.wait(lock);
+      } else {
+        cv_.wait_until(lock, std::max(last_refill_ + refill_interval_,
+                                      last_foreground_ + refill_interval_));
+      }
+      refill();
+    }
+    --tokens_;
+    return;
+  }
+
+  ++foreground_waiting_;
   while (tokens_ == 0) {
     auto next_time = last_refill_ + refill_interval_;
     cv_.wait_until(lock, next_time, [this] {
@@ -29,7 +53,15 @@ void TokenBucketRateLimiter::acquire() {
     });
   }
   --tokens_;
+  --foreground_waiting_;
+  last_foreground_ = std::chrono::steady_clock::now();
+  cv_.notify_all();
 }
 
-} // namespace Core
+bool TokenBucketRateLimiter::has_idle_capacity() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  refill();
+  return background_may_take(std::chrono::steady_clock::now());
+}
 
+} // namespace Core
@@ -7,22 +7,28 @@
 
 namespace Core {
 
+// Foreground callers always go first. A background caller only takes a token
+// when no foreground caller is waiting and none acquired within the last
+// refill interval, so a foreground burst is never paced behind prefetch.
 class TokenBucketRateLimiter : public IRateLimiter {
 public:
   TokenBucketRateLimiter(std::size_t capacity,
                          std::chrono::milliseconds refill_interval);
   void acquire() override;
+  bool has_idle_capacity() override;
 
 private:
   void refill();
+  bool background_may_take(std::chrono::steady_clock::time_point now) const;
 
   const std::size_t capacity_;
   std::size_t tokens_;
   const std::chrono::milliseconds refill_interval_;
   std::chrono::steady_clock::time_point last_refill_;
+  std::size_t foreground_waiting_{0};
+  std::chrono::steady_clock::time_point last_foreground_{};
   std::mutex mutex_;
   std::condition_variable cv_;
 };
 
 } // namespace Core
-
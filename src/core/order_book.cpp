@@ -0,0 +1,121 @@
+#include "order_book.h"
+
+#include <algorithm>
+#include <functional>
+
+namespace Core {
+
+template <typename Better>
+void OrderBook::update(std::vector<PriceLevel> &side, double price, double qty,
+                       Better better) {
+  // Most traffic is at the touch; skip the search when it is.
+  if (!side.empty() && side.back().price == price) {
+    if (qty > 0.0)
+      side.back().qty = qty;
+    else
+      side.pop_back();
+    return;
+  }
+  // Sorted worst to best, so "worse than price" comes first.
+  auto it = std::lower_bound(side.begin(), side.end(), price,
+                             [&](const PriceLevel &l, double p) { return better(p, l.price); });
+  if (it != side.end() && it->price == price) {
+    if (qty > 0.0)
+      it->qty = qty;
+    else
+      side.erase(it);
+  } else if (qty > 0.0) {
+    side.insert(it, PriceLevel{price, qty});
+  }
+}
+
+void OrderBook::set_level(Side side, double price, double qty) {
+  if (side == Side::Bid)
+    update(bids_, price, qty, std::greater<double>());
+  else
+    update(asks_, price, qty, std::less<double>());
+}
+
+void OrderBook::clear() {
+  bids_.clear();
+  asks_.clear();
+  last_update_id_ = 0;
+  synced_ = false;
+  bridged_ = false;
+}
+
+void OrderBook::apply_snapshot(const DepthSnapshot &snapshot) {
+  bids_.clear();
+  asks_.clear();
+  for (const auto &l : snapshot.bids)
+    if (l.qty > 0.0)
+      bids_.push_back(l);
+  for (const auto &l : snapshot.asks)
+    if (l.qty > 0.0)
+      asks_.push_back(l);
+  std::sort(bids_.begin(), bids_.end(),
+            [](const PriceLevel &a, const PriceLevel &b) { return a.price < b.price; });
+  std::sort(asks_.begin(), asks_.end(),
+            [](const PriceLevel &a, const PriceLevel &b) { return a.price > b.price; });
+  last_update_id_ = snapshot.last_update_id;
+  synced_ = true;
+  bridged_ = false;
+}
+
+void OrderBook::apply_levels(const DepthDiff &diff) {
+  for (const auto &l : diff.bids)
+    update(bids_, l.price, l.qty, std::greater<double>());
+  for (const auto &l : diff.asks)
+    update(asks_, l.price, l.qty, std::less<double>());
+}
+
+OrderBook::DiffResult OrderBook::apply_diff(const DepthDiff &diff) {
+  if (!synced_)
+    return DiffResult::Gap;
+  if (diff.final_update_id <= last_update_id_)
+    return DiffResult::Stale;
+  const bool in_sequence =
+      bridged_ ? diff.first_update_id == last_update_id_ + 1
+               : diff.first_update_id <= last_update_id_ + 1;
+  if (!in_sequence) {
+    synced_ = false;
+    ++gaps_;
+    return DiffResult::Gap;
+  }
+  apply_levels(diff);
+  last_update_id_ = diff.final_update_id;
+  bridged_ = true;
+  return DiffResult::Applied;
+}
+
+void OrderBook::top(Side side, std::size_t n, std::vector<PriceLevel> &out) const {
+  const auto &v = levels(side);
+  n = std::min(n, v.size());
+  out.assign(v.rbegin(), v.rbegin() + static_cast<std::ptrdiff_t>(n));
+}
+
+double OrderBook::microprice() const {
+  const auto &b = best_bid();
+  const auto &a = best_ask();
+  const double total = b.qty + a.qty;
+  if (total <= 0.0)
+    return mid();
+  return (b.price * a.qty + a.price * b.qty) / total;
+}
+
+double OrderBook::imbalance() const {
+  const double b = best_bid().qty;
+  const double a = best_ask().qty;
+  return b + a > 0.0 ? (b - a) / (b + a) : 0.0;
+}
+
+double OrderBook::imbalance(std::size_t levels) const {
+  double b = 0.0, a = 0.0;
+  for (std::size_t i = 0; i < levels && i < bids_.size(); ++i)
+    b += level(Side::Bid, i).qty;
+  for (std::size_t i = 0; i < levels && i < asks_.size(); ++i)
+    a += level(Side::Ask, i).qty;
+  return b + a > 0.0 ? (b - a) / (b + a) : 0.0;
+}
+
+} // namespace Core
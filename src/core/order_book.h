@@ -0,0 +1,101 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Core {
+
+struct PriceLevel {
+  double price{0.0};
+  double qty{0.0};
+};
+
+// Full book state, e.g. Binance GET /api/v3/depth or a Hyperliquid l2Book
+// message (which carries no sequence; its timestamp is used instead).
+struct DepthSnapshot {
+  std::uint64_t last_update_id{0};
+  std::vector<PriceLevel> bids;
+  std::vector<PriceLevel> asks;
+};
+
+// Incremental update covering sequence ids [first_update_id,
+// final_update_id] (Binance depthUpdate U/u). A zero quantity removes the
+// level.
+struct DepthDiff {
+  std::uint64_t first_update_id{0};
+  std::uint64_t final_update_id{0};
+  long long event_time{0};
+  std::vector<PriceLevel> bids;
+  std::vector<PriceLevel> asks;
+};
+
+// L2 order book for one symbol. Each side is a flat vector sorted so that
+// the best level is at the back: best bid/ask and the i-th level from the
+// top are O(1) reads from contiguous memory, a level is found by binary
+// search (the top level is checked first), and inserting or erasing a level
+// only moves the levels between it and the top, which for near-touch
+// traffic is a handful. The trade-off: a level deep in the book costs
+// O(depth) element moves, not a tree's O(log n). Diffs are sequenced the Binance way: after a
+// snapshot with id L, diffs with u <= L are stale, the first applied diff
+// must straddle L + 1, and every later one must start right after the
+// previous one; anything else is a gap and the book waits for a new
+// snapshot. Not thread-safe.
+class OrderBook {
+public:
+  enum class Side { Bid, Ask };
+  enum class DiffResult { Applied, Stale, Gap };
+
+  void apply_snapshot(const DepthSnapshot &snapshot);
+  DiffResult apply_diff(const DepthDiff &diff);
+  // Sets (qty > 0) or removes (qty <= 0) one level, bypassing sequencing.
+  void set_level(Side side, double price, double qty);
+  void clear();
+
+  // False before the first snapshot and after a gap.
+  bool synced() const { return synced_; }
+  std::uint64_t last_update_id() const { return last_update_id_; }
+  std::uint64_t gaps() const { return gaps_; }
+
+  std::size_t depth(Side side) const { return levels(side).size(); }
+  bool empty() const { return bids_.empty() || asks_.empty(); }
+  // i-th level from the top (0 = best); requires i < depth(side).
+  const PriceLevel &level(Side side, std::size_t i) const {
+    const auto &v = levels(side);
+    return v[v.size() - 1 - i];
+  }
+  const PriceLevel &best_bid() const { return bids_.back(); }
+  const PriceLevel &best_ask() const { return asks_.back(); }
+  // Copies up to n levels from the top into out (cleared first).
+  void top(Side side, std::size_t n, std::vector<PriceLevel> &out) const;
+
+  // Top-of-book measures; all require !empty().
+  double spread() const { return best_ask().price - best_bid().price; }
+  double mid() const { return (best_ask().price + best_bid().price) / 2.0; }
+  // Mid weighted towards the side with less size: the price more likely
+  // to trade next.
+  double microprice() const;
+  // (bid qty - ask qty) / (bid qty + ask qty) at the best level, in [-1, 1].
+  double imbalance() const;
+  // Same over the top `levels` levels of each side (O(levels)).
+  double imbalance(std::size_t levels) const;
+
+private:
+  const std::vector<PriceLevel> &levels(Side side) const {
+    return side == Side::Bid ? bids_ : asks_;
+  }
+  template <typename Better>
+  static void update(std::vector<PriceLevel> &side, double price, double qty,
+                     Better better);
+  void apply_levels(const DepthDiff &diff);
+
+  // Ascending for bids, descending for asks: best level last.
+  std::vector<PriceLevel> bids_;
+  std::vector<PriceLevel> asks_;
+  std::uint64_t last_update_id_{0};
+  bool synced_{false};
+  bool bridged_{false}; // a diff was applied since the last snapshot
+  std::uint64_t gaps_{0};
+};
+
+} // namespace Core
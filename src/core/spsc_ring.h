@@ -0,0 +1,72 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <new>
+#include <vector>
+
+namespace Core {
+
+// Bounded lock-free ring for exactly one producer and one consumer thread
+// (a producer may migrate between threads as long as its pushes are
+// serialised, e.g. by a mutex it holds). Capacity is rounded up to a power
+// of two; the indices run freely and are masked on access.
+template <typename T> class SpscRing {
+public:
+  explicit SpscRing(std::size_t capacity) {
+    std::size_t n = 1;
+    while (n < capacity)
+      n <<= 1;
+    slots_.resize(n);
+    mask_ = n - 1;
+  }
+  SpscRing(const SpscRing &) = delete;
+  SpscRing &operator=(const SpscRing &) = delete;
+
+  // Producer side. False when the ring is full.
+  bool try_push(const T &value) {
+    const std::size_t tail = tail_.load(std::memory_order_relaxed);
+    if (tail - head_cache_ == slots_.size()) {
+      head_cache_ = head_.load(std::memory_order_acquire);
+      if (tail - head_cache_ == slots_.size())
+        return false;
+    }
+    slots_[tail & mask_] = value;
+    tail_.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Consumer side. False when the ring is empty.
+  bool try_pop(T &out) {
+    const std::size_t head = head_.load(std::memory_order_relaxed);
+    if (head == tail_cache_) {
+      tail_cache_ = tail_.load(std::memory_order_acquire);
+      if (head == tail_cache_)
+        return false;
+    }
+    out = slots_[head & mask_];
+    head_.store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Approximate when called concurrently with push/pop.
+  std::size_t size() const {
+    return tail_.load(std::memory_order_acquire) -
+           head_.load(std::memory_order_acquire);
+  }
+  std::size_t capacity() const { return slots_.size(); }
+
+private:
+  static constexpr std::size_t kCacheLine = 64;
+
+  std::vector<T> slots_;
+  std::size_t mask_{0};
+  // Consumer-owned line: read index and the consumer's view of tail_.
+  alignas(kCacheLine) std::atomic<std::size_t> head_{0};
+  std::size_t tail_cache_{0};
+  // Producer-owned line: write index and the producer's view of head_.
+  alignas(kCacheLine) std::atomic<std::size_t> tail_{0};
+  std::size_t head_cache_{0};
+};
+
+} // namespace Core
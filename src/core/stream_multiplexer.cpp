@@ -0,0 +1,849 @@
+#include "stream_multiplexer.h"
+
+#include <algorithm>
+#include <ctime>
+#include <optional>
+#include <nlohmann/json.hpp>
+
+#include "core/logger.h"
+#include "exchange_utils.h"
+#include "interval_utils.h"
+#include "kline_parsers.h"
+
+namespace Core {
+
+namespace {
+constexpr const char *kBinanceStreamUrl = "wss://stream.binance.com:9443/stream";
+constexpr const char *kGateStreamUrl = "wss://api.gateio.ws/ws/v4/";
+constexpr const char *kHyperliquidStreamUrl = "wss://api.hyperliquid.xyz/ws";
+// Hyperliquid drops connections that stay silent for a minute.
+constexpr std::chrono::seconds kHyperliquidPingInterval{50};
+// Trade-built bars of quiet symbols are closed on this tick, once the
+// window ended longer ago than the grace allowed for late trades.
+constexpr std::chrono::seconds kTradeBarTick{1};
+constexpr long long kTradeBarGraceMs = 1000;
+// Gap fetches of one reconnect run at most this many at a time.
+constexpr std::size_t kBackfillWorkers = 4;
+
+long long now_ms() {
+  return std::chrono::duration_cast<std::chrono::milliseconds>(
+             std::chrono::system_clock::now().time_since_epoch())
+      .count();
+}
+
+std::string derived_name(const std::string &trade_stream, const std::string &interval) {
+  return trade_stream + "#" + interval;
+}
+} // namespace
+
+struct StreamMultiplexer::BackfillRound {
+  struct Gap {
+    std::string stream;
+    std::shared_ptr<const Subscription> sub;
+    long long last{0};
+  };
+  std::uint64_t id{0};
+  std::vector<Gap> gaps;
+  GapFetcher fetch;
+  std::size_t max_bars{0};
+  long long now{0};
+  std::chrono::steady_clock::time_point deadline;
+  std::atomic<std::size_t> next{0}; // next gap to take
+  std::atomic<std::size_t> busy{0}; // workers still running
+  std::atomic<bool> cancelled{false};
+  std::atomic<std::size_t> published{0};
+  std::atomic<std::size_t> series{0};
+};
+
+StreamMultiplexer::StreamMultiplexer(const std::string &provider,
+                                     CandleManager &manager,
+                                     WebSocketFactory ws_factory,
+                                     SleepFunc sleep_func,
+                                     std::chrono::milliseconds base_delay,
+                                     std::shared_ptr<MarketDataBus> bus)
+    : provider_(provider),
+      ws_factory_(std::move(ws_factory)),
+      sleep_func_(sleep_func ? std::move(sleep_func)
+                             : [](std::chrono::milliseconds
+                                      d) { std::this_thread::sleep_for(d); }),
+      base_delay_(base_delay),
+      bus_(bus ? std::move(bus) : std::make_shared<MarketDataBus>()),
+      writer_(manager) {
+  // Persistence is the first closed-bar consumer.
+  persist_token_ = bus_->on_candle_closed([this](const CandleEvent &e) {
+    writer_.enqueue(e.symbol, e.interval, e.candle, e.stamps ? e.stamps->received_us : 0);
+  });
+}
+
+StreamMultiplexer::~StreamMultiplexer() {
+  stop();
+  bus_->unsubscribe(persist_token_);
+}
+
+bool StreamMultiplexer::supports(const std::string &provider) {
+  return provider == "binance" || provider == "gateio" || provider == "hyperliquid";
+}
+
+std::string StreamMultiplexer::binance_stream_name(const std::string &symbol,
+                                                   const std::string &interval) {
+  std::string sym = symbol;
+  std::transform(sym.begin(), sym.end(), sym.begin(),
+                 [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+  return sym + "@kline_" + interval;
+}
+
+std::string StreamMultiplexer::gate_stream_name(const std::string &symbol,
+                                                const std::string &interval) {
+  return interval + "_" + to_gate_symbol(symbol);
+}
+
+std::string StreamMultiplexer::hyperliquid_stream_name(const std::string &symbol,
+                                                       const std::string &interval) {
+  return to_hyperliquid_coin(symbol) + "@candle_" + interval;
+}
+
+std::string StreamMultiplexer::trade_stream_name(const std::string &symbol) const {
+  if (provider_ == "gateio")
+    return "trades_" + to_gate_symbol(symbol);
+  if (provider_ == "hyperliquid")
+    return to_hyperliquid_coin(symbol) + "@trades";
+  std::string sym = symbol;
+  std::transform(sym.begin(), sym.end(), sym.begin(),
+                 [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+  return sym + "@aggTrade";
+}
+
+bool StreamMultiplexer::built_from_trades(const std::string &interval) {
+  const auto period = parse_interval(interval);
+  return period.count() > 0 && period < std::chrono::minutes(1);
+}
+
+std::string StreamMultiplexer::stream_name(const std::string &symbol,
+                                           const std::string &interval) const {
+  if (provider_ == "gateio")
+    return gate_stream_name(symbol, interval);
+  if (provider_ == "hyperliquid")
+    return hyperliquid_stream_name(symbol, interval);
+  return binance_stream_name(symbol, interval);
+}
+
+std::string StreamMultiplexer::connect_url(
+    const std::map<std::string, std::pair<std::string, std::string>> &streams) const {
+  if (provider_ == "gateio")
+    return kGateStreamUrl;
+  if (provider_ == "hyperliquid")
+    return kHyperliquidStreamUrl;
+  std::string url = kBinanceStreamUrl;
+  char sep = '?';
+  for (const auto &entry : streams) {
+    url += sep == '?' ? "?streams=" : "/";
+    url += entry.first;
+    sep = '/';
+  }
+  return url;
+}
+
+void StreamMultiplexer::start() {
+  if (running_)
+    return;
+  running_ = true;
+  writer_.start();
+  thread_ = std::thread([this]() { run(); });
+}
+
+void StreamMultiplexer::stop() {
+  {
+    // Under mutex_ so the reactor cannot miss the wakeup between testing
+    // its predicate and blocking.
+    std::lock_guard<std::mutex> lock(mutex_);
+    running_ = false;
+  }
+  cv_.notify_all();
+  if (thread_.joinable())
+    thread_.join();
+  for (auto &worker : backfill_workers_)
+    worker.join();
+  backfill_workers_.clear();
+  writer_.stop();
+  std::uint64_t late = 0;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto &entry : aggregators_)
+      late += entry.second.late_trades();
+  }
+  if (late > 0)
+    Logger::instance().info("Trade bars (" + provider_ + "): " + std::to_string(late) +
+                            " late trades");
+}
+
+void StreamMultiplexer::set_live_update_interval(std::chrono::milliseconds interval) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  updates_.set_interval(interval);
+}
+
+void StreamMultiplexer::set_gap_fetcher(GapFetcher fetcher, std::size_t max_bars,
+                                        std::chrono::milliseconds deadline) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  gap_fetcher_ = std::move(fetcher);
+  max_backfill_bars_ = max_bars;
+  backfill_deadline_ = deadline;
+}
+
+StreamMultiplexer::BackfillStats StreamMultiplexer::backfill_stats() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return backfill_stats_;
+}
+
+void StreamMultiplexer::subscribe(const std::string &symbol,
+                                  const std::string &interval) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (built_from_trades(interval)) {
+      const auto trades = trade_stream_name(symbol);
+      auto &sub = wanted_[derived_name(trades, interval)];
+      if (sub)
+        return;
+      sub = std::make_shared<const Subscription>(Subscription{symbol, interval, true});
+      aggregators_[trades].add_interval(interval);
+      auto &stream = wanted_[trades];
+      if (stream)
+        return;
+      stream = std::make_shared<const Subscription>(Subscription{symbol, ""});
+    } else {
+      auto &sub = wanted_[stream_name(symbol, interval)];
+      if (sub)
+        return;
+      sub = std::make_shared<const Subscription>(Subscription{symbol, interval});
+    }
+    dirty_ = true;
+  }
+  cv_.notify_all();
+}
+
+void StreamMultiplexer::unsubscribe(const std::string &symbol,
+                                    const std::string &interval) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (built_from_trades(interval)) {
+      const auto trades = trade_stream_name(symbol);
+      const auto name = derived_name(trades, interval);
+      if (wanted_.erase(name) == 0)
+        return;
+      updates_.erase(name);
+      auto agg = aggregators_.find(trades);
+      agg->second.remove_interval(interval);
+      if (!agg->second.empty())
+        return;
+      aggregators_.erase(agg);
+      wanted_.erase(trades);
+    } else {
+      const auto name = stream_name(symbol, interval);
+      if (wanted_.erase(name) == 0)
+        return;
+      forming_.erase(name);
+      updates_.erase(name);
+      last_closed_.erase(name);
+      held_.erase(name);
+    }
+    dirty_ = true;
+  }
+  cv_.notify_all();
+}
+
+std::vector<std::pair<std::string, std::string>>
+StreamMultiplexer::subscriptions() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::vector<std::pair<std::string, std::string>> out;
+  out.reserve(wanted_.size());
+  for (const auto &entry : wanted_)
+    if (!entry.second->interval.empty())
+      out.emplace_back(entry.second->symbol, entry.second->interval);
+  return out;
+}
+
+std::map<std::string, std::pair<std::string, std::string>>
+StreamMultiplexer::network_streams() const {
+  std::map<std::string, std::pair<std::string, std::string>> out;
+  for (const auto &entry : wanted_)
+    if (!entry.second->derived)
+      out[entry.first] = {entry.second->symbol, entry.second->interval};
+  return out;
+}
+
+void StreamMultiplexer::run() {
+  if (!supports(provider_)) {
+    Logger::instance().warn("Streaming provider '" + provider_ +
+                            "' not supported; Kline streaming disabled");
+    bus_->publish_stream_status(provider_, StreamStatus::Failed);
+    running_ = false;
+    return;
+  }
+  std::size_t attempt = 0;
+
+  while (running_) {
+    std::map<std::string, std::pair<std::string, std::string>> initial;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      initial = network_streams();
+      // Trades missed while disconnected would leave forming bars short.
+      for (auto &entry : aggregators_)
+        entry.second.reset();
+      closed_ = false;
+      error_ = false;
+      dirty_ = false;
+    }
+    ws_ = ws_factory_();
+    if (!ws_) {
+      Logger::instance().warn(
+          "WebSocket support not available; Kline streaming disabled");
+      bus_->publish_stream_status(provider_, StreamStatus::Failed);
+      running_ = false;
+      break;
+    }
+    // Binance takes the initial streams in the URL; the other venues
+    // subscribe everything once the connection is open.
+    ws_->setUrl(connect_url(initial));
+    live_ = provider_ == "binance" ? initial : decltype(initial){};
+
+    ws_->setOnOpen([this, n = initial.size()]() {
+      Logger::instance().info("WS open (" + provider_ + "), " +
+                              std::to_string(n) + " streams");
+      connected_ = true;
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        dirty_ = true;
+        // Hold every series that delivered before the drop until its
+        // outage window is fetched; nothing is delivered yet on this socket.
+        if (gap_fetcher_) {
+          for (const auto &entry : wanted_)
+            if (!entry.second->derived && !entry.second->interval.empty() &&
+                last_closed_.count(entry.first))
+              held_[entry.first];
+          backfill_due_ = !held_.empty();
+        }
+      }
+      cv_.notify_all();
+      bus_->publish_stream_status(provider_, StreamStatus::Connected);
+    });
+    ws_->setOnMessage([this](const std::string &msg) { on_message(msg); });
+    ws_->setOnError([this]() {
+      Logger::instance().warn("WS error (" + provider_ + ")");
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        error_ = true;
+        closed_ = true;
+      }
+      cv_.notify_all();
+    });
+    ws_->setOnClose([this]() {
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        closed_ = true;
+      }
+      cv_.notify_all();
+    });
+
+    ws_->start();
+
+    auto next_ping = std::chrono::steady_clock::now() + kHyperliquidPingInterval;
+    auto next_tick = std::chrono::steady_clock::now() + kTradeBarTick;
+    for (;;) {
+      std::unique_lock<std::mutex> lock(mutex_);
+      auto woken = [this] {
+        return closed_ || dirty_ || rearm_ || backfill_due_ || !running_;
+      };
+      auto deadline = updates_.next_due();
+      if (provider_ == "hyperliquid" && (!deadline || next_ping < *deadline))
+        deadline = next_ping;
+      if (!aggregators_.empty() && (!deadline || next_tick < *deadline))
+        deadline = next_tick;
+      if (backfill_ && (!deadline || backfill_->deadline < *deadline))
+        deadline = backfill_->deadline;
+      if (deadline)
+        cv_.wait_until(lock, *deadline, woken);
+      else
+        cv_.wait(lock, woken);
+      if (closed_ || !running_)
+        break;
+      const bool changed = dirty_;
+      const bool backfill = backfill_due_;
+      dirty_ = false;
+      rearm_ = false;
+      backfill_due_ = false;
+      lock.unlock();
+
+      const auto now = std::chrono::steady_clock::now();
+      if (now >= next_tick) {
+        close_trade_bars();
+        next_tick = now + kTradeBarTick;
+      }
+      flush_updates(now);
+      if (provider_ == "hyperliquid" && now >= next_ping) {
+        if (connected_)
+          ws_->sendText(R"({"method":"ping"})");
+        next_ping = now + kHyperliquidPingInterval;
+      }
+      if (changed && connected_)
+        reconcile();
+      if (backfill)
+        backfill_gaps();
+      if (backfill_)
+        expire_backfill(now);
+    }
+
+    connected_ = false;
+    ws_->stop(); // may invoke the close callback; mutex_ must not be held
+    ws_.reset();
+    live_.clear();
+    // A backfill that never ran or is still fetching must not keep series
+    // held; the next reconnect fetches the window again.
+    if (backfill_) {
+      backfill_->cancelled = true;
+      backfill_.reset();
+    }
+    std::vector<std::string> held;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      backfill_due_ = false;
+      for (const auto &entry : held_)
+        held.push_back(entry.first);
+    }
+    for (const auto &name : held)
+      release_held(name, {});
+    Logger::instance().info("WS close (" + provider_ + ")");
+
+    bool error = false;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      error = error_;
+    }
+    bus_->publish_stream_status(provider_, error ? StreamStatus::Failed
+                                                 : StreamStatus::Disconnected);
+
+    if (error) {
+      ++attempt;
+      auto delay = base_delay_ * (1 << std::min<std::size_t>(attempt - 1, 8));
+      sleep_func_(delay);
+    } else {
+      attempt = 0;
+    }
+  }
+}
+
+void StreamMultiplexer::reconcile() {
+  std::map<std::string, std::pair<std::string, std::string>> wanted;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    wanted = network_streams();
+  }
+  std::vector<std::string> added, removed;
+  for (const auto &entry : wanted)
+    if (!live_.count(entry.first))
+      added.push_back(entry.first);
+  for (const auto &entry : live_)
+    if (!wanted.count(entry.first))
+      removed.push_back(entry.first);
+  if (added.empty() && removed.empty())
+    return;
+
+  if (provider_ == "binance") {
+    // One message per direction: the venue limits incoming messages per second.
+    if (!removed.empty()) {
+      nlohmann::json msg = {{"method", "UNSUBSCRIBE"}, {"params", removed}, {"id", ++request_id_}};
+      ws_->sendText(msg.dump());
+    }
+    if (!added.empty()) {
+      nlohmann::json msg = {{"method", "SUBSCRIBE"}, {"params", added}, {"id", ++request_id_}};
+      ws_->sendText(msg.dump());
+    }
+  } else if (provider_ == "hyperliquid") {
+    auto send = [&](const std::pair<std::string, std::string> &series,
+                    const char *method) {
+      nlohmann::json sub = {{"type", "candle"},
+                            {"coin", to_hyperliquid_coin(series.first)},
+                            {"interval", series.second}};
+      if (series.second.empty())
+        sub = {{"type", "trades"}, {"coin", to_hyperliquid_coin(series.first)}};
+      nlohmann::json msg = {{"method", method}, {"subscription", sub}};
+      ws_->sendText(msg.dump());
+    };
+    for (const auto &name : removed)
+      send(live_[name], "unsubscribe");
+    for (const auto &name : added)
+      send(wanted[name], "subscribe");
+  } else {
+    auto send = [&](const std::pair<std::string, std::string> &series,
+                    const char *event) {
+      const bool trades = series.second.empty();
+      nlohmann::json msg = {
+          {"time", std::time(nullptr)},
+          {"channel", trades ? "spot.trades" : "spot.candlesticks"},
+          {"event", event},
+          {"payload", trades ? nlohmann::json::array({to_gate_symbol(series.first)})
+                             : nlohmann::json::array({series.second,
+                                                      to_gate_symbol(series.first)})}};
+      ws_->sendText(msg.dump());
+    };
+    for (const auto &name : removed)
+      send(live_[name], "unsubscribe");
+    for (const auto &name : added)
+      send(wanted[name], "subscribe");
+  }
+  Logger::instance().info("WS (" + provider_ + ") +" + std::to_string(added.size()) +
+                          " -" + std::to_string(removed.size()) + " streams");
+  live_ = std::move(wanted);
+}
+
+void StreamMultiplexer::on_message(const std::string &msg) {
+  LatencyStamps stamps;
+  stamps.received_us = LatencyTracker::steady_us();
+  // Marks the parse done and records the receive-side stages.
+  auto parsed = [&stamps](long long exchange_ms) {
+    auto &tracker = LatencyTracker::instance();
+    stamps.parsed_us = LatencyTracker::steady_us();
+    stamps.exchange_ms = exchange_ms;
+    tracker.record(LatencyTracker::Stage::Parse, stamps.parsed_us - stamps.received_us);
+    if (exchange_ms > 0)
+      tracker.record(LatencyTracker::Stage::Network,
+                     (LatencyTracker::wall_ms() - exchange_ms) * 1000);
+    return &stamps;
+  };
+  try {
+    auto j = nlohmann::json::parse(msg);
+    if (provider_ == "binance") {
+      // Combined-stream envelope; subscription acks ({"result":null,"id":n})
+      // carry no "stream" and are ignored.
+      if (j.contains("stream") && j.contains("data") &&
+          (j["data"].value("e", std::string()) == "aggTrade" ||
+           j["data"].value("e", std::string()) == "trade")) {
+        if (auto trade = parse_binance_trade(j["data"]))
+          on_trade(j["stream"].get<std::string>(), *trade,
+                   parsed(j["data"].value("E", 0LL)));
+      } else if (j.contains("stream") && j.contains("data") && j["data"].contains("k")) {
+        auto update = parse_binance_kline(j["data"]["k"]);
+        if (!update)
+          return;
+        const auto *st = parsed(j["data"].value("E", 0LL));
+        if (update->closed)
+          deliver(j["stream"].get<std::string>(), update->candle, st);
+        else
+          offer_update(j["stream"].get<std::string>(), update->candle, st);
+      }
+    } else if (provider_ == "hyperliquid") {
+      // Other channels (subscriptionResponse, pong) carry no market data.
+      if (j.value("channel", std::string()) == "trades" && j["data"].is_array()) {
+        for (const auto &e : j["data"])
+          if (auto trade = parse_hyperliquid_trade(e))
+            on_trade(e.value("coin", std::string()) + "@trades", *trade,
+                     parsed(trade->time));
+        return;
+      }
+      if (j.value("channel", std::string()) != "candle")
+        return;
+      const auto &data = j["data"];
+      auto handle = [&](const nlohmann::json &e) {
+        auto update = parse_hyperliquid_candle(e);
+        if (!update)
+          return;
+        // The candle channel has no event time (t is the bar open).
+        const auto *st = parsed(0);
+        const std::string name =
+            e.value("s", std::string()) + "@candle_" + e.value("i", std::string());
+        std::optional<Candle> closed;
+        bool current = false;
+        {
+          std::lock_guard<std::mutex> lock(mutex_);
+          auto &forming = forming_[name];
+          if (forming.open_time > 0 && update->candle.open_time > forming.open_time)
+            closed = forming;
+          if (update->candle.open_time >= forming.open_time) {
+            forming = update->candle;
+            current = true;
+          }
+        }
+        if (closed)
+          deliver(name, *closed, st);
+        if (current)
+          offer_update(name, update->candle, st);
+      };
+      if (data.is_array()) {
+        for (const auto &e : data)
+          handle(e);
+      } else {
+        handle(data);
+      }
+    } else if (j.value("channel", std::string()) == "spot.trades" &&
+               j.value("event", std::string()) == "update") {
+      const auto &res = j["result"];
+      if (auto trade = parse_gate_trade(res))
+        on_trade("trades_" + res.value("currency_pair", std::string()), *trade,
+                 parsed(j.value("time_ms", 0LL)));
+    } else if (j.value("channel", std::string()) == "spot.candlesticks" &&
+               j.value("event", std::string()) == "update") {
+      const auto &res = j["result"];
+      const std::string name =
+          res.is_object() ? res.value("n", std::string()) : std::string();
+      const auto updates = parse_gate_candles(res);
+      const auto *st = updates.empty() ? nullptr : parsed(j.value("time_ms", 0LL));
+      for (const auto &update : updates) {
+        if (update.closed)
+          deliver(name, update.candle, st);
+        else
+          offer_update(name, update.candle, st);
+      }
+    }
+  } catch (const std::exception &e) {
+    Logger::instance().error(std::string("Kline parse error: ") + e.what());
+  }
+}
+
+void StreamMultiplexer::deliver(const std::string &stream, const Candle &candle,
+                                const LatencyStamps *stamps) {
+  std::lock_guard<std::mutex> order(deliver_mutex_);
+  std::shared_ptr<const Subscription> sub;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    updates_.on_closed(stream, candle.open_time);
+    auto it = wanted_.find(stream);
+    if (it == wanted_.end())
+      return; // unsubscribed while the message was in flight
+    if (auto held = held_.find(stream); held != held_.end()) {
+      held->second.bars.push_back(candle);
+      return;
+    }
+    auto &last = last_closed_[stream];
+    if (candle.open_time <= last)
+      return; // already published, e.g. replayed after a reconnect
+    last = candle.open_time;
+    sub = it->second;
+  }
+  bus_->publish_candle_closed(sub->symbol, sub->interval, candle, stamps);
+}
+
+void StreamMultiplexer::on_trade(const std::string &stream, const Trade &trade,
+                                 const LatencyStamps *stamps) {
+  std::vector<BarAggregator::Bar> closed, forming;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = aggregators_.find(stream);
+    if (it == aggregators_.end())
+      return;
+    it->second.on_trade(trade, closed);
+    it->second.forming(forming);
+  }
+  for (const auto &bar : closed)
+    deliver(derived_name(stream, bar.interval), bar.candle, stamps);
+  for (const auto &bar : forming)
+    offer_update(derived_name(stream, bar.interval), bar.candle, stamps);
+}
+
+void StreamMultiplexer::close_trade_bars() {
+  const long long now =
+      std::chrono::duration_cast<std::chrono::milliseconds>(
+          std::chrono::system_clock::now().time_since_epoch())
+          .count();
+  std::vector<std::pair<std::string, Candle>> closed;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<BarAggregator::Bar> bars;
+    for (auto &[stream, agg] : aggregators_) {
+      bars.clear();
+      agg.close_until(now - kTradeBarGraceMs, bars);
+      for (auto &bar : bars)
+        closed.emplace_back(derived_name(stream, bar.interval), bar.candle);
+    }
+  }
+  for (const auto &[name, candle] : closed)
+    deliver(name, candle);
+}
+
+void StreamMultiplexer::backfill_gaps() {
+  auto round = std::make_shared<BackfillRound>();
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    round->id = ++backfill_rounds_;
+    for (auto &entry : held_) {
+      auto it = wanted_.find(entry.first);
+      if (entry.second.round != 0 || it == wanted_.end())
+        continue;
+      entry.second.round = round->id;
+      round->gaps.push_back({entry.first, it->second, last_closed_[entry.first]});
+    }
+    round->fetch = gap_fetcher_;
+    round->max_bars = max_backfill_bars_;
+    round->deadline = std::chrono::steady_clock::now() + backfill_deadline_;
+    ++backfill_stats_.reconnects;
+  }
+  if (round->gaps.empty())
+    return;
+  round->now = now_ms();
+  // Threads of earlier rounds are joined once none is still fetching.
+  if (backfill_busy_ == 0) {
+    for (auto &worker : backfill_workers_)
+      worker.join();
+    backfill_workers_.clear();
+  }
+  const std::size_t workers = std::min(kBackfillWorkers, round->gaps.size());
+  round->busy = workers;
+  backfill_busy_ += workers;
+  for (std::size_t i = 0; i < workers; ++i)
+    backfill_workers_.emplace_back([this, round]() {
+      backfill_worker(*round);
+      --backfill_busy_;
+    });
+  backfill_ = std::move(round);
+}
+
+void StreamMultiplexer::backfill_worker(BackfillRound &round) {
+  while (running_ && !round.cancelled) {
+    const std::size_t i = round.next++;
+    if (i >= round.gaps.size())
+      break;
+    const auto &gap = round.gaps[i];
+    const long long period = parse_interval(gap.sub->interval).count();
+    std::vector<Candle> fetched;
+    // The first missing bar must have closed for there to be a gap.
+    long long start = gap.last + period;
+    if (round.fetch && period > 0 && start + period <= round.now) {
+      const long long missing = (round.now - start) / period;
+      if (missing > static_cast<long long>(round.max_bars))
+        start += (missing - static_cast<long long>(round.max_bars)) * period;
+      auto res = round.fetch(gap.sub->symbol, gap.sub->interval, start, round.now);
+      if (res.error != FetchError::None) {
+        Logger::instance().warn("WS (" + provider_ + ") backfill of " + gap.sub->symbol +
+                                " " + gap.sub->interval + " failed: " + res.message);
+        std::lock_guard<std::mutex> lock(mutex_);
+        ++backfill_stats_.failures;
+      }
+      // Only bars that have closed; the live stream supplies the current one.
+      for (auto &c : res.candles)
+        if (c.open_time >= start && c.open_time + period <= round.now)
+          fetched.push_back(c);
+      ++round.series;
+    }
+    round.published += release_held(gap.stream, std::move(fetched), round.id);
+  }
+  if (--round.busy == 0 && round.series > 0)
+    Logger::instance().info("WS (" + provider_ + ") reconnect backfill: " +
+                            std::to_string(round.published) + " candles for " +
+                            std::to_string(round.series) + " series");
+}
+
+void StreamMultiplexer::expire_backfill(std::chrono::steady_clock::time_point now) {
+  if (backfill_->busy == 0) {
+    backfill_.reset();
+    return;
+  }
+  if (now < backfill_->deadline)
+    return;
+  backfill_->cancelled = true;
+  const std::uint64_t id = backfill_->id;
+  backfill_.reset();
+  std::vector<std::string> expired;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto &entry : held_)
+      if (entry.second.round == id)
+        expired.push_back(entry.first);
+    backfill_stats_.timeouts += expired.size();
+  }
+  for (const auto &name : expired)
+    release_held(name, {}, id);
+  if (!expired.empty())
+    Logger::instance().warn("WS (" + provider_ + ") reconnect backfill timed out; " +
+                            std::to_string(expired.size()) +
+                            " series resumed without their gap");
+}
+
+std::size_t StreamMultiplexer::release_held(const std::string &stream,
+                                            std::vector<Candle> fetched,
+                                            std::uint64_t round) {
+  std::lock_guard<std::mutex> order(deliver_mutex_);
+  std::shared_ptr<const Subscription> sub;
+  std::vector<Candle> out;
+  std::size_t from_fetch = 0;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto held = held_.find(stream);
+    if (held == held_.end() || (round != 0 && held->second.round != round))
+      return 0;
+    auto it = wanted_.find(stream);
+    if (it == wanted_.end()) {
+      held_.erase(held);
+      return 0;
+    }
+    sub = it->second;
+    // Stable sort with the held bars last: on equal open times the
+    // stream's own bar wins over the fetched copy.
+    const std::size_t fetched_count = fetched.size();
+    fetched.insert(fetched.end(), held->second.bars.begin(), held->second.bars.end());
+    held_.erase(held);
+    std::vector<std::size_t> idx(fetched.size());
+    for (std::size_t i = 0; i < idx.size(); ++i)
+      idx[i] = i;
+    std::stable_sort(idx.begin(), idx.end(), [&](std::size_t a, std::size_t b) {
+      return fetched[a].open_time < fetched[b].open_time;
+    });
+    auto &last = last_closed_[stream];
+    for (std::size_t k = 0; k < idx.size(); ++k) {
+      const auto &c = fetched[idx[k]];
+      if (k + 1 < idx.size() && fetched[idx[k + 1]].open_time == c.open_time)
+        continue;
+      if (c.open_time <= last)
+        continue;
+      last = c.open_time;
+      updates_.on_closed(stream, c.open_time);
+      out.push_back(c);
+      if (idx[k] < fetched_count)
+        ++from_fetch;
+    }
+    backfill_stats_.candles += from_fetch;
+  }
+  for (const auto &c : out)
+    bus_->publish_candle_closed(sub->symbol, sub->interval, c);
+  return from_fetch;
+}
+
+void StreamMultiplexer::offer_update(const std::string &stream,
+                                     const Candle &candle,
+                                     const LatencyStamps *stamps) {
+  if (!bus_->has_candle_update_handlers())
+    return;
+  std::lock_guard<std::mutex> order(deliver_mutex_);
+  std::shared_ptr<const Subscription> sub;
+  std::optional<Candle> now_ready;
+  bool rearm = false;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = wanted_.find(stream);
+    if (it == wanted_.end() || held_.count(stream))
+      return;
+    const auto before = updates_.next_due();
+    now_ready = updates_.offer(stream, candle, BarUpdateCoalescer::Clock::now());
+    if (now_ready)
+      sub = it->second;
+    else if (updates_.next_due() != before)
+      rearm = rearm_ = true;
+  }
+  if (rearm)
+    cv_.notify_all();
+  if (sub)
+    bus_->publish_candle_update(sub->symbol, sub->interval, *now_ready, stamps);
+}
+
+void StreamMultiplexer::flush_updates(BarUpdateCoalescer::Clock::time_point now) {
+  std::lock_guard<std::mutex> order(deliver_mutex_);
+  std::vector<std::pair<std::shared_ptr<const Subscription>, Candle>> ready;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto &[stream, candle] : updates_.take_due(now)) {
+      auto it = wanted_.find(stream);
+      if (it != wanted_.end())
+        ready.emplace_back(it->second, candle);
+    }
+  }
+  for (const auto &[sub, candle] : ready)
+    bus_->publish_candle_update(sub->symbol, sub->interval, candle);
+}
+
+} // namespace Core
@@ -0,0 +1,215 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "bar_aggregator.h"
+#include "bar_update_coalescer.h"
+#include "candle.h"
+#include "candle_batch_writer.h"
+#include "candle_manager.h"
+#include "iwebsocket.h"
+#include "market_data_bus.h"
+#include "net/fetch_result.h"
+
+namespace Core {
+
+// Carries every kline subscription for one venue over a single WebSocket,
+// driven by one reactor thread. Binance uses the combined-stream endpoint
+// (/stream?streams=a/b, then SUBSCRIBE/UNSUBSCRIBE); Gate.io and Hyperliquid
+// get one subscribe message per series on the shared connection.
+// Subscriptions can change at any time: the reactor reconciles the wanted
+// set with what the current connection carries, and replays all of them
+// after a reconnect. Closed bars (once per open time), forming bars and
+// Connected/Disconnected/Failed status are published on a MarketDataBus.
+class StreamMultiplexer {
+public:
+  using SleepFunc = std::function<void(std::chrono::milliseconds)>;
+  // Blocking HTTP fetch of the candles with open time in [start_ms, end_ms].
+  using GapFetcher = std::function<KlinesResult(
+      const std::string &symbol, const std::string &interval, long long start_ms,
+      long long end_ms)>;
+  struct BackfillStats {
+    std::uint64_t reconnects{0}; // reconnects that had gaps to check
+    std::uint64_t candles{0};    // fetched bars published
+    std::uint64_t failures{0};   // fetches that returned an error
+    std::uint64_t timeouts{0};   // series released unfetched at the deadline
+  };
+
+  StreamMultiplexer(
+      const std::string &provider, CandleManager &manager,
+      WebSocketFactory ws_factory = default_websocket_factory(),
+      SleepFunc sleep_func = nullptr,
+      std::chrono::milliseconds base_delay = std::chrono::milliseconds(1000),
+      std::shared_ptr<MarketDataBus> bus = nullptr);
+  ~StreamMultiplexer();
+  StreamMultiplexer(const StreamMultiplexer &) = delete;
+  StreamMultiplexer &operator=(const StreamMultiplexer &) = delete;
+
+  static bool supports(const std::string &provider);
+
+  // Failed is published on connection errors (before each reconnect) and
+  // when the provider cannot be streamed at all.
+  void start();
+  void stop();
+  bool running() const { return running_; }
+  bool connected() const { return connected_; }
+  // Minimum spacing of in-progress updates per series (0 forwards each one).
+  // Forming bars are only published while someone listens for them.
+  void set_live_update_interval(std::chrono::milliseconds interval);
+  // Enables reconnect backfill of at most max_bars bars per series: after a
+  // reconnect each kline series that has delivered before is held back, the
+  // bars that closed while the socket was down are fetched and published,
+  // then the held live bars follow. The fetches run on up to four worker
+  // threads, so pings, forming bars and subscription changes carry on
+  // meanwhile, and each series is released as soon as its own fetch returns;
+  // the fetcher must be safe to call concurrently. Series still unfetched
+  // when `deadline` passes are released without their gap. stop() waits
+  // for fetches already in flight.
+  void set_gap_fetcher(GapFetcher fetcher, std::size_t max_bars = 1000,
+                       std::chrono::milliseconds deadline = std::chrono::seconds(30));
+  BackfillStats backfill_stats() const;
+
+  const std::shared_ptr<MarketDataBus> &bus() const { return bus_; }
+  CandleBatchWriter::Stats writer_stats() const { return writer_.stats(); }
+
+  // Adds the series to the connection; its bars go out on bus().
+  void subscribe(const std::string &symbol, const std::string &interval);
+  void unsubscribe(const std::string &symbol, const std::string &interval);
+  std::vector<std::pair<std::string, std::string>> subscriptions() const;
+
+  // Venue stream names, e.g. "btcusdt@kline_1m", "1m_BTC_USDT", "BTC@candle_1m".
+  static std::string binance_stream_name(const std::string &symbol,
+                                         const std::string &interval);
+  static std::string gate_stream_name(const std::string &symbol,
+                                      const std::string &interval);
+  static std::string hyperliquid_stream_name(const std::string &symbol,
+                                             const std::string &interval);
+  // Trade stream of a symbol, e.g. "btcusdt@aggTrade", "trades_BTC_USDT",
+  // "BTC@trades".
+  std::string trade_stream_name(const std::string &symbol) const;
+  // Intervals below one minute, which the venues do not stream as klines,
+  // are aggregated from the symbol's trade stream (Binance aggTrade,
+  // Hyperliquid trades, Gate.io spot.trades).
+  static bool built_from_trades(const std::string &interval);
+
+private:
+  struct Subscription {
+    std::string symbol;
+    std::string interval; // empty for a trade stream
+    bool derived{false};  // built from a trade stream; nothing to send
+  };
+  // Live closed bars held while a series is backfilled, and the backfill
+  // round fetching its gap (0 until one starts).
+  struct Held {
+    std::uint64_t round{0};
+    std::vector<Candle> bars;
+  };
+  // One reconnect's gap fetches, shared by its workers.
+  struct BackfillRound;
+
+  void run();
+  // Streams the connection should carry: name -> (symbol, interval).
+  std::map<std::string, std::pair<std::string, std::string>> network_streams() const;
+  std::string stream_name(const std::string &symbol,
+                          const std::string &interval) const;
+  std::string connect_url(
+      const std::map<std::string, std::pair<std::string, std::string>> &streams) const;
+  // Sends (un)subscribe messages so the connection carries exactly the
+  // wanted streams. Reactor thread only.
+  void reconcile();
+  void on_message(const std::string &msg);
+  void deliver(const std::string &stream, const Candle &candle,
+               const LatencyStamps *stamps = nullptr);
+  void on_trade(const std::string &stream, const Trade &trade,
+                const LatencyStamps *stamps = nullptr);
+  // Starts fetching the outage window of every held series on worker
+  // threads. Reactor thread only.
+  void backfill_gaps();
+  // Fetches and releases gaps of `round` until none are left.
+  void backfill_worker(BackfillRound &round);
+  // Releases, unfetched, the series the current round still holds once its
+  // deadline has passed. Reactor thread only.
+  void expire_backfill(std::chrono::steady_clock::time_point now);
+  // Publishes fetched and held bars of one series in open-time order,
+  // skipping any already delivered, and ends the hold. A nonzero `round`
+  // only releases a hold that round owns, so a fetch returning after its
+  // round was given up cannot end a later one.
+  // Returns how many fetched bars were published.
+  std::size_t release_held(const std::string &stream, std::vector<Candle> fetched,
+                           std::uint64_t round = 0);
+  // Closes trade-built bars whose window has ended, so quiet symbols still
+  // get their bars; called on a 1s tick. Reactor thread only.
+  void close_trade_bars();
+  // Passes a forming bar through the coalescer; flush_updates() forwards
+  // the coalesced ones once due. Reactor thread only.
+  // Only an update forwarded immediately keeps its stamps; a coalesced one
+  // goes out later without them.
+  void offer_update(const std::string &stream, const Candle &candle,
+                    const LatencyStamps *stamps = nullptr);
+  void flush_updates(BarUpdateCoalescer::Clock::time_point now);
+
+  std::string provider_;
+  WebSocketFactory ws_factory_;
+  SleepFunc sleep_func_;
+  std::chrono::milliseconds base_delay_;
+  std::shared_ptr<MarketDataBus> bus_;
+  // Persists closed bars through a bus handler registered in the
+  // constructor, committing bursts together; stop() commits the rest.
+  CandleBatchWriter writer_;
+  MarketDataBus::Token persist_token_{0};
+
+  // Serialises bus publishing so a coalesced update never lands after
+  // the closed bar that supersedes it. Taken before mutex_.
+  std::mutex deliver_mutex_;
+  mutable std::mutex mutex_;
+  std::condition_variable cv_;
+  // Keyed by stream name; shared so delivery copies a pointer, not strings.
+  std::map<std::string, std::shared_ptr<const Subscription>> wanted_;
+  bool dirty_{false};
+  bool rearm_{false}; // a pending update moved the reactor's next deadline
+  bool backfill_due_{false};
+  bool closed_{false};
+  bool error_{false};
+
+  std::unique_ptr<IWebSocket> ws_;              // reactor thread only
+  // Streams the current connection carries: name -> (symbol, interval).
+  std::map<std::string, std::pair<std::string, std::string>> live_;
+  // Hyperliquid candles carry no close flag: the newest bar seen per
+  // stream is emitted as closed once the next bar starts.
+  std::map<std::string, Candle> forming_;
+  // Forming bars per series, at most one per live-update interval.
+  BarUpdateCoalescer updates_;
+  GapFetcher gap_fetcher_;
+  std::size_t max_backfill_bars_{1000};
+  std::chrono::milliseconds backfill_deadline_{std::chrono::seconds(30)};
+  std::uint64_t backfill_rounds_{0};
+  BackfillStats backfill_stats_;
+  // Open time of the last closed bar published per stream.
+  std::map<std::string, long long> last_closed_;
+  // Streams being backfilled, with the live closed bars held meanwhile.
+  std::map<std::string, Held> held_;
+  // One aggregator per symbol, whatever the number of intervals, keyed by
+  // trade stream name; the derived series are wanted_ entries named
+  // "<trade stream>#<interval>".
+  std::map<std::string, BarAggregator> aggregators_;
+  int request_id_{0};
+  std::atomic<bool> running_{false};
+  std::atomic<bool> connected_{false};
+  std::thread thread_;
+  std::shared_ptr<BackfillRound> backfill_; // reactor thread only
+  // Gap fetch threads; joined once idle, or by stop().
+  std::vector<std::thread> backfill_workers_;
+  std::atomic<std::size_t> backfill_busy_{0};
+};
+
+} // namespace Core
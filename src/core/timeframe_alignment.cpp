@@ -0,0 +1,96 @@
+#include "timeframe_alignment.h"
+
+#include <algorithm>
+
+#include "interval_utils.h"
+
+namespace Core {
+
+TimeframeAlignment::TimeframeAlignment(std::chrono::milliseconds lower,
+                                       std::chrono::milliseconds higher)
+    : lower_ms_(lower.count()), higher_ms_(higher.count()) {}
+
+bool TimeframeAlignment::same_history(const std::vector<Candle> &lower,
+                                      const std::vector<Candle> &higher) const {
+  if (lower.size() < index_.size() || higher.size() < higher_size_)
+    return false;
+  if (!index_.empty() && (lower.front().open_time != lower_first_ ||
+                          lower[index_.size() - 1].open_time != lower_last_))
+    return false;
+  if (higher_size_ > 0 && (higher.front().open_time != higher_first_ ||
+                           higher[higher_size_ - 1].open_time != higher_last_))
+    return false;
+  return true;
+}
+
+// Entries before `from` are current, so the scan over the higher series
+// resumes after the last index they point to.
+void TimeframeAlignment::fill(const std::vector<Candle> &lower,
+                              const std::vector<Candle> &higher, std::size_t from) {
+  index_.resize(lower.size());
+  std::size_t k = from > 0 && index_[from - 1] != kNone
+                      ? static_cast<std::size_t>(index_[from - 1]) + 1
+                      : 0;
+  for (std::size_t i = from; i < lower.size(); ++i) {
+    const long long close = lower[i].open_time + lower_ms_;
+    while (k < higher.size() && higher[k].open_time + higher_ms_ <= close)
+      ++k;
+    index_[i] = k == 0 ? kNone : static_cast<std::int32_t>(k - 1);
+  }
+}
+
+std::size_t TimeframeAlignment::update(const std::vector<Candle> &lower,
+                                       const std::vector<Candle> &higher) {
+  if (!same_history(lower, higher)) {
+    index_.clear();
+    higher_size_ = 0;
+  }
+  std::size_t from = index_.size();
+  if (higher.size() > higher_size_ && from > 0) {
+    // Lower bars closing at or after the first new higher bar's close may
+    // now see it (a higher bar can arrive after the lower bars covering it).
+    const long long first_close = higher[higher_size_].open_time + higher_ms_;
+    const auto it = std::lower_bound(
+        lower.begin(), lower.begin() + static_cast<std::ptrdiff_t>(from), first_close - lower_ms_,
+        [](const Candle &c, long long t) { return c.open_time < t; });
+    from = static_cast<std::size_t>(it - lower.begin());
+  }
+  const bool changed = from < lower.size();
+  if (changed)
+    fill(lower, higher, from);
+  higher_size_ = higher.size();
+  if (!lower.empty()) {
+    lower_first_ = lower.front().open_time;
+    lower_last_ = lower.back().open_time;
+  }
+  if (!higher.empty()) {
+    higher_first_ = higher.front().open_time;
+    higher_last_ = higher.back().open_time;
+  }
+  return changed ? from : index_.size();
+}
+
+std::vector<AlignedSeries>
+TimeframeAlignments::align(const std::string &pair,
+                           const std::map<std::string, std::vector<Candle>> &intervals,
+                           const std::string &lower) {
+  std::vector<AlignedSeries> out;
+  const auto lower_it = intervals.find(lower);
+  const auto lower_ms = parse_interval(lower);
+  if (lower_it == intervals.end() || lower_ms.count() <= 0)
+    return out;
+  for (const auto &[interval, candles] : intervals) {
+    const auto higher_ms = parse_interval(interval);
+    if (interval == lower || higher_ms.count() <= 0)
+      continue;
+    auto key = std::make_tuple(pair, lower, interval);
+    auto it = entries_.find(key);
+    if (it == entries_.end())
+      it = entries_.emplace(std::move(key), TimeframeAlignment(lower_ms, higher_ms)).first;
+    it->second.update(lower_it->second, candles);
+    out.push_back({interval, &candles, it->second.indices()});
+  }
+  return out;
+}
+
+} // namespace Core
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <span>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "candle.h"
+
+namespace Core {
+
+// For each candle of a lower interval, the index of the last candle of a
+// higher interval that had closed by the lower candle's close (open time +
+// interval), or kNone before the first. A higher bar closing at the same
+// moment counts; one still forming never does, so a strategy evaluated at
+// the lower bar's close cannot see ahead. Works for any two intervals.
+//
+// update() extends the index over candles appended to either series in
+// O(new candles + log n). Rewritten history (another first candle, fewer
+// candles, or a changed open time of the last known one) rebuilds it. Not
+// thread-safe.
+class TimeframeAlignment {
+public:
+  static constexpr std::int32_t kNone = -1;
+
+  TimeframeAlignment(std::chrono::milliseconds lower, std::chrono::milliseconds higher);
+
+  // Brings the index in line with both series. Returns the first lower
+  // index whose entry was added or changed (size() when none was).
+  std::size_t update(const std::vector<Candle> &lower, const std::vector<Candle> &higher);
+
+  std::int32_t operator[](std::size_t lower_index) const { return index_[lower_index]; }
+  // Non-decreasing; kNone entries come first.
+  std::span<const std::int32_t> indices() const { return index_; }
+  std::size_t size() const { return index_.size(); }
+
+private:
+  bool same_history(const std::vector<Candle> &lower, const std::vector<Candle> &higher) const;
+  void fill(const std::vector<Candle> &lower, const std::vector<Candle> &higher, std::size_t from);
+
+  long long lower_ms_;
+  long long higher_ms_;
+  std::vector<std::int32_t> index_;
+  std::size_t higher_size_ = 0;
+  long long lower_first_ = 0;
+  long long lower_last_ = 0;
+  long long higher_first_ = 0;
+  long long higher_last_ = 0;
+};
+
+// Another interval of the same pair, aligned to the series a strategy
+// evaluates: aligned[i] is the index into `candles` for candle i.
+// `version` is the IndicatorCache version of `candles`; align() leaves it
+// 0 for the caller to fill in.
+struct AlignedSeries {
+  std::string interval;
+  const std::vector<Candle> *candles = nullptr;
+  std::span<const std::int32_t> aligned;
+  std::uint64_t version = 0;
+};
+
+// The alignments between the intervals of each pair, kept between calls so
+// a new candle only costs its own entries. Not thread-safe.
+class TimeframeAlignments {
+public:
+  // Updates (or builds on first use) the alignment from `lower` to every
+  // other interval in `intervals`. The views stay valid until the next
+  // call or until the candles change.
+  std::vector<AlignedSeries> align(const std::string &pair,
+                                   const std::map<std::string, std::vector<Candle>> &intervals,
+                                   const std::string &lower);
+
+  void clear() { entries_.clear(); }
+
+private:
+  std::map<std::tuple<std::string, std::string, std::string>, TimeframeAlignment> entries_;
+};
+
+} // namespace Core
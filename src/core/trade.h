@@ -0,0 +1,14 @@
+#pragma once
+
+namespace Core {
+
+// One print from a venue trade stream.
+struct Trade {
+  long long time{0}; // Unix timestamp in milliseconds
+  double price{0.0};
+  double qty{0.0};
+  bool taker_buy{false}; // the aggressor was the buyer
+  int count{1};          // venue trades folded into this print (aggTrade)
+};
+
+} // namespace Core
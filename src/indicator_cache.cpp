@@ -0,0 +1,292 @@
+#include "indicator_cache.h"
+
+#include <algorithm>
+#include <type_traits>
+
+namespace Signal {
+
+namespace {
+
+// Writes the current value of `indicator` as element i of `out`.
+template <typename Indicator>
+void store(const Indicator& indicator, IndicatorSeries& out, std::size_t i) {
+    if constexpr (std::is_same_v<Indicator, Macd>) {
+        const MACDResult r = indicator.value();
+        out.values[i] = r.macd;
+        out.signal[i] = r.signal;
+        out.histogram[i] = r.histogram;
+    } else {
+        out.values[i] = indicator.value();
+    }
+}
+
+double Core::Candle::*field_of(IndicatorKind kind) {
+    switch (kind) {
+    case IndicatorKind::Open:
+        return &Core::Candle::open;
+    case IndicatorKind::High:
+        return &Core::Candle::high;
+    case IndicatorKind::Low:
+        return &Core::Candle::low;
+    case IndicatorKind::Close:
+        return &Core::Candle::close;
+    case IndicatorKind::Volume:
+        return &Core::Candle::volume;
+    default:
+        return nullptr;
+    }
+}
+
+void resize(IndicatorSeries& series, std::size_t n, bool macd) {
+    series.values.resize(n);
+    if (macd) {
+        series.signal.resize(n);
+        series.histogram.resize(n);
+    }
+}
+
+} // namespace
+
+IndicatorSeries compute_indicator(const std::vector<Core::Candle>& candles,
+                                  const IndicatorSpec& spec) {
+    IndicatorSeries out;
+    switch (spec.kind) {
+    case IndicatorKind::Sma:
+        out.values = sma_series(candles, spec.period);
+        break;
+    case IndicatorKind::Ema:
+        out.values = ema_series(candles, spec.period);
+        break;
+    case IndicatorKind::Rsi:
+        out.values = rsi_series(candles, spec.period);
+        break;
+    case IndicatorKind::Macd: {
+        const auto macd = macd_series(candles, spec.period, spec.slow, spec.signal);
+        resize(out, macd.size(), true);
+        for (std::size_t i = 0; i < macd.size(); ++i) {
+            out.values[i] = macd[i].macd;
+            out.signal[i] = macd[i].signal;
+            out.histogram[i] = macd[i].histogram;
+        }
+        break;
+    }
+    case IndicatorKind::Open:
+    case IndicatorKind::High:
+    case IndicatorKind::Low:
+    case IndicatorKind::Close:
+    case IndicatorKind::Volume: {
+        const auto field = field_of(spec.kind);
+        out.values.reserve(candles.size());
+        for (const auto& c : candles) {
+            out.values.push_back(c.*field);
+        }
+        break;
+    }
+    }
+    return out;
+}
+
+std::string series_id(std::string_view pair, std::string_view interval) {
+    std::string id;
+    id.reserve(pair.size() + interval.size() + 1);
+    id.append(pair).append(1, '|').append(interval);
+    return id;
+}
+
+IndicatorCache::IndicatorCache(std::size_t max_bytes) : max_bytes_(max_bytes) {}
+
+IndicatorCache& IndicatorCache::instance() {
+    static IndicatorCache cache;
+    return cache;
+}
+
+IndicatorCache::State IndicatorCache::make_state(const IndicatorSpec& spec) {
+    switch (spec.kind) {
+    case IndicatorKind::Ema:
+        return Ema(spec.period);
+    case IndicatorKind::Rsi:
+        return Rsi(spec.period);
+    case IndicatorKind::Macd:
+        return Macd(spec.period, spec.slow, spec.signal);
+    case IndicatorKind::Sma:
+        break;
+    default:
+        return Column{field_of(spec.kind)};
+    }
+    return Sma(spec.period);
+}
+
+bool IndicatorCache::extends(const Entry& entry, std::uint64_t version,
+                             const std::vector<Core::Candle>& candles) {
+    const std::size_t n = entry.series->values.size();
+    if (entry.version != version || n == 0 || candles.size() < n ||
+        candles.front().open_time != entry.first_open_time) {
+        return false;
+    }
+    if (n >= 2) {
+        const auto& stable = candles[n - 2];
+        if (stable.open_time != entry.stable_open_time || stable.close != entry.stable_close) {
+            return false;
+        }
+        // A column also changes with fields other than the close.
+        if (const auto* column = std::get_if<Column>(&entry.state)) {
+            return entry.series->values[n - 2] == stable.*column->field;
+        }
+    }
+    return true;
+}
+
+bool IndicatorCache::last_unchanged(const Entry& entry, const std::vector<Core::Candle>& candles) {
+    const auto& last = candles.back();
+    if (entry.series->values.size() != candles.size() || last.open_time != entry.last_open_time ||
+        last.close != entry.last_close) {
+        return false;
+    }
+    const auto* column = std::get_if<Column>(&entry.state);
+    return !column || entry.series->values.back() == last.*column->field;
+}
+
+// Recomputes elements [from, size) where `from` is the index of the stored
+// last candle (the state has seen everything before it).
+void IndicatorCache::advance(Entry& entry, const std::vector<Core::Candle>& candles,
+                             std::size_t from) {
+    const std::size_t n = candles.size();
+    IndicatorSeries& out = *entry.series;
+    resize(out, n, std::holds_alternative<Macd>(entry.state));
+    std::visit(
+        [&](auto& indicator) {
+            if constexpr (std::is_same_v<std::decay_t<decltype(indicator)>, Column>) {
+                for (std::size_t i = from; i < n; ++i) {
+                    out.values[i] = candles[i].*indicator.field;
+                }
+            } else {
+                for (std::size_t i = from; i + 1 < n; ++i) {
+                    indicator.update(candles[i].close);
+                    store(indicator, out, i);
+                }
+                auto last = indicator;
+                last.update(candles[n - 1].close);
+                store(last, out, n - 1);
+            }
+        },
+        entry.state);
+    entry.first_open_time = candles.front().open_time;
+    if (n >= 2) {
+        entry.stable_open_time = candles[n - 2].open_time;
+        entry.stable_close = candles[n - 2].close;
+    }
+    entry.last_open_time = candles.back().open_time;
+    entry.last_close = candles.back().close;
+}
+
+std::size_t IndicatorCache::entry_bytes(const Entry& entry) {
+    const IndicatorSeries& s = *entry.series;
+    std::size_t bytes = sizeof(Entry) + sizeof(IndicatorSeries) +
+                        (s.values.capacity() + s.signal.capacity() + s.histogram.capacity()) *
+                            sizeof(double);
+    if (const auto* sma = std::get_if<Sma>(&entry.state)) {
+        bytes += sma->period() * sizeof(double);
+    }
+    return bytes;
+}
+
+std::shared_ptr<const IndicatorSeries> IndicatorCache::get(std::string_view series_id,
+                                                           std::uint64_t version,
+                                                           const std::vector<Core::Candle>& candles,
+                                                           const IndicatorSpec& spec) {
+    if (candles.empty()) {
+        return std::make_shared<const IndicatorSeries>();
+    }
+    std::lock_guard lock(mutex_);
+    Key key{std::string(series_id), spec};
+    auto it = entries_.find(key);
+    if (it != entries_.end() && extends(it->second, version, candles)) {
+        Entry& entry = it->second;
+        const std::size_t n = entry.series->values.size();
+        entry.last_used = ++tick_;
+        if (last_unchanged(entry, candles)) {
+            ++stats_.hits;
+            return entry.series;
+        }
+        ++stats_.extensions;
+        if (entry.series.use_count() > 1) {
+            entry.series = std::make_shared<IndicatorSeries>(*entry.series);
+        }
+        advance(entry, candles, n - 1);
+        bytes_ -= entry.bytes;
+        entry.bytes = entry_bytes(entry);
+        bytes_ += entry.bytes;
+        auto series = entry.series;
+        evict_locked(&it->first);
+        return series;
+    }
+
+    ++stats_.misses;
+    if (it != entries_.end()) {
+        bytes_ -= it->second.bytes;
+        entries_.erase(it);
+    }
+    Entry entry{version, std::make_shared<IndicatorSeries>(), make_state(spec)};
+    advance(entry, candles, 0);
+    entry.bytes = entry_bytes(entry);
+    entry.last_used = ++tick_;
+    auto series = entry.series;
+    bytes_ += entry.bytes;
+    const auto inserted = entries_.emplace(std::move(key), std::move(entry)).first;
+    evict_locked(&inserted->first);
+    return series;
+}
+
+// Evicts least recently used entries until the total fits. `keep` goes
+// last, so a single series larger than the cap is still returned but not
+// retained.
+void IndicatorCache::evict_locked(const Key* keep) {
+    while (bytes_ > max_bytes_ && !entries_.empty()) {
+        auto victim = entries_.end();
+        for (auto it = entries_.begin(); it != entries_.end(); ++it) {
+            if (keep && it->first == *keep && entries_.size() > 1) {
+                continue;
+            }
+            if (victim == entries_.end() || it->second.last_used < victim->second.last_used) {
+                victim = it;
+            }
+        }
+        bytes_ -= victim->second.bytes;
+        entries_.erase(victim);
+        ++stats_.evictions;
+    }
+}
+
+void IndicatorCache::set_max_bytes(std::size_t max_bytes) {
+    std::lock_guard lock(mutex_);
+    max_bytes_ = max_bytes;
+    evict_locked(nullptr);
+}
+
+void IndicatorCache::invalidate(std::string_view series_id) {
+    std::lock_guard lock(mutex_);
+    for (auto it = entries_.begin(); it != entries_.end();) {
+        if (it->first.first == series_id) {
+            bytes_ -= it->second.bytes;
+            it = entries_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void IndicatorCache::clear() {
+    std::lock_guard lock(mutex_);
+    entries_.clear();
+    bytes_ = 0;
+}
+
+IndicatorCache::Stats IndicatorCache::stats() const {
+    std::lock_guard lock(mutex_);
+    Stats s = stats_;
+    s.entries = entries_.size();
+    s.bytes = bytes_;
+    return s;
+}
+
+} // namespace Signal
@@ -0,0 +1,139 @@
+#pragma once
+
+#include "core/candle.h"
+#include "indicators.h"
+#include <compare>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <variant>
+#include <vector>
+
+namespace Signal {
+
+// Open..Volume are the raw candle fields, kept as columns for consumers
+// that read them in bulk (see RuleProgram).
+enum class IndicatorKind { Sma, Ema, Rsi, Macd, Open, High, Low, Close, Volume };
+
+// An indicator and its parameters. MACD reads `period` as the fast period;
+// `slow` and `signal` are only used by MACD.
+struct IndicatorSpec {
+    IndicatorKind kind = IndicatorKind::Sma;
+    std::size_t period = 0;
+    std::size_t slow = 0;
+    std::size_t signal = 0;
+
+    static IndicatorSpec sma(std::size_t period) { return {IndicatorKind::Sma, period, 0, 0}; }
+    static IndicatorSpec ema(std::size_t period) { return {IndicatorKind::Ema, period, 0, 0}; }
+    static IndicatorSpec rsi(std::size_t period) { return {IndicatorKind::Rsi, period, 0, 0}; }
+    static IndicatorSpec macd(std::size_t fast, std::size_t slow, std::size_t signal) {
+        return {IndicatorKind::Macd, fast, slow, signal};
+    }
+    static IndicatorSpec column(IndicatorKind field) { return {field, 0, 0, 0}; }
+
+    auto operator<=>(const IndicatorSpec&) const = default;
+};
+
+// Indicator values by candle index, identical to the *_series functions.
+// MACD fills all three vectors (`values` is the MACD line); the other
+// indicators only `values`.
+struct IndicatorSeries {
+    std::vector<double> values;
+    std::vector<double> signal;
+    std::vector<double> histogram;
+};
+
+// Computes a whole series without caching.
+[[nodiscard]] IndicatorSeries compute_indicator(const std::vector<Core::Candle>& candles,
+                                                const IndicatorSpec& spec);
+
+// Cache id for the candles of one pair and interval.
+[[nodiscard]] std::string series_id(std::string_view pair, std::string_view interval);
+
+// Process-wide store of indicator results keyed by (series id, series
+// version, indicator, parameters), shared by the Signals window, SignalBot
+// and the backtester.
+//
+// Each entry keeps the indicator state as of the second-to-last candle, so
+// appended candles and an updated last (forming) candle only cost the new
+// bars. Appends are recognised from the data: the first open time and the
+// candle before the last one must be unchanged. Bump `version` when
+// earlier candles are rewritten in place; a different version recomputes.
+// Entries beyond the memory cap are evicted least recently used first.
+//
+// Results are immutable snapshots: a series still held by a caller is
+// copied before being extended. Thread-safe.
+class IndicatorCache {
+public:
+    static constexpr std::size_t kDefaultMaxBytes = std::size_t{128} << 20;
+
+    struct Stats {
+        std::uint64_t hits = 0;        // served as stored
+        std::uint64_t extensions = 0;  // stored result extended to new bars
+        std::uint64_t misses = 0;      // computed from the first candle
+        std::uint64_t evictions = 0;
+        std::size_t entries = 0;
+        std::size_t bytes = 0;
+    };
+
+    explicit IndicatorCache(std::size_t max_bytes = kDefaultMaxBytes);
+
+    static IndicatorCache& instance();
+
+    // Values for every candle of the series; empty for an empty series.
+    [[nodiscard]] std::shared_ptr<const IndicatorSeries> get(std::string_view series_id,
+                                                             std::uint64_t version,
+                                                             const std::vector<Core::Candle>& candles,
+                                                             const IndicatorSpec& spec);
+
+    void set_max_bytes(std::size_t max_bytes);
+    // Drops every entry of one series.
+    void invalidate(std::string_view series_id);
+    void clear();
+    [[nodiscard]] Stats stats() const;
+
+private:
+    // A candle field copied as is.
+    struct Column {
+        double Core::Candle::*field;
+    };
+
+    using State = std::variant<Sma, Ema, Rsi, Macd, Column>;
+
+    struct Entry {
+        std::uint64_t version = 0;
+        std::shared_ptr<IndicatorSeries> series;
+        // Indicator fed with every candle but the last one.
+        State state;
+        long long first_open_time = 0;
+        long long stable_open_time = 0;
+        double stable_close = 0.0;
+        long long last_open_time = 0;
+        double last_close = 0.0;
+        std::size_t bytes = 0;
+        std::uint64_t last_used = 0;
+    };
+
+    using Key = std::pair<std::string, IndicatorSpec>;
+
+    static State make_state(const IndicatorSpec& spec);
+    static bool extends(const Entry& entry, std::uint64_t version,
+                        const std::vector<Core::Candle>& candles);
+    static bool last_unchanged(const Entry& entry, const std::vector<Core::Candle>& candles);
+    static void advance(Entry& entry, const std::vector<Core::Candle>& candles, std::size_t from);
+    static std::size_t entry_bytes(const Entry& entry);
+    void evict_locked(const Key* keep);
+
+    mutable std::mutex mutex_;
+    std::map<Key, Entry> entries_;
+    std::size_t max_bytes_;
+    std::size_t bytes_ = 0;
+    std::uint64_t tick_ = 0;
+    Stats stats_;
+};
+
+} // namespace Signal
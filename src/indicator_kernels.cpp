@@ -0,0 +1,324 @@
+#include "indicator_kernels.h"
+#include "indicator_kernels_impl.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <numeric>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <immintrin.h>
+#include <intrin.h>
+#endif
+
+namespace Signal {
+
+namespace kernels::scalar {
+
+// Same operation order as Signal::Sma, so the results are identical.
+void sma(const double* in, std::size_t n, std::size_t period, double* out) {
+    const double np = static_cast<double>(period);
+    double sum = 0.0;
+    for (std::size_t i = 0; i < n; ++i) {
+        if (i < period) {
+            sum += in[i];
+            out[i] = i + 1 == period ? sum / np : 0.0;
+            continue;
+        }
+        sum += in[i] - in[i - period];
+        if ((i + 1 - period) % period == 0) {
+            sum = std::accumulate(in + i + 1 - period, in + i + 1, 0.0);
+        }
+        out[i] = sum / np;
+    }
+}
+
+// Same operation order as Signal::Ema.
+void ema(const double* in, std::size_t n, std::size_t period, double* out) {
+    const double k = 2.0 / (static_cast<double>(period) + 1.0);
+    double seed = 0.0;
+    double e = 0.0;
+    for (std::size_t i = 0; i < n; ++i) {
+        if (i < period) {
+            seed += in[i];
+            if (i + 1 == period) {
+                e = seed / static_cast<double>(period);
+            }
+            out[i] = i + 1 == period ? e : 0.0;
+            continue;
+        }
+        e = (in[i] - e) * k + e;
+        out[i] = e;
+    }
+}
+
+// Same operation order as Signal::Rsi.
+void rsi(const double* in, std::size_t n, std::size_t period, double* out) {
+    const double np = static_cast<double>(period);
+    double avg_gain = 0.0;
+    double avg_loss = 0.0;
+    for (std::size_t i = 0; i < n; ++i) {
+        if (i == 0) {
+            out[i] = 0.0;
+            continue;
+        }
+        const double change = in[i] - in[i - 1];
+        const double gain = change > 0 ? change : 0.0;
+        const double loss = change < 0 ? -change : 0.0;
+        if (i <= period) {
+            avg_gain += gain;
+            avg_loss += loss;
+            if (i < period) {
+                out[i] = 0.0;
+                continue;
+            }
+            avg_gain /= np;
+            avg_loss /= np;
+        } else {
+            avg_gain = (avg_gain * (np - 1.0) + gain) / np;
+            avg_loss = (avg_loss * (np - 1.0) + loss) / np;
+        }
+        out[i] = avg_loss == 0.0 ? 100.0 : 100.0 - (100.0 / (1.0 + avg_gain / avg_loss));
+    }
+}
+
+namespace {
+
+// Monotonic deque of indices; `keep(a, b)` is true when an older a still
+// dominates a newer b.
+template <typename Keep>
+void rolling_extreme(const double* in, std::size_t n, std::size_t period, double* out, Keep keep) {
+    std::vector<std::size_t> q(n);
+    std::size_t head = 0;
+    std::size_t tail = 0;
+    for (std::size_t i = 0; i < n; ++i) {
+        while (tail > head && !keep(in[q[tail - 1]], in[i])) {
+            --tail;
+        }
+        q[tail++] = i;
+        if (q[head] + period <= i) {
+            ++head;
+        }
+        out[i] = i + 1 >= period ? in[q[head]] : 0.0;
+    }
+}
+
+} // namespace
+
+void rolling_min(const double* in, std::size_t n, std::size_t period, double* out) {
+    rolling_extreme(in, n, period, out, [](double older, double newer) { return older < newer; });
+}
+
+void rolling_max(const double* in, std::size_t n, std::size_t period, double* out) {
+    rolling_extreme(in, n, period, out, [](double older, double newer) { return older > newer; });
+}
+
+// Sums are kept relative to the first value of the window at each resum
+// point, which keeps the variance from cancelling when prices are large.
+void rolling_stddev(const double* in, std::size_t n, std::size_t period, double* out) {
+    const double np = static_cast<double>(period);
+    double shift = 0.0;
+    double s1 = 0.0;
+    double s2 = 0.0;
+    for (std::size_t i = 0; i < n; ++i) {
+        if (i + 1 < period) {
+            out[i] = 0.0;
+            continue;
+        }
+        if ((i + 1 - period) % kResumInterval == 0) {
+            shift = in[i + 1 - period];
+            s1 = 0.0;
+            s2 = 0.0;
+            for (std::size_t j = i + 1 - period; j <= i; ++j) {
+                const double d = in[j] - shift;
+                s1 += d;
+                s2 += d * d;
+            }
+        } else {
+            const double a = in[i] - shift;
+            const double b = in[i - period] - shift;
+            s1 += a - b;
+            s2 += a * a - b * b;
+        }
+        const double mean = s1 / np;
+        const double var = s2 / np - mean * mean;
+        out[i] = var > 0.0 ? std::sqrt(var) : 0.0;
+    }
+}
+
+void true_range(const double* high, const double* low, const double* close, std::size_t n,
+                double* out) {
+    for (std::size_t i = 0; i < n; ++i) {
+        const double range = high[i] - low[i];
+        if (i == 0) {
+            out[i] = range;
+            continue;
+        }
+        const double up = std::fabs(high[i] - close[i - 1]);
+        const double down = std::fabs(low[i] - close[i - 1]);
+        out[i] = std::max(range, std::max(up, down));
+    }
+}
+
+} // namespace kernels::scalar
+
+namespace {
+
+bool cpu_has_avx2() {
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) {
+        return false;
+    }
+    __cpuid(info, 1);
+    const bool osxsave = (info[2] & (1 << 27)) != 0;
+    const bool fma = (info[2] & (1 << 12)) != 0;
+    if (!osxsave || !fma || (_xgetbv(0) & 0x6) != 0x6) {
+        return false;
+    }
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#elif (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#else
+    return false;
+#endif
+}
+
+// CANDLE_KERNELS=scalar forces the scalar path.
+KernelIsa detect_isa() {
+    if (const char* forced = std::getenv("CANDLE_KERNELS")) {
+        if (std::strcmp(forced, "scalar") == 0) {
+            return KernelIsa::Scalar;
+        }
+    }
+    return avx2_available() ? KernelIsa::Avx2 : KernelIsa::Scalar;
+}
+
+std::atomic<KernelIsa>& current_isa() {
+    static std::atomic<KernelIsa> isa{detect_isa()};
+    return isa;
+}
+
+bool use_avx2() { return current_isa().load(std::memory_order_relaxed) == KernelIsa::Avx2; }
+
+// Elements to process; 0 when there is nothing to do. A zero period
+// produces zeros.
+std::size_t prepare(std::size_t in_size, std::size_t period, std::span<double> out) {
+    const std::size_t n = std::min(in_size, out.size());
+    if (period == 0) {
+        std::fill(out.begin(), out.begin() + static_cast<std::ptrdiff_t>(n), 0.0);
+        return 0;
+    }
+    return n;
+}
+
+} // namespace
+
+bool avx2_available() {
+    static const bool available = kernels::avx2::compiled() && cpu_has_avx2();
+    return available;
+}
+
+KernelIsa kernel_isa() { return current_isa().load(std::memory_order_relaxed); }
+
+KernelIsa set_kernel_isa(KernelIsa isa) {
+    if (isa == KernelIsa::Avx2 && !avx2_available()) {
+        isa = KernelIsa::Scalar;
+    }
+    current_isa().store(isa, std::memory_order_relaxed);
+    return isa;
+}
+
+const char* kernel_isa_name(KernelIsa isa) {
+    return isa == KernelIsa::Avx2 ? "avx2" : "scalar";
+}
+
+CandleColumns to_columns(const std::vector<Core::Candle>& candles) {
+    CandleColumns cols;
+    const std::size_t n = candles.size();
+    cols.open.resize(n);
+    cols.high.resize(n);
+    cols.low.resize(n);
+    cols.close.resize(n);
+    cols.volume.resize(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        const auto& c = candles[i];
+        cols.open[i] = c.open;
+        cols.high[i] = c.high;
+        cols.low[i] = c.low;
+        cols.close[i] = c.close;
+        cols.volume[i] = c.volume;
+    }
+    return cols;
+}
+
+void compute_sma(std::span<const double> in, std::size_t period, std::span<double> out) {
+    if (const std::size_t n = prepare(in.size(), period, out)) {
+        use_avx2() ? kernels::avx2::sma(in.data(), n, period, out.data())
+                   : kernels::scalar::sma(in.data(), n, period, out.data());
+    }
+}
+
+void compute_ema(std::span<const double> in, std::size_t period, std::span<double> out) {
+    if (const std::size_t n = prepare(in.size(), period, out)) {
+        use_avx2() ? kernels::avx2::ema(in.data(), n, period, out.data())
+                   : kernels::scalar::ema(in.data(), n, period, out.data());
+    }
+}
+
+void compute_rsi(std::span<const double> in, std::size_t period, std::span<double> out) {
+    if (const std::size_t n = prepare(in.size(), period, out)) {
+        use_avx2() ? kernels::avx2::rsi(in.data(), n, period, out.data())
+                   : kernels::scalar::rsi(in.data(), n, period, out.data());
+    }
+}
+
+void compute_rolling_min(std::span<const double> in, std::size_t period, std::span<double> out) {
+    if (const std::size_t n = prepare(in.size(), period, out)) {
+        if (use_avx2()) {
+            std::vector<double> scratch(n);
+            kernels::avx2::rolling_min(in.data(), n, period, out.data(), scratch.data());
+        } else {
+            kernels::scalar::rolling_min(in.data(), n, period, out.data());
+        }
+    }
+}
+
+void compute_rolling_max(std::span<const double> in, std::size_t period, std::span<double> out) {
+    if (const std::size_t n = prepare(in.size(), period, out)) {
+        if (use_avx2()) {
+            std::vector<double> scratch(n);
+            kernels::avx2::rolling_max(in.data(), n, period, out.data(), scratch.data());
+        } else {
+            kernels::scalar::rolling_max(in.data(), n, period, out.data());
+        }
+    }
+}
+
+void compute_rolling_stddev(std::span<const double> in, std::size_t period, std::span<double> out) {
+    // A single value has no spread; the sums would only add rounding noise.
+    if (const std::size_t n = prepare(in.size(), period == 1 ? 0 : period, out)) {
+        use_avx2() ? kernels::avx2::rolling_stddev(in.data(), n, period, out.data())
+                   : kernels::scalar::rolling_stddev(in.data(), n, period, out.data());
+    }
+}
+
+void compute_true_range(std::span<const double> high,
+                        std::span<const double> low,
+                        std::span<const double> close,
+                        std::span<double> out) {
+    const std::size_t n =
+        std::min({high.size(), low.size(), close.size(), out.size()});
+    if (n == 0) {
+        return;
+    }
+    use_avx2() ? kernels::avx2::true_range(high.data(), low.data(), close.data(), n, out.data())
+               : kernels::scalar::true_range(high.data(), low.data(), close.data(), n, out.data());
+}
+
+} // namespace Signal
@@ -0,0 +1,56 @@
+#pragma once
+
+#include "core/candle.h"
+#include <cstddef>
+#include <span>
+#include <vector>
+
+namespace Signal {
+
+// Batch indicator kernels over contiguous columns. Each writes one value per
+// input element into `out` (which must be at least as long as the input;
+// extra output is left untouched) and, like indicators.h, 0.0 where the
+// window is not complete yet. The implementation is chosen once at runtime:
+// AVX2 when the CPU has it, otherwise scalar. Results match the scalar path
+// exactly for true range and rolling min/max, and to rounding (~1e-12
+// relative) for the rest, since the vector path re-associates the sums.
+
+struct CandleColumns {
+    std::vector<double> open;
+    std::vector<double> high;
+    std::vector<double> low;
+    std::vector<double> close;
+    std::vector<double> volume;
+};
+
+[[nodiscard]] CandleColumns to_columns(const std::vector<Core::Candle>& candles);
+
+enum class KernelIsa { Scalar, Avx2 };
+
+// The implementation in use, and an override for tests and benchmarks; a
+// request for AVX2 on a CPU without it keeps the scalar path. Returns the
+// implementation actually selected.
+[[nodiscard]] KernelIsa kernel_isa();
+KernelIsa set_kernel_isa(KernelIsa isa);
+[[nodiscard]] bool avx2_available();
+[[nodiscard]] const char* kernel_isa_name(KernelIsa isa);
+
+void compute_sma(std::span<const double> in, std::size_t period, std::span<double> out);
+// Seeded with the SMA of the first `period` values.
+void compute_ema(std::span<const double> in, std::size_t period, std::span<double> out);
+// Wilder RSI; ready from index `period`.
+void compute_rsi(std::span<const double> in, std::size_t period, std::span<double> out);
+void compute_rolling_min(std::span<const double> in, std::size_t period, std::span<double> out);
+void compute_rolling_max(std::span<const double> in, std::size_t period, std::span<double> out);
+// Population standard deviation of the window, from running sums: the
+// variance carries rounding relative to the price level, so a nearly flat
+// window can come out slightly above zero.
+void compute_rolling_stddev(std::span<const double> in, std::size_t period, std::span<double> out);
+// max(high - low, |high - prev close|, |low - prev close|); high - low for
+// the first bar.
+void compute_true_range(std::span<const double> high,
+                        std::span<const double> low,
+                        std::span<const double> close,
+                        std::span<double> out);
+
+} // namespace Signal
@@ -0,0 +1,403 @@
+// AVX2/FMA kernels. This file is compiled with AVX2 enabled and only runs
+// after a CPU check (indicator_kernels.cpp), so it must not instantiate or
+// odr-use inline functions and templates from other headers (std::max,
+// std::vector, ...): the linker could keep this file's AVX2 copy for the
+// whole program. Everything here is intrinsics and internal-linkage helpers.
+
+#include "indicator_kernels_impl.h"
+
+#if (defined(__AVX2__) && defined(__FMA__)) || (defined(_MSC_VER) && defined(_M_X64))
+#define SIGNAL_KERNELS_AVX2 1
+#include <immintrin.h>
+#endif
+
+namespace Signal::kernels::avx2 {
+
+#ifdef SIGNAL_KERNELS_AVX2
+
+namespace {
+
+// Inclusive prefix sum of the four lanes.
+inline __m256d prefix_sum(__m256d v) {
+    const __m256d zero = _mm256_setzero_pd();
+    // [0, a, b, c]
+    v = _mm256_add_pd(v, _mm256_blend_pd(_mm256_permute4x64_pd(v, 0x90), zero, 0x1));
+    // [0, 0, a, a + b]
+    v = _mm256_add_pd(v, _mm256_blend_pd(_mm256_permute4x64_pd(v, 0x40), zero, 0x3));
+    return v;
+}
+
+inline __m256d last_lane(__m256d v) { return _mm256_permute4x64_pd(v, 0xFF); }
+
+// Affine scan e[j] = a * e[j - 1] + y[j] over the lanes, continuing from
+// `carry` (broadcast e[-1]); powers = [a, a^2, a^3, a^4].
+inline __m256d affine_scan(__m256d y, __m256d a, __m256d a2, __m256d powers, __m256d carry) {
+    const __m256d zero = _mm256_setzero_pd();
+    y = _mm256_fmadd_pd(a, _mm256_blend_pd(_mm256_permute4x64_pd(y, 0x90), zero, 0x1), y);
+    y = _mm256_fmadd_pd(a2, _mm256_blend_pd(_mm256_permute4x64_pd(y, 0x40), zero, 0x3), y);
+    return _mm256_fmadd_pd(powers, carry, y);
+}
+
+inline double lane3(__m256d v) { return _mm_cvtsd_f64(_mm256_extractf128_pd(last_lane(v), 0)); }
+
+inline double max_d(double a, double b) { return a > b ? a : b; }
+inline double abs_d(double a) { return a < 0 ? -a : a; }
+inline double sqrt_d(double a) { return _mm_cvtsd_f64(_mm_sqrt_sd(_mm_setzero_pd(), _mm_set_sd(a))); }
+
+double window_sum(const double* in, std::size_t len) {
+    __m256d acc = _mm256_setzero_pd();
+    std::size_t j = 0;
+    for (; j + 4 <= len; j += 4)
+        acc = _mm256_add_pd(acc, _mm256_loadu_pd(in + j));
+    alignas(32) double lanes[4];
+    _mm256_store_pd(lanes, acc);
+    double sum = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+    for (; j < len; ++j)
+        sum += in[j];
+    return sum;
+}
+
+// Prefix extremes within blocks of `period` into out, suffix extremes into
+// scratch, then out[i] = op(scratch[i - period + 1], out[i]) (van Herk /
+// Gil-Werman).
+template <bool Max>
+void rolling_extreme(const double* in, std::size_t n, std::size_t period, double* out,
+                     double* scratch) {
+    auto pick = [](double a, double b) { return Max ? (a > b ? a : b) : (a < b ? a : b); };
+    for (std::size_t start = 0; start < n; start += period) {
+        const std::size_t end = start + period < n ? start + period : n;
+        out[start] = in[start];
+        for (std::size_t i = start + 1; i < end; ++i)
+            out[i] = pick(out[i - 1], in[i]);
+        scratch[end - 1] = in[end - 1];
+        for (std::size_t i = end - 1; i > start; --i)
+            scratch[i - 1] = pick(scratch[i], in[i - 1]);
+    }
+    std::size_t i = period - 1;
+    for (; i + 4 <= n; i += 4) {
+        const __m256d suffix = _mm256_loadu_pd(scratch + i + 1 - period);
+        const __m256d prefix = _mm256_loadu_pd(out + i);
+        _mm256_storeu_pd(out + i, Max ? _mm256_max_pd(suffix, prefix) : _mm256_min_pd(suffix, prefix));
+    }
+    for (; i < n; ++i)
+        out[i] = pick(scratch[i + 1 - period], out[i]);
+    for (std::size_t j = 0; j + 1 < period && j < n; ++j)
+        out[j] = 0.0;
+}
+
+} // namespace
+
+bool compiled() { return true; }
+
+void sma(const double* in, std::size_t n, std::size_t period, double* out) {
+    const double np = static_cast<double>(period);
+    double sum = 0.0;
+    for (std::size_t i = 0; i < n && i < period; ++i) {
+        sum += in[i];
+        out[i] = i + 1 == period ? sum / np : 0.0;
+    }
+    const __m256d vp = _mm256_set1_pd(np);
+    for (std::size_t chunk = period; chunk < n; chunk += kResumInterval) {
+        const std::size_t end = chunk + kResumInterval < n ? chunk + kResumInterval : n;
+        if (chunk > period)
+            sum = window_sum(in + chunk - period, period);
+        __m256d carry = _mm256_set1_pd(sum);
+        std::size_t i = chunk;
+        for (; i + 4 <= end; i += 4) {
+            const __m256d d =
+                _mm256_sub_pd(_mm256_loadu_pd(in + i), _mm256_loadu_pd(in + i - period));
+            const __m256d s = _mm256_add_pd(prefix_sum(d), carry);
+            _mm256_storeu_pd(out + i, _mm256_div_pd(s, vp));
+            carry = last_lane(s);
+        }
+        sum = lane3(carry);
+        for (; i < end; ++i) {
+            sum += in[i] - in[i - period];
+            out[i] = sum / np;
+        }
+    }
+}
+
+void ema(const double* in, std::size_t n, std::size_t period, double* out) {
+    const double k = 2.0 / (static_cast<double>(period) + 1.0);
+    const double a = 1.0 - k;
+    double e = 0.0;
+    for (std::size_t i = 0; i < n && i < period; ++i) {
+        e += in[i];
+        out[i] = 0.0;
+    }
+    if (n < period)
+        return;
+    e /= static_cast<double>(period);
+    out[period - 1] = e;
+    const __m256d va = _mm256_set1_pd(a);
+    const __m256d va2 = _mm256_set1_pd(a * a);
+    const __m256d powers = _mm256_setr_pd(a, a * a, a * a * a, a * a * a * a);
+    const __m256d vk = _mm256_set1_pd(k);
+    __m256d carry = _mm256_set1_pd(e);
+    std::size_t i = period;
+    for (; i + 4 <= n; i += 4) {
+        const __m256d y = _mm256_mul_pd(vk, _mm256_loadu_pd(in + i));
+        carry = affine_scan(y, va, va2, powers, carry);
+        _mm256_storeu_pd(out + i, carry);
+        carry = last_lane(carry);
+    }
+    e = lane3(carry);
+    for (; i < n; ++i) {
+        e = (in[i] - e) * k + e;
+        out[i] = e;
+    }
+}
+
+void rsi(const double* in, std::size_t n, std::size_t period, double* out) {
+    const double np = static_cast<double>(period);
+    double gain = 0.0;
+    double loss = 0.0;
+    out[0] = 0.0;
+    for (std::size_t i = 1; i < n && i <= period; ++i) {
+        const double change = in[i] - in[i - 1];
+        gain += change > 0 ? change : 0.0;
+        loss += change < 0 ? -change : 0.0;
+        out[i] = 0.0;
+    }
+    if (n <= period)
+        return;
+    gain /= np;
+    loss /= np;
+    auto rsi_of = [](double g, double l) {
+        return l == 0.0 ? 100.0 : 100.0 - (100.0 / (1.0 + g / l));
+    };
+    out[period] = rsi_of(gain, loss);
+
+    const double a = (np - 1.0) / np;
+    const __m256d va = _mm256_set1_pd(a);
+    const __m256d va2 = _mm256_set1_pd(a * a);
+    const __m256d powers = _mm256_setr_pd(a, a * a, a * a * a, a * a * a * a);
+    const __m256d inv = _mm256_set1_pd(1.0 / np);
+    const __m256d zero = _mm256_setzero_pd();
+    const __m256d hundred = _mm256_set1_pd(100.0);
+    const __m256d one = _mm256_set1_pd(1.0);
+    __m256d g_carry = _mm256_set1_pd(gain);
+    __m256d l_carry = _mm256_set1_pd(loss);
+    std::size_t i = period + 1;
+    for (; i + 4 <= n; i += 4) {
+        const __m256d d = _mm256_sub_pd(_mm256_loadu_pd(in + i), _mm256_loadu_pd(in + i - 1));
+        const __m256d g = _mm256_mul_pd(_mm256_max_pd(d, zero), inv);
+        const __m256d l = _mm256_mul_pd(_mm256_max_pd(_mm256_sub_pd(zero, d), zero), inv);
+        const __m256d avg_g = affine_scan(g, va, va2, powers, g_carry);
+        const __m256d avg_l = affine_scan(l, va, va2, powers, l_carry);
+        const __m256d r = _mm256_sub_pd(
+            hundred, _mm256_div_pd(hundred, _mm256_add_pd(one, _mm256_div_pd(avg_g, avg_l))));
+        const __m256d no_loss = _mm256_cmp_pd(avg_l, zero, _CMP_EQ_OQ);
+        _mm256_storeu_pd(out + i, _mm256_blendv_pd(r, hundred, no_loss));
+        g_carry = last_lane(avg_g);
+        l_carry = last_lane(avg_l);
+    }
+    gain = lane3(g_carry);
+    loss = lane3(l_carry);
+    for (; i < n; ++i) {
+        const double change = in[i] - in[i - 1];
+        gain = (gain * (np - 1.0) + (change > 0 ? change : 0.0)) / np;
+        loss = (loss * (np - 1.0) + (change < 0 ? -change : 0.0)) / np;
+        out[i] = rsi_of(gain, loss);
+    }
+}
+
+void rolling_min(const double* in, std::size_t n, std::size_t period, double* out,
+                 double* scratch) {
+    rolling_extreme<false>(in, n, period, out, scratch);
+}
+
+void rolling_max(const double* in, std::size_t n, std::size_t period, double* out,
+                 double* scratch) {
+    rolling_extreme<true>(in, n, period, out, scratch);
+}
+
+// Same resum points and shifted sums as the scalar kernel.
+void rolling_stddev(const double* in, std::size_t n, std::size_t period, double* out) {
+    const double np = static_cast<double>(period);
+    for (std::size_t i = 0; i + 1 < period && i < n; ++i)
+        out[i] = 0.0;
+    const __m256d vp = _mm256_set1_pd(np);
+    const __m256d zero = _mm256_setzero_pd();
+    auto finish = [np](double s1, double s2) {
+        const double mean = s1 / np;
+        const double var = s2 / np - mean * mean;
+        return var > 0.0 ? sqrt_d(var) : 0.0;
+    };
+    for (std::size_t anchor = period - 1; anchor < n; anchor += kResumInterval) {
+        const std::size_t end = anchor + kResumInterval < n ? anchor + kResumInterval : n;
+        const double shift = in[anchor + 1 - period];
+        double s1 = 0.0;
+        double s2 = 0.0;
+        for (std::size_t j = anchor + 1 - period; j <= anchor; ++j) {
+            const double d = in[j] - shift;
+            s1 += d;
+            s2 += d * d;
+        }
+        out[anchor] = finish(s1, s2);
+        const __m256d vshift = _mm256_set1_pd(shift);
+        __m256d c1 = _mm256_set1_pd(s1);
+        __m256d c2 = _mm256_set1_pd(s2);
+        std::size_t i = anchor + 1;
+        for (; i + 4 <= end; i += 4) {
+            const __m256d a = _mm256_sub_pd(_mm256_loadu_pd(in + i), vshift);
+            const __m256d b = _mm256_sub_pd(_mm256_loadu_pd(in + i - period), vshift);
+            const __m256d v1 = _mm256_add_pd(prefix_sum(_mm256_sub_pd(a, b)), c1);
+            const __m256d v2 = _mm256_add_pd(
+                prefix_sum(_mm256_fmsub_pd(a, a, _mm256_mul_pd(b, b))), c2);
+            const __m256d mean = _mm256_div_pd(v1, vp);
+            const __m256d var = _mm256_fnmadd_pd(mean, mean, _mm256_div_pd(v2, vp));
+            _mm256_storeu_pd(out + i, _mm256_sqrt_pd(_mm256_max_pd(var, zero)));
+            c1 = last_lane(v1);
+            c2 = last_lane(v2);
+        }
+        s1 = lane3(c1);
+        s2 = lane3(c2);
+        for (; i < end; ++i) {
+            const double a = in[i] - shift;
+            const double b = in[i - period] - shift;
+            s1 += a - b;
+            s2 += a * a - b * b;
+            out[i] = finish(s1, s2);
+        }
+    }
+}
+
+void true_range(const double* high, const double* low, const double* close, std::size_t n,
+                double* out) {
+    out[0] = high[0] - low[0];
+    const __m256d sign = _mm256_set1_pd(-0.0);
+    std::size_t i = 1;
+    for (; i + 4 <= n; i += 4) {
+        const __m256d h = _mm256_loadu_pd(high + i);
+        const __m256d l = _mm256_loadu_pd(low + i);
+        const __m256d pc = _mm256_loadu_pd(close + i - 1);
+        const __m256d up = _mm256_andnot_pd(sign, _mm256_sub_pd(h, pc));
+        const __m256d down = _mm256_andnot_pd(sign, _mm256_sub_pd(l, pc));
+        _mm256_storeu_pd(out + i, _mm256_max_pd(_mm256_sub_pd(h, l), _mm256_max_pd(up, down)));
+    }
+    for (; i < n; ++i) {
+        const double range = high[i] - low[i];
+        out[i] = max_d(range, max_d(abs_d(high[i] - close[i - 1]), abs_d(low[i] - close[i - 1])));
+    }
+}
+
+namespace {
+
+// Rule operators on four lanes; `ord` has the lanes where both operands
+// are known.
+inline __m256d unknown_lanes() { return _mm256_castsi256_pd(_mm256_set1_epi64x(0x7FF8000000000000LL)); }
+
+inline __m256d rule_lanes(RuleOp op, __m256d a, __m256d b) {
+    const __m256d zero = _mm256_setzero_pd();
+    const __m256d one = _mm256_set1_pd(1.0);
+    const __m256d unknown = unknown_lanes();
+    const __m256d sign = _mm256_set1_pd(-0.0);
+    const __m256d ord = _mm256_cmp_pd(a, b, _CMP_ORD_Q);
+    auto truth = [&](__m256d cmp) { return _mm256_blendv_pd(unknown, _mm256_and_pd(cmp, one), ord); };
+    switch (op) {
+    case RuleOp::Add: return _mm256_add_pd(a, b);
+    case RuleOp::Sub: return _mm256_sub_pd(a, b);
+    case RuleOp::Mul: return _mm256_mul_pd(a, b);
+    case RuleOp::Div: return _mm256_div_pd(a, b);
+    case RuleOp::Min: return _mm256_blendv_pd(unknown, _mm256_min_pd(a, b), ord);
+    case RuleOp::Max: return _mm256_blendv_pd(unknown, _mm256_max_pd(a, b), ord);
+    case RuleOp::Lt: return truth(_mm256_cmp_pd(a, b, _CMP_LT_OQ));
+    case RuleOp::Le: return truth(_mm256_cmp_pd(a, b, _CMP_LE_OQ));
+    case RuleOp::Gt: return truth(_mm256_cmp_pd(a, b, _CMP_GT_OQ));
+    case RuleOp::Ge: return truth(_mm256_cmp_pd(a, b, _CMP_GE_OQ));
+    case RuleOp::Eq: return truth(_mm256_cmp_pd(a, b, _CMP_EQ_OQ));
+    case RuleOp::Ne: return truth(_mm256_cmp_pd(a, b, _CMP_NEQ_OQ));
+    case RuleOp::And: {
+        const __m256d any_false = _mm256_or_pd(_mm256_cmp_pd(a, zero, _CMP_EQ_OQ),
+                                               _mm256_cmp_pd(b, zero, _CMP_EQ_OQ));
+        return _mm256_blendv_pd(_mm256_blendv_pd(unknown, one, ord), zero, any_false);
+    }
+    case RuleOp::Or: {
+        const __m256d any_true = _mm256_or_pd(_mm256_cmp_pd(a, zero, _CMP_NEQ_OQ),
+                                              _mm256_cmp_pd(b, zero, _CMP_NEQ_OQ));
+        return _mm256_blendv_pd(_mm256_blendv_pd(unknown, zero, ord), one, any_true);
+    }
+    case RuleOp::Neg: return _mm256_xor_pd(a, sign);
+    case RuleOp::Abs: return _mm256_andnot_pd(sign, a);
+    case RuleOp::Not:
+        return _mm256_blendv_pd(unknown, _mm256_and_pd(_mm256_cmp_pd(a, zero, _CMP_EQ_OQ), one),
+                                _mm256_cmp_pd(a, a, _CMP_ORD_Q));
+    }
+    return a;
+}
+
+// The tail goes through the same lanes, padded with unknowns.
+inline __m256d load_partial(const double* p, std::size_t n) {
+    alignas(32) double lanes[4];
+    _mm256_store_pd(lanes, unknown_lanes());
+    for (std::size_t j = 0; j < n; ++j)
+        lanes[j] = p[j];
+    return _mm256_load_pd(lanes);
+}
+
+inline void store_partial(double* p, __m256d v, std::size_t n) {
+    alignas(32) double lanes[4];
+    _mm256_store_pd(lanes, v);
+    for (std::size_t j = 0; j < n; ++j)
+        p[j] = lanes[j];
+}
+
+inline __m128i signal_lanes(__m256d buy, __m256d sell) {
+    const __m256d zero = _mm256_setzero_pd();
+    const __m256d is_buy = _mm256_cmp_pd(buy, zero, _CMP_NEQ_OQ);
+    const __m256d is_sell = _mm256_cmp_pd(sell, zero, _CMP_NEQ_OQ);
+    const __m256d v = _mm256_blendv_pd(
+        _mm256_blendv_pd(zero, _mm256_set1_pd(-1.0), is_sell), _mm256_set1_pd(1.0), is_buy);
+    return _mm256_cvtpd_epi32(v);
+}
+
+} // namespace
+
+void rule_op(RuleOp op, const double* a, const double* b, double* out, std::size_t n) {
+    const bool unary = op == RuleOp::Neg || op == RuleOp::Abs || op == RuleOp::Not;
+    std::size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        const __m256d va = _mm256_loadu_pd(a + i);
+        const __m256d vb = unary ? va : _mm256_loadu_pd(b + i);
+        _mm256_storeu_pd(out + i, rule_lanes(op, va, vb));
+    }
+    if (i < n) {
+        const __m256d va = load_partial(a + i, n - i);
+        const __m256d vb = unary ? va : load_partial(b + i, n - i);
+        store_partial(out + i, rule_lanes(op, va, vb), n - i);
+    }
+}
+
+void rule_signals(const double* buy, const double* sell, int* out, std::size_t n) {
+    std::size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        const __m128i v = signal_lanes(_mm256_loadu_pd(buy + i), _mm256_loadu_pd(sell + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), v);
+    }
+    if (i < n) {
+        alignas(16) int lanes[4];
+        _mm_store_si128(reinterpret_cast<__m128i*>(lanes),
+                        signal_lanes(load_partial(buy + i, n - i), load_partial(sell + i, n - i)));
+        for (std::size_t j = 0; i + j < n; ++j)
+            out[i + j] = lanes[j];
+    }
+}
+
+#else // no AVX2 code in this build; the dispatcher never selects it
+
+bool compiled() { return false; }
+void sma(const double*, std::size_t, std::size_t, double*) {}
+void ema(const double*, std::size_t, std::size_t, double*) {}
+void rsi(const double*, std::size_t, std::size_t, double*) {}
+void rolling_min(const double*, std::size_t, std::size_t, double*, double*) {}
+void rolling_max(const double*, std::size_t, std::size_t, double*, double*) {}
+void rolling_stddev(const double*, std::size_t, std::size_t, double*) {}
+void true_range(const double*, const double*, const double*, std::size_t, double*) {}
+void rule_op(RuleOp, const double*, const double*, double*, std::size_t) {}
+void rule_signals(const double*, const double*, int*, std::size_t) {}
+
+#endif
+
+} // namespace Signal::kernels::avx2
@@ -0,0 +1,69 @@
+#pragma once
+
+// Per-ISA entry points behind indicator_kernels.h. All take raw pointers and
+// write n values; inputs are at least n long and period is at least 1.
+
+#include <cstddef>
+
+namespace Signal::kernels {
+
+// Rolling statistics recompute their window sums from scratch every this
+// many outputs, so rounding cannot build up over long series.
+constexpr std::size_t kResumInterval = 512;
+
+// Element-wise operators of rule programs (rule_program.h): NaN is an
+// unknown value, comparisons and and/or/not give 1.0, 0.0 or unknown. The
+// scalar definitions are in rule_program.cpp.
+enum class RuleOp : unsigned char {
+    Add,
+    Sub,
+    Mul,
+    Div,
+    Min,
+    Max,
+    Lt,
+    Le,
+    Gt,
+    Ge,
+    Eq,
+    Ne,
+    And,
+    Or,
+    Neg,
+    Abs,
+    Not,
+};
+
+namespace scalar {
+void sma(const double* in, std::size_t n, std::size_t period, double* out);
+void ema(const double* in, std::size_t n, std::size_t period, double* out);
+void rsi(const double* in, std::size_t n, std::size_t period, double* out);
+void rolling_min(const double* in, std::size_t n, std::size_t period, double* out);
+void rolling_max(const double* in, std::size_t n, std::size_t period, double* out);
+void rolling_stddev(const double* in, std::size_t n, std::size_t period, double* out);
+void true_range(const double* high, const double* low, const double* close, std::size_t n,
+                double* out);
+} // namespace scalar
+
+// Compiled with AVX2/FMA enabled (indicator_kernels_avx2.cpp). compiled() is
+// false when the build has no AVX2 code, e.g. on other architectures. The
+// rolling min/max need n doubles of scratch.
+namespace avx2 {
+bool compiled();
+void sma(const double* in, std::size_t n, std::size_t period, double* out);
+void ema(const double* in, std::size_t n, std::size_t period, double* out);
+void rsi(const double* in, std::size_t n, std::size_t period, double* out);
+void rolling_min(const double* in, std::size_t n, std::size_t period, double* out,
+                 double* scratch);
+void rolling_max(const double* in, std::size_t n, std::size_t period, double* out,
+                 double* scratch);
+void rolling_stddev(const double* in, std::size_t n, std::size_t period, double* out);
+void true_range(const double* high, const double* low, const double* close, std::size_t n,
+                double* out);
+// out = op(a, b) (b is ignored by Neg, Abs and Not), and a rule program's
+// signals: 1 where buy is true, else -1 where sell is true, else 0.
+void rule_op(RuleOp op, const double* a, const double* b, double* out, std::size_t n);
+void rule_signals(const double* buy, const double* sell, int* out, std::size_t n);
+} // namespace avx2
+
+} // namespace Signal::kernels
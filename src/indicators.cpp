@@ -0,0 +1,182 @@
+#include "indicators.h"
+#include <numeric>
+
+namespace Signal {
+
+Sma::Sma(std::size_t period) : period_(period), window_(period, 0.0) {}
+
+void Sma::update(double x) {
+    if (period_ == 0) {
+        return;
+    }
+    if (count_ < period_) {
+        window_[count_++] = x;
+        sum_ += x;
+        return;
+    }
+    sum_ += x - window_[pos_];
+    window_[pos_] = x;
+    if (++pos_ == period_) {
+        pos_ = 0;
+        // The window is in order again: resum it to drop accumulated error.
+        sum_ = std::accumulate(window_.begin(), window_.end(), 0.0);
+    }
+}
+
+double Sma::value() const noexcept {
+    return ready() ? sum_ / static_cast<double>(period_) : 0.0;
+}
+
+void Sma::reset() {
+    pos_ = 0;
+    count_ = 0;
+    sum_ = 0.0;
+}
+
+Ema::Ema(std::size_t period)
+    : period_(period), k_(2.0 / (static_cast<double>(period) + 1.0)) {}
+
+void Ema::update(double x) {
+    if (period_ == 0) {
+        return;
+    }
+    if (count_ < period_) {
+        seed_sum_ += x;
+        if (++count_ == period_) {
+            ema_ = seed_sum_ / static_cast<double>(period_);
+        }
+        return;
+    }
+    ema_ = (x - ema_) * k_ + ema_;
+}
+
+void Ema::reset() {
+    count_ = 0;
+    seed_sum_ = 0.0;
+    ema_ = 0.0;
+}
+
+Rsi::Rsi(std::size_t period) : period_(period) {}
+
+void Rsi::update(double x) {
+    if (period_ == 0) {
+        return;
+    }
+    if (!has_prev_) {
+        has_prev_ = true;
+        prev_ = x;
+        return;
+    }
+    const double change = x - prev_;
+    prev_ = x;
+    const double gain = change > 0 ? change : 0.0;
+    const double loss = change < 0 ? -change : 0.0;
+    const double n = static_cast<double>(period_);
+    if (changes_ < period_) {
+        avg_gain_ += gain;
+        avg_loss_ += loss;
+        if (++changes_ == period_) {
+            avg_gain_ /= n;
+            avg_loss_ /= n;
+        }
+        return;
+    }
+    avg_gain_ = (avg_gain_ * (n - 1.0) + gain) / n;
+    avg_loss_ = (avg_loss_ * (n - 1.0) + loss) / n;
+}
+
+double Rsi::value() const noexcept {
+    if (!ready()) {
+        return 0.0;
+    }
+    if (avg_loss_ == 0.0) {
+        return 100.0;
+    }
+    const double rs = avg_gain_ / avg_loss_;
+    return 100.0 - (100.0 / (1.0 + rs));
+}
+
+void Rsi::reset() {
+    has_prev_ = false;
+    prev_ = 0.0;
+    changes_ = 0;
+    avg_gain_ = 0.0;
+    avg_loss_ = 0.0;
+}
+
+Macd::Macd(std::size_t fast_period, std::size_t slow_period, std::size_t signal_period)
+    : fast_(fast_period), slow_(slow_period), signal_(signal_period) {}
+
+bool Macd::valid() const noexcept {
+    return fast_.period() > 0 && slow_.period() > 0 && signal_.period() > 0 &&
+           fast_.period() < slow_.period();
+}
+
+void Macd::update(double x) {
+    if (!valid()) {
+        return;
+    }
+    fast_.update(x);
+    slow_.update(x);
+    if (slow_.ready()) {
+        signal_.update(fast_.value() - slow_.value());
+    }
+}
+
+MACDResult Macd::value() const noexcept {
+    if (!ready()) {
+        return {0.0, 0.0, 0.0};
+    }
+    const double line = fast_.value() - slow_.value();
+    const double signal = signal_.value();
+    return {line, signal, line - signal};
+}
+
+void Macd::reset() {
+    fast_.reset();
+    slow_.reset();
+    signal_.reset();
+}
+
+namespace {
+
+template <typename Indicator>
+std::vector<double> run_series(const std::vector<Core::Candle>& candles, Indicator indicator) {
+    std::vector<double> out;
+    out.reserve(candles.size());
+    for (const auto& c : candles) {
+        indicator.update(c.close);
+        out.push_back(indicator.value());
+    }
+    return out;
+}
+
+} // namespace
+
+std::vector<double> sma_series(const std::vector<Core::Candle>& candles, std::size_t period) {
+    return run_series(candles, Sma(period));
+}
+
+std::vector<double> ema_series(const std::vector<Core::Candle>& candles, std::size_t period) {
+    return run_series(candles, Ema(period));
+}
+
+std::vector<double> rsi_series(const std::vector<Core::Candle>& candles, std::size_t period) {
+    return run_series(candles, Rsi(period));
+}
+
+std::vector<MACDResult> macd_series(const std::vector<Core::Candle>& candles,
+                                    std::size_t fast_period,
+                                    std::size_t slow_period,
+                                    std::size_t signal_period) {
+    Macd macd(fast_period, slow_period, signal_period);
+    std::vector<MACDResult> out;
+    out.reserve(candles.size());
+    for (const auto& c : candles) {
+        macd.update(c.close);
+        out.push_back(macd.value());
+    }
+    return out;
+}
+
+} // namespace Signal
@@ -0,0 +1,106 @@
+#pragma once
+
+#include "core/candle.h"
+#include <cstddef>
+#include <vector>
+
+namespace Signal {
+
+// Incremental indicators: update() takes the next close in O(1) and value()
+// is 0.0 until ready(). Feeding a whole series once gives the same values as
+// the per-index functions in signal.h, which are thin wrappers over these.
+
+// Mean of the last `period` values. The running sum is recomputed from the
+// window once per `period` updates so rounding does not accumulate.
+class Sma {
+public:
+    explicit Sma(std::size_t period);
+    void update(double x);
+    [[nodiscard]] bool ready() const noexcept { return period_ > 0 && count_ >= period_; }
+    [[nodiscard]] double value() const noexcept;
+    [[nodiscard]] std::size_t period() const noexcept { return period_; }
+    void reset();
+
+private:
+    std::size_t period_;
+    std::vector<double> window_;
+    std::size_t pos_{0};
+    std::size_t count_{0};
+    double sum_{0.0};
+};
+
+// Exponential moving average with k = 2 / (period + 1), seeded with the SMA
+// of the first `period` values.
+class Ema {
+public:
+    explicit Ema(std::size_t period);
+    void update(double x);
+    [[nodiscard]] bool ready() const noexcept { return period_ > 0 && count_ >= period_; }
+    [[nodiscard]] double value() const noexcept { return ready() ? ema_ : 0.0; }
+    [[nodiscard]] std::size_t period() const noexcept { return period_; }
+    void reset();
+
+private:
+    std::size_t period_;
+    double k_;
+    std::size_t count_{0};
+    double seed_sum_{0.0};
+    double ema_{0.0};
+};
+
+// Relative Strength Index with Wilder smoothing: the first averages are the
+// means of `period` changes, later ones avg = (avg * (period - 1) + x) / period.
+// Ready after period + 1 values.
+class Rsi {
+public:
+    explicit Rsi(std::size_t period);
+    void update(double x);
+    [[nodiscard]] bool ready() const noexcept { return period_ > 0 && changes_ >= period_; }
+    [[nodiscard]] double value() const noexcept;
+    [[nodiscard]] std::size_t period() const noexcept { return period_; }
+    void reset();
+
+private:
+    std::size_t period_;
+    bool has_prev_{false};
+    double prev_{0.0};
+    std::size_t changes_{0};
+    double avg_gain_{0.0};
+    double avg_loss_{0.0};
+};
+
+struct MACDResult {
+    double macd;
+    double signal;
+    double histogram;
+};
+
+// MACD line EMA(fast) - EMA(slow) and its EMA(signal_period). The line is
+// available after `slow` values, the signal after slow + signal - 1.
+class Macd {
+public:
+    Macd(std::size_t fast_period, std::size_t slow_period, std::size_t signal_period);
+    void update(double x);
+    [[nodiscard]] bool valid() const noexcept;
+    [[nodiscard]] bool line_ready() const noexcept { return valid() && slow_.ready(); }
+    [[nodiscard]] bool ready() const noexcept { return line_ready() && signal_.ready(); }
+    [[nodiscard]] MACDResult value() const noexcept;
+    void reset();
+
+private:
+    Ema fast_;
+    Ema slow_;
+    Ema signal_;
+};
+
+// One pass over a whole series; element i is the indicator at index i (0.0
+// while not ready).
+[[nodiscard]] std::vector<double> sma_series(const std::vector<Core::Candle>& candles, std::size_t period);
+[[nodiscard]] std::vector<double> ema_series(const std::vector<Core::Candle>& candles, std::size_t period);
+[[nodiscard]] std::vector<double> rsi_series(const std::vector<Core::Candle>& candles, std::size_t period);
+[[nodiscard]] std::vector<MACDResult> macd_series(const std::vector<Core::Candle>& candles,
+                                                  std::size_t fast_period,
+                                                  std::size_t slow_period,
+                                                  std::size_t signal_period);
+
+} // namespace Signal
@@ -0,0 +1,776 @@
+#include "rule_program.h"
+
+#include "core/interval_utils.h"
+#include "indicator_kernels.h"
+#include "indicator_kernels_impl.h"
+#include "strategy.h"
+
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <map>
+#include <optional>
+#include <tuple>
+
+namespace Signal {
+
+namespace {
+
+using Op = RuleProgram::Op;
+
+constexpr double kUnknown = std::numeric_limits<double>::quiet_NaN();
+// Bounds how far back a rule may look, which is the history every register
+// keeps between blocks.
+constexpr std::size_t kMaxPrev = 4096;
+
+// Written with & rather than && so the block loops compile to selects.
+bool known(double x) { return x == x; }
+bool truthy(double x) { return known(x) & (x != 0.0); }
+
+// Scalar semantics of every operator, shared by constant folding and the
+// block loops.
+double compare(bool ok, double a, double b) { return known(a) & known(b) ? (ok ? 1.0 : 0.0) : kUnknown; }
+double op_add(double a, double b) { return a + b; }
+double op_sub(double a, double b) { return a - b; }
+double op_mul(double a, double b) { return a * b; }
+double op_div(double a, double b) { return a / b; }
+// Same operand order as the AVX2 min/max, which differ only for +-0.
+double op_min(double a, double b) { return known(a) & known(b) ? (a < b ? a : b) : kUnknown; }
+double op_max(double a, double b) { return known(a) & known(b) ? (a > b ? a : b) : kUnknown; }
+double op_lt(double a, double b) { return compare(a < b, a, b); }
+double op_le(double a, double b) { return compare(a <= b, a, b); }
+double op_gt(double a, double b) { return compare(a > b, a, b); }
+double op_ge(double a, double b) { return compare(a >= b, a, b); }
+double op_eq(double a, double b) { return compare(a == b, a, b); }
+double op_ne(double a, double b) { return compare(a != b, a, b); }
+double op_and(double a, double b) {
+    return (a == 0.0) | (b == 0.0) ? 0.0 : (known(a) & known(b) ? 1.0 : kUnknown);
+}
+double op_or(double a, double b) {
+    return truthy(a) | truthy(b) ? 1.0 : (known(a) & known(b) ? 0.0 : kUnknown);
+}
+double op_neg(double a, double) { return -a; }
+double op_abs(double a, double) { return std::fabs(a); }
+double op_not(double a, double) { return known(a) ? (a == 0.0 ? 1.0 : 0.0) : kUnknown; }
+
+using ScalarFn = double (*)(double, double);
+
+ScalarFn scalar_fn(Op op) {
+    switch (op) {
+    case Op::Add: return op_add;
+    case Op::Sub: return op_sub;
+    case Op::Mul: return op_mul;
+    case Op::Div: return op_div;
+    case Op::Min: return op_min;
+    case Op::Max: return op_max;
+    case Op::Lt: return op_lt;
+    case Op::Le: return op_le;
+    case Op::Gt: return op_gt;
+    case Op::Ge: return op_ge;
+    case Op::Eq: return op_eq;
+    case Op::Ne: return op_ne;
+    case Op::And: return op_and;
+    case Op::Or: return op_or;
+    case Op::Neg: return op_neg;
+    case Op::Abs: return op_abs;
+    case Op::Not: return op_not;
+    default: return nullptr;
+    }
+}
+
+bool unary(Op op) { return op == Op::Neg || op == Op::Abs || op == Op::Not || op == Op::Prev; }
+
+bool commutative(Op op) {
+    return op == Op::Add || op == Op::Mul || op == Op::Min || op == Op::Max || op == Op::Eq ||
+           op == Op::Ne || op == Op::And || op == Op::Or;
+}
+
+using kernels::RuleOp;
+
+// The scalar block loops: one pass per instruction over the block, with the
+// operator inlined. The AVX2 versions are in indicator_kernels_avx2.cpp.
+template <double (*F)(double, double)>
+void binary_block(const double* a, const double* b, double* r, std::size_t n) {
+    for (std::size_t i = 0; i < n; ++i) {
+        r[i] = F(a[i], b[i]);
+    }
+}
+
+template <double (*F)(double, double)>
+void unary_block(const double* a, double* r, std::size_t n) {
+    for (std::size_t i = 0; i < n; ++i) {
+        r[i] = F(a[i], 0.0);
+    }
+}
+
+void scalar_block(RuleOp op, const double* a, const double* b, double* r, std::size_t n) {
+    switch (op) {
+    case RuleOp::Add: binary_block<op_add>(a, b, r, n); break;
+    case RuleOp::Sub: binary_block<op_sub>(a, b, r, n); break;
+    case RuleOp::Mul: binary_block<op_mul>(a, b, r, n); break;
+    case RuleOp::Div: binary_block<op_div>(a, b, r, n); break;
+    case RuleOp::Min: binary_block<op_min>(a, b, r, n); break;
+    case RuleOp::Max: binary_block<op_max>(a, b, r, n); break;
+    case RuleOp::Lt: binary_block<op_lt>(a, b, r, n); break;
+    case RuleOp::Le: binary_block<op_le>(a, b, r, n); break;
+    case RuleOp::Gt: binary_block<op_gt>(a, b, r, n); break;
+    case RuleOp::Ge: binary_block<op_ge>(a, b, r, n); break;
+    case RuleOp::Eq: binary_block<op_eq>(a, b, r, n); break;
+    case RuleOp::Ne: binary_block<op_ne>(a, b, r, n); break;
+    case RuleOp::And: binary_block<op_and>(a, b, r, n); break;
+    case RuleOp::Or: binary_block<op_or>(a, b, r, n); break;
+    case RuleOp::Neg: unary_block<op_neg>(a, r, n); break;
+    case RuleOp::Abs: unary_block<op_abs>(a, r, n); break;
+    case RuleOp::Not: unary_block<op_not>(a, r, n); break;
+    }
+}
+
+void scalar_signals(const double* buy, const double* sell, int* out, std::size_t n) {
+    for (std::size_t i = 0; i < n; ++i) {
+        out[i] = truthy(buy[i]) ? 1 : (truthy(sell[i]) ? -1 : 0);
+    }
+}
+
+// The block operator of an instruction; nullopt for loads and prev.
+std::optional<RuleOp> block_op(Op op) {
+    switch (op) {
+    case Op::Add: return RuleOp::Add;
+    case Op::Sub: return RuleOp::Sub;
+    case Op::Mul: return RuleOp::Mul;
+    case Op::Div: return RuleOp::Div;
+    case Op::Min: return RuleOp::Min;
+    case Op::Max: return RuleOp::Max;
+    case Op::Lt: return RuleOp::Lt;
+    case Op::Le: return RuleOp::Le;
+    case Op::Gt: return RuleOp::Gt;
+    case Op::Ge: return RuleOp::Ge;
+    case Op::Eq: return RuleOp::Eq;
+    case Op::Ne: return RuleOp::Ne;
+    case Op::And: return RuleOp::And;
+    case Op::Or: return RuleOp::Or;
+    case Op::Neg: return RuleOp::Neg;
+    case Op::Abs: return RuleOp::Abs;
+    case Op::Not: return RuleOp::Not;
+    default: return std::nullopt;
+    }
+}
+
+std::size_t warmup(const IndicatorSpec& spec) {
+    switch (spec.kind) {
+    case IndicatorKind::Sma:
+    case IndicatorKind::Ema:
+        return spec.period - 1;
+    case IndicatorKind::Rsi:
+        return spec.period;
+    case IndicatorKind::Macd:
+        // Macd reports all three values once the signal line is ready.
+        return spec.slow + spec.signal - 2;
+    default:
+        return 0;
+    }
+}
+
+struct Token {
+    enum Kind { End, Number, Ident, Symbol, Interval } kind = End;
+    std::string_view text;
+    double number = 0.0;
+    std::size_t pos = 0;
+};
+
+} // namespace
+
+// Recursive-descent parser that emits instructions as it goes; identical
+// instructions are looked up rather than emitted twice.
+class RuleCompiler {
+public:
+    explicit RuleCompiler(RuleProgram& program) : program_(program) {}
+
+    std::optional<std::uint32_t> compile(std::string_view name, std::string_view text,
+                                         std::string& error) {
+        text_ = text;
+        pos_ = 0;
+        error_.clear();
+        next();
+        auto root = parse_or();
+        if (root && tok_.kind != Token::End) {
+            fail("unexpected '" + std::string(tok_.text) + "'");
+        }
+        if (!error_.empty()) {
+            error = std::string(name) + ": " + error_;
+            return std::nullopt;
+        }
+        return root;
+    }
+
+    void finish(std::uint32_t buy, std::optional<std::uint32_t> sell) {
+        // No sell rule is a constant false, so the output loop needs no check.
+        const std::uint32_t sell_reg = sell ? *sell : constant(0.0);
+        program_.buy_ = buy;
+        program_.sell_ = sell_reg;
+        program_.lookback_ = std::max(depth_[buy], depth_[sell_reg]);
+    }
+
+private:
+    using Key = std::tuple<Op, std::uint32_t, std::uint32_t, std::uint64_t, std::uint32_t>;
+
+    // --- lexer ---
+
+    void next() {
+        while (pos_ < text_.size() && std::isspace(static_cast<unsigned char>(text_[pos_]))) {
+            ++pos_;
+        }
+        tok_ = Token{};
+        tok_.pos = pos_;
+        if (pos_ >= text_.size()) {
+            return;
+        }
+        const char c = text_[pos_];
+        if (std::isdigit(static_cast<unsigned char>(c)) || c == '.') {
+            const char* begin = text_.data() + pos_;
+            const auto [end, ec] = std::from_chars(begin, text_.data() + text_.size(), tok_.number);
+            if (ec != std::errc()) {
+                fail("bad number");
+                tok_.kind = Token::End;
+                return;
+            }
+            tok_.kind = Token::Number;
+            tok_.text = text_.substr(pos_, static_cast<std::size_t>(end - begin));
+        } else if (std::isalpha(static_cast<unsigned char>(c)) || c == '_') {
+            std::size_t end = pos_;
+            while (end < text_.size() &&
+                   (std::isalnum(static_cast<unsigned char>(text_[end])) || text_[end] == '_')) {
+                ++end;
+            }
+            tok_.kind = Token::Ident;
+            tok_.text = text_.substr(pos_, end - pos_);
+        } else if (c == '@') {
+            std::size_t end = pos_ + 1;
+            while (end < text_.size() && std::isalnum(static_cast<unsigned char>(text_[end]))) {
+                ++end;
+            }
+            tok_.kind = Token::Interval;
+            tok_.text = text_.substr(pos_, end - pos_);
+        } else {
+            static constexpr const char* two[] = {"<=", ">=", "==", "!="};
+            std::size_t len = 1;
+            for (const char* t : two) {
+                if (text_.substr(pos_, 2) == t) {
+                    len = 2;
+                }
+            }
+            tok_.kind = Token::Symbol;
+            tok_.text = text_.substr(pos_, len);
+        }
+        pos_ += tok_.text.size();
+    }
+
+    bool accept(std::string_view text) {
+        if ((tok_.kind == Token::Symbol || tok_.kind == Token::Ident) && tok_.text == text) {
+            next();
+            return true;
+        }
+        return false;
+    }
+
+    bool expect(std::string_view text) {
+        if (accept(text)) {
+            return true;
+        }
+        fail("expected '" + std::string(text) + "'");
+        return false;
+    }
+
+    void fail(const std::string& message) {
+        if (error_.empty()) {
+            error_ = message + " at column " + std::to_string(tok_.pos + 1);
+        }
+    }
+
+    // --- grammar ---
+    // or := and ('or' and)*;  and := not ('and' not)*;  not := 'not' not | cmp
+    // cmp := sum (('<' | '<=' | ...) sum)?;  sum := prod (('+' | '-') prod)*
+    // prod := unary (('*' | '/') unary)*;  unary := '-' unary | primary
+    // primary := number | '(' or ')' | field ['@' interval]
+    //          | name '(' [or (',' or)*] ')' ['@' interval]
+
+    std::optional<std::uint32_t> parse_or() {
+        auto lhs = parse_and();
+        while (lhs && accept("or")) {
+            auto rhs = parse_and();
+            if (!rhs) {
+                return std::nullopt;
+            }
+            lhs = emit(Op::Or, *lhs, *rhs);
+        }
+        return lhs;
+    }
+
+    std::optional<std::uint32_t> parse_and() {
+        auto lhs = parse_not();
+        while (lhs && accept("and")) {
+            auto rhs = parse_not();
+            if (!rhs) {
+                return std::nullopt;
+            }
+            lhs = emit(Op::And, *lhs, *rhs);
+        }
+        return lhs;
+    }
+
+    std::optional<std::uint32_t> parse_not() {
+        if (accept("not")) {
+            auto operand = parse_not();
+            return operand ? std::optional(emit(Op::Not, *operand)) : std::nullopt;
+        }
+        return parse_cmp();
+    }
+
+    std::optional<std::uint32_t> parse_cmp() {
+        auto lhs = parse_sum();
+        if (!lhs) {
+            return std::nullopt;
+        }
+        static constexpr std::pair<std::string_view, Op> ops[] = {
+            {"<", Op::Lt}, {"<=", Op::Le}, {">", Op::Gt}, {">=", Op::Ge}, {"==", Op::Eq}, {"!=", Op::Ne}};
+        for (const auto& [text, op] : ops) {
+            if (tok_.kind == Token::Symbol && tok_.text == text) {
+                next();
+                auto rhs = parse_sum();
+                return rhs ? std::optional(emit(op, *lhs, *rhs)) : std::nullopt;
+            }
+        }
+        return lhs;
+    }
+
+    std::optional<std::uint32_t> parse_sum() {
+        auto lhs = parse_prod();
+        while (lhs) {
+            const Op op = tok_.text == "+" ? Op::Add : tok_.text == "-" ? Op::Sub : Op::Const;
+            if (tok_.kind != Token::Symbol || op == Op::Const) {
+                break;
+            }
+            next();
+            auto rhs = parse_prod();
+            if (!rhs) {
+                return std::nullopt;
+            }
+            lhs = emit(op, *lhs, *rhs);
+        }
+        return lhs;
+    }
+
+    std::optional<std::uint32_t> parse_prod() {
+        auto lhs = parse_unary();
+        while (lhs) {
+            const Op op = tok_.text == "*" ? Op::Mul : tok_.text == "/" ? Op::Div : Op::Const;
+            if (tok_.kind != Token::Symbol || op == Op::Const) {
+                break;
+            }
+            next();
+            auto rhs = parse_unary();
+            if (!rhs) {
+                return std::nullopt;
+            }
+            lhs = emit(op, *lhs, *rhs);
+        }
+        return lhs;
+    }
+
+    std::optional<std::uint32_t> parse_unary() {
+        if (accept("-")) {
+            auto operand = parse_unary();
+            return operand ? std::optional(emit(Op::Neg, *operand)) : std::nullopt;
+        }
+        return parse_primary();
+    }
+
+    std::optional<std::uint32_t> parse_primary() {
+        if (tok_.kind == Token::Number) {
+            const double value = tok_.number;
+            next();
+            return constant(value);
+        }
+        if (accept("(")) {
+            auto inner = parse_or();
+            if (!inner || !expect(")")) {
+                return std::nullopt;
+            }
+            return inner;
+        }
+        if (tok_.kind != Token::Ident) {
+            fail(tok_.kind == Token::End ? "unexpected end of rule"
+                                         : "unexpected '" + std::string(tok_.text) + "'");
+            return std::nullopt;
+        }
+        const std::string name(tok_.text);
+        const std::size_t name_pos = tok_.pos;
+        next();
+        static const std::map<std::string, IndicatorKind, std::less<>> fields = {
+            {"open", IndicatorKind::Open},   {"high", IndicatorKind::High},
+            {"low", IndicatorKind::Low},     {"close", IndicatorKind::Close},
+            {"volume", IndicatorKind::Volume}};
+        if (auto it = fields.find(name); it != fields.end()) {
+            const auto interval = parse_interval();
+            return interval ? std::optional(input(IndicatorSpec::column(it->second),
+                                                  RuleProgram::Output::Values, *interval))
+                            : std::nullopt;
+        }
+        if (!accept("(")) {
+            tok_.pos = name_pos;
+            fail("unknown name '" + name + "'");
+            return std::nullopt;
+        }
+        std::vector<std::uint32_t> args;
+        if (!accept(")")) {
+            do {
+                auto arg = parse_or();
+                if (!arg) {
+                    return std::nullopt;
+                }
+                args.push_back(*arg);
+            } while (accept(","));
+            if (!expect(")")) {
+                return std::nullopt;
+            }
+        }
+        const auto interval = parse_interval();
+        return interval ? call(name, name_pos, args, *interval) : std::nullopt;
+    }
+
+    // The interval of an optional `@interval` suffix; empty without one.
+    std::optional<std::string> parse_interval() {
+        if (tok_.kind != Token::Interval) {
+            return std::string();
+        }
+        std::string interval(tok_.text.substr(1));
+        if (Core::parse_interval(interval).count() <= 0) {
+            fail("unknown interval '" + interval + "'");
+            return std::nullopt;
+        }
+        next();
+        return interval;
+    }
+
+    std::optional<std::uint32_t> call(const std::string& name, std::size_t pos,
+                                      const std::vector<std::uint32_t>& args,
+                                      const std::string& interval) {
+        auto arity = [&](std::size_t n) {
+            if (args.size() != n) {
+                tok_.pos = pos;
+                fail(name + "() takes " + std::to_string(n) + " argument" + (n == 1 ? "" : "s"));
+                return false;
+            }
+            return true;
+        };
+        // Periods must fold to positive integers.
+        auto period = [&](std::uint32_t reg) -> std::optional<std::size_t> {
+            const auto& in = program_.code_[reg];
+            if (in.op != Op::Const || in.imm < 1 || std::floor(in.imm) != in.imm || in.imm > 1e6) {
+                tok_.pos = pos;
+                fail(name + "() needs positive whole-number periods");
+                return std::nullopt;
+            }
+            return static_cast<std::size_t>(in.imm);
+        };
+        const bool indicator = name == "sma" || name == "ema" || name == "rsi" || name == "macd" ||
+                               name == "macd_signal" || name == "macd_hist";
+        if (!interval.empty() && !indicator) {
+            tok_.pos = pos;
+            fail(name + "() takes no interval");
+            return std::nullopt;
+        }
+
+        if (name == "sma" || name == "ema" || name == "rsi") {
+            if (!arity(1)) {
+                return std::nullopt;
+            }
+            const auto p = period(args[0]);
+            if (!p) {
+                return std::nullopt;
+            }
+            const IndicatorSpec spec = name == "sma"   ? IndicatorSpec::sma(*p)
+                                       : name == "ema" ? IndicatorSpec::ema(*p)
+                                                       : IndicatorSpec::rsi(*p);
+            return input(spec, RuleProgram::Output::Values, interval);
+        }
+        if (name == "macd" || name == "macd_signal" || name == "macd_hist") {
+            if (!arity(3)) {
+                return std::nullopt;
+            }
+            const auto fast = period(args[0]);
+            const auto slow = fast ? period(args[1]) : std::nullopt;
+            const auto signal = slow ? period(args[2]) : std::nullopt;
+            if (!signal) {
+                return std::nullopt;
+            }
+            if (*fast >= *slow) {
+                tok_.pos = pos;
+                fail(name + "() needs the fast period below the slow one");
+                return std::nullopt;
+            }
+            const auto output = name == "macd"          ? RuleProgram::Output::Values
+                                : name == "macd_signal" ? RuleProgram::Output::Signal
+                                                        : RuleProgram::Output::Histogram;
+            return input(IndicatorSpec::macd(*fast, *slow, *signal), output, interval);
+        }
+        if (name == "prev") {
+            if (args.empty() || args.size() > 2) {
+                tok_.pos = pos;
+                fail("prev() takes 1 or 2 arguments");
+                return std::nullopt;
+            }
+            std::size_t n = 1;
+            if (args.size() == 2) {
+                const auto p = period(args[1]);
+                if (!p) {
+                    return std::nullopt;
+                }
+                n = *p;
+            }
+            if (depth_[args[0]] + n > kMaxPrev) {
+                tok_.pos = pos;
+                fail("prev() reaches more than " + std::to_string(kMaxPrev) + " bars back");
+                return std::nullopt;
+            }
+            return prev(args[0], n);
+        }
+        if (name == "cross_above" || name == "cross_below") {
+            if (!arity(2)) {
+                return std::nullopt;
+            }
+            const bool above = name == "cross_above";
+            const auto before = emit(above ? Op::Le : Op::Ge, prev(args[0], 1), prev(args[1], 1));
+            const auto now = emit(above ? Op::Gt : Op::Lt, args[0], args[1]);
+            return emit(Op::And, before, now);
+        }
+        if (name == "abs") {
+            return arity(1) ? std::optional(emit(Op::Abs, args[0])) : std::nullopt;
+        }
+        if (name == "min" || name == "max") {
+            return arity(2) ? std::optional(emit(name == "min" ? Op::Min : Op::Max, args[0], args[1]))
+                            : std::nullopt;
+        }
+        tok_.pos = pos;
+        fail("unknown function '" + name + "'");
+        return std::nullopt;
+    }
+
+    // --- emission ---
+
+    std::uint32_t constant(double value) {
+        RuleProgram::Instr in{Op::Const};
+        in.imm = value;
+        return intern(in, 0);
+    }
+
+    std::uint32_t input(const IndicatorSpec& spec, RuleProgram::Output output,
+                        const std::string& interval) {
+        const RuleProgram::Input wanted{spec, output, warmup(spec), interval};
+        auto& inputs = program_.inputs_;
+        auto it = std::find(inputs.begin(), inputs.end(), wanted);
+        RuleProgram::Instr in{Op::Input};
+        in.input = static_cast<std::uint32_t>(it - inputs.begin());
+        if (it == inputs.end()) {
+            inputs.push_back(wanted);
+        }
+        return intern(in, 0);
+    }
+
+    std::uint32_t prev(std::uint32_t a, std::size_t n) {
+        RuleProgram::Instr in{Op::Prev, a};
+        in.imm = static_cast<double>(n);
+        return intern(in, depth_[a] + n);
+    }
+
+    std::uint32_t emit(Op op, std::uint32_t a = 0, std::uint32_t b = 0) {
+        const auto& code = program_.code_;
+        const bool is_unary = unary(op);
+        const bool has_args = scalar_fn(op) != nullptr;
+        if (has_args && code[a].op == Op::Const && (is_unary || code[b].op == Op::Const)) {
+            return constant(scalar_fn(op)(code[a].imm, is_unary ? 0.0 : code[b].imm));
+        }
+        if (commutative(op) && b < a) {
+            std::swap(a, b);
+        }
+        RuleProgram::Instr in{op};
+        std::size_t depth = 0;
+        if (has_args) {
+            in.a = a;
+            depth = depth_[a];
+            if (!is_unary) {
+                in.b = b;
+                depth = std::max(depth, depth_[b]);
+            }
+        }
+        return intern(in, depth);
+    }
+
+    std::uint32_t intern(const RuleProgram::Instr& in, std::size_t depth) {
+        std::uint64_t bits = 0;
+        std::memcpy(&bits, &in.imm, sizeof bits);
+        const Key key{in.op, in.a, in.b, bits, in.input};
+        if (auto it = seen_.find(key); it != seen_.end()) {
+            return it->second;
+        }
+        const auto reg = static_cast<std::uint32_t>(program_.code_.size());
+        program_.code_.push_back(in);
+        depth_.push_back(depth);
+        seen_.emplace(key, reg);
+        return reg;
+    }
+
+    RuleProgram& program_;
+    std::map<Key, std::uint32_t> seen_;
+    std::vector<std::size_t> depth_;
+    std::string_view text_;
+    std::size_t pos_ = 0;
+    Token tok_;
+    std::string error_;
+};
+
+std::shared_ptr<const RuleProgram> RuleProgram::compile(std::string_view buy,
+                                                        std::string_view sell,
+                                                        std::string& error) {
+    auto program = std::make_shared<RuleProgram>();
+    RuleCompiler compiler(*program);
+    const auto buy_reg = compiler.compile("buy", buy, error);
+    if (!buy_reg) {
+        return nullptr;
+    }
+    std::optional<std::uint32_t> sell_reg;
+    if (sell.find_first_not_of(" \t\r\n") != std::string_view::npos) {
+        sell_reg = compiler.compile("sell", sell, error);
+        if (!sell_reg) {
+            return nullptr;
+        }
+    }
+    compiler.finish(*buy_reg, sell_reg);
+    return program;
+}
+
+void RuleProgram::run(const SeriesView& view, std::size_t from, std::span<int> out) const {
+    const std::size_t n = std::min(view.candles.size(), out.size());
+    if (from >= n) {
+        return;
+    }
+    std::vector<std::shared_ptr<const IndicatorSeries>> held;
+    std::vector<const double*> columns;
+    // Per input from another interval: the index of its candle for each of
+    // ours; nullptr when it is not in the view (the input stays unknown).
+    // The view's own interval, from its id, needs no alignment.
+    const auto bar = view.id.find('|');
+    const std::string_view own = bar == std::string_view::npos ? std::string_view() : view.id.substr(bar + 1);
+    std::vector<bool> other(inputs_.size(), false);
+    std::vector<const std::int32_t*> aligned(inputs_.size(), nullptr);
+    held.reserve(inputs_.size());
+    columns.reserve(inputs_.size());
+    for (std::size_t k = 0; k < inputs_.size(); ++k) {
+        const Input& in = inputs_[k];
+        const Core::AlignedSeries* frame = nullptr;
+        other[k] = !in.interval.empty() && in.interval != own;
+        if (other[k]) {
+            frame = view_timeframe(view, in.interval);
+            // Indices are non-decreasing, so the last one bounds them all.
+            if (frame && frame->aligned.size() >= n &&
+                frame->aligned[n - 1] < static_cast<std::int64_t>(frame->candles->size())) {
+                aligned[k] = frame->aligned.data();
+            }
+        }
+        if (!other[k]) {
+            held.push_back(view_indicator(view, in.spec));
+        } else if (aligned[k]) {
+            held.push_back(timeframe_indicator(view, *frame, in.spec));
+        } else {
+            held.push_back(std::make_shared<const IndicatorSeries>());
+        }
+        const auto& series = *held.back();
+        columns.push_back(in.output == Output::Signal      ? series.signal.data()
+                          : in.output == Output::Histogram ? series.histogram.data()
+                                                           : series.values.data());
+    }
+
+    // Register r holds [lookback_ values before the block | the block].
+    const std::size_t stride = lookback_ + kBlock;
+    std::vector<double> regs(code_.size() * stride, kUnknown);
+    auto reg = [&](std::uint32_t r) { return regs.data() + r * stride + lookback_; };
+    for (std::uint32_t r = 0; r < code_.size(); ++r) {
+        if (code_[r].op == Op::Const) {
+            std::fill_n(regs.data() + r * stride, stride, code_[r].imm);
+        }
+    }
+
+    // Where each instruction's values for the block are read from: its
+    // register; for an input past its warm-up (and lookback) the column
+    // itself; for prev(x, d) x's values shifted by d, which the history
+    // before each block provides.
+    std::vector<const double*> src(code_.size());
+    for (std::uint32_t r = 0; r < code_.size(); ++r) {
+        src[r] = reg(r);
+    }
+
+    const bool avx2 = kernel_isa() == KernelIsa::Avx2;
+    const std::size_t start = from > lookback_ ? from - lookback_ : 0;
+    for (std::size_t base = start; base < n; base += kBlock) {
+        const std::size_t len = std::min(kBlock, n - base);
+        for (std::uint32_t r = 0; r < code_.size(); ++r) {
+            const Instr& in = code_[r];
+            double* dst = reg(r);
+            const double* a = src[in.a];
+            const double* b = src[in.b];
+            switch (in.op) {
+            case Op::Const:
+                break;
+            case Op::Input: {
+                const std::size_t ready = inputs_[in.input].warmup;
+                const double* column = columns[in.input];
+                if (other[in.input]) {
+                    // Gathered through the alignment; kNone and the other
+                    // interval's warm-up are unknown.
+                    const std::int32_t* index = aligned[in.input];
+                    for (std::size_t i = 0; i < len; ++i) {
+                        const std::int32_t k = index ? index[base + i] : Core::TimeframeAlignment::kNone;
+                        dst[i] = k >= 0 && static_cast<std::size_t>(k) >= ready ? column[k] : kUnknown;
+                    }
+                    break;
+                }
+                if (base >= ready + lookback_) {
+                    src[r] = column + base;
+                    break;
+                }
+                const std::size_t unknown = ready > base ? std::min(ready - base, len) : 0;
+                std::fill_n(dst, unknown, kUnknown);
+                std::copy(column + base + unknown, column + base + len, dst + unknown);
+                break;
+            }
+            case Op::Prev:
+                src[r] = a - static_cast<std::ptrdiff_t>(in.imm);
+                break;
+            default: {
+                const RuleOp op = *block_op(in.op);
+                avx2 ? kernels::avx2::rule_op(op, a, b, dst, len) : scalar_block(op, a, b, dst, len);
+                break;
+            }
+            }
+        }
+
+        const double* buy = src[buy_];
+        const double* sell = src[sell_];
+        const std::size_t skip = base < from ? from - base : 0;
+        avx2 ? kernels::avx2::rule_signals(buy + skip, sell + skip, out.data() + base + skip, len - skip)
+             : scalar_signals(buy + skip, sell + skip, out.data() + base + skip, len - skip);
+
+        // Keep the tail of each computed register for prev() in the next
+        // block.
+        for (std::uint32_t r = 0; r < code_.size(); ++r) {
+            if (lookback_ > 0 && src[r] == reg(r) && code_[r].op != Op::Const) {
+                double* row = regs.data() + r * stride;
+                std::memmove(row, row + len, lookback_ * sizeof(double));
+            }
+        }
+    }
+}
+
+} // namespace Signal
@@ -0,0 +1,122 @@
+#pragma once
+
+#include "indicator_cache.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Signal {
+
+struct SeriesView;
+
+// Strategy rules written as expressions, e.g.
+//
+//   buy:  rsi(14) < 30 and close > ema(200)
+//   sell: cross_below(sma(10), sma(50)) or rsi(14) > 70
+//
+// Values: numbers, open/high/low/close/volume, sma(n), ema(n), rsi(n),
+// macd(f, s, g), macd_signal(f, s, g), macd_hist(f, s, g) (all on close),
+// + - * / and unary -, abs(x), min(a, b), max(a, b), prev(x) / prev(x, n)
+// (the value n bars back). Conditions: < <= > >= == !=, and, or, not,
+// cross_above(a, b) and cross_below(a, b) (a crossing b on this bar).
+//
+// An indicator that is not ready yet, or a bar before the first, is
+// unknown (NaN); comparisons with an unknown are unknown, and/or/not follow
+// three-valued logic, and only a condition that is definitely true fires.
+// So rules stay silent during warm-up, like the built-in strategies.
+//
+// A field or indicator may name another interval of the pair, e.g.
+// `close@1h > ema(200)@1h`: its value on a bar is the one of the last
+// higher-interval candle closed by then (SeriesView::timeframes), so a rule
+// never looks ahead. Without that interval in the view it is unknown.
+// prev() always counts bars of the evaluated series.
+//
+// Both rules are compiled together into one program: identical
+// subexpressions become one instruction (rsi(14) above is computed once),
+// constant parts are folded, and the instructions run over blocks of bars,
+// one column at a time. A bar's signal is 1 when `buy` holds, else -1 when
+// `sell` holds, else 0.
+class RuleProgram {
+public:
+    enum class Op : std::uint8_t {
+        Const,
+        Input,  // column inputs()[input]: an indicator or candle field
+        Add,
+        Sub,
+        Mul,
+        Div,
+        Neg,
+        Abs,
+        Min,
+        Max,
+        Lt,
+        Le,
+        Gt,
+        Ge,
+        Eq,
+        Ne,
+        And,
+        Or,
+        Not,
+        Prev,  // a `imm` bars back
+    };
+
+    // One instruction; its result is register `index in code()`. Operands
+    // refer to earlier registers.
+    struct Instr {
+        Op op;
+        std::uint32_t a = 0;
+        std::uint32_t b = 0;
+        double imm = 0.0;  // Const value, Prev distance
+        std::uint32_t input = 0;
+    };
+
+    enum class Output : std::uint8_t { Values, Signal, Histogram };
+
+    // A column the program reads from the IndicatorCache. Candle fields are
+    // columns too, so a parameter sweep over one series reads contiguous,
+    // shared data.
+    struct Input {
+        IndicatorSpec spec;
+        Output output = Output::Values;
+        // Bars before this index are unknown.
+        std::size_t warmup = 0;
+        // Empty for the evaluated candles, else the aligned interval.
+        std::string interval;
+        bool operator==(const Input&) const = default;
+    };
+
+    static constexpr std::size_t kBlock = 512;
+
+    // Parses and compiles the rules; an empty `sell` never fires. Returns
+    // nullptr and sets `error` (with the offending position) on failure.
+    [[nodiscard]] static std::shared_ptr<const RuleProgram> compile(std::string_view buy,
+                                                                    std::string_view sell,
+                                                                    std::string& error);
+
+    // Signals for bars [from, size) written to out (up to out.size());
+    // earlier elements are untouched. Only lookback() bars before `from`
+    // are re-evaluated, so live updates cost the new bars.
+    void run(const SeriesView& view, std::size_t from, std::span<int> out) const;
+
+    [[nodiscard]] const std::vector<Instr>& code() const noexcept { return code_; }
+    [[nodiscard]] const std::vector<Input>& inputs() const noexcept { return inputs_; }
+    // Deepest chain of prev() distances (at most 4096); bars needed before
+    // the first evaluated one.
+    [[nodiscard]] std::size_t lookback() const noexcept { return lookback_; }
+
+private:
+    friend class RuleCompiler;
+
+    std::vector<Instr> code_;
+    std::vector<Input> inputs_;
+    std::uint32_t buy_ = 0;
+    std::uint32_t sell_ = 0;
+    std::size_t lookback_ = 0;
+};
+
+} // namespace Signal
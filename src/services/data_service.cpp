@@ -1,6 +1,7 @@
 #include "services/data_service.h"
 
 #include "config_manager.h"
+#include "core/backfill_planner.h"
 #include "config_path.h"
 #include "core/data_dir.h"
 #include "core/candle_manager.h"
@@ -8,54 +9,189 @@
 #include "core/exchange_utils.h"
 #include "core/interval_utils.h"
 #include "core/logger.h"
-#include "core/candle_utils.h"
+#include "core/market_data_recorder.h"
 #include "core/net/binance_data_provider.h"
 #include "core/net/hyperliquid_data_provider.h"
+#include "core/net/recording_http_client.h"
+#include "core/net/replay_http_client.h"
 
 #include <algorithm>
 #include <chrono>
 #include <cctype>
+#include <condition_variable>
+#include <cstdlib>
 #include <map>
+#include <mutex>
 #include <nlohmann/json.hpp>
 #include <thread>
 
 namespace {
 constexpr const char *kDefaultProvider = "Hyperliquid";
+// Bounds for the hedge trigger derived from the primary's p95 latency.
+constexpr std::chrono::milliseconds kHedgeMinDelay{150};
+constexpr std::chrono::milliseconds kHedgeMaxDelay{5000};
+constexpr std::size_t kHedgeSymbolsTopN = 1000;
+// Backfill range requests in flight at once (the rate limiter still paces them).
+constexpr std::size_t kBackfillParallelism = 4;
+// Venues publish the newest bars with a delay, so an empty answer only counts
+// for bars that closed at least this long ago.
+constexpr long long kEmptyRangeGraceMs = 15 * 60'000;
+// Empty ranges remembered per series (newest kept).
+constexpr std::size_t kMaxEmptyRanges = 1024;
+
+// CANDLE_HTTP_REPLAY=<fixture> serves recorded responses instead of the
+// network; CANDLE_HTTP_RECORD=<fixture> records live traffic into one. A
+// market-data recording (CANDLE_MARKET_RECORD/_REPLAY) carries the HTTP
+// exchanges alongside the WebSocket frames and takes precedence.
+std::shared_ptr<Core::IHttpClient> make_http_client() {
+  if (auto replayer = Core::session_market_replayer()) {
+    Core::ReplayHttpClient::Options options;
+    options.simulate_latency = replayer->speed() > 0;
+    options.latency_scale = options.simulate_latency ? 1.0 / replayer->speed() : 1.0;
+    auto client = std::make_shared<Core::ReplayHttpClient>(options);
+    for (const auto &exchange : replayer->http_exchanges())
+      client->add(exchange);
+    return client;
+  }
+  if (const char *replay = std::getenv("CANDLE_HTTP_REPLAY")) {
+    auto client = std::make_shared<Core::ReplayHttpClient>();
+    const auto n = client->load(replay);
+    Core::Logger::instance().info("Replaying " + std::to_string(n) +
+                                  " HTTP exchanges from " + replay);
+    return client;
+  }
+  std::shared_ptr<Core::IHttpClient> client = std::make_shared<Core::CprHttpClient>();
+  if (auto recorder = Core::session_market_recorder())
+    return std::make_shared<Core::RecordingHttpClient>(client, recorder);
+  if (const char *record = std::getenv("CANDLE_HTTP_RECORD")) {
+    Core::Logger::instance().info(std::string("Recording HTTP exchanges to ") + record);
+    client = std::make_shared<Core::RecordingHttpClient>(client, record);
+  }
+  return client;
+}
+
+// "BTCUSDT", "btcusd" and "BTC" all map to "BTC".
+std::string symbol_base(const std::string &symbol) {
+  std::string s;
+  s.reserve(symbol.size());
+  for (unsigned char c : symbol)
+    s.push_back(static_cast<char>(std::toupper(c)));
+  auto strip = [&](const char *suffix) {
+    const std::size_t n = std::char_traits<char>::length(suffix);
+    if (s.size() > n && s.compare(s.size() - n, n, suffix) == 0) {
+      s.resize(s.size() - n);
+      return true;
+    }
+    return false;
+  };
+  if (!strip("USDT"))
+    strip("USD");
+  return s;
+}
+
+std::vector<Core::BackfillRange> ranges_from_json(const nlohmann::json &value) {
+  std::vector<Core::BackfillRange> out;
+  if (!value.is_array())
+    return out;
+  for (const auto &r : value) {
+    if (r.is_array() && r.size() == 2 && r[0].is_number_integer() &&
+        r[1].is_number_integer())
+      out.push_back({r[0].get<long long>(), r[1].get<long long>(), 0});
+  }
+  return out;
+}
+
+nlohmann::json ranges_to_json(const std::vector<Core::BackfillRange> &ranges) {
+  nlohmann::json out = nlohmann::json::array();
+  for (const auto &r : ranges)
+    out.push_back({r.start_ms, r.end_ms});
+  return out;
+}
+
+// Sorts and joins overlapping or adjacent ranges.
+void coalesce_ranges(std::vector<Core::BackfillRange> &ranges, long long step) {
+  std::sort(ranges.begin(), ranges.end(),
+            [](const auto &a, const auto &b) { return a.start_ms < b.start_ms; });
+  std::vector<Core::BackfillRange> out;
+  for (const auto &r : ranges) {
+    if (!out.empty() && r.start_ms <= out.back().end_ms + step)
+      out.back().end_ms = std::max(out.back().end_ms, r.end_ms);
+    else
+      out.push_back(r);
+  }
+  if (out.size() > kMaxEmptyRanges)
+    out.erase(out.begin(), out.end() - static_cast<std::ptrdiff_t>(kMaxEmptyRanges));
+  ranges = std::move(out);
+}
+
+// Metadata cache entry holding a hedge provider's symbol list.
+std::string hedge_symbols_key(const std::string &provider_key) {
+  return provider_key + "|symbols|hedge";
+}
 }
 
 DataService::DataService()
-    : http_client_(std::make_shared<Core::CprHttpClient>()),
+    : http_client_(make_http_client()),
       rate_limiter_(std::make_shared<Core::TokenBucketRateLimiter>(
           1, std::chrono::milliseconds(1100))),
-      candle_manager_(Core::resolve_data_dir()) {
+      candle_manager_(Core::resolve_data_dir()),
+      metadata_cache_(std::make_shared<Core::MetadataCache>(
+          candle_manager_.get_data_dir() / "metadata_cache.json")) {
   persist_allowed_after_ = std::chrono::steady_clock::now() + std::chrono::seconds(3);
   // Binance disabled per pivot to Hyperliquid-only
-  // register_provider("Binance", std::make_shared<Core::BinanceDataProvider>(http_client_, rate_limiter_));
-  register_provider("Hyperliquid", std::make_shared<Core::HyperliquidDataProvider>(http_client_, rate_limiter_));
+  // auto binance = std::make_shared<Core::BinanceDataProvider>(http_client_, rate_limiter_);
+  // binance->set_metadata_cache(metadata_cache_);
+  // if (const char *url = std::getenv("CANDLE_BINANCE_BASE_URL")) binance->set_base_url(url);
+  // register_provider("Binance", binance);
+  auto hyperliquid = std::make_shared<Core::HyperliquidDataProvider>(http_client_, rate_limiter_);
+  if (const char *url = std::getenv("CANDLE_HYPERLIQUID_BASE_URL"))
+    hyperliquid->set_base_url(url);
+  register_provider("Hyperliquid", hyperliquid);
   if (!set_active_provider(kDefaultProvider)) {
     Core::Logger::instance().error("Default provider 'Hyperliquid' is not registered");
   }
   apply_configured_provider();
+  log_failover_status();
+  prefetch_hedge_symbols();
 }
 
 DataService::DataService(const std::filesystem::path &data_dir)
-    : http_client_(std::make_shared<Core::CprHttpClient>()),
+    : http_client_(make_http_client()),
       rate_limiter_(std::make_shared<Core::TokenBucketRateLimiter>(
           1, std::chrono::milliseconds(1100))),
-      candle_manager_(data_dir) {
+      candle_manager_(data_dir),
+      metadata_cache_(std::make_shared<Core::MetadataCache>(
+          candle_manager_.get_data_dir() / "metadata_cache.json")) {
   persist_allowed_after_ = std::chrono::steady_clock::now() + std::chrono::seconds(3);
   // Binance disabled per pivot to Hyperliquid-only
-  // register_provider("Binance", std::make_shared<Core::BinanceDataProvider>(http_client_, rate_limiter_));
-  register_provider("Hyperliquid", std::make_shared<Core::HyperliquidDataProvider>(http_client_, rate_limiter_));
+  // auto binance = std::make_shared<Core::BinanceDataProvider>(http_client_, rate_limiter_);
+  // binance->set_metadata_cache(metadata_cache_);
+  // if (const char *url = std::getenv("CANDLE_BINANCE_BASE_URL")) binance->set_base_url(url);
+  // register_provider("Binance", binance);
+  auto hyperliquid = std::make_shared<Core::HyperliquidDataProvider>(http_client_, rate_limiter_);
+  if (const char *url = std::getenv("CANDLE_HYPERLIQUID_BASE_URL"))
+    hyperliquid->set_base_url(url);
+  register_provider("Hyperliquid", hyperliquid);
   if (!set_active_provider(kDefaultProvider)) {
     Core::Logger::instance().error("Default provider 'Hyperliquid' is not registered");
   }
   apply_configured_provider();
+  log_failover_status();
+  prefetch_hedge_symbols();
 }
 
-void DataService::register_provider(const std::string &name, std::shared_ptr<Core::IDataProvider> provider) {
+void DataService::register_provider(const std::string &name, std::shared_ptr<Core::IDataProvider> provider,
+                                    Core::ProviderHealth::Options health_options) {
   const auto key = normalize_provider_name(name);
-  providers_[key] = ProviderRecord{name, std::move(provider)};
+  providers_[key] = ProviderRecord{name, std::move(provider),
+                                   std::make_shared<Core::ProviderHealth>(health_options)};
+}
+
+void DataService::set_config(const Config::ConfigData &cfg) {
+  config_cache_ = cfg;
+  apply_configured_provider();
+  log_failover_status();
+  prefetch_hedge_symbols();
 }
 
 bool DataService::set_active_provider(const std::string &name) {
@@ -84,23 +220,74 @@ std::string DataService::get_active_provider_name() const {
   return std::string();
 }
 
+std::map<std::string, Core::ProviderHealth::Snapshot>
+DataService::provider_health() const {
+  std::map<std::string, Core::ProviderHealth::Snapshot> out;
+  for (const auto &entry : providers_) {
+    if (entry.second.health)
+      out[entry.second.display_name] = entry.second.health->snapshot();
+  }
+  return out;
+}
+
+void DataService::set_on_provider_recovered(RecoveryHook hook) {
+  on_provider_recovered_ = std::make_shared<const RecoveryHook>(std::move(hook));
+}
+
 Core::SymbolsResult
 DataService::fetch_all_symbols(int max_retries,
                                std::chrono::milliseconds retry_delay,
                                std::size_t top_n) const {
-  if (const auto *record = active_provider_record()) {
-    return record->provider->fetch_all_symbols(max_retries, retry_delay, top_n);
+  const auto *record = active_provider_record();
+  if (!record) {
+    return {Core::FetchError::NetworkError, 0, "No active provider", {}};
+  }
+  const std::string key =
+      *active_provider_key_ + "|symbols|" + std::to_string(top_n);
+  const auto cached = metadata_cache_->get(key);
+  if (cached && Core::MetadataCache::is_fresh(
+                    *cached, std::chrono::seconds(config().symbols_cache_ttl_s))) {
+    return {Core::FetchError::None, 200, "",
+            Core::MetadataCache::to_strings(cached->value)};
   }
-  return {Core::FetchError::NetworkError, 0, "No active provider", {}};
+  auto res = record->provider->fetch_all_symbols(max_retries, retry_delay, top_n);
+  if (res.error == Core::FetchError::None && !res.symbols.empty()) {
+    metadata_cache_->put(key, {Core::MetadataCache::from_strings(res.symbols), 0, {}, {}});
+    metadata_cache_->save();
+  } else if (cached) {
+    Core::Logger::instance().warn("Symbol refresh failed (" + res.message +
+                                  "); using cached list");
+    return {Core::FetchError::None, res.http_status, "stale",
+            Core::MetadataCache::to_strings(cached->value)};
+  }
+  return res;
 }
 
 Core::IntervalsResult
 DataService::fetch_intervals(int max_retries,
                              std::chrono::milliseconds retry_delay) const {
-  if (const auto *record = active_provider_record()) {
-    return record->provider->fetch_intervals(max_retries, retry_delay);
+  const auto *record = active_provider_record();
+  if (!record) {
+    return {Core::FetchError::NetworkError, 0, "No active provider", {}};
+  }
+  const std::string key = *active_provider_key_ + "|intervals";
+  const auto cached = metadata_cache_->get(key);
+  if (cached && Core::MetadataCache::is_fresh(
+                    *cached, std::chrono::seconds(config().intervals_cache_ttl_s))) {
+    return {Core::FetchError::None, 200, "",
+            Core::MetadataCache::to_strings(cached->value)};
+  }
+  auto res = record->provider->fetch_intervals(max_retries, retry_delay);
+  if (res.error == Core::FetchError::None && !res.intervals.empty()) {
+    metadata_cache_->put(key, {Core::MetadataCache::from_strings(res.intervals), 0, {}, {}});
+    metadata_cache_->save();
+  } else if (cached) {
+    Core::Logger::instance().warn("Interval refresh failed (" + res.message +
+                                  "); using cached list");
+    return {Core::FetchError::None, res.http_status, "stale",
+            Core::MetadataCache::to_strings(cached->value)};
   }
-  return {Core::FetchError::NetworkError, 0, "No active provider", {}};
+  return res;
 }
 
 const Config::ConfigData &DataService::config() const {
@@ -112,24 +299,243 @@ const Config::ConfigData &DataService::config() const {
   return *config_cache_;
 }
 
+Core::KlinesResult DataService::timed_fetch(
+    const ProviderRecord &record, const KlinesCall &call, int max_retries,
+    const std::shared_ptr<const RecoveryHook> &on_recovered) {
+  const auto started = std::chrono::steady_clock::now();
+  auto res = call(*record.provider, max_retries);
+  const auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+      std::chrono::steady_clock::now() - started);
+  if (record.health) {
+    const auto before = record.health->state();
+    if (Core::ProviderHealth::is_provider_failure(res.error, res.http_status))
+      record.health->record_failure(elapsed);
+    else
+      record.health->record_success(elapsed);
+    const auto after = record.health->state();
+    if (before != after) {
+      Core::Logger::instance().warn("Provider '" + record.display_name +
+                                    "' circuit " + Core::to_string(before) +
+                                    " -> " + Core::to_string(after));
+      if (after == Core::CircuitState::Closed && on_recovered && *on_recovered)
+        (*on_recovered)(record.display_name);
+    }
+  }
+  return res;
+}
+
+Core::KlinesResult DataService::fetch_with_failover(const KlinesCall &call,
+                                                    int max_retries) const {
+  const auto *primary = active_provider_record();
+  if (!primary) {
+    return {Core::FetchError::NetworkError, 0, "No active provider", {}};
+  }
+  const auto *fallback = fallback_provider_record();
+  std::optional<Core::KlinesResult> primary_failure;
+  if (!primary->health || primary->health->allow_request()) {
+    // With a fallback available, do not burn the full retry budget on the
+    // primary: one attempt, then hand over.
+    auto res = timed_fetch(*primary, call,
+                           fallback ? std::min(max_retries, 1) : max_retries,
+                           on_provider_recovered_);
+    if (res.error == Core::FetchError::None || !fallback ||
+        !Core::ProviderHealth::is_provider_failure(res.error, res.http_status)) {
+      return res;
+    }
+    Core::Logger::instance().warn("Provider '" + primary->display_name +
+                                  "' failed (" + res.message + "); trying '" +
+                                  fallback->display_name + "'");
+    primary_failure = std::move(res);
+  } else if (!fallback) {
+    // Nothing was sent, so callers must not count this as a failed attempt;
+    // asking again after the cooldown makes the circuit's probe.
+    return {Core::FetchError::CircuitOpen, 0,
+            "Provider '" + primary->display_name + "' circuit open", {}};
+  }
+  if (!fallback->health || fallback->health->allow_request()) {
+    return timed_fetch(*fallback, call, max_retries, on_provider_recovered_);
+  }
+  if (primary_failure)
+    return *primary_failure;
+  return {Core::FetchError::CircuitOpen, 0, "All providers unavailable", {}};
+}
+
 Core::KlinesResult DataService::fetch_klines(
     const std::string &symbol, const std::string &interval, int limit,
     int max_retries, std::chrono::milliseconds retry_delay) const {
-  if (const auto *record = active_provider_record()) {
-    return record->provider->fetch_klines(symbol, interval, limit, max_retries, retry_delay);
-  }
-  return {Core::FetchError::NetworkError, 0, "No active provider", {}};
+  return fetch_with_failover(
+      [&](const Core::IDataProvider &provider, int retries) {
+        return provider.fetch_klines(symbol, interval, limit, retries, retry_delay);
+      },
+      max_retries);
 }
 
 Core::KlinesResult DataService::fetch_range(
     const std::string &symbol, const std::string &interval, long long start_ms,
     long long end_ms, int max_retries,
     std::chrono::milliseconds retry_delay) const {
-  if (const auto *record = active_provider_record()) {
-    return record->provider
-        ->fetch_range(symbol, interval, start_ms, end_ms, max_retries, retry_delay);
+  return fetch_with_failover(
+      [&](const Core::IDataProvider &provider, int retries) {
+        return provider.fetch_range(symbol, interval, start_ms, end_ms, retries,
+                                    retry_delay);
+      },
+      max_retries);
+}
+
+const DataService::ProviderRecord *DataService::hedge_provider_record() const {
+  if (const auto *fallback = fallback_provider_record())
+    return fallback;
+  for (const auto &entry : providers_) {
+    if (active_provider_key_ && entry.first == *active_provider_key_)
+      continue;
+    if (entry.second.provider &&
+        (!entry.second.health ||
+         entry.second.health->state() == Core::CircuitState::Closed))
+      return &entry.second;
   }
-  return {Core::FetchError::NetworkError, 0, "No active provider", {}};
+  return nullptr;
+}
+
+bool DataService::provider_lists_symbol(const ProviderRecord &record,
+                                        const std::string &symbol) const {
+  const auto cached =
+      metadata_cache_->get(hedge_symbols_key(normalize_provider_name(record.display_name)));
+  if (!cached)
+    return false;
+  const auto symbols = Core::MetadataCache::to_strings(cached->value);
+  const auto base = symbol_base(symbol);
+  return std::any_of(symbols.begin(), symbols.end(),
+                     [&](const std::string &s) { return symbol_base(s) == base; });
+}
+
+void DataService::prefetch_hedge_symbols() const {
+  const auto *secondary = hedge_provider_record();
+  if (!config().hedge_requests || !secondary)
+    return;
+  const auto key = hedge_symbols_key(normalize_provider_name(secondary->display_name));
+  const auto cached = metadata_cache_->get(key);
+  if (cached && Core::MetadataCache::is_fresh(
+                    *cached, std::chrono::seconds(config().symbols_cache_ttl_s)))
+    return;
+  if (hedge_symbols_refreshing_->exchange(true))
+    return;
+  // Owns everything it touches, so it may outlive the service.
+  std::thread([provider = secondary->provider, cache = metadata_cache_,
+               busy = hedge_symbols_refreshing_, key,
+               name = secondary->display_name]() {
+    auto res = provider->fetch_all_symbols(1, std::chrono::milliseconds(0),
+                                           kHedgeSymbolsTopN);
+    if (res.error == Core::FetchError::None && !res.symbols.empty()) {
+      cache->put(key, {Core::MetadataCache::from_strings(res.symbols), 0, {}, {}});
+      cache->save();
+    } else {
+      Core::Logger::instance().warn("Hedge symbol refresh for '" + name +
+                                    "' failed (" + res.message + ")");
+    }
+    *busy = false;
+  }).detach();
+}
+
+Core::KlinesResult DataService::fetch_range_hedged(
+    const std::string &symbol, const std::string &interval, long long start_ms,
+    long long end_ms, int max_retries,
+    std::chrono::milliseconds retry_delay) const {
+  const auto *primary = active_provider_record();
+  const auto *secondary = hedge_provider_record();
+  // Outside the happy path the regular failover logic is the better tool.
+  if (!config().hedge_requests || !primary || !secondary || !primary->health ||
+      primary->health->state() != Core::CircuitState::Closed) {
+    return fetch_range(symbol, interval, start_ms, end_ms, max_retries, retry_delay);
+  }
+  prefetch_hedge_symbols();
+
+  // Shared with the worker threads, which may outlive this call: the
+  // HTTP client cannot abort an in-flight request, so the loser runs to
+  // completion in the background and its answer is dropped.
+  struct Race {
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::optional<Core::KlinesResult> winner;
+    std::optional<Core::KlinesResult> last_failure;
+    int outstanding{0};
+    bool hedge_won{false};
+  };
+  auto race = std::make_shared<Race>();
+  auto call = std::make_shared<KlinesCall>(
+      [symbol, interval, start_ms, end_ms, retry_delay](
+          const Core::IDataProvider &provider, int retries) {
+        return provider.fetch_range(symbol, interval, start_ms, end_ms, retries,
+                                    retry_delay);
+      });
+  auto launch = [race, call, on_recovered = on_provider_recovered_,
+                 requests = hedged_requests_](ProviderRecord record, int retries,
+                                              bool is_hedge) {
+    {
+      std::lock_guard<std::mutex> lock(race->mutex);
+      ++race->outstanding;
+    }
+    {
+      std::lock_guard<std::mutex> lock(requests->mutex);
+      ++requests->running;
+    }
+    std::thread([race, call, on_recovered, requests, record = std::move(record),
+                 retries, is_hedge]() {
+      auto res = timed_fetch(record, *call, retries, on_recovered);
+      {
+        std::lock_guard<std::mutex> lock(race->mutex);
+        --race->outstanding;
+        if (!race->winner) {
+          if (res.error == Core::FetchError::None) {
+            race->winner = std::move(res);
+            race->hedge_won = is_hedge;
+          } else {
+            race->last_failure = std::move(res);
+          }
+        }
+        race->cv.notify_all();
+      }
+      std::lock_guard<std::mutex> lock(requests->mutex);
+      --requests->running;
+      requests->cv.notify_all();
+    }).detach();
+  };
+  auto settled = [&race]() { return race->winner || race->outstanding == 0; };
+  auto outcome = [&race]() -> Core::KlinesResult {
+    if (race->winner)
+      return *race->winner;
+    if (race->last_failure)
+      return *race->last_failure;
+    return {Core::FetchError::NetworkError, 0, "Hedged fetch failed", {}};
+  };
+
+  launch(*primary, max_retries, false);
+  const auto delay = std::clamp(
+      primary->health->latency_quantile(0.95).value_or(kHedgeMaxDelay),
+      kHedgeMinDelay, kHedgeMaxDelay);
+  {
+    std::unique_lock<std::mutex> lock(race->mutex);
+    if (race->cv.wait_for(lock, delay, settled) && race->winner)
+      return *race->winner;
+  }
+
+  if (!provider_lists_symbol(*secondary, symbol) ||
+      (secondary->health && !secondary->health->allow_request())) {
+    std::unique_lock<std::mutex> lock(race->mutex);
+    race->cv.wait(lock, settled);
+    return outcome();
+  }
+  ++hedges_issued_;
+  launch(*secondary, 1, true);
+  std::unique_lock<std::mutex> lock(race->mutex);
+  race->cv.wait(lock, settled);
+  if (race->winner && race->hedge_won)
+    ++hedges_won_;
+  return outcome();
+}
+
+void DataService::wait_for_hedged_requests() const {
+  std::unique_lock<std::mutex> lock(hedged_requests_->mutex);
+  hedged_requests_->cv.wait(lock, [this]() { return hedged_requests_->running == 0; });
 }
 
 std::future<Core::KlinesResult> DataService::fetch_klines_async(
@@ -151,6 +557,17 @@ const DataService::ProviderRecord *DataService::active_provider_record() const {
   return &it->second;
 }
 
+const DataService::ProviderRecord *DataService::fallback_provider_record() const {
+  if (!fallback_provider_key_ || fallback_provider_key_ == active_provider_key_) {
+    return nullptr;
+  }
+  auto it = providers_.find(*fallback_provider_key_);
+  if (it == providers_.end() || !it->second.provider) {
+    return nullptr;
+  }
+  return &it->second;
+}
+
 std::string DataService::normalize_provider_name(const std::string &name) {
   std::string normalized;
   normalized.reserve(name.size());
@@ -162,6 +579,14 @@ std::string DataService::normalize_provider_name(const std::string &name) {
 
 void DataService::apply_configured_provider() {
   const auto &cfg = config();
+  // Remembered for runtime failover; fallback_provider_record() ignores it
+  // while it matches the active provider.
+  fallback_provider_key_.reset();
+  if (cfg.fallback_provider) {
+    const auto key = normalize_provider_name(*cfg.fallback_provider);
+    if (providers_.count(key))
+      fallback_provider_key_ = key;
+  }
   const std::string requested = cfg.primary_provider;
   if (!requested.empty() && set_active_provider(requested)) {
     return;
@@ -190,6 +615,31 @@ void DataService::apply_configured_provider() {
   }
 }
 
+void DataService::log_failover_status() const {
+  const auto *active = active_provider_record();
+  if (!active)
+    return;
+  if (config().hedge_requests && !hedge_provider_record()) {
+    Core::Logger::instance().warn(
+        "hedge_requests is set but no secondary provider is registered; "
+        "requests are not hedged");
+  }
+  if (fallback_provider_record())
+    return;
+  // Only Hyperliquid is registered in the shipped build, so unless another
+  // provider is added the circuit breaker can only fail fast.
+  const auto &cfg = config();
+  if (cfg.fallback_provider && !cfg.fallback_provider->empty() &&
+      normalize_provider_name(*cfg.fallback_provider) != *active_provider_key_) {
+    Core::Logger::instance().warn("Fallback provider '" + *cfg.fallback_provider +
+                                  "' is not registered; provider failover is inactive");
+  } else {
+    Core::Logger::instance().info("No fallback provider registered; requests to '" +
+                                  active->display_name +
+                                  "' wait while its circuit is open");
+  }
+}
+
 std::vector<Core::Candle>
 DataService::load_candles(const std::string &pair,
                           const std::string &interval) const {
@@ -255,27 +705,122 @@ bool DataService::reload_candles(const std::string &pair, const std::string &int
   return false;
 }
 
+DataService::BackfillReport DataService::backfill(
+    const std::string &pair, const std::string &interval,
+    std::vector<Core::Candle> &candles, long long window_start_ms,
+    long long window_end_ms) const {
+  BackfillReport report;
+  const auto interval_ms = Core::parse_interval(interval).count();
+  const auto *record = active_provider_record();
+  if (interval_ms <= 0 || !record) {
+    return report;
+  }
+
+  // Ranges this provider already answered without candles for the series.
+  const std::string empty_key =
+      *active_provider_key_ + "|empty|" + pair + "|" + interval;
+  std::vector<Core::BackfillRange> known_empty;
+  if (const auto cached = metadata_cache_->get(empty_key))
+    known_empty = ranges_from_json(cached->value);
+
+  Core::BackfillOptions opts;
+  opts.interval_ms = interval_ms;
+  opts.max_rows_per_request = record->provider->max_candles_per_request();
+  opts.window_start_ms = window_start_ms;
+  opts.window_end_ms = window_end_ms;
+  opts.known_empty = known_empty;
+  const auto plan = Core::BackfillPlanner::plan(candles, opts);
+  report.gaps = plan.gaps.size();
+  report.missing_candles = plan.missing_candles;
+  report.planned_requests = plan.requests.size();
+  if (plan.requests.empty()) {
+    return report;
+  }
+
+  std::vector<Core::Candle> fetched;
+  std::vector<Core::BackfillRange> answered;
+  const Core::RequestPriority priority = Core::current_request_priority();
+  for (std::size_t i = 0; i < plan.requests.size(); i += kBackfillParallelism) {
+    std::vector<std::future<Core::KlinesResult>> wave;
+    const std::size_t end = std::min(plan.requests.size(), i + kBackfillParallelism);
+    for (std::size_t j = i; j < end; ++j) {
+      wave.push_back(std::async(std::launch::async,
+                                [this, &pair, &interval, priority,
+                                 range = plan.requests[j]]() {
+                                  Core::ScopedRequestPriority scope(priority);
+                                  return fetch_range(pair, interval, range.start_ms,
+                                                     range.end_ms);
+                                }));
+    }
+    for (std::size_t j = i; j < end; ++j) {
+      auto res = wave[j - i].get();
+      ++report.executed_requests;
+      if (res.error != Core::FetchError::None) {
+        ++report.failed_requests;
+        continue;
+      }
+      answered.push_back(plan.requests[j]);
+      for (auto &c : res.candles) {
+        // Provider-side gap filling would only overwrite our own placeholders.
+        if (!Core::BackfillPlanner::is_synthetic(c))
+          fetched.push_back(std::move(c));
+      }
+    }
+  }
+
+  report.candles_fetched = fetched.size();
+  if (!fetched.empty()) {
+    Core::merge_candles(candles, fetched);
+    Core::fill_missing(candles, interval_ms);
+    report.changed = true;
+    overwrite_candles(pair, interval, candles);
+  }
+
+  // Whatever an answered request left uncovered does not exist at the venue
+  // (quiet bars it never publishes, or history before its first bar).
+  const long long settled_before =
+      std::chrono::duration_cast<std::chrono::milliseconds>(
+          std::chrono::system_clock::now().time_since_epoch())
+          .count() -
+      kEmptyRangeGraceMs - interval_ms;
+  std::size_t remembered = known_empty.size();
+  for (const auto &range : answered) {
+    Core::BackfillOptions check;
+    check.interval_ms = interval_ms;
+    check.window_start_ms = range.start_ms;
+    check.window_end_ms = std::min(range.end_ms, settled_before);
+    if (check.window_end_ms < check.window_start_ms)
+      continue;
+    for (const auto &gap : Core::BackfillPlanner::plan(candles, check).gaps)
+      known_empty.push_back(gap);
+  }
+  if (known_empty.size() != remembered) {
+    coalesce_ranges(known_empty, interval_ms);
+    metadata_cache_->put(empty_key, {ranges_to_json(known_empty), 0, {}, {}});
+    metadata_cache_->save();
+  }
+  Core::Logger::instance().info(
+      "Backfill " + pair + " " + interval + ": " + std::to_string(report.gaps) +
+      " gaps (" + std::to_string(report.missing_candles) + " candles), " +
+      std::to_string(report.planned_requests) + " requests planned, " +
+      std::to_string(report.executed_requests) + " executed, " +
+      std::to_string(report.failed_requests) + " failed, " +
+      std::to_string(report.candles_fetched) + " candles fetched");
+  return report;
+}
+
 bool DataService::top_up_recent(const std::string &pair, const std::string &interval) const {
   auto existing = load_candles(pair, interval);
   auto interval_ms = Core::parse_interval(interval).count();
   if (existing.empty() || interval_ms <= 0) {
     return reload_candles(pair, interval);
   }
-  long long last_ts = existing.back().open_time;
-  long long start = last_ts + interval_ms;
-  long long end = std::chrono::duration_cast<std::chrono::milliseconds>(
+  long long now = std::chrono::duration_cast<std::chrono::milliseconds>(
                      std::chrono::system_clock::now().time_since_epoch())
                      .count();
-  auto res = fetch_range(pair, interval, start, end);
-  if (res.error == Core::FetchError::None && !res.candles.empty()) {
-    const std::size_t before_n = existing.size();
-    const long long before_last = before_n ? existing.back().open_time : 0LL;
-    Core::merge_candles(existing, res.candles);
-    const bool changed = existing.size() != before_n || (before_n && existing.back().open_time != before_last);
-    if (changed) overwrite_candles(pair, interval, existing);
-    return changed;
-  }
-  return false;
+  // Only the tail after the last stored candle; older holes are left to
+  // ensure_limit so routine top-ups stay a single cheap request.
+  return backfill(pair, interval, existing, existing.back().open_time, now).changed;
 }
 
 bool DataService::ensure_limit(const std::string &pair, const std::string &interval,
@@ -288,22 +833,39 @@ bool DataService::ensure_limit(const std::string &pair, const std::string &inter
   if (existing.size() >= target_count || interval_ms <= 0) {
     return true;
   }
-  // Backfill older
-  std::size_t need = target_count - existing.size();
-  long long min_ts = existing.front().open_time;
-  long long start = min_ts - static_cast<long long>(need) * interval_ms;
-  long long end = min_ts - interval_ms;
-  if (end <= 0) end = min_ts - 1;
-  auto res = fetch_range(pair, interval, start, end);
-  if (res.error == Core::FetchError::None && !res.candles.empty()) {
-    const std::size_t before_n = existing.size();
-    const long long before_last = before_n ? existing.back().open_time : 0LL;
-    Core::merge_candles(existing, res.candles);
-    const bool changed = existing.size() != before_n || (before_n && existing.back().open_time != before_last);
-    if (changed) overwrite_candles(pair, interval, existing);
-    return changed;
-  }
-  return false;
+  // Cover target_count candles ending at the newest one: older history that
+  // is missing plus any holes inside the stored range, in one planned batch.
+  const long long window_end = existing.back().open_time;
+  const long long window_start =
+      window_end - static_cast<long long>(target_count > 0 ? target_count - 1 : 0) *
+                       interval_ms;
+  const auto report = backfill(pair, interval, existing, window_start, window_end);
+  return report.failed_requests == 0 &&
+         (report.planned_requests == 0 || report.changed);
 }
 
-
+std::vector<Core::Candle> DataService::warm_candles(const std::string &pair,
+                                                    const std::string &interval,
+                                                    std::size_t target_count) const {
+  auto candles = load_candles(pair, interval);
+  const auto interval_ms = Core::parse_interval(interval).count();
+  if (interval_ms <= 0 || target_count == 0) {
+    return candles;
+  }
+  if (candles.empty()) {
+    auto res = fetch_klines(pair, interval, static_cast<int>(target_count));
+    if (res.error == Core::FetchError::None && !res.candles.empty()) {
+      candles = std::move(res.candles);
+      Core::normalize_candles(candles);
+      overwrite_candles(pair, interval, candles);
+    }
+    return candles;
+  }
+  const long long now = std::chrono::duration_cast<std::chrono::milliseconds>(
+                            std::chrono::system_clock::now().time_since_epoch())
+                            .count();
+  const long long window_start =
+      now - static_cast<long long>(target_count - 1) * interval_ms;
+  backfill(pair, interval, candles, window_start, now);
+  return candles;
+}
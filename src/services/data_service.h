@@ -11,10 +11,15 @@
 #include <optional>
 #include <functional>
 #include <map>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
 
 #include "core/candle.h"
 #include "core/candle_manager.h"
 #include "core/net/idata_provider.h"
+#include "core/net/metadata_cache.h"
+#include "core/net/provider_health.h"
 #include "core/net/cpr_http_client.h"
 #include "core/net/token_bucket_rate_limiter.h"
 #include "config_types.h"
@@ -24,10 +29,21 @@ public:
   DataService();
   explicit DataService(const std::filesystem::path &data_dir);
 
-  void register_provider(const std::string &name, std::shared_ptr<Core::IDataProvider> provider);
+  void register_provider(const std::string &name, std::shared_ptr<Core::IDataProvider> provider,
+                         Core::ProviderHealth::Options health_options = {});
   bool set_active_provider(const std::string &name);
   std::vector<std::string> get_provider_names() const;
   std::string get_active_provider_name() const;
+  // Replaces the configuration read from config.json and re-selects the
+  // active and fallback providers from it.
+  void set_config(const Config::ConfigData &cfg);
+  // Health score and circuit state per registered provider (display name).
+  std::map<std::string, Core::ProviderHealth::Snapshot> provider_health() const;
+  // Called with the provider's display name when a candle fetch closes its
+  // circuit again after it had opened. Runs on the fetching thread; set it
+  // before issuing fetches.
+  using RecoveryHook = std::function<void(const std::string &provider)>;
+  void set_on_provider_recovered(RecoveryHook hook);
 
   Core::SymbolsResult fetch_all_symbols(
       int max_retries = 3,
@@ -45,6 +61,25 @@ public:
       long long start_ms, long long end_ms,
       int max_retries = 3,
       std::chrono::milliseconds retry_delay = std::chrono::milliseconds(1000)) const;
+  // Like fetch_range, but when hedging is enabled and the active provider has
+  // not answered within its p95 latency, the same request is also issued to a
+  // secondary provider that lists the symbol; the first successful answer
+  // wins and the slower one is discarded. The shipped build registers no
+  // secondary provider, so this currently behaves exactly like fetch_range.
+  Core::KlinesResult fetch_range_hedged(
+      const std::string &symbol, const std::string &interval,
+      long long start_ms, long long end_ms,
+      int max_retries = 3,
+      std::chrono::milliseconds retry_delay = std::chrono::milliseconds(1000)) const;
+  bool hedging_enabled() const { return config().hedge_requests; }
+  struct HedgeStats {
+    std::size_t issued{0};
+    std::size_t won{0};
+  };
+  HedgeStats hedge_stats() const { return {hedges_issued_.load(), hedges_won_.load()}; }
+  // Blocks until every request fetch_range_hedged started has returned,
+  // including losers whose answers were discarded.
+  void wait_for_hedged_requests() const;
   std::future<Core::KlinesResult> fetch_klines_async(
       const std::string &symbol, const std::string &interval, int limit,
       int max_retries = 3,
@@ -78,6 +113,37 @@ public:
   bool ensure_limit(const std::string &pair, const std::string &interval,
                     std::size_t target_count) const;
 
+  struct BackfillReport {
+    std::size_t gaps{0};
+    std::size_t missing_candles{0};
+    std::size_t planned_requests{0};
+    std::size_t executed_requests{0};
+    std::size_t failed_requests{0};
+    std::size_t candles_fetched{0};
+    bool changed{false};
+  };
+  // Plans the minimal set of range requests covering every missing (or
+  // synthetic filler) candle of `candles` inside [window_start_ms,
+  // window_end_ms] (0 = series bounds), executes them as one batch, merges
+  // the results into `candles` and persists once if anything changed.
+  // Bars an answered request did not return are remembered per provider in
+  // the metadata cache and not requested again.
+  BackfillReport backfill(const std::string &pair, const std::string &interval,
+                          std::vector<Core::Candle> &candles,
+                          long long window_start_ms = 0,
+                          long long window_end_ms = 0) const;
+
+  // Loads a series from disk and tops it up to target_count candles ending
+  // at the current bar (tail and holes in one planned batch), persisting any
+  // change. Used by the prefetcher; returns what is available on failure.
+  std::vector<Core::Candle> warm_candles(const std::string &pair,
+                                         const std::string &interval,
+                                         std::size_t target_count) const;
+  // True while foreground fetches leave rate-limiter capacity unused.
+  bool has_idle_fetch_capacity() const {
+    return rate_limiter_ && rate_limiter_->has_idle_capacity();
+  }
+
   std::vector<std::string> list_stored_data() const;
 
   bool remove_candles(const std::string &pair) const { return candle_manager_.remove_candles(pair); }
@@ -92,16 +158,61 @@ private:
   struct ProviderRecord {
     std::string display_name;
     std::shared_ptr<Core::IDataProvider> provider;
+    std::shared_ptr<Core::ProviderHealth> health;
   };
+  using KlinesCall =
+      std::function<Core::KlinesResult(const Core::IDataProvider &, int max_retries)>;
 
   static std::string normalize_provider_name(const std::string &name);
   void apply_configured_provider();
+  // Startup note on whether failover and hedging have anywhere to go.
+  void log_failover_status() const;
   const ProviderRecord *active_provider_record() const;
+  // Configured fallback, or nullptr when unset or identical to the active one.
+  const ProviderRecord *fallback_provider_record() const;
+  // Runs a candle fetch against the active provider, recording the outcome in
+  // its health score. Fails over to the fallback provider when the primary's
+  // circuit is open or the call fails for provider-side reasons. Returns
+  // FetchError::CircuitOpen when no provider would take the request.
+  Core::KlinesResult fetch_with_failover(const KlinesCall &call, int max_retries) const;
+  static Core::KlinesResult timed_fetch(
+      const ProviderRecord &record, const KlinesCall &call, int max_retries,
+      const std::shared_ptr<const RecoveryHook> &on_recovered);
+  // Provider raced against the active one: the fallback when configured,
+  // otherwise any other registered provider with a closed circuit.
+  const ProviderRecord *hedge_provider_record() const;
+  // Checks the provider's cached symbol list for the symbol's base asset.
+  // Never fetches: a missing list means "not listed" until the background
+  // refresh has stored one.
+  bool provider_lists_symbol(const ProviderRecord &record,
+                             const std::string &symbol) const;
+  // Refreshes the hedge provider's symbol list on a background thread when
+  // it is missing or older than symbols_cache_ttl_s.
+  void prefetch_hedge_symbols() const;
 
   std::map<std::string, ProviderRecord> providers_;
   std::optional<std::string> active_provider_key_;
+  std::optional<std::string> fallback_provider_key_;
   Core::CandleManager candle_manager_;
+  // Symbol/interval lists persisted in <data_dir>/metadata_cache.json so
+  // startup does not hit the venue for data that rarely changes.
+  std::shared_ptr<Core::MetadataCache> metadata_cache_;
   mutable std::optional<Config::ConfigData> config_cache_;
+  std::shared_ptr<const RecoveryHook> on_provider_recovered_;
+  mutable std::atomic<std::size_t> hedges_issued_{0};
+  mutable std::atomic<std::size_t> hedges_won_{0};
+  // Requests of fetch_range_hedged still running; shared with their
+  // detached threads, which may outlive the call.
+  struct HedgedRequests {
+    std::mutex mutex;
+    std::condition_variable cv;
+    int running{0};
+  };
+  std::shared_ptr<HedgedRequests> hedged_requests_ =
+      std::make_shared<HedgedRequests>();
+  // Set while a hedge symbol refresh runs; shared with its detached thread.
+  std::shared_ptr<std::atomic<bool>> hedge_symbols_refreshing_ =
+      std::make_shared<std::atomic<bool>>(false);
 
   // Debounce + change detection for saves
   mutable std::map<std::string, std::pair<std::size_t, long long>> last_saved_state_;
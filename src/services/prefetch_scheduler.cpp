@@ -0,0 +1,134 @@
+#include "services/prefetch_scheduler.h"
+
+#include "core/logger.h"
+#include "core/net/irate_limiter.h"
+
+#include <utility>
+
+PrefetchScheduler::PrefetchScheduler(Loader loader, IdleProbe idle,
+                                     std::chrono::milliseconds idle_poll)
+    : loader_(std::move(loader)), idle_(std::move(idle)), idle_poll_(idle_poll) {}
+
+PrefetchScheduler::~PrefetchScheduler() { stop(); }
+
+void PrefetchScheduler::start() {
+  if (worker_.joinable())
+    return;
+  worker_ = std::jthread([this](std::stop_token stoken) { run(stoken); });
+}
+
+void PrefetchScheduler::stop() {
+  if (!worker_.joinable())
+    return;
+  worker_.request_stop();
+  cv_.notify_all();
+  worker_ = std::jthread();
+  std::lock_guard<std::mutex> lock(mutex_);
+  order_.clear();
+  queued_.clear();
+}
+
+void PrefetchScheduler::erase_locked(const Key &key) {
+  auto it = queued_.find(key);
+  if (it == queued_.end())
+    return;
+  order_.erase(it->second);
+  queued_.erase(it);
+}
+
+void PrefetchScheduler::enqueue(const std::string &pair,
+                                const std::string &interval,
+                                PrefetchPriority priority) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Key key{pair, interval};
+    if (running_ == key && !running_cancelled_)
+      return;
+    auto it = queued_.find(key);
+    if (it != queued_.end()) {
+      if (std::get<0>(it->second) <= priority)
+        return;
+      erase_locked(key);
+    }
+    Entry entry{priority, next_seq_++, key};
+    order_.insert(entry);
+    queued_.emplace(std::move(key), std::move(entry));
+  }
+  cv_.notify_one();
+}
+
+void PrefetchScheduler::cancel(const std::string &pair,
+                               const std::string &interval) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  const Key key{pair, interval};
+  erase_locked(key);
+  if (running_ == key)
+    running_cancelled_ = true;
+  std::erase_if(results_, [&](const Result &r) {
+    return r.pair == key.first && r.interval == key.second;
+  });
+}
+
+void PrefetchScheduler::clear() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  order_.clear();
+  queued_.clear();
+}
+
+std::vector<PrefetchScheduler::Result> PrefetchScheduler::take_results() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::vector<Result> out;
+  out.swap(results_);
+  return out;
+}
+
+std::size_t PrefetchScheduler::pending() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return order_.size() + (running_ ? 1 : 0);
+}
+
+std::size_t PrefetchScheduler::completed() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return completed_;
+}
+
+void PrefetchScheduler::run(std::stop_token stoken) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (!stoken.stop_requested()) {
+    if (!cv_.wait(lock, stoken, [this] { return !order_.empty(); }))
+      break;
+
+    // Only start a job while foreground fetches leave the limiter idle.
+    lock.unlock();
+    const bool idle = !idle_ || idle_();
+    lock.lock();
+    if (!idle) {
+      cv_.wait_for(lock, stoken, idle_poll_, [] { return false; });
+      continue;
+    }
+    if (order_.empty())
+      continue;
+
+    Key key = std::get<2>(*order_.begin());
+    erase_locked(key);
+    running_ = key;
+    lock.unlock();
+
+    std::vector<Core::Candle> candles;
+    {
+      Core::ScopedRequestPriority scope(Core::RequestPriority::Background);
+      candles = loader_(key.first, key.second);
+    }
+    Core::Logger::instance().info("Prefetched " + key.first + " " + key.second +
+                                  " (" + std::to_string(candles.size()) +
+                                  " candles)");
+
+    lock.lock();
+    running_.reset();
+    ++completed_;
+    if (std::exchange(running_cancelled_, false))
+      continue;
+    results_.push_back({std::move(key.first), std::move(key.second),
+                        std::move(candles)});
+  }
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <set>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "core/candle.h"
+
+// Lower value runs first. The active series is not a level here: it is
+// always fetched in the foreground and preempts every prefetch.
+enum class PrefetchPriority {
+  Visible = 0,   // other pairs shown in the Control Panel, active interval
+  Adjacent = 1,  // active pair, neighbouring intervals
+  Background = 2 // everything else
+};
+
+// Warms candle series the user is likely to switch to next. Jobs run one at
+// a time on a worker thread, highest priority first, and only start while
+// the rate limiter reports idle capacity. Requests made by a job are tagged
+// RequestPriority::Background, so a foreground fetch arriving mid-job still
+// gets the next token.
+class PrefetchScheduler {
+public:
+  struct Result {
+    std::string pair;
+    std::string interval;
+    std::vector<Core::Candle> candles;
+  };
+  using Loader = std::function<std::vector<Core::Candle>(
+      const std::string &pair, const std::string &interval)>;
+  using IdleProbe = std::function<bool()>;
+
+  PrefetchScheduler(Loader loader, IdleProbe idle,
+                    std::chrono::milliseconds idle_poll = std::chrono::milliseconds(100));
+  ~PrefetchScheduler();
+  PrefetchScheduler(const PrefetchScheduler &) = delete;
+  PrefetchScheduler &operator=(const PrefetchScheduler &) = delete;
+
+  void start();
+  // Waits for the running job (if any) to finish; queued jobs are dropped.
+  void stop();
+
+  // Queues the series, or raises its priority if it is already queued.
+  void enqueue(const std::string &pair, const std::string &interval,
+               PrefetchPriority priority);
+  // Drops a queued job, and the result of the job if it is running or has
+  // completed but was not taken yet, so a removed pair is not brought back.
+  void cancel(const std::string &pair, const std::string &interval);
+  void clear();
+
+  // Results completed since the previous call, in completion order.
+  std::vector<Result> take_results();
+  std::size_t pending() const;
+  std::size_t completed() const;
+
+private:
+  using Key = std::pair<std::string, std::string>;
+  using Entry = std::tuple<PrefetchPriority, std::uint64_t, Key>;
+
+  void run(std::stop_token stoken);
+  void erase_locked(const Key &key);
+
+  Loader loader_;
+  IdleProbe idle_;
+  const std::chrono::milliseconds idle_poll_;
+
+  mutable std::mutex mutex_;
+  std::condition_variable_any cv_;
+  std::set<Entry> order_;
+  std::map<Key, Entry> queued_;
+  std::optional<Key> running_;
+  bool running_cancelled_{false};
+  std::vector<Result> results_;
+  std::uint64_t next_seq_{0};
+  std::size_t completed_{0};
+  std::jthread worker_;
+};
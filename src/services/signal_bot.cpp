@@ -1,60 +1,113 @@
 #include "services/signal_bot.h"
-#include <cmath>
 
-SignalBot::SignalBot(const Config::SignalConfig& cfg) : cfg_(cfg) {}
+#include <algorithm>
+
+SignalBot::SignalBot(const Config::SignalConfig& cfg)
+    : cfg_(cfg), strategy_(Signal::make_strategy(cfg)) {}
 
 void SignalBot::set_config(const Config::SignalConfig& cfg) {
     cfg_ = cfg;
+    strategy_ = Signal::make_strategy(cfg);
+    cache_ = SeriesCache{};
 }
 
 const Config::SignalConfig& SignalBot::config() const noexcept {
     return cfg_;
 }
 
-int SignalBot::generate_signal(const std::vector<Core::Candle>& candles, size_t index) {
-    if (cfg_.type == "sma_crossover") {
-        return Signal::sma_crossover_signal(candles, index, cfg_.short_period, cfg_.long_period);
-    } else if (cfg_.type == "ema") {
-        std::size_t period = cfg_.short_period;
-        if (period == 0) {
-            auto it = cfg_.params.find("period");
-            if (it != cfg_.params.end()) {
-                double val = it->second;
-                if (val >= 0 && std::floor(val) == val) {
-                    period = static_cast<std::size_t>(val);
-                } else {
-                    Core::Logger::instance().warn("Invalid EMA period value");
-                    return 0;
-                }
-            }
+void SignalBot::set_series(std::string id, std::uint64_t version) {
+    series_id_ = std::move(id);
+    series_version_ = version;
+    cache_ = SeriesCache{};
+}
+
+bool SignalBot::extends_cache(const std::vector<Core::Candle>& candles) const {
+    const std::size_t n = cache_.size;
+    if (n == 0 || candles.size() < n || candles.front().open_time != cache_.first_open_time) {
+        return false;
+    }
+    return n < 2 || (candles[n - 2].open_time == cache_.stable_open_time &&
+                     candles[n - 2].close == cache_.stable_close);
+}
+
+std::size_t SignalBot::frame_change(const FrameState& state, const Core::AlignedSeries& frame) {
+    const auto& candles = *frame.candles;
+    if (state.candles != frame.candles || state.version != frame.version ||
+        candles.size() < state.size ||
+        (state.size > 0 && candles.front().open_time != state.first_open_time)) {
+        return 0;
+    }
+    if (state.size == 0) {
+        return candles.empty() ? kNoChange : 0;
+    }
+    const auto& last = candles[state.size - 1];
+    if (candles.size() == state.size && last.open_time == state.last_open_time &&
+        last.close == state.last_close) {
+        return kNoChange;
+    }
+    // Bars aligned to the old last candle or later.
+    const auto it = std::lower_bound(frame.aligned.begin(), frame.aligned.end(),
+                                     static_cast<std::int32_t>(state.size - 1));
+    return static_cast<std::size_t>(it - frame.aligned.begin());
+}
+
+void SignalBot::set_timeframes(std::span<const Core::AlignedSeries> frames) {
+    const bool same_set = frames.size() == frames_.size() &&
+                          std::equal(frames.begin(), frames.end(), frames_.begin(),
+                                     [](const auto& a, const auto& b) { return a.interval == b.interval; });
+    std::size_t from = same_set ? kNoChange : 0;
+    frame_states_.resize(frames.size());
+    for (std::size_t k = 0; k < frames.size(); ++k) {
+        if (same_set) {
+            from = std::min(from, frame_change(frame_states_[k], frames[k]));
         }
-        return Signal::ema_signal(candles, index, period);
-    } else if (cfg_.type == "rsi") {
-        std::size_t period = cfg_.short_period;
-        if (period == 0) {
-            auto it = cfg_.params.find("period");
-            if (it != cfg_.params.end()) {
-                double val = it->second;
-                if (val >= 0 && std::floor(val) == val) {
-                    period = static_cast<std::size_t>(val);
-                } else {
-                    Core::Logger::instance().warn("Invalid RSI period value");
-                    return 0;
-                }
-            }
+        const auto& candles = *frames[k].candles;
+        FrameState& state = frame_states_[k];
+        state.candles = frames[k].candles;
+        state.version = frames[k].version;
+        state.size = candles.size();
+        if (!candles.empty()) {
+            state.first_open_time = candles.front().open_time;
+            state.last_open_time = candles.back().open_time;
+            state.last_close = candles.back().close;
         }
-        double oversold = 30.0;
-        double overbought = 70.0;
-        auto it_os = cfg_.params.find("oversold");
-        if (it_os != cfg_.params.end()) {
-            oversold = it_os->second;
+    }
+    frames_.assign(frames.begin(), frames.end());
+    frames_from_ = std::min(frames_from_, from);
+}
+
+int SignalBot::generate_signal(const std::vector<Core::Candle>& candles, size_t index) {
+    if (index >= candles.size()) {
+        return 0;
+    }
+    const bool same_series = cache_.data == candles.data() && cache_.size == candles.size() &&
+                             cache_.last_open_time == candles.back().open_time &&
+                             cache_.last_close == candles.back().close;
+    if (!same_series || frames_from_ != kNoChange) {
+        const bool appended = extends_cache(candles);
+        const std::size_t from = appended ? std::min(cache_.size - 1, frames_from_) : 0;
+        frames_from_ = kNoChange;
+        cache_.data = candles.data();
+        cache_.size = candles.size();
+        cache_.first_open_time = candles.front().open_time;
+        if (candles.size() >= 2) {
+            cache_.stable_open_time = candles[candles.size() - 2].open_time;
+            cache_.stable_close = candles[candles.size() - 2].close;
         }
-        auto it_ob = cfg_.params.find("overbought");
-        if (it_ob != cfg_.params.end()) {
-            overbought = it_ob->second;
+        cache_.last_open_time = candles.back().open_time;
+        cache_.last_close = candles.back().close;
+        if (appended) {
+            cache_.signals.resize(candles.size(), 0);
+            strategy_->update_signals({candles, series_id_, series_version_, frames_}, from,
+                                      cache_.signals);
+        } else {
+            cache_.signals.assign(candles.size(), 0);
+            generate_signals(candles, cache_.signals);
         }
-        return Signal::rsi_signal(candles, index, period, oversold, overbought);
     }
-    return 0;
+    return cache_.signals[index];
 }
 
+void SignalBot::generate_signals(const std::vector<Core::Candle>& candles, std::span<int> out) {
+    strategy_->generate_signals({candles, series_id_, series_version_, frames_}, out);
+}
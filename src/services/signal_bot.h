@@ -1,14 +1,20 @@
 #pragma once
 
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <span>
+#include <string>
 #include <vector>
 
 #include "config_types.h"
 #include "core/backtester.h"
-#include "signal.h"
+#include "strategy.h"
 
 // SignalBot wraps signal generation based on configurable settings.
 // It implements Core::IStrategy so it can be used with the backtester
-// or real-time trading modules.
+// or real-time trading modules. The configuration is resolved once into a
+// Signal::Strategy (see make_strategy), which evaluates whole series.
 class SignalBot : public Core::IStrategy {
 public:
     explicit SignalBot(const Config::SignalConfig& cfg);
@@ -16,9 +22,59 @@ public:
     void set_config(const Config::SignalConfig& cfg);
     [[nodiscard]] const Config::SignalConfig& config() const noexcept;
 
+    // Names the candles passed to generate_signal (see Signal::series_id) so
+    // their indicators come from, and stay in, the shared IndicatorCache.
+    // Without a name each series is computed on its own. Pass a new
+    // `version` whenever candles before the last one were rewritten.
+    void set_series(std::string id, std::uint64_t version = 0);
+
     int generate_signal(const std::vector<Core::Candle>& candles, size_t index) override;
+    void generate_signals(const std::vector<Core::Candle>& candles, std::span<int> out) override;
+    // Passed to the strategy with every series (see SeriesView::timeframes).
+    // When a frame only gained candles, the cached signals are re-evaluated
+    // from the first bar that can see them; a frame with a new version is
+    // evaluated again from the start.
+    void set_timeframes(std::span<const Core::AlignedSeries> frames) override;
 
 private:
+    // Per-index callers ask for each index of the same series in turn, so
+    // the signals of the last series seen are kept until it changes. When
+    // candles were only appended (or the last one updated) the strategy
+    // evaluates just the new bars.
+    struct SeriesCache {
+        const Core::Candle* data = nullptr;
+        std::size_t size = 0;
+        long long first_open_time = 0;
+        long long stable_open_time = 0;  // candle size - 2
+        double stable_close = 0.0;
+        long long last_open_time = 0;
+        double last_close = 0.0;
+        std::vector<int> signals;
+    };
+
+    // What set_timeframes last saw of a frame's candles.
+    struct FrameState {
+        const std::vector<Core::Candle>* candles = nullptr;
+        std::size_t size = 0;
+        long long first_open_time = 0;
+        long long last_open_time = 0;
+        double last_close = 0.0;
+        std::uint64_t version = 0;
+    };
+
+    static constexpr std::size_t kNoChange = std::numeric_limits<std::size_t>::max();
+
+    [[nodiscard]] bool extends_cache(const std::vector<Core::Candle>& candles) const;
+    // The first bar whose frame values may differ from `state`.
+    [[nodiscard]] static std::size_t frame_change(const FrameState& state,
+                                                  const Core::AlignedSeries& frame);
+
     Config::SignalConfig cfg_;
+    std::unique_ptr<Signal::Strategy> strategy_;
+    std::string series_id_;
+    std::uint64_t series_version_ = 0;
+    SeriesCache cache_;
+    std::vector<Core::AlignedSeries> frames_;
+    std::vector<FrameState> frame_states_;
+    std::size_t frames_from_ = kNoChange;
 };
-
@@ -1,19 +1,47 @@
 #include "signal.h"
-#include <numeric>
+
+#include <algorithm>
 
 namespace Signal {
 
+namespace {
+
+// 1 when a crosses above b, -1 when it crosses below, 0 otherwise.
+int crossing(double prev_a, double prev_b, double curr_a, double curr_b) {
+    if (prev_a <= prev_b && curr_a > curr_b) {
+        return 1;
+    }
+    if (prev_a >= prev_b && curr_a < curr_b) {
+        return -1;
+    }
+    return 0;
+}
+
+int rsi_threshold(double rsi, double oversold, double overbought) {
+    if (rsi < oversold) {
+        return 1;
+    }
+    if (rsi > overbought) {
+        return -1;
+    }
+    return 0;
+}
+
+bool valid_macd_periods(std::size_t fast_period, std::size_t slow_period, std::size_t signal_period) {
+    return fast_period > 0 && slow_period > 0 && signal_period > 0 && fast_period < slow_period;
+}
+
+} // namespace
+
 double simple_moving_average(const std::vector<Core::Candle>& candles, std::size_t index, std::size_t period) {
     if (period == 0 || index >= candles.size() || index + 1 < period) {
         return 0.0;
     }
-    const std::size_t start = index + 1 - period;
-    const auto begin = candles.begin() + static_cast<long>(start);
-    const auto end = candles.begin() + static_cast<long>(index) + 1;
-    const double sum = std::accumulate(begin, end, 0.0, [](double acc, const Core::Candle& c) {
-        return acc + c.close;
-    });
-    return sum / static_cast<double>(period);
+    Sma sma(period);
+    for (std::size_t i = index + 1 - period; i <= index; ++i) {
+        sma.update(candles[i].close);
+    }
+    return sma.value();
 }
 
 int sma_crossover_signal(const std::vector<Core::Candle>& candles,
@@ -23,22 +51,14 @@ int sma_crossover_signal(const std::vector<Core::Candle>& candles,
     if (short_period == 0 || long_period == 0 || short_period >= long_period) {
         return 0;
     }
-    if (index >= candles.size() || index + 1 < long_period) {
+    // Both averages must exist at index - 1 as well.
+    if (index >= candles.size() || index < long_period) {
         return 0;
     }
-
-    double short_prev = simple_moving_average(candles, index - 1, short_period);
-    double long_prev  = simple_moving_average(candles, index - 1, long_period);
-    double short_curr = simple_moving_average(candles, index, short_period);
-    double long_curr  = simple_moving_average(candles, index, long_period);
-
-    if (short_prev <= long_prev && short_curr > long_curr) {
-        return 1; // Bullish crossover
-    }
-    if (short_prev >= long_prev && short_curr < long_curr) {
-        return -1; // Bearish crossover
-    }
-    return 0;
+    return crossing(simple_moving_average(candles, index - 1, short_period),
+                    simple_moving_average(candles, index - 1, long_period),
+                    simple_moving_average(candles, index, short_period),
+                    simple_moving_average(candles, index, long_period));
 }
 
 double exponential_moving_average(const std::vector<Core::Candle>& candles,
@@ -47,59 +67,39 @@ double exponential_moving_average(const std::vector<Core::Candle>& candles,
     if (period == 0 || index >= candles.size() || index + 1 < period) {
         return 0.0;
     }
-    const double k = 2.0 / (static_cast<double>(period) + 1.0);
-    // Start with SMA for the first period
-    std::size_t start = index + 1 - period;
-    double ema = simple_moving_average(candles, index - (period > 1 ? 1 : 0), period);
-    for (std::size_t i = start; i <= index; ++i) {
-        ema = (candles[i].close - ema) * k + ema;
+    Ema ema(period);
+    for (std::size_t i = 0; i <= index; ++i) {
+        ema.update(candles[i].close);
     }
-    return ema;
+    return ema.value();
 }
 
 int ema_signal(const std::vector<Core::Candle>& candles,
                std::size_t index,
                std::size_t period) {
-    if (index == 0) {
+    if (period == 0 || index >= candles.size() || index < period) {
         return 0;
     }
-    double prev_ema = exponential_moving_average(candles, index - 1, period);
-    double curr_ema = exponential_moving_average(candles, index, period);
-    double prev_price = candles[index - 1].close;
-    double curr_price = candles[index].close;
-    if (prev_price <= prev_ema && curr_price > curr_ema) {
-        return 1;
-    }
-    if (prev_price >= prev_ema && curr_price < curr_ema) {
-        return -1;
+    Ema ema(period);
+    for (std::size_t i = 0; i < index; ++i) {
+        ema.update(candles[i].close);
     }
-    return 0;
+    const double prev_ema = ema.value();
+    ema.update(candles[index].close);
+    return crossing(candles[index - 1].close, prev_ema, candles[index].close, ema.value());
 }
 
-  double relative_strength_index(const std::vector<Core::Candle>& candles,
-                                 std::size_t index,
-                                 std::size_t period) {
-    if (period == 0 || index >= candles.size() || index + 1 < period) {
+double relative_strength_index(const std::vector<Core::Candle>& candles,
+                               std::size_t index,
+                               std::size_t period) {
+    if (period == 0 || index >= candles.size() || index < period) {
         return 0.0;
     }
-    double gain = 0.0;
-    double loss = 0.0;
-    std::size_t start = index + 2 - period;
-    for (std::size_t i = start; i <= index; ++i) {
-        double change = candles[i].close - candles[i - 1].close;
-        if (change > 0) {
-            gain += change;
-        } else {
-            loss -= change;
-        }
-    }
-    double avg_gain = gain / static_cast<double>(period);
-    double avg_loss = loss / static_cast<double>(period);
-    if (avg_loss == 0.0) {
-        return 100.0;
+    Rsi rsi(period);
+    for (std::size_t i = 0; i <= index; ++i) {
+        rsi.update(candles[i].close);
     }
-    double rs = avg_gain / avg_loss;
-    return 100.0 - (100.0 / (1.0 + rs));
+    return rsi.value();
 }
 
 int rsi_signal(const std::vector<Core::Candle>& candles,
@@ -107,104 +107,174 @@ int rsi_signal(const std::vector<Core::Candle>& candles,
                std::size_t period,
                double oversold,
                double overbought) {
-    if (index + 1 < period) {
-        // RSI requires at least `period` candles before producing signals
+    if (period == 0 || index >= candles.size() || index < period) {
+        // RSI requires `period` price changes before producing signals
         return 0;
     }
-    double rsi = relative_strength_index(candles, index, period);
-    if (rsi < oversold) {
-        return 1;
+    return rsi_threshold(relative_strength_index(candles, index, period), oversold, overbought);
+}
+
+MACDResult macd(const std::vector<Core::Candle>& candles,
+                std::size_t index,
+                std::size_t fast_period,
+                std::size_t slow_period,
+                std::size_t signal_period) {
+    if (!valid_macd_periods(fast_period, slow_period, signal_period) ||
+        index >= candles.size() || index + 1 < slow_period + signal_period - 1) {
+        return {0.0, 0.0, 0.0};
     }
-    if (rsi > overbought) {
-        return -1;
+    Macd m(fast_period, slow_period, signal_period);
+    for (std::size_t i = 0; i <= index; ++i) {
+        m.update(candles[i].close);
     }
-    return 0;
-  }
-
-  // Calculates the MACD line (EMA(fast) - EMA(slow)).
-  double macd_line(const std::vector<Core::Candle>& candles,
-                   std::size_t index,
-                   std::size_t fast_period,
-                   std::size_t slow_period) {
-      if (fast_period == 0 || slow_period == 0 || fast_period >= slow_period) {
-          return 0.0;
-      }
-      if (index >= candles.size() || index + 1 < slow_period) {
-          return 0.0;
-      }
-      double fast = exponential_moving_average(candles, index, fast_period);
-      double slow = exponential_moving_average(candles, index, slow_period);
-      return fast - slow;
-  }
-
-  // Calculates the signal line of MACD (EMA of MACD values).
-  double macd_signal_line(const std::vector<Core::Candle>& candles,
-                          std::size_t index,
-                          std::size_t fast_period,
-                          std::size_t slow_period,
-                          std::size_t signal_period) {
-      if (signal_period == 0 || fast_period == 0 || slow_period == 0 ||
-          fast_period >= slow_period) {
-          return 0.0;
-      }
-      if (index >= candles.size() ||
-          index + 1 < slow_period + signal_period - 1) {
-          return 0.0;
-      }
-
-      std::size_t start = index + 1 - signal_period;
-      std::vector<double> macd_vals;
-      macd_vals.reserve(signal_period);
-      for (std::size_t i = start; i <= index; ++i) {
-          macd_vals.push_back(macd_line(candles, i, fast_period, slow_period));
-      }
-
-      const double k = 2.0 / (static_cast<double>(signal_period) + 1.0);
-      double signal = macd_vals.front();
-      for (std::size_t i = 1; i < macd_vals.size(); ++i) {
-          signal = (macd_vals[i] - signal) * k + signal;
-      }
-      return signal;
-  }
-
-  MACDResult macd(const std::vector<Core::Candle>& candles,
-                  std::size_t index,
-                  std::size_t fast_period,
-                  std::size_t slow_period,
-                  std::size_t signal_period) {
-      if (fast_period == 0 || slow_period == 0 || signal_period == 0 ||
-          fast_period >= slow_period) {
-          return {0.0, 0.0, 0.0};
-      }
-      if (index >= candles.size() ||
-          index + 1 < slow_period + signal_period - 1) {
-          return {0.0, 0.0, 0.0};
-      }
-
-      double macd_val = macd_line(candles, index, fast_period, slow_period);
-      double signal = macd_signal_line(candles, index, fast_period, slow_period, signal_period);
-      double histogram = macd_val - signal;
-      return {macd_val, signal, histogram};
-  }
+    return m.value();
+}
 
 int macd_signal(const std::vector<Core::Candle>& candles,
                 std::size_t index,
                 std::size_t fast_period,
                 std::size_t slow_period,
                 std::size_t signal_period) {
-    if (index == 0) {
+    if (!valid_macd_periods(fast_period, slow_period, signal_period) ||
+        index >= candles.size() || index < slow_period + signal_period - 1) {
         return 0;
     }
-    MACDResult prev = macd(candles, index - 1, fast_period, slow_period, signal_period);
-    MACDResult curr = macd(candles, index, fast_period, slow_period, signal_period);
-    if (prev.macd <= prev.signal && curr.macd > curr.signal) {
-        return 1;
+    Macd m(fast_period, slow_period, signal_period);
+    for (std::size_t i = 0; i < index; ++i) {
+        m.update(candles[i].close);
     }
-    if (prev.macd >= prev.signal && curr.macd < curr.signal) {
-        return -1;
+    const MACDResult prev = m.value();
+    m.update(candles[index].close);
+    const MACDResult curr = m.value();
+    return crossing(prev.macd, prev.signal, curr.macd, curr.signal);
+}
+
+std::vector<int> sma_crossover_signals(const std::vector<Core::Candle>& candles,
+                                       std::size_t short_period,
+                                       std::size_t long_period) {
+    std::vector<int> out(candles.size(), 0);
+    if (short_period == 0 || long_period == 0 || short_period >= long_period) {
+        return out;
     }
-    return 0;
+    Sma fast(short_period);
+    Sma slow(long_period);
+    double prev_fast = 0.0;
+    double prev_slow = 0.0;
+    for (std::size_t i = 0; i < candles.size(); ++i) {
+        fast.update(candles[i].close);
+        slow.update(candles[i].close);
+        if (i >= long_period) {
+            out[i] = crossing(prev_fast, prev_slow, fast.value(), slow.value());
+        }
+        prev_fast = fast.value();
+        prev_slow = slow.value();
+    }
+    return out;
 }
 
-} // namespace Signal
+std::vector<int> ema_signals(const std::vector<Core::Candle>& candles, std::size_t period) {
+    std::vector<int> out(candles.size(), 0);
+    if (period == 0) {
+        return out;
+    }
+    Ema ema(period);
+    double prev_ema = 0.0;
+    for (std::size_t i = 0; i < candles.size(); ++i) {
+        ema.update(candles[i].close);
+        if (i >= period) {
+            out[i] = crossing(candles[i - 1].close, prev_ema, candles[i].close, ema.value());
+        }
+        prev_ema = ema.value();
+    }
+    return out;
+}
+
+std::vector<int> rsi_signals(const std::vector<Core::Candle>& candles,
+                             std::size_t period,
+                             double oversold,
+                             double overbought) {
+    std::vector<int> out(candles.size(), 0);
+    Rsi rsi(period);
+    for (std::size_t i = 0; i < candles.size(); ++i) {
+        rsi.update(candles[i].close);
+        if (rsi.ready()) {
+            out[i] = rsi_threshold(rsi.value(), oversold, overbought);
+        }
+    }
+    return out;
+}
+
+std::vector<int> macd_signals(const std::vector<Core::Candle>& candles,
+                              std::size_t fast_period,
+                              std::size_t slow_period,
+                              std::size_t signal_period) {
+    std::vector<int> out(candles.size(), 0);
+    Macd m(fast_period, slow_period, signal_period);
+    MACDResult prev{0.0, 0.0, 0.0};
+    bool prev_ready = false;
+    for (std::size_t i = 0; i < candles.size(); ++i) {
+        m.update(candles[i].close);
+        const MACDResult curr = m.value();
+        if (prev_ready) {
+            out[i] = crossing(prev.macd, prev.signal, curr.macd, curr.signal);
+        }
+        prev = curr;
+        prev_ready = m.ready();
+    }
+    return out;
+}
 
+void sma_crossover_signals(std::span<const double> short_sma,
+                           std::span<const double> long_sma,
+                           std::size_t short_period,
+                           std::size_t long_period,
+                           std::span<int> out) {
+    const std::size_t n = std::min({short_sma.size(), long_sma.size(), out.size()});
+    const bool valid = short_period > 0 && long_period > 0 && short_period < long_period;
+    for (std::size_t i = 0; i < n; ++i) {
+        out[i] = valid && i >= long_period
+                     ? crossing(short_sma[i - 1], long_sma[i - 1], short_sma[i], long_sma[i])
+                     : 0;
+    }
+}
+
+void ema_signals(std::span<const Core::Candle> candles,
+                 std::span<const double> ema,
+                 std::size_t period,
+                 std::span<int> out) {
+    const std::size_t n = std::min({candles.size(), ema.size(), out.size()});
+    for (std::size_t i = 0; i < n; ++i) {
+        out[i] = period > 0 && i >= period
+                     ? crossing(candles[i - 1].close, ema[i - 1], candles[i].close, ema[i])
+                     : 0;
+    }
+}
+
+void rsi_signals(std::span<const double> rsi,
+                 std::size_t period,
+                 double oversold,
+                 double overbought,
+                 std::span<int> out) {
+    const std::size_t n = std::min(rsi.size(), out.size());
+    for (std::size_t i = 0; i < n; ++i) {
+        out[i] = period > 0 && i >= period ? rsi_threshold(rsi[i], oversold, overbought) : 0;
+    }
+}
+
+void macd_signals(std::span<const double> line,
+                  std::span<const double> signal,
+                  std::size_t fast_period,
+                  std::size_t slow_period,
+                  std::size_t signal_period,
+                  std::span<int> out) {
+    const std::size_t n = std::min({line.size(), signal.size(), out.size()});
+    const bool valid = valid_macd_periods(fast_period, slow_period, signal_period);
+    const std::size_t first = slow_period + signal_period - 1;
+    for (std::size_t i = 0; i < n; ++i) {
+        out[i] = valid && i >= first
+                     ? crossing(line[i - 1], signal[i - 1], line[i], signal[i])
+                     : 0;
+    }
+}
+
+} // namespace Signal
@@ -1,10 +1,17 @@
 #pragma once
 
 #include "core/candle.h"
+#include "indicators.h"
+#include <span>
 #include <vector>
 
 namespace Signal {
 
+// Per-index functions. Each evaluates the indicator at `index` on its own
+// (SMA over the window, EMA/RSI/MACD over candles[0..index]); loops over a
+// series should use the *_series functions in indicators.h or the *_signals
+// functions below, which make a single pass.
+
 // Calculates simple moving average of candle close prices.
 [[nodiscard]] double simple_moving_average(const std::vector<Core::Candle>& candles, std::size_t index, std::size_t period);
 
@@ -16,17 +23,20 @@ namespace Signal {
                                        std::size_t short_period,
                                        std::size_t long_period);
 
-// Calculates exponential moving average of candle close prices.
+// Calculates exponential moving average of candle close prices, seeded with
+// the SMA of the first `period` closes.
 [[nodiscard]] double exponential_moving_average(const std::vector<Core::Candle>& candles,
                                                std::size_t index,
                                                std::size_t period);
 
-// Generates signal based on price crossing EMA.
+// Generates signal based on price crossing EMA (0 until the EMA is ready at
+// index - 1).
 [[nodiscard]] int ema_signal(const std::vector<Core::Candle>& candles,
                              std::size_t index,
                              std::size_t period);
 
-// Calculates Relative Strength Index.
+// Calculates Relative Strength Index with Wilder smoothing; 0.0 until
+// `period` price changes are available (index >= period).
 [[nodiscard]] double relative_strength_index(const std::vector<Core::Candle>& candles,
                                              std::size_t index,
                                              std::size_t period);
@@ -38,12 +48,6 @@ namespace Signal {
                              double oversold,
                              double overbought);
 
-struct MACDResult {
-    double macd;
-    double signal;
-    double histogram;
-};
-
 // Calculates Moving Average Convergence Divergence (MACD).
 [[nodiscard]] MACDResult macd(const std::vector<Core::Candle>& candles,
                               std::size_t index,
@@ -51,12 +55,53 @@ struct MACDResult {
                               std::size_t slow_period,
                               std::size_t signal_period);
 
-// Generates signal based on MACD line crossing the signal line.
+// Generates signal based on MACD line crossing the signal line (0 until the
+// signal line is ready at index - 1).
 [[nodiscard]] int macd_signal(const std::vector<Core::Candle>& candles,
                               std::size_t index,
                               std::size_t fast_period,
                               std::size_t slow_period,
                               std::size_t signal_period);
 
+// Whole-series signals in one pass; element i equals the per-index signal at
+// i (SMA values up to rounding of the running sum).
+[[nodiscard]] std::vector<int> sma_crossover_signals(const std::vector<Core::Candle>& candles,
+                                                     std::size_t short_period,
+                                                     std::size_t long_period);
+[[nodiscard]] std::vector<int> ema_signals(const std::vector<Core::Candle>& candles,
+                                           std::size_t period);
+[[nodiscard]] std::vector<int> rsi_signals(const std::vector<Core::Candle>& candles,
+                                           std::size_t period,
+                                           double oversold,
+                                           double overbought);
+[[nodiscard]] std::vector<int> macd_signals(const std::vector<Core::Candle>& candles,
+                                            std::size_t fast_period,
+                                            std::size_t slow_period,
+                                            std::size_t signal_period);
+
+// The same signals from indicator series computed beforehand (e.g. by
+// IndicatorCache), laid out as the *_series functions return them. One
+// signal is written per element of the shortest input, up to out.size().
+void sma_crossover_signals(std::span<const double> short_sma,
+                           std::span<const double> long_sma,
+                           std::size_t short_period,
+                           std::size_t long_period,
+                           std::span<int> out);
+void ema_signals(std::span<const Core::Candle> candles,
+                 std::span<const double> ema,
+                 std::size_t period,
+                 std::span<int> out);
+void rsi_signals(std::span<const double> rsi,
+                 std::size_t period,
+                 double oversold,
+                 double overbought,
+                 std::span<int> out);
+void macd_signals(std::span<const double> line,
+                  std::span<const double> signal,
+                  std::size_t fast_period,
+                  std::size_t slow_period,
+                  std::size_t signal_period,
+                  std::span<int> out);
+
 } // namespace Signal
 
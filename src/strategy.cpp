@@ -0,0 +1,150 @@
+#include "strategy.h"
+
+#include "core/logger.h"
+#include "indicator_cache.h"
+#include "signal.h"
+
+#include <algorithm>
+#include <cmath>
+#include <optional>
+#include <string>
+
+namespace Signal {
+
+std::shared_ptr<const IndicatorSeries> view_indicator(const SeriesView& view,
+                                                     const IndicatorSpec& spec) {
+    if (view.id.empty()) {
+        return std::make_shared<const IndicatorSeries>(compute_indicator(view.candles, spec));
+    }
+    return IndicatorCache::instance().get(view.id, view.version, view.candles, spec);
+}
+
+const Core::AlignedSeries* view_timeframe(const SeriesView& view, std::string_view interval) {
+    for (const auto& frame : view.timeframes) {
+        if (frame.interval == interval) {
+            return &frame;
+        }
+    }
+    return nullptr;
+}
+
+std::shared_ptr<const IndicatorSeries> timeframe_indicator(const SeriesView& view,
+                                                           const Core::AlignedSeries& frame,
+                                                           const IndicatorSpec& spec) {
+    if (view.id.empty()) {
+        return view_indicator({*frame.candles}, spec);
+    }
+    const std::string id = series_id(view.id.substr(0, view.id.find('|')), frame.interval);
+    return IndicatorCache::instance().get(id, frame.version, *frame.candles, spec);
+}
+
+namespace {
+
+// A period from `value`, or params[key] when `value` is 0. nullopt (after a
+// warning) when the parameter is not a non-negative integer.
+std::optional<std::size_t> period_param(const Config::SignalConfig& cfg,
+                                        std::size_t value,
+                                        const char* key,
+                                        std::size_t fallback) {
+    if (value != 0) {
+        return value;
+    }
+    auto it = cfg.params.find(key);
+    if (it == cfg.params.end()) {
+        return fallback;
+    }
+    const double v = it->second;
+    if (v < 0 || std::floor(v) != v) {
+        Core::Logger::instance().warn("Invalid " + cfg.type + " " + key + " value");
+        return std::nullopt;
+    }
+    return static_cast<std::size_t>(v);
+}
+
+double number_param(const Config::SignalConfig& cfg, const char* key, double fallback) {
+    auto it = cfg.params.find(key);
+    return it != cfg.params.end() ? it->second : fallback;
+}
+
+template <typename Policy>
+std::unique_ptr<Strategy> make(Policy policy) {
+    return std::make_unique<PolicyStrategy<Policy>>(policy);
+}
+
+std::unique_ptr<Strategy> hold(const Config::SignalConfig& cfg, const char* reason) {
+    Core::Logger::instance().warn("Signal strategy '" + cfg.type + "' disabled: " + reason);
+    return make(HoldPolicy{});
+}
+
+} // namespace
+
+void SmaCrossoverPolicy::generate(const SeriesView& view, std::span<int> out) const {
+    const auto fast = view_indicator(view, IndicatorSpec::sma(short_period));
+    const auto slow = view_indicator(view, IndicatorSpec::sma(long_period));
+    sma_crossover_signals(fast->values, slow->values, short_period, long_period, out);
+}
+
+void EmaPolicy::generate(const SeriesView& view, std::span<int> out) const {
+    const auto ema = view_indicator(view, IndicatorSpec::ema(period));
+    ema_signals(view.candles, ema->values, period, out);
+}
+
+void RsiPolicy::generate(const SeriesView& view, std::span<int> out) const {
+    const auto rsi = view_indicator(view, IndicatorSpec::rsi(period));
+    rsi_signals(rsi->values, period, oversold, overbought, out);
+}
+
+void MacdPolicy::generate(const SeriesView& view, std::span<int> out) const {
+    const auto macd = view_indicator(view, IndicatorSpec::macd(fast_period, slow_period, signal_period));
+    macd_signals(macd->values, macd->signal, fast_period, slow_period, signal_period, out);
+}
+
+void HoldPolicy::generate(const SeriesView& view, std::span<int> out) const {
+    std::fill_n(out.begin(), std::min(out.size(), view.candles.size()), 0);
+}
+
+std::unique_ptr<Strategy> make_strategy(const Config::SignalConfig& cfg) {
+    if (cfg.type == SmaCrossoverPolicy::kName) {
+        if (cfg.short_period == 0 || cfg.short_period >= cfg.long_period) {
+            return hold(cfg, "short_period must be positive and below long_period");
+        }
+        return make(SmaCrossoverPolicy{cfg.short_period, cfg.long_period});
+    }
+    if (cfg.type == EmaPolicy::kName || cfg.type == RsiPolicy::kName) {
+        const auto period = period_param(cfg, cfg.short_period, "period", 0);
+        if (!period) {
+            return make(HoldPolicy{});
+        }
+        if (*period == 0) {
+            return hold(cfg, "no period");
+        }
+        if (cfg.type == EmaPolicy::kName) {
+            return make(EmaPolicy{*period});
+        }
+        return make(RsiPolicy{*period, number_param(cfg, "oversold", 30.0),
+                              number_param(cfg, "overbought", 70.0)});
+    }
+    if (cfg.type == MacdPolicy::kName) {
+        const auto fast = period_param(cfg, cfg.short_period, "fast", 12);
+        const auto slow = period_param(cfg, cfg.long_period, "slow", 26);
+        const auto signal = period_param(cfg, 0, "signal", 9);
+        if (!fast || !slow || !signal) {
+            return make(HoldPolicy{});
+        }
+        if (*fast == 0 || *signal == 0 || *fast >= *slow) {
+            return hold(cfg, "periods must be positive with fast below slow");
+        }
+        return make(MacdPolicy{*fast, *slow, *signal});
+    }
+    if (cfg.type == ExpressionPolicy::kName) {
+        std::string error;
+        auto program = RuleProgram::compile(cfg.buy, cfg.sell, error);
+        if (!program) {
+            return hold(cfg, error.c_str());
+        }
+        return make(ExpressionPolicy{std::move(program)});
+    }
+    return hold(cfg, "unknown type");
+}
+
+} // namespace Signal
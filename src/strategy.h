@@ -0,0 +1,139 @@
+#pragma once
+
+#include "config_types.h"
+#include "core/candle.h"
+#include "core/timeframe_alignment.h"
+#include "indicator_cache.h"
+#include "rule_program.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string_view>
+#include <vector>
+
+namespace Signal {
+
+// Candles to evaluate and, when `id` is set, their IndicatorCache key so the
+// indicators are shared with other consumers of the same series.
+// `timeframes` are other intervals of the pair aligned to these candles.
+struct SeriesView {
+    const std::vector<Core::Candle>& candles;
+    std::string_view id{};
+    std::uint64_t version = 0;
+    std::span<const Core::AlignedSeries> timeframes{};
+};
+
+// An indicator over the view's candles, from the IndicatorCache when the
+// view has an id.
+[[nodiscard]] std::shared_ptr<const IndicatorSeries> view_indicator(const SeriesView& view,
+                                                                   const IndicatorSpec& spec);
+
+// The view's aligned series for `interval`, or nullptr.
+[[nodiscard]] const Core::AlignedSeries* view_timeframe(const SeriesView& view,
+                                                        std::string_view interval);
+
+// An indicator over an aligned series' own candles, cached under the pair's
+// id for that interval (at frame.version) when the view has an id. Index it with
+// frame.aligned[i] (when not kNone) for candle i of the view.
+[[nodiscard]] std::shared_ptr<const IndicatorSeries> timeframe_indicator(
+    const SeriesView& view, const Core::AlignedSeries& frame, const IndicatorSpec& spec);
+
+// A strategy resolved from configuration. generate_signals writes one
+// signal per candle (1 buy, -1 sell, 0 hold) into out[0, min(size)); the
+// virtual call happens once per series, never per candle.
+class Strategy {
+public:
+    virtual ~Strategy() = default;
+    virtual void generate_signals(const SeriesView& view, std::span<int> out) const = 0;
+    // Only bars [from, size) after candles were appended or the last one
+    // changed; out[0, from) already holds this series' signals. By default
+    // the whole series is evaluated again.
+    virtual void update_signals(const SeriesView& view, std::size_t from, std::span<int> out) const {
+        (void)from;
+        generate_signals(view, out);
+    }
+    [[nodiscard]] virtual std::string_view name() const noexcept = 0;
+};
+
+// Policies: the parameters of one strategy kind, resolved once, and its
+// whole-series evaluation.
+struct SmaCrossoverPolicy {
+    static constexpr std::string_view kName = "sma_crossover";
+    std::size_t short_period;
+    std::size_t long_period;
+    void generate(const SeriesView& view, std::span<int> out) const;
+};
+
+// Close crossing its EMA.
+struct EmaPolicy {
+    static constexpr std::string_view kName = "ema";
+    std::size_t period;
+    void generate(const SeriesView& view, std::span<int> out) const;
+};
+
+// Buy below `oversold`, sell above `overbought`.
+struct RsiPolicy {
+    static constexpr std::string_view kName = "rsi";
+    std::size_t period;
+    double oversold;
+    double overbought;
+    void generate(const SeriesView& view, std::span<int> out) const;
+};
+
+// MACD line crossing its signal line.
+struct MacdPolicy {
+    static constexpr std::string_view kName = "macd";
+    std::size_t fast_period;
+    std::size_t slow_period;
+    std::size_t signal_period;
+    void generate(const SeriesView& view, std::span<int> out) const;
+};
+
+// Buy/sell rules in the expression language (rule_program.h).
+struct ExpressionPolicy {
+    static constexpr std::string_view kName = "expression";
+    std::shared_ptr<const RuleProgram> program;
+    void generate(const SeriesView& view, std::span<int> out) const { program->run(view, 0, out); }
+    void update(const SeriesView& view, std::size_t from, std::span<int> out) const {
+        program->run(view, from, out);
+    }
+};
+
+// Unknown or invalid configuration: always hold.
+struct HoldPolicy {
+    static constexpr std::string_view kName = "none";
+    void generate(const SeriesView& view, std::span<int> out) const;
+};
+
+template <typename Policy>
+class PolicyStrategy final : public Strategy {
+public:
+    explicit PolicyStrategy(Policy policy) : policy_(policy) {}
+
+    void generate_signals(const SeriesView& view, std::span<int> out) const override {
+        policy_.generate(view, out);
+    }
+    void update_signals(const SeriesView& view, std::size_t from, std::span<int> out) const override {
+        if constexpr (requires { policy_.update(view, from, out); }) {
+            policy_.update(view, from, out);
+        } else {
+            policy_.generate(view, out);
+        }
+    }
+    [[nodiscard]] std::string_view name() const noexcept override { return Policy::kName; }
+    [[nodiscard]] const Policy& policy() const noexcept { return policy_; }
+
+private:
+    Policy policy_;
+};
+
+// Resolves `cfg.type` and its parameters once. Types: sma_crossover
+// (short/long_period), ema and rsi (short_period, else params.period; rsi
+// also params.oversold/overbought, default 30/70), macd (short/long period
+// or params.fast/slow, default 12/26, params.signal default 9) and
+// expression (the `buy`/`sell` rules, compiled once).
+// Invalid settings are logged and give a strategy that always holds.
+[[nodiscard]] std::unique_ptr<Strategy> make_strategy(const Config::SignalConfig& cfg);
+
+} // namespace Signal
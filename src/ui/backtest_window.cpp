@@ -4,12 +4,15 @@
 #include "config_path.h"
 #include "imgui.h"
 #include "implot.h"
+#include "indicator_cache.h"
 #include "services/signal_bot.h"
 
 void DrawBacktestWindow(
     const std::map<std::string,
                    std::map<std::string, std::vector<Core::Candle>>>
         &all_candles,
+    const std::map<std::pair<std::string, std::string>, std::uint64_t>
+        &series_versions,
     const std::string &active_pair, const std::string &selected_interval) {
   ImGui::Begin("Backtest");
 
@@ -30,7 +33,20 @@ void DrawBacktestWindow(
         Config::SignalConfig scfg;
         if (cfg)
           scfg = cfg->signal;
+        auto version = [&](const std::string &interval) {
+          auto it = series_versions.find({active_pair, interval});
+          return it == series_versions.end() ? std::uint64_t{0} : it->second;
+        };
         SignalBot bot(scfg);
+        bot.set_series(Signal::series_id(active_pair, selected_interval),
+                       version(selected_interval));
+        // Rules may read the pair's other intervals (e.g. `close@1h`).
+        static Core::TimeframeAlignments alignments;
+        auto frames =
+            alignments.align(active_pair, pair_it->second, selected_interval);
+        for (auto &frame : frames)
+          frame.version = version(frame.interval);
+        bot.set_timeframes(frames);
         Core::Backtester bt(interval_it->second, bot);
         result = bt.run();
         ran = true;
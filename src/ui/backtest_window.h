@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstdint>
 #include <map>
 #include <string>
 #include <vector>
@@ -8,9 +9,11 @@
 
 // DrawBacktestWindow renders a window allowing backtesting on the
 // currently selected pair and interval. It displays summary statistics
-// such as PnL, win rate and the equity curve.
+// such as PnL, win rate and the equity curve. `series_versions` are the
+// IndicatorCache versions of the candles (see AppContext::series_versions).
 void DrawBacktestWindow(
     const std::map<std::string, std::map<std::string, std::vector<Core::Candle>>>& all_candles,
+    const std::map<std::pair<std::string, std::string>, std::uint64_t>& series_versions,
     const std::string& active_pair,
     const std::string& selected_interval);
 
@@ -66,6 +66,7 @@ bool LoadInitialCandles(
     const std::vector<std::string> &intervals,
     std::map<std::string, std::map<std::string, std::vector<Core::Candle>>>
         &all_candles,
+    std::map<std::pair<std::string, std::string>, std::uint64_t> &series_versions,
     std::string &load_error) {
   bool failed = false;
   for (const auto &interval : intervals) {
@@ -119,6 +120,7 @@ bool LoadInitialCandles(
       failed = true;
     } else {
       all_candles[symbol][interval] = candles;
+      ++series_versions[{symbol, interval}];
     }
   }
   if (failed && load_error.empty())
@@ -134,6 +136,7 @@ bool RenderPairRow(
     const std::vector<std::string> &intervals, std::string &selected_interval,
     std::map<std::string, std::map<std::string, std::vector<Core::Candle>>>
         &all_candles,
+    std::map<std::pair<std::string, std::string>, std::uint64_t> &series_versions,
     const std::function<void()> &save_pairs, DataService &data_service,
     AppStatus &status,
     const std::function<void(const std::string &)> &cancel_pair) {
@@ -241,6 +244,8 @@ bool RenderPairRow(
       // Drop in-memory data first to minimize downstream references
       auto itmap = all_candles.find(item.name);
       if (itmap != all_candles.end()) {
+        for (const auto &entry : itmap->second)
+          ++series_versions[{item.name, entry.first}];
         itmap->second.clear();
         all_candles.erase(itmap);
       }
@@ -279,6 +284,7 @@ bool RenderPairRow(
         if (ok) {
           all_candles[item.name][interval] =
               data_service.load_candles(item.name, interval);
+          ++series_versions[{item.name, interval}];
         }
       }
     }
@@ -298,6 +304,7 @@ bool RenderPairRow(
           if (itp != all_candles.end()) {
             auto iti = itp->second.find(interval);
             if (iti != itp->second.end()) iti->second.clear();
+            ++series_versions[{item.name, interval}];
           }
           Core::Logger::instance().info(std::string("UI: clear_interval result=") + (ok ? "true" : "false"));
         } catch (const std::exception &e) {
@@ -321,6 +328,7 @@ static void RenderLoadControls(
     const std::vector<std::string> &intervals,
     std::map<std::string, std::map<std::string, std::vector<Core::Candle>>>
         &all_candles,
+    std::map<std::pair<std::string, std::string>, std::uint64_t> &series_versions,
     const std::function<void()> &save_pairs,
     const std::vector<std::string> &exchange_pairs, DataService &data_service) {
   ImGui::Text("Select pairs to load:");
@@ -369,7 +377,7 @@ static void RenderLoadControls(
             resolve_config_path().string(), selected_pairs);
       }
       if (!LoadInitialCandles(data_service, symbol, intervals, all_candles,
-                              load_error)) {
+                              series_versions, load_error)) {
         // load_error already set inside helper
       }
     }
@@ -387,6 +395,7 @@ static void RenderPairSelector(
     std::string &selected_interval,
     std::map<std::string, std::map<std::string, std::vector<Core::Candle>>>
         &all_candles,
+    std::map<std::pair<std::string, std::string>, std::uint64_t> &series_versions,
     const std::function<void()> &save_pairs, DataService &data_service,
     AppStatus &status,
     const std::function<void(const std::string &)> &cancel_pair) {
@@ -394,8 +403,8 @@ static void RenderPairSelector(
     for (auto it = pairs.begin(); it != pairs.end();) {
       ImGui::TableNextRow();
       if (RenderPairRow(pairs, *it, selected_pairs, active_pair, intervals,
-                        selected_interval, all_candles, save_pairs,
-                        data_service, status, cancel_pair)) {
+                        selected_interval, all_candles, series_versions,
+                        save_pairs, data_service, status, cancel_pair)) {
         it = pairs.erase(it);
       } else {
         ++it;
@@ -440,6 +449,7 @@ float DrawControlPanel(
     std::string &selected_interval,
     std::map<std::string, std::map<std::string, std::vector<Core::Candle>>>
         &all_candles,
+    std::map<std::pair<std::string, std::string>, std::uint64_t> &series_versions,
     const std::function<void()> &save_pairs,
     const std::vector<std::string> &exchange_pairs, AppStatus &status,
     std::mutex &status_mutex, DataService &data_service,
@@ -472,8 +482,8 @@ float DrawControlPanel(
     }
   }
 
-  RenderLoadControls(pairs, selected_pairs, intervals, all_candles, save_pairs,
-                     exchange_pairs, data_service);
+  RenderLoadControls(pairs, selected_pairs, intervals, all_candles,
+                     series_versions, save_pairs, exchange_pairs, data_service);
   // Quick action for active pair/interval
   if (!active_pair.empty() && !selected_interval.empty()) {
     ImGui::Separator();
@@ -489,12 +499,13 @@ float DrawControlPanel(
         auto loaded = data_service.load_candles(active_pair, selected_interval);
         Core::Logger::instance().info(std::string("UI: loaded ") + std::to_string(loaded.size()) + " candles after reload");
         all_candles[active_pair][selected_interval] = std::move(loaded);
+        ++series_versions[{active_pair, selected_interval}];
       }
     }
   }
   RenderPairSelector(pairs, selected_pairs, active_pair, intervals,
-                     selected_interval, all_candles, save_pairs, data_service,
-                     status, cancel_pair);
+                     selected_interval, all_candles, series_versions,
+                     save_pairs, data_service, status, cancel_pair);
   RenderStatusPane(status, status_mutex);
 
   ImGui::Separator();
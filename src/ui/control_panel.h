@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstdint>
 #include <functional>
 #include <map>
 #include <mutex>
@@ -22,6 +23,7 @@ float DrawControlPanel(
     std::string &selected_interval,
     std::map<std::string, std::map<std::string, std::vector<Core::Candle>>>
         &all_candles,
+    std::map<std::pair<std::string, std::string>, std::uint64_t> &series_versions,
     const std::function<void()> &save_pairs,
     const std::vector<std::string> &exchange_pairs, AppStatus &status,
     std::mutex &status_mutex, DataService &data_service,
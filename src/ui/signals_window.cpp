@@ -1,11 +1,16 @@
-// Caches previously computed signals to avoid recalculation when parameters
-// have not changed.
+// Indicator values come from the shared IndicatorCache, so switching
+// strategy or parameters back and forth, or a new candle, does not
+// recompute series already seen; only the table rows are rebuilt here.
+// The optional trend filter reads another interval of the pair through a
+// TimeframeAlignment, one lookup per signal.
 
 #include "ui/signals_window.h"
 #include "app.h"
 
+#include "core/timeframe_alignment.h"
 #include "imgui.h"
-#include "signal.h"
+#include "indicator_cache.h"
+#include "strategy.h"
 
 #include <algorithm>
 #include <ctime>
@@ -18,6 +23,8 @@ void DrawSignalsWindow(
     const std::map<std::string,
                    std::map<std::string, std::vector<Core::Candle>>>
         &all_candles,
+    const std::map<std::pair<std::string, std::string>, std::uint64_t>
+        &series_versions,
     const std::string &active_pair, const std::string &selected_interval,
     AppStatus &status) {
   auto vp = ImGui::GetMainViewport();
@@ -49,20 +56,29 @@ void DrawSignalsWindow(
   ImGui::Checkbox("Show on Chart", &show_on_chart);
   bool request = ImGui::Button("Request signals");
 
-  struct SignalsCache {
+  // Rows of the last evaluation; the indicators themselves live in the
+  // shared IndicatorCache.
+  struct SignalRows {
     std::string strategy;
     int short_period = 0;
     int long_period = 0;
     double oversold = 30.0;
     double overbought = 70.0;
-    std::string active_pair;
-    std::string selected_interval;
+    std::string series;
+    std::uint64_t version = 0;
+    std::size_t size = 0;
     long long last_candle_time = 0;
+    double last_close = 0.0;
+    std::string trend_interval;
+    int trend_period = 0;
+    std::uint64_t trend_version = 0;
+    std::size_t trend_size = 0;
+    double trend_last_close = 0.0;
     std::vector<SignalEntry> entries;
     std::vector<AppContext::TradeEvent> trades;
     bool initialized = false;
   };
-  static SignalsCache cache;
+  static SignalRows last;
   auto pair_it = all_candles.find(active_pair);
   if (pair_it == all_candles.end()) {
     status.signal_message = "No candles for " + active_pair;
@@ -81,94 +97,142 @@ void DrawSignalsWindow(
     ImGui::End();
     return;
   }
+  const std::string series = Signal::series_id(active_pair, selected_interval);
+  auto version_of = [&](const std::string &interval) {
+    auto it = series_versions.find({active_pair, interval});
+    return it == series_versions.end() ? std::uint64_t{0} : it->second;
+  };
+  const std::uint64_t version = version_of(selected_interval);
   long long latest_time = sig_candles.back().open_time;
+  double latest_close = sig_candles.back().close;
+
+  // Trend filter: buys only while the last closed candle of the chosen
+  // interval is above its EMA, sells only while below.
+  static std::string trend_interval;
+  static int trend_period = 50;
+  if (ImGui::BeginCombo("Trend filter", trend_interval.empty()
+                                            ? "None"
+                                            : trend_interval.c_str())) {
+    if (ImGui::Selectable("None", trend_interval.empty()))
+      trend_interval.clear();
+    for (const auto &[interval, candles] : pair_it->second) {
+      if (interval != selected_interval &&
+          ImGui::Selectable(interval.c_str(), interval == trend_interval))
+        trend_interval = interval;
+    }
+    ImGui::EndCombo();
+  }
+  if (!trend_interval.empty())
+    ImGui::InputInt("Trend EMA", &trend_period);
+  trend_period = std::max(trend_period, 1);
+
+  static Core::TimeframeAlignments alignments;
+  auto frames =
+      alignments.align(active_pair, pair_it->second, selected_interval);
+  for (auto &frame : frames)
+    frame.version = version_of(frame.interval);
+  const Signal::SeriesView view{sig_candles, series, version, frames};
+  const Core::AlignedSeries *trend =
+      Signal::view_timeframe(view, trend_interval);
+  const std::size_t trend_size = trend ? trend->candles->size() : 0;
+  const std::uint64_t trend_version = trend ? trend->version : 0;
+  const double trend_last_close =
+      trend_size > 0 ? trend->candles->back().close : 0.0;
 
   bool need_recalc =
-      request || !cache.initialized || cache.short_period != short_period ||
-      cache.long_period != long_period || cache.strategy != strategy ||
-      cache.oversold != oversold || cache.overbought != overbought ||
-      cache.active_pair != active_pair ||
-      cache.selected_interval != selected_interval ||
-      cache.last_candle_time != latest_time;
+      request || !last.initialized || last.short_period != short_period ||
+      last.long_period != long_period || last.strategy != strategy ||
+      last.oversold != oversold || last.overbought != overbought ||
+      last.series != series || last.version != version ||
+      last.size != sig_candles.size() ||
+      last.last_candle_time != latest_time || last.last_close != latest_close ||
+      last.trend_interval != trend_interval ||
+      last.trend_period != trend_period ||
+      last.trend_version != trend_version || last.trend_size != trend_size ||
+      last.trend_last_close != trend_last_close;
 
   if (need_recalc) {
-    status.signal_message = "Computing signals";
-    Core::Logger::instance().info("Computing signals for " + active_pair + " " +
-                                  selected_interval);
-    cache.strategy = strategy;
-    cache.short_period = short_period;
-    cache.long_period = long_period;
-    cache.oversold = oversold;
-    cache.overbought = overbought;
-    cache.active_pair = active_pair;
-    cache.selected_interval = selected_interval;
-    cache.last_candle_time = latest_time;
-
-    cache.entries.clear();
-    cache.trades.clear();
+    last.strategy = strategy;
+    last.short_period = short_period;
+    last.long_period = long_period;
+    last.oversold = oversold;
+    last.overbought = overbought;
+    last.series = series;
+    last.version = version;
+    last.size = sig_candles.size();
+    last.last_candle_time = latest_time;
+    last.last_close = latest_close;
+    last.trend_interval = trend_interval;
+    last.trend_period = trend_period;
+    last.trend_version = trend_version;
+    last.trend_size = trend_size;
+    last.trend_last_close = trend_last_close;
 
-    if (strategy == "sma_crossover") {
-      for (std::size_t i = static_cast<std::size_t>(long_period);
-           i < sig_candles.size(); ++i) {
-        int sig = Signal::sma_crossover_signal(sig_candles, i, short_period,
-                                               long_period);
-        if (sig != 0) {
-          double t = static_cast<double>(sig_candles[i].open_time) / 1000.0;
-          double price = sig_candles[i].close;
-          double short_sma =
-              Signal::simple_moving_average(sig_candles, i, short_period);
-          double long_sma =
-              Signal::simple_moving_average(sig_candles, i, long_period);
-          cache.entries.push_back({t, price, short_sma, long_sma, sig});
-          cache.trades.push_back({t, price,
-                                  sig > 0
-                                      ? AppContext::TradeEvent::Side::Buy
-                                      : AppContext::TradeEvent::Side::Sell});
-        }
+    last.entries.clear();
+    last.trades.clear();
+
+    const auto short_p = static_cast<std::size_t>(std::max(short_period, 0));
+    const auto long_p = static_cast<std::size_t>(std::max(long_period, 0));
+    Config::SignalConfig cfg;
+    cfg.type = strategy;
+    cfg.short_period = short_p;
+    cfg.long_period = long_p;
+    cfg.params = {{"oversold", oversold}, {"overbought", overbought}};
+    const auto evaluator = Signal::make_strategy(cfg);
+    std::vector<int> signals(sig_candles.size(), 0);
+    evaluator->generate_signals(view, signals);
+    if (trend) {
+      const auto period = static_cast<std::size_t>(trend_period);
+      const auto ema = Signal::timeframe_indicator(
+          view, *trend, Signal::IndicatorSpec::ema(period));
+      const auto &higher = *trend->candles;
+      for (std::size_t i = 0; i < signals.size(); ++i) {
+        if (signals[i] == 0)
+          continue;
+        const std::int32_t k = trend->aligned[i];
+        const bool ready =
+            k != Core::TimeframeAlignment::kNone &&
+            static_cast<std::size_t>(k) + 1 >= period;
+        const double diff = ready ? higher[k].close - ema->values[k] : 0.0;
+        if ((signals[i] > 0 && !(diff > 0)) || (signals[i] < 0 && !(diff < 0)))
+          signals[i] = 0;
       }
+    }
+
+    // Table values; the strategy has just put them in the cache.
+    auto &indicators = Signal::IndicatorCache::instance();
+    std::shared_ptr<const Signal::IndicatorSeries> value1, value2;
+    if (strategy == "sma_crossover") {
+      value1 = indicators.get(series, version, sig_candles,
+                              Signal::IndicatorSpec::sma(short_p));
+      value2 = indicators.get(series, version, sig_candles,
+                              Signal::IndicatorSpec::sma(long_p));
     } else if (strategy == "ema") {
-      for (std::size_t i = static_cast<std::size_t>(short_period);
-           i < sig_candles.size(); ++i) {
-        int sig = Signal::ema_signal(sig_candles, i,
-                                     static_cast<std::size_t>(short_period));
-        if (sig != 0) {
-          double t = static_cast<double>(sig_candles[i].open_time) / 1000.0;
-          double price = sig_candles[i].close;
-          double ema = Signal::exponential_moving_average(
-              sig_candles, i, static_cast<std::size_t>(short_period));
-          cache.entries.push_back({t, price, ema, 0.0, sig});
-          cache.trades.push_back({t, price,
-                                  sig > 0
-                                      ? AppContext::TradeEvent::Side::Buy
-                                      : AppContext::TradeEvent::Side::Sell});
-        }
-      }
+      value1 = indicators.get(series, version, sig_candles,
+                              Signal::IndicatorSpec::ema(short_p));
     } else if (strategy == "rsi") {
-      for (std::size_t i = static_cast<std::size_t>(short_period);
-           i < sig_candles.size(); ++i) {
-        int sig = Signal::rsi_signal(sig_candles, i,
-                                     static_cast<std::size_t>(short_period),
-                                     oversold, overbought);
-        if (sig != 0) {
-          double t = static_cast<double>(sig_candles[i].open_time) / 1000.0;
-          double price = sig_candles[i].close;
-          double rsi = Signal::relative_strength_index(
-              sig_candles, i, static_cast<std::size_t>(short_period));
-          cache.entries.push_back({t, price, rsi, 0.0, sig});
-          cache.trades.push_back({t, price,
-                                  sig > 0
-                                      ? AppContext::TradeEvent::Side::Buy
-                                      : AppContext::TradeEvent::Side::Sell});
-        }
-      }
+      value1 = indicators.get(series, version, sig_candles,
+                              Signal::IndicatorSpec::rsi(short_p));
+    }
+    for (std::size_t i = 0; i < signals.size(); ++i) {
+      int sig = signals[i];
+      if (sig == 0)
+        continue;
+      double t = static_cast<double>(sig_candles[i].open_time) / 1000.0;
+      double price = sig_candles[i].close;
+      last.entries.push_back({t, price, value1 ? value1->values[i] : 0.0,
+                              value2 ? value2->values[i] : 0.0, sig});
+      last.trades.push_back({t, price,
+                             sig > 0 ? AppContext::TradeEvent::Side::Buy
+                                     : AppContext::TradeEvent::Side::Sell});
     }
 
-    cache.initialized = true;
+    last.initialized = true;
     status.signal_message = "Signals updated";
   }
 
-  signal_entries = cache.entries;
-  trades = cache.trades;
+  signal_entries = last.entries;
+  trades = last.trades;
 
   if (ImGui::BeginTable("SignalsTable", 4,
                         ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg)) {
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstdint>
 #include <map>
 #include <string>
 #include <vector>
@@ -18,5 +19,7 @@ void DrawSignalsWindow(
     const std::map<std::string,
                    std::map<std::string, std::vector<Core::Candle>>>
         &all_candles,
+    const std::map<std::pair<std::string, std::string>, std::uint64_t>
+        &series_versions,
     const std::string &active_pair, const std::string &selected_interval,
     AppStatus &status);
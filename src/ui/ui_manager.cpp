@@ -1636,9 +1636,24 @@ void UiManager::draw_status_bar() {
   ImGui::SameLine();
   ImGui::TextDisabled("FPS:"); ImGui::SameLine();
   ImGui::Text("%.0f", ImGui::GetIO().Framerate);
+  std::string latency;
+  {
+    std::lock_guard<std::mutex> lock(ui_mutex_);
+    latency = latency_summary_;
+  }
+  if (!latency.empty()) {
+    ImGui::SameLine();
+    ImGui::TextDisabled("Latency p50/p99 ms:"); ImGui::SameLine();
+    ImGui::TextUnformatted(latency.c_str());
+  }
   ImGui::End();
 }
 
+void UiManager::set_latency_summary(const std::string &summary) {
+  std::lock_guard<std::mutex> lock(ui_mutex_);
+  latency_summary_ = summary;
+}
+
 void UiManager::set_markers(const std::string &markers_json) {
   std::lock_guard<std::mutex> lock(ui_mutex_);
 #ifdef HAVE_WEBVIEW
@@ -1713,24 +1728,6 @@ void UiManager::remove_position(int id) {
       positions_.end());
 }
 
-std::function<void(const std::string &)> UiManager::candle_callback() {
-  return [this](const std::string &json) {
-    try {
-      auto j = nlohmann::json::parse(json);
-      Core::Candle c{};
-      c.open_time = j.value("time", 0ULL) * 1000ULL;
-      c.open = j.value("open", 0.0);
-      c.high = j.value("high", 0.0);
-      c.low = j.value("low", 0.0);
-      c.close = j.value("close", 0.0);
-      c.volume = j.value("volume", 0.0);
-      push_candle(c);
-    } catch (...) {
-      // ignore parse errors
-    }
-  };
-}
-
 void UiManager::set_candles(const std::vector<Core::Candle> &candles) {
   std::lock_guard<std::mutex> lock(ui_mutex_);
 #ifdef HAVE_WEBVIEW
@@ -36,8 +36,8 @@ public:
   void set_candles(const std::vector<Core::Candle> &candles);
   // Sends a new candle to the chart for real-time updates.
   void push_candle(const Core::Candle &candle);
-  // Provides callback to forward candle JSON to the chart.
-  std::function<void(const std::string &)> candle_callback();
+  // Stream latency summary (p50/p99 per stage) shown in the status bar.
+  void set_latency_summary(const std::string &summary);
   // Placeholder for future interval change notifications from embedded charts.
   void set_interval_callback(std::function<void(const std::string &)> cb);
   // Notify when the active trading pair changes.
@@ -109,6 +109,7 @@ private:
   std::optional<double> price_line_;
   std::string current_interval_;
   std::string current_pair_;
+  std::string latency_summary_;
   bool fit_next_plot_ = false;
   bool use_utc_time_ = false;
   bool show_seconds_pref_ = false; // show seconds on axis/cursor when true (otherwise derive from interval)
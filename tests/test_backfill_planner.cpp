@@ -0,0 +1,123 @@
+#include <gtest/gtest.h>
+#include "core/backfill_planner.h"
+#include "core/candle_utils.h"
+#include <vector>
+
+namespace {
+
+constexpr long long kMinute = 60'000;
+
+std::vector<Core::Candle> series(const std::vector<long long> &slots) {
+    std::vector<Core::Candle> out;
+    for (long long s : slots)
+        out.emplace_back(s * kMinute, 1.0, 2.0, 0.5, 1.5, 10.0, s * kMinute + kMinute - 1, 0.0, 5);
+    return out;
+}
+
+Core::BackfillOptions options(std::size_t cap) {
+    Core::BackfillOptions opts;
+    opts.interval_ms = kMinute;
+    opts.max_rows_per_request = cap;
+    return opts;
+}
+
+} // namespace
+
+TEST(BackfillPlannerTest, NoGapsMeansNoRequests) {
+    auto plan = Core::BackfillPlanner::plan(series({10, 11, 12, 13}), options(100));
+    EXPECT_TRUE(plan.gaps.empty());
+    EXPECT_TRUE(plan.requests.empty());
+}
+
+TEST(BackfillPlannerTest, NearbyGapsMergeIntoOneRequest) {
+    // Gaps at 11 and 13..14, separated by one present candle.
+    auto plan = Core::BackfillPlanner::plan(series({10, 12, 15}), options(100));
+    ASSERT_EQ(plan.gaps.size(), 2u);
+    EXPECT_EQ(plan.missing_candles, 3u);
+    ASSERT_EQ(plan.requests.size(), 1u);
+    EXPECT_EQ(plan.requests[0].start_ms, 11 * kMinute);
+    EXPECT_EQ(plan.requests[0].end_ms, 14 * kMinute);
+    EXPECT_EQ(plan.requested_candles, 4u);
+}
+
+TEST(BackfillPlannerTest, DistantGapsStaySeparateWhenMergingCostsMore) {
+    // Bridging 20 present candles would need an extra request at cap 10.
+    std::vector<long long> slots = {0};
+    for (long long s = 2; s <= 21; ++s) slots.push_back(s);
+    slots.push_back(23);
+    auto plan = Core::BackfillPlanner::plan(series(slots), options(10));
+    ASSERT_EQ(plan.requests.size(), 2u);
+    EXPECT_EQ(plan.requests[0].start_ms, 1 * kMinute);
+    EXPECT_EQ(plan.requests[0].end_ms, 1 * kMinute);
+    EXPECT_EQ(plan.requests[1].start_ms, 22 * kMinute);
+}
+
+TEST(BackfillPlannerTest, SplitsAtProviderRowLimit) {
+    auto opts = options(1000);
+    opts.window_start_ms = 0;
+    opts.window_end_ms = 2499 * kMinute;
+    auto plan = Core::BackfillPlanner::plan({}, opts);
+    EXPECT_EQ(plan.missing_candles, 2500u);
+    ASSERT_EQ(plan.requests.size(), 3u);
+    EXPECT_EQ(plan.requests[0].candles, 1000u);
+    EXPECT_EQ(plan.requests[2].candles, 500u);
+    EXPECT_EQ(plan.requests[2].end_ms, 2499 * kMinute);
+}
+
+TEST(BackfillPlannerTest, SyntheticFillerCountsAsGap) {
+    auto candles = series({10, 12, 13});
+    Core::fill_missing(candles, kMinute);
+    ASSERT_TRUE(candles[1].synthetic);
+    auto plan = Core::BackfillPlanner::plan(candles, options(100));
+    ASSERT_EQ(plan.requests.size(), 1u);
+    EXPECT_EQ(plan.requests[0].start_ms, 11 * kMinute);
+
+    auto keep = options(100);
+    keep.treat_synthetic_as_gap = false;
+    EXPECT_TRUE(Core::BackfillPlanner::plan(candles, keep).requests.empty());
+
+    // A received bar without trades looks the same but is not a gap.
+    candles[1].synthetic = false;
+    EXPECT_TRUE(Core::BackfillPlanner::plan(candles, options(100)).requests.empty());
+}
+
+TEST(BackfillPlannerTest, KnownEmptyRangesAreNotRequested) {
+    auto opts = options(100);
+    opts.window_start_ms = 1 * kMinute;
+    opts.window_end_ms = 12 * kMinute;
+    // Nothing before 5 and nothing at 11 on the venue side.
+    opts.known_empty = {{0, 4 * kMinute, 0}, {11 * kMinute, 11 * kMinute, 0}};
+    auto plan = Core::BackfillPlanner::plan(series({10, 12}), opts);
+    ASSERT_EQ(plan.gaps.size(), 1u);
+    EXPECT_EQ(plan.gaps[0].start_ms, 5 * kMinute);
+    EXPECT_EQ(plan.gaps[0].end_ms, 9 * kMinute);
+}
+
+TEST(BackfillPlannerTest, WindowExtendsIntoOlderHistoryAndTail) {
+    auto opts = options(100);
+    opts.window_start_ms = 5 * kMinute;
+    opts.window_end_ms = 14 * kMinute + 30'000; // unaligned end is rounded down
+    auto plan = Core::BackfillPlanner::plan(series({10, 11, 12}), opts);
+    ASSERT_EQ(plan.gaps.size(), 2u);
+    EXPECT_EQ(plan.gaps[0].start_ms, 5 * kMinute);
+    EXPECT_EQ(plan.gaps[0].end_ms, 9 * kMinute);
+    EXPECT_EQ(plan.gaps[1].start_ms, 13 * kMinute);
+    EXPECT_EQ(plan.gaps[1].end_ms, 14 * kMinute);
+    // Re-fetching the three stored candles is cheaper than a second request.
+    ASSERT_EQ(plan.requests.size(), 1u);
+    EXPECT_EQ(plan.requests[0].start_ms, 5 * kMinute);
+    EXPECT_EQ(plan.requests[0].end_ms, 14 * kMinute);
+}
+
+TEST(CandleUtilsTest, MergeReportsBarsBeforeTheLastOne) {
+    auto base = series({1, 2, 3});
+    EXPECT_FALSE(Core::merge_candles(base, series({3, 4, 5}))); // tail only
+    EXPECT_EQ(base.size(), 5u);
+    EXPECT_TRUE(Core::merge_candles(base, series({0, 6})));     // earlier bar
+    EXPECT_EQ(base.front().open_time, 0);
+    EXPECT_TRUE(Core::merge_candles(base, series({3})));        // rewrite
+    EXPECT_FALSE(Core::merge_candles(base, {}));
+    std::vector<Core::Candle> empty;
+    EXPECT_FALSE(Core::merge_candles(empty, series({1, 2})));
+    EXPECT_EQ(base.size(), 7u);
+}
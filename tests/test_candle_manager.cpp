@@ -1,4 +1,5 @@
 #include <gtest/gtest.h>
+#include "core/candle_batch_writer.h"
 #include "core/candle_manager.h"
 #include <filesystem>
 #include <fstream>
@@ -75,4 +76,53 @@ TEST_F(CandleManagerTest, Validate) {
     cm->save_candles("INVALID", "1m", invalid_candles);
 
     EXPECT_FALSE(cm->validate_candles("INVALID", "1m"));
-}
\ No newline at end of file
+}
+
+TEST_F(CandleManagerTest, AppendBatchKeepsHandlesAndSkipsDuplicates) {
+    auto candle = [](long long open_time, double close) {
+        return Core::Candle(open_time, close, close, close, close, 1.0, open_time + 59'999);
+    };
+    cm->save_candles("BTCUSDT", "1m", {candle(60'000, 1.0)});
+
+    std::vector<Core::CandleManager::SeriesAppend> batch{
+        {"BTCUSDT", "1m", {candle(60'000, 9.0), candle(120'000, 2.0)}}, // first is a duplicate
+        {"ETHUSDT", "1m", {candle(60'000, 3.0)}}};                      // new file
+    EXPECT_EQ(cm->append_batch(batch), 2u);
+    EXPECT_EQ(cm->append_batch({{"BTCUSDT", "1m", {candle(180'000, 4.0)}}}), 1u);
+
+    auto btc = cm->load_candles("BTCUSDT", "1m");
+    ASSERT_EQ(btc.size(), 3u);
+    EXPECT_DOUBLE_EQ(btc[0].close, 1.0);
+    EXPECT_EQ(btc[2].open_time, 180'000);
+    EXPECT_EQ(cm->read_last_open_time("BTCUSDT", "1m"), 180'000);
+    EXPECT_EQ(cm->load_candles("ETHUSDT", "1m").size(), 1u);
+
+    // A rewrite by another path must not leave a stale cached handle behind.
+    cm->save_candles("BTCUSDT", "1m", {candle(60'000, 1.0), candle(120'000, 2.0),
+                                       candle(180'000, 4.0), candle(240'000, 5.0)});
+    EXPECT_EQ(cm->append_batch({{"BTCUSDT", "1m", {candle(240'000, 5.0), candle(300'000, 6.0)}}}),
+              1u);
+    EXPECT_EQ(cm->load_candles("BTCUSDT", "1m").size(), 5u);
+    EXPECT_TRUE(cm->validate_candles("BTCUSDT", "1m"));
+}
+
+TEST_F(CandleManagerTest, BatchWriterCommitsAllSeriesTogether) {
+    Core::CandleBatchWriter writer(*cm);
+    for (const std::string sym : {"AAA", "BBB", "CCC"}) {
+        writer.enqueue(sym, "1m", Core::Candle(60'000, 1, 1, 1, 1, 1, 119'999));
+        writer.enqueue(sym, "1m", Core::Candle(60'000, 1, 1, 1, 2, 1, 119'999)); // replaces
+    }
+    EXPECT_EQ(writer.buffered(), 3u);
+    EXPECT_EQ(writer.flush(), 3u);
+    writer.enqueue("AAA", "1m", Core::Candle(120'000, 1, 1, 1, 3, 1, 179'999));
+    writer.stop(); // commits the remainder
+
+    auto stats = writer.stats();
+    EXPECT_EQ(stats.commits, 2u);
+    EXPECT_EQ(stats.candles, 4u);
+    EXPECT_EQ(stats.series_writes, 4u);
+    auto aaa = cm->load_candles("AAA", "1m");
+    ASSERT_EQ(aaa.size(), 2u);
+    EXPECT_DOUBLE_EQ(aaa[0].close, 2.0);
+    EXPECT_EQ(cm->load_candles("CCC", "1m").size(), 1u);
+}
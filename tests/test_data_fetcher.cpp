@@ -0,0 +1,693 @@
+#include <gtest/gtest.h>
+#include "core/candle_utils.h"
+#include "core/net/binance_data_provider.h"
+#include "core/net/hyperliquid_data_provider.h"
+#include "core/net/metadata_cache.h"
+#include "core/net/provider_health.h"
+#include "core/net/recording_http_client.h"
+#include "core/net/replay_http_client.h"
+#include "core/net/token_bucket_rate_limiter.h"
+#include "services/data_service.h"
+#include "services/prefetch_scheduler.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <filesystem>
+#include <map>
+#include <nlohmann/json.hpp>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace {
+
+// Scripted HTTP client: returns queued responses and records request headers.
+class FakeHttpClient : public Core::IHttpClient {
+public:
+    std::vector<Core::HttpResponse> responses;
+    std::vector<std::map<std::string, std::string>> seen_headers;
+
+    Core::HttpResponse get(const std::string &, std::chrono::milliseconds,
+                           const std::map<std::string, std::string> &headers) override {
+        seen_headers.push_back(headers);
+        if (responses.empty())
+            return {500, "", "no scripted response", false, {}};
+        auto r = responses.front();
+        responses.erase(responses.begin());
+        return r;
+    }
+    Core::HttpResponse post(const std::string &url, const std::string &,
+                            std::chrono::milliseconds timeout,
+                            const std::map<std::string, std::string> &headers) override {
+        return get(url, timeout, headers);
+    }
+};
+
+// Answers candleSnapshot POSTs with one candle per bar in the requested
+// window, truncated to the server cap like the real endpoint.
+class CandleSnapshotServer : public Core::IHttpClient {
+public:
+    std::atomic<int> posts{0};
+    std::size_t cap = 5000;
+
+    Core::HttpResponse get(const std::string &, std::chrono::milliseconds,
+                           const std::map<std::string, std::string> &) override {
+        return {404, "", "", false, {}};
+    }
+    Core::HttpResponse post(const std::string &, const std::string &body,
+                            std::chrono::milliseconds,
+                            const std::map<std::string, std::string> &) override {
+        ++posts;
+        auto req = nlohmann::json::parse(body)["req"];
+        const long long step = 60'000;
+        long long t = req["startTime"].get<long long>();
+        t = (t + step - 1) / step * step;
+        const long long end = req["endTime"].get<long long>();
+        nlohmann::json out = nlohmann::json::array();
+        for (; t <= end && out.size() < cap; t += step) {
+            out.push_back({{"t", t}, {"T", t + step - 1}, {"o", "1"}, {"h", "2"},
+                           {"l", "0.5"}, {"c", "1.5"}, {"v", "10"}, {"n", 3}});
+        }
+        return {200, out.dump(), "", false, {}};
+    }
+};
+
+class NoopRateLimiter : public Core::IRateLimiter {
+public:
+    void acquire() override {}
+};
+
+// Provider that answers every range with one candle whose close identifies
+// it, or fails like an unreachable venue while `down` is set. While held,
+// calls wait for release() so a test decides which provider answers first.
+class FakeProvider : public Core::IDataProvider {
+public:
+    explicit FakeProvider(double close) : close(close) {}
+
+    double close;
+    std::atomic<bool> down{false};
+    std::atomic<bool> empty{false};
+    mutable std::atomic<int> calls{0};
+    std::vector<std::string> symbols{"BTCUSDT"};
+
+    void hold() {
+        std::lock_guard<std::mutex> lock(gate_mutex);
+        held = true;
+    }
+    void release() {
+        {
+            std::lock_guard<std::mutex> lock(gate_mutex);
+            held = false;
+        }
+        gate_cv.notify_all();
+    }
+    // Blocks until the provider has been called `n` times in total.
+    void wait_for_calls(int n) const {
+        std::unique_lock<std::mutex> lock(gate_mutex);
+        gate_cv.wait(lock, [&]() { return calls.load() >= n; });
+    }
+
+    Core::KlinesResult fetch_klines(const std::string &symbol, const std::string &interval,
+                                    int, int max_retries,
+                                    std::chrono::milliseconds retry_delay) const override {
+        return fetch_range(symbol, interval, 0, 0, max_retries, retry_delay);
+    }
+    Core::KlinesResult fetch_range(const std::string &, const std::string &, long long start_ms,
+                                   long long, int, std::chrono::milliseconds) const override {
+        {
+            std::unique_lock<std::mutex> lock(gate_mutex);
+            ++calls;
+            gate_cv.notify_all();
+            gate_cv.wait(lock, [&]() { return !held; });
+        }
+        if (down)
+            return {Core::FetchError::NetworkError, 0, "unreachable", {}};
+        if (empty)
+            return {Core::FetchError::None, 200, "", {}};
+        return {Core::FetchError::None, 200, "", {Core::Candle(start_ms, close, close, close, close, 1.0)}};
+    }
+    Core::SymbolsResult fetch_all_symbols(int, std::chrono::milliseconds,
+                                          std::size_t) const override {
+        return {Core::FetchError::None, 200, "", symbols};
+    }
+    Core::IntervalsResult fetch_intervals(int, std::chrono::milliseconds) const override {
+        return {Core::FetchError::None, 200, "", {"1m"}};
+    }
+
+private:
+    mutable std::mutex gate_mutex;
+    mutable std::condition_variable gate_cv;
+    bool held{false};
+};
+
+} // namespace
+
+class MetadataCacheTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        test_dir = std::filesystem::temp_directory_path() / "metadata_cache_tests";
+        std::filesystem::create_directories(test_dir);
+        file = test_dir / "metadata_cache.json";
+    }
+
+    void TearDown() override {
+        std::filesystem::remove_all(test_dir);
+    }
+
+    std::filesystem::path test_dir;
+    std::filesystem::path file;
+};
+
+TEST_F(MetadataCacheTest, PersistsAcrossInstances) {
+    {
+        Core::MetadataCache cache(file);
+        cache.put("hl|symbols|100",
+                  {Core::MetadataCache::from_strings({"BTCUSDT", "ETHUSDT"}), 0, "\"v1\"", ""});
+        ASSERT_TRUE(cache.save());
+    }
+    Core::MetadataCache reloaded(file);
+    auto entry = reloaded.get("hl|symbols|100");
+    ASSERT_TRUE(entry.has_value());
+    EXPECT_EQ(Core::MetadataCache::to_strings(entry->value),
+              (std::vector<std::string>{"BTCUSDT", "ETHUSDT"}));
+    EXPECT_EQ(entry->etag, "\"v1\"");
+    EXPECT_GT(entry->fetched_at_ms, 0);
+}
+
+TEST_F(MetadataCacheTest, FreshnessHonoursTtl) {
+    Core::MetadataCache::Entry entry;
+    entry.fetched_at_ms = 1'000'000;
+    EXPECT_TRUE(Core::MetadataCache::is_fresh(entry, std::chrono::seconds(60), 1'000'000 + 59'000));
+    EXPECT_FALSE(Core::MetadataCache::is_fresh(entry, std::chrono::seconds(60), 1'000'000 + 60'000));
+    EXPECT_FALSE(Core::MetadataCache::is_fresh(entry, std::chrono::seconds(0), 1'000'000));
+}
+
+TEST_F(MetadataCacheTest, BinanceRevalidatesExchangeInfo) {
+    auto http = std::make_shared<FakeHttpClient>();
+    auto cache = std::make_shared<Core::MetadataCache>(file);
+    Core::BinanceDataProvider provider(http, std::make_shared<NoopRateLimiter>());
+    provider.set_metadata_cache(cache);
+
+    Core::HttpResponse full{200,
+                            R"({"symbols":[{"symbol":"BTCUSDT","klineIntervals":["1m","1h"]}]})",
+                            "", false, {{"etag", "\"abc\""}}};
+    http->responses.push_back(full);
+    auto first = provider.fetch_intervals(1, std::chrono::milliseconds(0));
+    ASSERT_EQ(first.error, Core::FetchError::None);
+    EXPECT_EQ(first.intervals, (std::vector<std::string>{"1h", "1m"}));
+    EXPECT_TRUE(http->seen_headers[0].empty());
+
+    http->responses.push_back({304, "", "", false, {}});
+    auto second = provider.fetch_intervals(1, std::chrono::milliseconds(0));
+    ASSERT_EQ(second.error, Core::FetchError::None);
+    EXPECT_EQ(second.http_status, 304);
+    EXPECT_EQ(second.intervals, first.intervals);
+    ASSERT_EQ(http->seen_headers.size(), 2u);
+    EXPECT_EQ(http->seen_headers[1].at("If-None-Match"), "\"abc\"");
+}
+
+TEST(ProviderHealthTest, OpensAfterConsecutiveFailuresAndRecovers) {
+    Core::ProviderHealth::Options opts;
+    opts.failure_threshold = 3;
+    opts.open_cooldown = std::chrono::milliseconds(1000);
+    Core::ProviderHealth health(opts);
+    auto t0 = Core::ProviderHealth::Clock::time_point{} + std::chrono::hours(1);
+    const auto ms = std::chrono::milliseconds(50);
+
+    for (int i = 0; i < 3; ++i) {
+        ASSERT_TRUE(health.allow_request(t0));
+        health.record_failure(ms, t0);
+    }
+    EXPECT_EQ(health.state(), Core::CircuitState::Open);
+    EXPECT_FALSE(health.allow_request(t0 + std::chrono::milliseconds(500)));
+
+    // Cooldown elapsed: exactly one probe goes through.
+    auto t1 = t0 + std::chrono::milliseconds(1000);
+    EXPECT_TRUE(health.allow_request(t1));
+    EXPECT_EQ(health.state(), Core::CircuitState::HalfOpen);
+    EXPECT_FALSE(health.allow_request(t1));
+
+    // Failed probe doubles the cooldown.
+    health.record_failure(ms, t1);
+    EXPECT_EQ(health.state(), Core::CircuitState::Open);
+    EXPECT_FALSE(health.allow_request(t1 + std::chrono::milliseconds(1500)));
+    auto t2 = t1 + std::chrono::milliseconds(2000);
+    EXPECT_TRUE(health.allow_request(t2));
+    health.record_success(ms, t2);
+    EXPECT_EQ(health.state(), Core::CircuitState::Closed);
+    EXPECT_EQ(health.snapshot().consecutive_failures, 0);
+}
+
+TEST(ProviderHealthTest, ClassifiesProviderFailures) {
+    using Core::FetchError;
+    EXPECT_TRUE(Core::ProviderHealth::is_provider_failure(FetchError::NetworkError, 0));
+    EXPECT_TRUE(Core::ProviderHealth::is_provider_failure(FetchError::HttpError, 503));
+    EXPECT_TRUE(Core::ProviderHealth::is_provider_failure(FetchError::HttpError, 429));
+    EXPECT_FALSE(Core::ProviderHealth::is_provider_failure(FetchError::HttpError, 400));
+    EXPECT_FALSE(Core::ProviderHealth::is_provider_failure(FetchError::InvalidInterval, 0));
+    EXPECT_FALSE(Core::ProviderHealth::is_provider_failure(FetchError::CircuitOpen, 0));
+    EXPECT_FALSE(Core::ProviderHealth::is_provider_failure(FetchError::None, 200));
+}
+
+TEST(ProviderHealthTest, TracksLatencyQuantile) {
+    Core::ProviderHealth health;
+    EXPECT_FALSE(health.latency_quantile(0.95).has_value());
+    for (int i = 1; i <= 100; ++i)
+        health.record_success(std::chrono::milliseconds(i));
+    auto p95 = health.latency_quantile(0.95);
+    ASSERT_TRUE(p95.has_value());
+    EXPECT_NEAR(static_cast<double>(p95->count()), 95.0, 1.0);
+    EXPECT_NEAR(health.snapshot().p95_ms, 95.0, 1.0);
+}
+
+// DataService over a scratch data directory, with fake providers registered
+// and selected through the configuration like the real ones.
+class DataServiceTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        test_dir = std::filesystem::temp_directory_path() / "data_service_tests";
+        std::filesystem::create_directories(test_dir);
+    }
+
+    void TearDown() override {
+        std::filesystem::remove_all(test_dir);
+    }
+
+    static std::shared_ptr<FakeProvider> add_provider(DataService &service, const std::string &name,
+                                                      double close,
+                                                      Core::ProviderHealth::Options opts = {}) {
+        auto provider = std::make_shared<FakeProvider>(close);
+        service.register_provider(name, provider, opts);
+        return provider;
+    }
+
+    static void select_providers(DataService &service, const std::string &primary,
+                                 std::optional<std::string> fallback = std::nullopt,
+                                 bool hedge = false) {
+        Config::ConfigData cfg;
+        cfg.primary_provider = primary;
+        cfg.fallback_provider = fallback;
+        cfg.hedge_requests = hedge;
+        service.set_config(cfg);
+    }
+
+    std::filesystem::path test_dir;
+};
+
+TEST_F(DataServiceTest, FailsOverWhileCircuitIsOpen) {
+    DataService service(test_dir);
+    Core::ProviderHealth::Options opts;
+    opts.failure_threshold = 2;
+    opts.open_cooldown = std::chrono::milliseconds(50);
+    auto primary = add_provider(service, "Primary", 1.0, opts);
+    auto backup = add_provider(service, "Backup", 2.0, opts);
+    select_providers(service, "primary", "backup");
+    ASSERT_EQ(service.get_active_provider_name(), "Primary");
+
+    auto close_of = [&]() {
+        auto res = service.fetch_range("BTCUSDT", "1m", 0, 60'000, 3, std::chrono::milliseconds(0));
+        return res.error == Core::FetchError::None && !res.candles.empty() ? res.candles[0].close : 0.0;
+    };
+    EXPECT_EQ(close_of(), 1.0);
+
+    // Each failure is served by the fallback; the second opens the circuit.
+    primary->down = true;
+    EXPECT_EQ(close_of(), 2.0);
+    EXPECT_EQ(close_of(), 2.0);
+    EXPECT_EQ(primary->calls.load(), 3);
+    EXPECT_EQ(service.provider_health()["Primary"].state, Core::CircuitState::Open);
+
+    // Open circuit: the primary is not contacted at all.
+    EXPECT_EQ(close_of(), 2.0);
+    EXPECT_EQ(primary->calls.load(), 3);
+
+    // After the cooldown the half-open probe reaches the recovered primary.
+    primary->down = false;
+    std::this_thread::sleep_for(std::chrono::milliseconds(60));
+    EXPECT_EQ(close_of(), 1.0);
+    EXPECT_EQ(primary->calls.load(), 4);
+    EXPECT_EQ(service.provider_health()["Primary"].state, Core::CircuitState::Closed);
+    EXPECT_EQ(backup->calls.load(), 3);
+}
+
+// Walks a series through an outage the way the App's fetch queue does: only
+// attempts that reached the provider count against max_retries. Without a
+// fallback, an open circuit used to fail every retry instantly and give the
+// series up for the rest of the session.
+TEST_F(DataServiceTest, OutageWithoutFallbackDoesNotUseUpRetries) {
+    DataService service(test_dir);
+    Core::ProviderHealth::Options opts;
+    opts.failure_threshold = 2;
+    opts.open_cooldown = std::chrono::milliseconds(20);
+    auto primary = add_provider(service, "Primary", 1.0, opts);
+    select_providers(service, "primary");
+    std::vector<std::string> recovered;
+    service.set_on_provider_recovered(
+        [&](const std::string &provider) { recovered.push_back(provider); });
+
+    const int max_retries = 3;
+    int retries = 0;
+    int rejected = 0;
+    auto attempt = [&]() {
+        auto res = service.fetch_klines("BTCUSDT", "1m", 1, 1, std::chrono::milliseconds(0));
+        if (res.error == Core::FetchError::CircuitOpen)
+            ++rejected;
+        else if (res.error != Core::FetchError::None)
+            ++retries;
+        return res;
+    };
+
+    primary->down = true;
+    EXPECT_EQ(attempt().error, Core::FetchError::NetworkError);
+    EXPECT_EQ(attempt().error, Core::FetchError::NetworkError);
+    EXPECT_EQ(service.provider_health()["Primary"].state, Core::CircuitState::Open);
+
+    // Open circuit: rejected without contacting the provider, as often as
+    // the queue asks, and none of it is a retry.
+    for (int i = 0; i <= max_retries; ++i)
+        EXPECT_EQ(attempt().error, Core::FetchError::CircuitOpen);
+    EXPECT_EQ(primary->calls.load(), 2);
+    EXPECT_TRUE(recovered.empty());
+
+    // The first attempt after the cooldown is the probe; it succeeds, closes
+    // the circuit and reports the recovery.
+    primary->down = false;
+    auto res = attempt();
+    while (res.error == Core::FetchError::CircuitOpen) {
+        std::this_thread::yield();
+        res = attempt();
+    }
+    ASSERT_EQ(res.error, Core::FetchError::None);
+    EXPECT_EQ(res.candles[0].close, 1.0);
+    EXPECT_EQ(primary->calls.load(), 3);
+    EXPECT_EQ(service.provider_health()["Primary"].state, Core::CircuitState::Closed);
+    EXPECT_EQ(recovered, (std::vector<std::string>{"Primary"}));
+    EXPECT_EQ(retries, 2);
+    EXPECT_LE(retries, max_retries);
+    EXPECT_GT(rejected, max_retries);
+}
+
+TEST_F(DataServiceTest, BackfillRemembersBarsTheVenueDoesNotHave) {
+    DataService service(test_dir);
+    auto provider = add_provider(service, "Primary", 1.0);
+    select_providers(service, "primary");
+
+    const long long step = 60'000;
+    const long long base = 1'600'000'000'000LL / step * step;
+    std::vector<Core::Candle> candles;
+    for (long long s : {0, 1, 2, 5, 6})
+        candles.emplace_back(base + s * step, 1.0, 1.0, 1.0, 1.0, 0.0, base + s * step + step - 1);
+    Core::fill_missing(candles, step);
+
+    // One request for slots 3..4; the venue only has slot 3.
+    auto report = service.backfill("BTCUSDT", "1m", candles);
+    EXPECT_EQ(report.executed_requests, 1u);
+    EXPECT_TRUE(report.changed);
+    ASSERT_EQ(candles.size(), 7u);
+    EXPECT_FALSE(candles[3].synthetic);
+    EXPECT_TRUE(candles[4].synthetic);
+    // Flat zero-volume bars that were received are not gaps either.
+    EXPECT_FALSE(candles[1].synthetic);
+
+    // Placeholders are not written; loading fills the hole again.
+    auto loaded = service.load_candles("BTCUSDT", "1m");
+    ASSERT_EQ(loaded.size(), 7u);
+    EXPECT_TRUE(loaded[4].synthetic);
+
+    report = service.backfill("BTCUSDT", "1m", loaded);
+    EXPECT_EQ(report.planned_requests, 0u);
+    EXPECT_EQ(provider->calls.load(), 1);
+
+    // Remembered across restarts through the metadata cache.
+    DataService restarted(test_dir);
+    restarted.register_provider("Primary", provider);
+    select_providers(restarted, "primary");
+    EXPECT_EQ(restarted.backfill("BTCUSDT", "1m", loaded).planned_requests, 0u);
+}
+
+TEST_F(DataServiceTest, HedgedFetchRacesSecondaryProvider) {
+    {
+        // The secondary's symbol list as the background refresh stores it.
+        Core::MetadataCache cache(test_dir / "metadata_cache.json");
+        cache.put("backup|symbols|hedge", {Core::MetadataCache::from_strings({"BTCUSDT"}), 0, "", ""});
+        ASSERT_TRUE(cache.save());
+    }
+    DataService service(test_dir);
+    auto primary = add_provider(service, "Primary", 1.0);
+    auto backup = add_provider(service, "Backup", 2.0);
+    select_providers(service, "primary", "backup", true);
+    // Fast answers put the primary's p95, and so the hedge delay, at the
+    // 150ms floor.
+    for (int i = 0; i < 5; ++i)
+        service.fetch_range("BTCUSDT", "1m", 0, 60'000, 1, std::chrono::milliseconds(0));
+
+    auto hedged = [&](const std::string &symbol) {
+        return std::async(std::launch::async, [&service, symbol]() {
+            return service.fetch_range_hedged(symbol, "1m", 0, 60'000, 1,
+                                              std::chrono::milliseconds(0));
+        });
+    };
+
+    // Primary slower than the delay but answering before the hedge.
+    primary->hold();
+    backup->hold();
+    auto pending = hedged("BTCUSDT");
+    backup->wait_for_calls(1);
+    primary->release();
+    auto res = pending.get();
+    ASSERT_EQ(res.error, Core::FetchError::None);
+    EXPECT_EQ(res.candles[0].close, 1.0);
+    EXPECT_EQ(service.hedge_stats().issued, 1u);
+    EXPECT_EQ(service.hedge_stats().won, 0u);
+    backup->release();
+    service.wait_for_hedged_requests();
+
+    // Stalled primary: the hedge answers first.
+    primary->hold();
+    res = hedged("BTCUSDT").get();
+    ASSERT_EQ(res.error, Core::FetchError::None);
+    EXPECT_EQ(res.candles[0].close, 2.0);
+    EXPECT_EQ(service.hedge_stats().issued, 2u);
+    EXPECT_EQ(service.hedge_stats().won, 1u);
+    primary->release();
+    service.wait_for_hedged_requests();
+    EXPECT_EQ(primary->calls.load(), 7);
+
+    // A symbol the secondary does not list is never hedged: a stalled
+    // primary keeps the call waiting well past the hedge delay.
+    primary->hold();
+    pending = hedged("DOGEUSDT");
+    primary->wait_for_calls(8);
+    EXPECT_EQ(pending.wait_for(std::chrono::milliseconds(300)), std::future_status::timeout);
+    primary->release();
+    res = pending.get();
+    EXPECT_EQ(res.candles[0].close, 1.0);
+    EXPECT_EQ(service.hedge_stats().issued, 2u);
+    EXPECT_EQ(backup->calls.load(), 2);
+
+    // Both fail: the failure is reported and nothing is won.
+    primary->down = true;
+    backup->down = true;
+    primary->hold();
+    pending = hedged("BTCUSDT");
+    backup->wait_for_calls(3);
+    primary->release();
+    res = pending.get();
+    EXPECT_EQ(res.error, Core::FetchError::NetworkError);
+    EXPECT_EQ(service.hedge_stats().issued, 3u);
+    EXPECT_EQ(service.hedge_stats().won, 1u);
+    service.wait_for_hedged_requests();
+}
+
+// Scratch directory for recorded HTTP fixtures.
+class ReplayHttpTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        test_dir = std::filesystem::temp_directory_path() / "replay_http_tests";
+        std::filesystem::create_directories(test_dir);
+        fixture = test_dir / "http_fixture.jsonl";
+    }
+
+    void TearDown() override {
+        std::filesystem::remove_all(test_dir);
+    }
+
+    std::filesystem::path test_dir;
+    std::filesystem::path fixture;
+};
+
+TEST_F(ReplayHttpTest, RecordedExchangesReplayInOrder) {
+    auto http = std::make_shared<FakeHttpClient>();
+    http->responses.push_back({200, "first", "", false, {{"etag", "\"1\""}}});
+    http->responses.push_back({503, "second", "busy", false, {}});
+    {
+        Core::RecordingHttpClient recorder(http, fixture);
+        ASSERT_TRUE(recorder.is_open());
+        recorder.get("http://mock/api/v3/klines?startTime=1", std::chrono::milliseconds(100), {});
+        recorder.post("http://mock/info", "{\"a\":1}", std::chrono::milliseconds(100), {});
+    }
+
+    Core::ReplayHttpClient replay;
+    ASSERT_EQ(replay.load(fixture), 2u);
+    auto r1 = replay.get("http://mock/api/v3/klines?startTime=1", std::chrono::milliseconds(100), {});
+    EXPECT_EQ(r1.status_code, 200);
+    EXPECT_EQ(r1.text, "first");
+    EXPECT_EQ(r1.headers.at("etag"), "\"1\"");
+    auto r2 = replay.post("http://mock/info", "{\"a\":1}", std::chrono::milliseconds(100), {});
+    EXPECT_EQ(r2.status_code, 503);
+    EXPECT_EQ(r2.error_message, "busy");
+
+    // Same path, different query: served in non-strict mode only.
+    auto r3 = replay.get("http://mock/api/v3/klines?startTime=2", std::chrono::milliseconds(100), {});
+    EXPECT_EQ(r3.text, "first");
+    Core::ReplayHttpClient strict({true, false, 1.0});
+    strict.load(fixture);
+    auto r4 = strict.get("http://mock/api/v3/klines?startTime=2", std::chrono::milliseconds(100), {});
+    EXPECT_TRUE(r4.network_error);
+    EXPECT_EQ(strict.misses(), 1u);
+}
+
+TEST_F(ReplayHttpTest, FallbackMatchesBodyFieldsAndServesOnce) {
+    auto snapshot = [](const std::string &coin, long long start) {
+        return nlohmann::json{{"type", "candleSnapshot"},
+                              {"req", {{"coin", coin}, {"interval", "1m"}, {"startTime", start}}}}
+            .dump();
+    };
+    Core::ReplayHttpClient replay;
+    auto record = [&](const std::string &body, const std::string &text) {
+        Core::HttpExchange exchange;
+        exchange.method = "POST";
+        exchange.url = "http://mock/info";
+        exchange.body = body;
+        exchange.response = {200, text, "", false, {}};
+        replay.add(exchange);
+    };
+    record(snapshot("BTC", 1), "btc1");
+    record(snapshot("ETH", 1), "eth1");
+    record(snapshot("BTC", 2), "btc2");
+    record(R"({"type":"meta"})", "meta");
+    const auto timeout = std::chrono::milliseconds(100);
+
+    EXPECT_EQ(replay.post("http://mock/info", snapshot("BTC", 1), timeout, {}).text, "btc1");
+    // Other start times: the next unserved recording for the same coin.
+    EXPECT_EQ(replay.post("http://mock/info", snapshot("BTC", 9), timeout, {}).text, "btc2");
+    EXPECT_EQ(replay.post("http://mock/info", snapshot("ETH", 9), timeout, {}).text, "eth1");
+    EXPECT_EQ(replay.post("http://mock/info", R"({"type":"meta"})", timeout, {}).text, "meta");
+    // Drained: the last answer for the coin repeats.
+    EXPECT_EQ(replay.post("http://mock/info", snapshot("BTC", 10), timeout, {}).text, "btc2");
+    EXPECT_TRUE(replay.post("http://mock/info", snapshot("SOL", 1), timeout, {}).network_error);
+    EXPECT_EQ(replay.served(), 5u);
+    EXPECT_EQ(replay.misses(), 1u);
+}
+
+TEST(HyperliquidDataProviderTest, PaginatesRangesBeyondServerCap) {
+    auto http = std::make_shared<CandleSnapshotServer>();
+    Core::HyperliquidDataProvider provider(http, std::make_shared<NoopRateLimiter>());
+    const long long step = 60'000;
+    const long long start = 1'700'000'000'000LL / step * step;
+    const long long end = start + 11'999 * step;
+
+    auto res = provider.fetch_range("BTCUSDT", "1m", start, end, 1, std::chrono::milliseconds(0));
+    ASSERT_EQ(res.error, Core::FetchError::None);
+    EXPECT_EQ(http->posts.load(), 3);
+    ASSERT_EQ(res.candles.size(), 12'000u);
+    EXPECT_EQ(res.candles.front().open_time, start);
+    EXPECT_EQ(res.candles.back().open_time, end);
+    for (std::size_t i = 1; i < res.candles.size(); ++i)
+        ASSERT_EQ(res.candles[i].open_time - res.candles[i - 1].open_time, step);
+
+    http->posts = 0;
+    auto small = provider.fetch_range("BTCUSDT", "1m", start, start + 99 * step, 1,
+                                      std::chrono::milliseconds(0));
+    EXPECT_EQ(http->posts.load(), 1);
+    EXPECT_EQ(small.candles.size(), 100u);
+}
+
+TEST(PrefetchSchedulerTest, RunsHighestPriorityFirstOnceIdle) {
+    std::atomic<bool> idle{false};
+    std::vector<std::string> order;
+    std::atomic<bool> background_tagged{true};
+    PrefetchScheduler scheduler(
+        [&](const std::string &pair, const std::string &interval) {
+            if (Core::current_request_priority() != Core::RequestPriority::Background)
+                background_tagged = false;
+            order.push_back(pair + " " + interval);
+            return std::vector<Core::Candle>{Core::Candle{}};
+        },
+        [&]() { return idle.load(); }, std::chrono::milliseconds(5));
+    scheduler.start();
+    scheduler.enqueue("AAA", "1h", PrefetchPriority::Background);
+    scheduler.enqueue("BBB", "5m", PrefetchPriority::Adjacent);
+    scheduler.enqueue("CCC", "1m", PrefetchPriority::Visible);
+    scheduler.enqueue("AAA", "1h", PrefetchPriority::Visible); // raised
+    scheduler.enqueue("DDD", "1d", PrefetchPriority::Background);
+    scheduler.cancel("DDD", "1d");
+    std::this_thread::sleep_for(std::chrono::milliseconds(30));
+    EXPECT_EQ(scheduler.completed(), 0u); // limiter busy: nothing starts
+    idle = true;
+    for (int i = 0; i < 200 && scheduler.completed() < 3; ++i)
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    scheduler.stop();
+
+    ASSERT_EQ(order.size(), 3u);
+    EXPECT_EQ(order[0], "CCC 1m");
+    EXPECT_EQ(order[1], "AAA 1h");
+    EXPECT_EQ(order[2], "BBB 5m");
+    EXPECT_TRUE(background_tagged);
+    EXPECT_EQ(scheduler.take_results().size(), 3u);
+}
+
+TEST(PrefetchSchedulerTest, CancelDropsRunningAndCompletedResults) {
+    std::atomic<bool> release{false};
+    std::atomic<int> started{0};
+    PrefetchScheduler scheduler(
+        [&](const std::string &pair, const std::string &) {
+            ++started;
+            while (pair == "AAA" && !release)
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            return std::vector<Core::Candle>{Core::Candle{}};
+        },
+        nullptr, std::chrono::milliseconds(5));
+    scheduler.start();
+    scheduler.enqueue("BBB", "1m", PrefetchPriority::Visible);
+    for (int i = 0; i < 200 && scheduler.completed() < 1; ++i)
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    scheduler.enqueue("AAA", "1m", PrefetchPriority::Visible);
+    for (int i = 0; i < 200 && started < 2; ++i)
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+
+    // BBB finished but was not taken; AAA is still running.
+    scheduler.cancel("BBB", "1m");
+    scheduler.cancel("AAA", "1m");
+    release = true;
+    for (int i = 0; i < 200 && scheduler.completed() < 2; ++i)
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    scheduler.stop();
+    EXPECT_EQ(scheduler.completed(), 2u);
+    EXPECT_TRUE(scheduler.take_results().empty());
+}
+
+TEST(TokenBucketRateLimiterTest, BackgroundYieldsToForeground) {
+    Core::TokenBucketRateLimiter limiter(1, std::chrono::milliseconds(50));
+    limiter.acquire();
+    EXPECT_FALSE(limiter.has_idle_capacity());
+
+    std::atomic<int> seq{0};
+    int background_pos = -1;
+    std::thread background([&] {
+        Core::ScopedRequestPriority scope(Core::RequestPriority::Background);
+        limiter.acquire();
+        background_pos = seq++;
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    limiter.acquire(); // foreground, queued after the background caller
+    const int foreground_pos = seq++;
+    background.join();
+
+    EXPECT_EQ(foreground_pos, 0);
+    EXPECT_EQ(background_pos, 1);
+}
+
@@ -0,0 +1,857 @@
+#include <gtest/gtest.h>
+#include "core/bar_aggregator.h"
+#include "core/bar_update_coalescer.h"
+#include "core/kline_parsers.h"
+#include "core/candle_manager.h"
+#include "core/kline_queue.h"
+#include "core/latency_tracker.h"
+#include "core/market_data_bus.h"
+#include "core/market_data_recorder.h"
+#include "core/spsc_ring.h"
+#include "core/stream_multiplexer.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <filesystem>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <nlohmann/json.hpp>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// Shared state of every socket a FakeWebSocket factory hands out.
+struct FakeSocketLog {
+    std::mutex mutex;
+    int created = 0;
+    std::vector<std::string> urls;
+    std::vector<std::string> sent;
+    Core::IWebSocket::MessageCallback on_message;
+    Core::IWebSocket::ErrorCallback on_error;
+};
+
+class FakeWebSocket : public Core::IWebSocket {
+public:
+    explicit FakeWebSocket(std::shared_ptr<FakeSocketLog> log) : log_(std::move(log)) {}
+    void setUrl(const std::string &url) override {
+        std::lock_guard<std::mutex> lock(log_->mutex);
+        log_->urls.push_back(url);
+    }
+    void setOnMessage(MessageCallback cb) override {
+        std::lock_guard<std::mutex> lock(log_->mutex);
+        log_->on_message = std::move(cb);
+    }
+    void setOnError(ErrorCallback cb) override {
+        std::lock_guard<std::mutex> lock(log_->mutex);
+        log_->on_error = std::move(cb);
+    }
+    void setOnClose(CloseCallback cb) override { close_cb_ = std::move(cb); }
+    void setOnOpen(OpenCallback cb) override { open_cb_ = std::move(cb); }
+    void sendText(const std::string &text) override {
+        std::lock_guard<std::mutex> lock(log_->mutex);
+        log_->sent.push_back(text);
+    }
+    void start() override {
+        if (open_cb_) open_cb_();
+    }
+    void stop() override {
+        if (close_cb_) close_cb_();
+    }
+
+private:
+    std::shared_ptr<FakeSocketLog> log_;
+    OpenCallback open_cb_;
+    CloseCallback close_cb_;
+};
+
+Core::WebSocketFactory fake_factory(const std::shared_ptr<FakeSocketLog> &log) {
+    return [log]() {
+        {
+            std::lock_guard<std::mutex> lock(log->mutex);
+            ++log->created;
+        }
+        return std::make_unique<FakeWebSocket>(log);
+    };
+}
+
+bool wait_until(const std::function<bool()> &pred) {
+    for (int i = 0; i < 400; ++i) {
+        if (pred())
+            return true;
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    return pred();
+}
+
+std::size_t sent_count(FakeSocketLog &log) {
+    std::lock_guard<std::mutex> lock(log.mutex);
+    return log.sent.size();
+}
+
+void push(FakeSocketLog &log, const nlohmann::json &msg) {
+    Core::IWebSocket::MessageCallback cb;
+    {
+        std::lock_guard<std::mutex> lock(log.mutex);
+        cb = log.on_message;
+    }
+    ASSERT_TRUE(cb);
+    cb(msg.dump());
+}
+
+} // namespace
+
+class StreamMultiplexerTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        dir = std::filesystem::temp_directory_path() / "stream_mux_test";
+        std::filesystem::remove_all(dir);
+        std::filesystem::create_directories(dir);
+    }
+    void TearDown() override { std::filesystem::remove_all(dir); }
+    std::filesystem::path dir;
+};
+
+TEST_F(StreamMultiplexerTest, BinanceCombinedStreamOnOneSocket) {
+    Core::CandleManager manager(dir);
+    auto log = std::make_shared<FakeSocketLog>();
+    Core::StreamMultiplexer mux("binance", manager, fake_factory(log));
+    std::atomic<int> btc{0}, eth{0};
+    mux.bus()->on_candle_closed([&](const Core::CandleEvent &e) {
+        ++(e.symbol == "BTCUSDT" ? btc : eth);
+    });
+    mux.subscribe("BTCUSDT", "1m");
+    mux.subscribe("ETHUSDT", "1m");
+    mux.start();
+    ASSERT_TRUE(wait_until([&] { return mux.connected(); }));
+    {
+        std::lock_guard<std::mutex> lock(log->mutex);
+        ASSERT_EQ(log->urls.size(), 1u);
+        EXPECT_EQ(log->urls[0], "wss://stream.binance.com:9443/stream"
+                                "?streams=btcusdt@kline_1m/ethusdt@kline_1m");
+    }
+
+    mux.subscribe("SOLUSDT", "1m");
+    ASSERT_TRUE(wait_until([&] { return sent_count(*log) == 1; }));
+    mux.unsubscribe("ETHUSDT", "1m");
+    ASSERT_TRUE(wait_until([&] { return sent_count(*log) == 2; }));
+    {
+        std::lock_guard<std::mutex> lock(log->mutex);
+        auto sub = nlohmann::json::parse(log->sent[0]);
+        EXPECT_EQ(sub["method"], "SUBSCRIBE");
+        EXPECT_EQ(sub["params"], nlohmann::json::array({"solusdt@kline_1m"}));
+        auto unsub = nlohmann::json::parse(log->sent[1]);
+        EXPECT_EQ(unsub["method"], "UNSUBSCRIBE");
+        EXPECT_EQ(unsub["params"], nlohmann::json::array({"ethusdt@kline_1m"}));
+    }
+
+    auto kline = [](const std::string &stream, long long t, bool closed) {
+        return nlohmann::json{
+            {"stream", stream},
+            {"data", {{"e", "kline"},
+                      {"k", {{"t", t}, {"T", t + 59'999}, {"o", "1"}, {"h", "2"},
+                             {"l", "0.5"}, {"c", "1.5"}, {"v", "10"}, {"n", 4},
+                             {"x", closed}}}}}};
+    };
+    push(*log, kline("btcusdt@kline_1m", 60'000, false)); // still forming
+    push(*log, kline("btcusdt@kline_1m", 60'000, true));
+    push(*log, kline("ethusdt@kline_1m", 60'000, true));  // unsubscribed
+    push(*log, {{"result", nullptr}, {"id", 1}});         // ack
+    mux.stop();
+
+    EXPECT_EQ(btc.load(), 1);
+    EXPECT_EQ(eth.load(), 0);
+    EXPECT_EQ(log->created, 1);
+    auto stored = manager.load_candles("BTCUSDT", "1m");
+    ASSERT_EQ(stored.size(), 1u);
+    EXPECT_EQ(stored[0].open_time, 60'000);
+}
+
+TEST_F(StreamMultiplexerTest, GateSubscribesEachSeriesAfterOpen) {
+    Core::CandleManager manager(dir);
+    auto log = std::make_shared<FakeSocketLog>();
+    Core::StreamMultiplexer mux("gateio", manager, fake_factory(log));
+    std::map<std::string, int> seen;
+    std::mutex seen_mutex;
+    mux.bus()->on_candle_closed([&](const Core::CandleEvent &e) {
+        std::lock_guard<std::mutex> lock(seen_mutex);
+        ++seen[e.symbol];
+    });
+    mux.subscribe("BTCUSDT", "1m");
+    mux.subscribe("ETHUSDT", "1m");
+    mux.start();
+    ASSERT_TRUE(wait_until([&] { return sent_count(*log) == 2; }));
+    {
+        std::lock_guard<std::mutex> lock(log->mutex);
+        EXPECT_EQ(log->urls[0], "wss://api.gateio.ws/ws/v4/");
+        auto first = nlohmann::json::parse(log->sent[0]);
+        EXPECT_EQ(first["event"], "subscribe");
+        EXPECT_EQ(first["payload"], nlohmann::json::array({"1m", "BTC_USDT"}));
+    }
+
+    auto update = [](const std::string &name, bool closed) {
+        return nlohmann::json{
+            {"channel", "spot.candlesticks"},
+            {"event", "update"},
+            {"result", {{"t", "120"}, {"o", "1"}, {"h", "2"}, {"l", "0.5"},
+                        {"c", "1.5"}, {"v", "10"}, {"n", name}, {"w", closed}}}};
+    };
+    push(*log, update("1m_ETH_USDT", true));
+    push(*log, update("1m_BTC_USDT", false));
+    mux.stop();
+
+    std::lock_guard<std::mutex> lock(seen_mutex);
+    EXPECT_EQ(seen["ETHUSDT"], 1);
+    EXPECT_EQ(seen["BTCUSDT"], 0);
+}
+
+TEST_F(StreamMultiplexerTest, HyperliquidClosesBarWhenNextOneStarts) {
+    Core::CandleManager manager(dir);
+    auto log = std::make_shared<FakeSocketLog>();
+    Core::StreamMultiplexer mux("hyperliquid", manager, fake_factory(log));
+    std::vector<Core::Candle> btc;
+    std::mutex btc_mutex;
+    mux.bus()->on_candle_closed(
+        [&](const Core::CandleEvent &e) {
+            std::lock_guard<std::mutex> lock(btc_mutex);
+            btc.push_back(e.candle);
+        },
+        "BTCUSDT", "1m");
+    mux.subscribe("BTCUSDT", "1m");
+    mux.subscribe("ETH", "1m");
+    mux.start();
+    ASSERT_TRUE(wait_until([&] { return sent_count(*log) == 2; }));
+    {
+        std::lock_guard<std::mutex> lock(log->mutex);
+        ASSERT_EQ(log->urls.size(), 1u);
+        EXPECT_EQ(log->urls[0], "wss://api.hyperliquid.xyz/ws");
+        auto first = nlohmann::json::parse(log->sent[0]);
+        EXPECT_EQ(first["method"], "subscribe");
+        EXPECT_EQ(first["subscription"]["type"], "candle");
+        EXPECT_EQ(first["subscription"]["coin"], "BTC");
+        EXPECT_EQ(first["subscription"]["interval"], "1m");
+    }
+
+    auto candle = [](const std::string &coin, long long t, const std::string &close) {
+        return nlohmann::json{
+            {"channel", "candle"},
+            {"data", {{"t", t}, {"T", t + 59'999}, {"s", coin}, {"i", "1m"},
+                      {"o", "1"}, {"h", "2"}, {"l", "0.5"}, {"c", close},
+                      {"v", "10"}, {"n", 7}}}};
+    };
+    push(*log, {{"channel", "subscriptionResponse"}, {"data", {}}});
+    push(*log, candle("BTC", 60'000, "1.1"));
+    push(*log, candle("BTC", 60'000, "1.4")); // same bar, still forming
+    push(*log, candle("ETH", 120'000, "3"));  // other coin does not close BTC
+    {
+        std::lock_guard<std::mutex> lock(btc_mutex);
+        EXPECT_TRUE(btc.empty());
+    }
+    push(*log, candle("BTC", 120'000, "1.5")); // next bar: previous one is final
+
+    mux.unsubscribe("ETH", "1m");
+    ASSERT_TRUE(wait_until([&] { return sent_count(*log) == 3; }));
+    mux.stop();
+
+    std::lock_guard<std::mutex> lock(btc_mutex);
+    ASSERT_EQ(btc.size(), 1u);
+    EXPECT_EQ(btc[0].open_time, 60'000);
+    EXPECT_DOUBLE_EQ(btc[0].close, 1.4);
+    EXPECT_EQ(btc[0].number_of_trades, 7);
+    EXPECT_EQ(nlohmann::json::parse(log->sent[2])["method"], "unsubscribe");
+    EXPECT_EQ(log->created, 1);
+    EXPECT_EQ(manager.load_candles("BTCUSDT", "1m").size(), 1u);
+}
+
+TEST(BarAggregatorTest, MatchesExchangeKlineFields) {
+    Core::BarAggregator agg;
+    ASSERT_TRUE(agg.add_interval("5s"));
+    ASSERT_TRUE(agg.add_interval("1m"));
+    EXPECT_FALSE(agg.add_interval("bogus"));
+
+    auto agg_trade = [](long long t, const char *p, const char *q, bool maker, long long f,
+                        long long l) {
+        return nlohmann::json{{"e", "aggTrade"}, {"T", t}, {"p", p}, {"q", q},
+                              {"m", maker},      {"f", f}, {"l", l}};
+    };
+    std::vector<Core::BarAggregator::Bar> closed;
+    for (const auto &j : {agg_trade(60'000, "10", "1", false, 1, 1),
+                          agg_trade(61'000, "12", "2", true, 2, 4),
+                          agg_trade(64'999, "9", "1", false, 5, 5),
+                          // 65s-70s has no trades; 70s closes the first 5s bar
+                          agg_trade(70'500, "11", "3", false, 6, 7)}) {
+        auto trade = Core::parse_binance_trade(j);
+        ASSERT_TRUE(trade);
+        agg.on_trade(*trade, closed);
+    }
+    ASSERT_EQ(closed.size(), 2u);
+
+    // What Binance reports for the 60s-65s window of the same trades.
+    auto kline = Core::parse_binance_kline(
+        {{"t", 60'000}, {"T", 64'999}, {"o", "10"}, {"h", "12"}, {"l", "9"}, {"c", "9"},
+         {"v", "4"}, {"q", "43"}, {"n", 5}, {"V", "2"}, {"Q", "19"}, {"x", true}});
+    ASSERT_TRUE(kline);
+    const auto &bar = closed[0].candle;
+    const auto &ref = kline->candle;
+    EXPECT_EQ(closed[0].interval, "5s");
+    EXPECT_EQ(bar.open_time, ref.open_time);
+    EXPECT_EQ(bar.close_time, ref.close_time);
+    EXPECT_DOUBLE_EQ(bar.open, ref.open);
+    EXPECT_DOUBLE_EQ(bar.high, ref.high);
+    EXPECT_DOUBLE_EQ(bar.low, ref.low);
+    EXPECT_DOUBLE_EQ(bar.close, ref.close);
+    EXPECT_DOUBLE_EQ(bar.volume, ref.volume);
+    EXPECT_DOUBLE_EQ(bar.quote_asset_volume, ref.quote_asset_volume);
+    EXPECT_EQ(bar.number_of_trades, ref.number_of_trades);
+    EXPECT_DOUBLE_EQ(bar.taker_buy_base_asset_volume, ref.taker_buy_base_asset_volume);
+    EXPECT_DOUBLE_EQ(bar.taker_buy_quote_asset_volume, ref.taker_buy_quote_asset_volume);
+
+    // The empty window is a flat bar at the previous close.
+    EXPECT_EQ(closed[1].candle.open_time, 65'000);
+    EXPECT_DOUBLE_EQ(closed[1].candle.high, 9.0);
+    EXPECT_DOUBLE_EQ(closed[1].candle.volume, 0.0);
+    EXPECT_EQ(closed[1].candle.number_of_trades, 0);
+
+    std::vector<Core::BarAggregator::Bar> forming;
+    agg.forming(forming);
+    ASSERT_EQ(forming.size(), 2u);
+    EXPECT_EQ(forming[1].interval, "1m");
+    EXPECT_DOUBLE_EQ(forming[1].candle.volume, 7.0);
+    EXPECT_EQ(forming[1].candle.number_of_trades, 7);
+
+    // Quiet series advance on the clock; a trade for a closed window is late.
+    closed.clear();
+    agg.close_until(80'001, closed);
+    ASSERT_EQ(closed.size(), 2u); // 70s bar and the empty 75s window
+    EXPECT_EQ(closed[1].candle.open_time, 75'000);
+    agg.on_trade({79'000, 8.0, 1.0, true, 1}, closed);
+    EXPECT_EQ(agg.late_trades(), 1u);
+    EXPECT_EQ(closed.size(), 2u);
+}
+
+TEST_F(StreamMultiplexerTest, BuildsSubMinuteBarsFromTrades) {
+    Core::CandleManager manager(dir);
+    auto log = std::make_shared<FakeSocketLog>();
+    Core::StreamMultiplexer mux("binance", manager, fake_factory(log));
+    std::map<std::string, std::vector<Core::Candle>> bars;
+    std::mutex bars_mutex;
+    mux.bus()->on_candle_closed([&](const Core::CandleEvent &e) {
+        std::lock_guard<std::mutex> lock(bars_mutex);
+        bars[e.interval].push_back(e.candle);
+    });
+    mux.subscribe("BTCUSDT", "5s");
+    mux.subscribe("BTCUSDT", "15s");
+    mux.start();
+    ASSERT_TRUE(wait_until([&] { return mux.connected(); }));
+    {
+        std::lock_guard<std::mutex> lock(log->mutex);
+        EXPECT_EQ(log->urls[0], "wss://stream.binance.com:9443/stream?streams=btcusdt@aggTrade");
+    }
+    EXPECT_EQ(mux.subscriptions().size(), 2u);
+
+    // Future timestamps keep the reactor's clock tick from closing bars early.
+    const long long base =
+        (std::chrono::duration_cast<std::chrono::milliseconds>(
+             std::chrono::system_clock::now().time_since_epoch())
+                 .count() /
+             15'000 +
+         240) *
+        15'000;
+    auto trade = [&](long long offset, const char *price) {
+        return nlohmann::json{
+            {"stream", "btcusdt@aggTrade"},
+            {"data", {{"e", "aggTrade"}, {"T", base + offset}, {"p", price}, {"q", "1"},
+                      {"m", false}, {"f", 1}, {"l", 1}}}};
+    };
+    push(*log, trade(1'000, "10"));
+    push(*log, trade(6'000, "11"));
+    push(*log, trade(16'000, "12")); // closes 5s bars at 0s, 5s, 10s and the 15s bar
+
+    mux.unsubscribe("BTCUSDT", "5s");
+    mux.unsubscribe("BTCUSDT", "15s");
+    ASSERT_TRUE(wait_until([&] { return sent_count(*log) == 1; }));
+    mux.stop();
+
+    std::lock_guard<std::mutex> lock(bars_mutex);
+    ASSERT_EQ(bars["5s"].size(), 3u);
+    EXPECT_EQ(bars["5s"][2].open_time, base + 10'000);
+    EXPECT_DOUBLE_EQ(bars["5s"][2].close, 11.0); // flat
+    ASSERT_EQ(bars["15s"].size(), 1u);
+    EXPECT_DOUBLE_EQ(bars["15s"][0].volume, 2.0);
+    EXPECT_EQ(manager.load_candles("BTCUSDT", "5s").size(), 3u);
+    auto unsub = nlohmann::json::parse(log->sent[0]);
+    EXPECT_EQ(unsub["method"], "UNSUBSCRIBE");
+    EXPECT_EQ(unsub["params"], nlohmann::json::array({"btcusdt@aggTrade"}));
+}
+
+TEST_F(StreamMultiplexerTest, RecordsAndReplaysSessionAtRecordedPace) {
+    const auto file = dir / "session.cmdr";
+    auto kline = [](long long open_time) {
+        return nlohmann::json{
+            {"stream", "btcusdt@kline_1m"},
+            {"data", {{"e", "kline"},
+                      {"k", {{"t", open_time}, {"T", open_time + 59'999}, {"o", "1"},
+                             {"h", "2"}, {"l", "0.5"}, {"c", "1.5"}, {"v", "10"},
+                             {"x", true}}}}}};
+    };
+    {
+        auto recorder = std::make_shared<Core::MarketDataRecorder>(file);
+        ASSERT_TRUE(recorder->is_open());
+        Core::CandleManager manager(dir);
+        auto log = std::make_shared<FakeSocketLog>();
+        Core::StreamMultiplexer mux("binance", manager,
+                                    Core::recording_websocket_factory(fake_factory(log), recorder));
+        mux.subscribe("BTCUSDT", "1m");
+        mux.start();
+        ASSERT_TRUE(wait_until([&] { return mux.connected(); }));
+        for (long long t : {60'000LL, 120'000LL, 180'000LL}) {
+            push(*log, kline(t));
+            std::this_thread::sleep_for(std::chrono::milliseconds(40));
+        }
+        Core::HttpExchange exchange{"GET", "https://api/klines?x=1", "", {}, 12};
+        exchange.response = {200, "[]", "", false, {{"etag", "abc"}}};
+        recorder->record_http(exchange);
+        mux.stop(); // our own stop is not recorded as a close
+    }
+
+    std::vector<Core::MarketDataRecord> records;
+    ASSERT_TRUE(Core::MarketDataReplayer::read_file(file, records));
+    ASSERT_EQ(records.size(), 5u);
+    EXPECT_EQ(records[0].kind, Core::MarketDataRecord::Kind::Open);
+    EXPECT_NE(records[0].payload.find("btcusdt@kline_1m"), std::string::npos);
+    EXPECT_EQ(records[1].kind, Core::MarketDataRecord::Kind::Message);
+    EXPECT_GE(records[3].time_us - records[1].time_us, 70'000);
+    ASSERT_TRUE(records[4].http);
+    EXPECT_EQ(records[4].http->url, "https://api/klines?x=1");
+    EXPECT_EQ(records[4].http->response.headers.at("etag"), "abc");
+    EXPECT_EQ(records[4].http->latency_ms, 12);
+
+    auto replay = [&](double speed) {
+        Core::MarketDataReplayer::Options options;
+        options.speed = speed;
+        auto replayer = std::make_shared<Core::MarketDataReplayer>(options);
+        EXPECT_EQ(replayer->load(file), 5u);
+        EXPECT_EQ(replayer->connections(), 1u);
+        EXPECT_EQ(replayer->http_exchanges().size(), 1u);
+        Core::CandleManager manager(dir / "replay");
+        Core::StreamMultiplexer mux("binance", manager, Core::replay_websocket_factory(replayer));
+        std::vector<long long> closed;
+        std::mutex closed_mutex;
+        mux.bus()->on_candle_closed([&](const Core::CandleEvent &e) {
+            std::lock_guard<std::mutex> lock(closed_mutex);
+            closed.push_back(e.candle.open_time);
+        });
+        mux.subscribe("BTCUSDT", "1m");
+        const auto started = std::chrono::steady_clock::now();
+        mux.start();
+        EXPECT_TRUE(replayer->wait_finished(std::chrono::seconds(5)));
+        const auto elapsed = std::chrono::steady_clock::now() - started;
+        mux.stop();
+        EXPECT_EQ(replayer->delivered(), 3u);
+        std::lock_guard<std::mutex> lock(closed_mutex);
+        EXPECT_EQ(closed, (std::vector<long long>{60'000, 120'000, 180'000}));
+        return elapsed;
+    };
+    EXPECT_GE(replay(1.0), std::chrono::milliseconds(70));
+    EXPECT_LT(replay(0.0), std::chrono::milliseconds(70));
+}
+
+TEST_F(StreamMultiplexerTest, BackfillsOutageWindowOnReconnect) {
+    Core::CandleManager manager(dir);
+    auto log = std::make_shared<FakeSocketLog>();
+    Core::StreamMultiplexer mux("binance", manager, fake_factory(log),
+                                [](std::chrono::milliseconds) {});
+    std::vector<Core::Candle> closed;
+    std::mutex closed_mutex;
+    mux.bus()->on_candle_closed([&](const Core::CandleEvent &e) {
+        std::lock_guard<std::mutex> lock(closed_mutex);
+        closed.push_back(e.candle);
+    });
+    const long long minute = 60'000;
+    const long long t0 =
+        (std::chrono::duration_cast<std::chrono::milliseconds>(
+             std::chrono::system_clock::now().time_since_epoch())
+                 .count() /
+             minute -
+         5) *
+        minute;
+    auto bar = [&](long long t, double close) {
+        return Core::Candle(t, 1, 2, 0.5, close, 10, t + minute - 1);
+    };
+    auto kline = [&](long long t, double close) {
+        return nlohmann::json{
+            {"stream", "btcusdt@kline_1m"},
+            {"data", {{"e", "kline"},
+                      {"k", {{"t", t}, {"T", t + minute - 1}, {"o", "1"}, {"h", "2"},
+                             {"l", "0.5"}, {"c", std::to_string(close)}, {"v", "10"},
+                             {"x", true}}}}}};
+    };
+    std::atomic<int> fetches{0};
+    long long fetch_start = 0;
+    mux.set_gap_fetcher([&](const std::string &symbol, const std::string &interval,
+                            long long start, long long) {
+        ++fetches;
+        fetch_start = start;
+        EXPECT_EQ(symbol, "BTCUSDT");
+        EXPECT_EQ(interval, "1m");
+        // A live bar arriving mid-fetch is held and wins over the fetched copy.
+        push(*log, kline(t0 + 4 * minute, 9.0));
+        Core::KlinesResult res;
+        for (int i = -1; i <= 4; ++i)
+            res.candles.push_back(bar(t0 + i * minute, 1.0));
+        return res;
+    });
+    mux.subscribe("BTCUSDT", "1m");
+    mux.start();
+    ASSERT_TRUE(wait_until([&] { return mux.connected(); }));
+    push(*log, kline(t0, 1.0));
+    push(*log, kline(t0, 1.0)); // duplicate
+    EXPECT_EQ(fetches.load(), 0);
+
+    Core::IWebSocket::ErrorCallback drop;
+    {
+        std::lock_guard<std::mutex> lock(log->mutex);
+        drop = log->on_error;
+    }
+    drop();
+    ASSERT_TRUE(wait_until([&] { return mux.backfill_stats().reconnects == 1; }));
+    ASSERT_TRUE(wait_until([&] {
+        std::lock_guard<std::mutex> lock(closed_mutex);
+        return closed.size() == 5u;
+    }));
+    push(*log, kline(t0 + 4 * minute, 9.0)); // replayed by the venue
+    mux.stop();
+
+    EXPECT_EQ(fetches.load(), 1);
+    EXPECT_EQ(fetch_start, t0 + minute);
+    EXPECT_EQ(mux.backfill_stats().candles, 3u);
+    std::lock_guard<std::mutex> lock(closed_mutex);
+    ASSERT_EQ(closed.size(), 5u);
+    for (std::size_t i = 0; i < closed.size(); ++i)
+        EXPECT_EQ(closed[i].open_time, t0 + static_cast<long long>(i) * minute);
+    EXPECT_DOUBLE_EQ(closed[4].close, 9.0);
+    EXPECT_EQ(manager.load_candles("BTCUSDT", "1m").size(), 5u);
+}
+
+TEST_F(StreamMultiplexerTest, BackfillRunsOffTheReactorWithDeadline) {
+    Core::CandleManager manager(dir);
+    auto log = std::make_shared<FakeSocketLog>();
+    Core::StreamMultiplexer mux("binance", manager, fake_factory(log),
+                                [](std::chrono::milliseconds) {});
+    std::map<std::string, std::vector<long long>> closed;
+    std::mutex closed_mutex;
+    mux.bus()->on_candle_closed([&](const Core::CandleEvent &e) {
+        std::lock_guard<std::mutex> lock(closed_mutex);
+        closed[e.symbol].push_back(e.candle.open_time);
+    });
+    auto closed_of = [&](const std::string &symbol) {
+        std::lock_guard<std::mutex> lock(closed_mutex);
+        return closed[symbol];
+    };
+    const long long minute = 60'000;
+    const long long t0 =
+        (std::chrono::duration_cast<std::chrono::milliseconds>(
+             std::chrono::system_clock::now().time_since_epoch())
+                 .count() /
+             minute -
+         5) *
+        minute;
+    auto kline = [&](const std::string &stream, long long t) {
+        return nlohmann::json{
+            {"stream", stream},
+            {"data", {{"e", "kline"},
+                      {"k", {{"t", t}, {"T", t + minute - 1}, {"o", "1"}, {"h", "2"},
+                             {"l", "0.5"}, {"c", "1.5"}, {"v", "10"}, {"x", true}}}}}};
+    };
+    // ETHUSDT's fetch hangs past the deadline; BTCUSDT's returns at once.
+    std::mutex gate_mutex;
+    std::condition_variable gate_cv;
+    bool gate_open = false;
+    std::atomic<bool> eth_fetching{false};
+    mux.set_gap_fetcher(
+        [&](const std::string &symbol, const std::string &, long long start, long long) {
+            if (symbol == "ETHUSDT") {
+                eth_fetching = true;
+                std::unique_lock<std::mutex> lock(gate_mutex);
+                gate_cv.wait_for(lock, std::chrono::seconds(5), [&] { return gate_open; });
+            }
+            Core::KlinesResult res;
+            res.candles.emplace_back(start, 1, 2, 0.5, 1.5, 10, start + minute - 1);
+            return res;
+        },
+        1000, std::chrono::milliseconds(300));
+    mux.subscribe("BTCUSDT", "1m");
+    mux.subscribe("ETHUSDT", "1m");
+    mux.start();
+    ASSERT_TRUE(wait_until([&] { return mux.connected(); }));
+    push(*log, kline("btcusdt@kline_1m", t0));
+    push(*log, kline("ethusdt@kline_1m", t0));
+
+    Core::IWebSocket::ErrorCallback drop;
+    {
+        std::lock_guard<std::mutex> lock(log->mutex);
+        drop = log->on_error;
+    }
+    drop();
+    ASSERT_TRUE(wait_until([&] { return eth_fetching.load(); }));
+    // BTCUSDT is released without waiting for ETHUSDT, and the reactor
+    // still reconciles subscriptions while the fetch hangs.
+    ASSERT_TRUE(wait_until([&] { return closed_of("BTCUSDT").size() == 2u; }));
+    const std::size_t sent = sent_count(*log);
+    mux.subscribe("SOLUSDT", "1m");
+    ASSERT_TRUE(wait_until([&] { return sent_count(*log) == sent + 1; }));
+    push(*log, kline("ethusdt@kline_1m", t0 + 4 * minute));
+    EXPECT_EQ(closed_of("ETHUSDT").size(), 1u); // held
+
+    ASSERT_TRUE(wait_until([&] { return mux.backfill_stats().timeouts == 1; }));
+    ASSERT_TRUE(wait_until([&] { return closed_of("ETHUSDT").size() == 2u; }));
+    {
+        std::lock_guard<std::mutex> lock(gate_mutex);
+        gate_open = true;
+    }
+    gate_cv.notify_all();
+    mux.stop();
+
+    EXPECT_EQ(closed_of("BTCUSDT"), (std::vector<long long>{t0, t0 + minute}));
+    // The late fetch result is dropped rather than published out of order.
+    EXPECT_EQ(closed_of("ETHUSDT"), (std::vector<long long>{t0, t0 + 4 * minute}));
+    EXPECT_EQ(mux.backfill_stats().candles, 1u);
+}
+
+TEST_F(StreamMultiplexerTest, StampsBarsForLatencyStages) {
+    using Stage = Core::LatencyTracker::Stage;
+    auto &tracker = Core::LatencyTracker::instance();
+    tracker.reset();
+    Core::CandleManager manager(dir);
+    auto log = std::make_shared<FakeSocketLog>();
+    Core::StreamMultiplexer mux("binance", manager, fake_factory(log));
+    std::optional<Core::LatencyStamps> seen;
+    std::mutex seen_mutex;
+    mux.bus()->on_candle_closed([&](const Core::CandleEvent &e) {
+        std::lock_guard<std::mutex> lock(seen_mutex);
+        if (e.stamps)
+            seen = *e.stamps;
+    });
+    mux.subscribe("BTCUSDT", "1m");
+    mux.start();
+    ASSERT_TRUE(wait_until([&] { return mux.connected(); }));
+    const long long event_ms = Core::LatencyTracker::wall_ms() - 20;
+    push(*log, {{"stream", "btcusdt@kline_1m"},
+                {"data", {{"e", "kline"},
+                          {"E", event_ms},
+                          {"k", {{"t", 60'000}, {"T", 119'999}, {"o", "1"}, {"h", "2"},
+                                 {"l", "0.5"}, {"c", "1.5"}, {"v", "10"}, {"x", true}}}}}});
+    mux.stop(); // commits the batch writer
+
+    std::lock_guard<std::mutex> lock(seen_mutex);
+    ASSERT_TRUE(seen);
+    EXPECT_EQ(seen->exchange_ms, event_ms);
+    EXPECT_GT(seen->received_us, 0);
+    EXPECT_GE(seen->parsed_us, seen->received_us);
+    EXPECT_EQ(tracker.summary(Stage::Parse).count, 1u);
+    EXPECT_EQ(tracker.summary(Stage::Network).count, 1u);
+    EXPECT_GE(tracker.summary(Stage::Network).max_ms, 19.0);
+    EXPECT_EQ(tracker.summary(Stage::Persist).count, 1u);
+    tracker.reset();
+}
+
+TEST(BarUpdateCoalescerTest, KeepsNewestUpdatePerSeriesUntilDue) {
+    using namespace std::chrono_literals;
+    Core::BarUpdateCoalescer coalescer(250ms);
+    const auto t0 = Core::BarUpdateCoalescer::Clock::time_point{} + 1h;
+    auto bar = [](long long open_time, double close) {
+        Core::Candle c{};
+        c.open_time = open_time;
+        c.close = close;
+        return c;
+    };
+
+    ASSERT_TRUE(coalescer.offer("btc", bar(60'000, 1.0), t0));
+    EXPECT_FALSE(coalescer.offer("btc", bar(60'000, 1.1), t0 + 50ms));
+    EXPECT_FALSE(coalescer.offer("btc", bar(60'000, 1.2), t0 + 100ms));
+    EXPECT_TRUE(coalescer.offer("eth", bar(60'000, 9.0), t0 + 100ms)); // own budget
+    ASSERT_TRUE(coalescer.next_due());
+    EXPECT_EQ(*coalescer.next_due(), t0 + 250ms);
+    EXPECT_TRUE(coalescer.take_due(t0 + 200ms).empty());
+
+    auto due = coalescer.take_due(t0 + 250ms);
+    ASSERT_EQ(due.size(), 1u);
+    EXPECT_EQ(due[0].first, "btc");
+    EXPECT_DOUBLE_EQ(due[0].second.close, 1.2);
+    EXPECT_FALSE(coalescer.next_due());
+
+    // A closed bar drops the stale pending update of that bar.
+    EXPECT_FALSE(coalescer.offer("btc", bar(60'000, 1.3), t0 + 300ms));
+    coalescer.on_closed("btc", 60'000);
+    EXPECT_EQ(coalescer.pending(), 0u);
+    EXPECT_TRUE(coalescer.offer("btc", bar(120'000, 1.4), t0 + 500ms));
+}
+
+TEST_F(StreamMultiplexerTest, ForwardsFormingBarsWithoutPersisting) {
+    Core::CandleManager manager(dir);
+    auto log = std::make_shared<FakeSocketLog>();
+    Core::StreamMultiplexer mux("binance", manager, fake_factory(log));
+    mux.set_live_update_interval(std::chrono::hours(1));
+    std::vector<Core::Candle> closed, live;
+    std::mutex seen_mutex;
+    mux.bus()->on_candle_closed([&](const Core::CandleEvent &e) {
+        std::lock_guard<std::mutex> lock(seen_mutex);
+        closed.push_back(e.candle);
+    });
+    mux.bus()->on_candle_update([&](const Core::CandleEvent &e) {
+        std::lock_guard<std::mutex> lock(seen_mutex);
+        live.push_back(e.candle);
+    });
+    mux.subscribe("BTCUSDT", "1m");
+    mux.start();
+    ASSERT_TRUE(wait_until([&] { return mux.connected(); }));
+
+    auto kline = [](const std::string &close, bool closed_bar) {
+        return nlohmann::json{
+            {"stream", "btcusdt@kline_1m"},
+            {"data", {{"e", "kline"},
+                      {"k", {{"t", 60'000}, {"T", 119'999}, {"o", "1"}, {"h", "2"},
+                             {"l", "0.5"}, {"c", close}, {"v", "10"}, {"n", 4},
+                             {"x", closed_bar}}}}}};
+    };
+    push(*log, kline("1.1", false)); // forwarded at once
+    push(*log, kline("1.2", false)); // coalesced: within the interval
+    push(*log, kline("1.3", false));
+    EXPECT_TRUE(manager.load_candles("BTCUSDT", "1m").empty());
+    push(*log, kline("1.4", true));  // final bar supersedes the pending update
+    mux.stop();
+
+    std::lock_guard<std::mutex> lock(seen_mutex);
+    ASSERT_EQ(live.size(), 1u);
+    EXPECT_DOUBLE_EQ(live[0].close, 1.1);
+    ASSERT_EQ(closed.size(), 1u);
+    EXPECT_DOUBLE_EQ(closed[0].close, 1.4);
+    auto stored = manager.load_candles("BTCUSDT", "1m");
+    ASSERT_EQ(stored.size(), 1u);
+    EXPECT_DOUBLE_EQ(stored[0].close, 1.4);
+}
+
+TEST(SpscRingTest, PreservesOrderAcrossThreads) {
+    Core::SpscRing<long long> ring(64);
+    EXPECT_EQ(ring.capacity(), 64u);
+    constexpr long long kCount = 20'000;
+    std::thread producer([&] {
+        for (long long i = 0; i < kCount;) {
+            if (ring.try_push(i))
+                ++i;
+            else
+                std::this_thread::yield();
+        }
+    });
+    long long expected = 0;
+    bool ordered = true;
+    while (expected < kCount) {
+        long long v = -1;
+        if (ring.try_pop(v)) {
+            ordered = ordered && v == expected;
+            ++expected;
+        } else {
+            std::this_thread::yield();
+        }
+    }
+    producer.join();
+    EXPECT_TRUE(ordered);
+    EXPECT_EQ(ring.size(), 0u);
+}
+
+TEST(KlineQueueTest, CoalescesOverflowByOpenTime) {
+    Core::KlineQueue queue(2);
+    auto update = [](long long open_time, double close, bool closed) {
+        Core::Candle c{};
+        c.open_time = open_time;
+        c.close = close;
+        return Core::KlineUpdate{c, closed};
+    };
+    queue.publish(update(60'000, 1.0, false));
+    queue.publish(update(60'000, 1.1, false)); // ring now full
+    queue.publish(update(60'000, 1.2, true));  // spilled
+    queue.publish(update(60'000, 1.3, false)); // never replaces the closed bar
+    queue.publish(update(120'000, 2.0, false));
+    queue.publish(update(120'000, 2.1, false)); // coalesced into the previous
+    EXPECT_EQ(queue.published(), 6u);
+    EXPECT_EQ(queue.coalesced(), 2u);
+    EXPECT_EQ(queue.high_water(), 4u);
+
+    // The spilled updates come out with the ring, without another publish.
+    std::vector<Core::KlineUpdate> out;
+    EXPECT_EQ(queue.drain(out), 4u);
+    queue.publish(update(180'000, 3.0, false));
+    queue.drain(out);
+    queue.publish(update(180'000, 3.1, false));
+    queue.drain(out);
+    ASSERT_EQ(out.size(), 6u);
+    EXPECT_DOUBLE_EQ(out[2].candle.close, 1.2);
+    EXPECT_TRUE(out[2].closed);
+    EXPECT_DOUBLE_EQ(out[3].candle.close, 2.1);
+    EXPECT_DOUBLE_EQ(out[4].candle.close, 3.0);
+    EXPECT_DOUBLE_EQ(out[5].candle.close, 3.1);
+}
+
+TEST(KlineQueueTest, KeepsClosedBarsInOrderUnderOverflow) {
+    Core::KlineQueue queue(4);
+    constexpr long long kCount = 50'000;
+    std::thread producer([&] {
+        for (long long i = 1; i <= kCount; ++i) {
+            Core::Candle c{};
+            c.open_time = i;
+            queue.publish({c, true});
+        }
+    });
+    std::vector<Core::KlineUpdate> out;
+    long long last = 0;
+    bool ordered = true;
+    while (last < kCount) {
+        out.clear();
+        queue.drain(out);
+        for (const auto &u : out) {
+            ordered = ordered && u.candle.open_time == last + 1;
+            last = u.candle.open_time;
+        }
+        if (!ordered)
+            break;
+    }
+    producer.join();
+    EXPECT_TRUE(ordered);
+    EXPECT_EQ(last, kCount);
+}
+
+TEST(MarketDataBusTest, FansOutTypedEventsWithSeriesFilters) {
+    Core::MarketDataBus bus;
+    std::vector<std::string> log;
+    auto all = bus.on_candle_closed([&](const Core::CandleEvent &e) {
+        log.push_back("all:" + e.symbol + ":" + std::to_string(e.candle.open_time));
+    });
+    bus.on_candle_closed(
+        [&](const Core::CandleEvent &e) { log.push_back("btc:" + e.interval); },
+        "BTCUSDT", "1m");
+    const Core::Candle *seen = nullptr;
+    bus.on_candle_update([&](const Core::CandleEvent &e) { seen = &e.candle; });
+    std::vector<Core::StreamStatus> status;
+    bus.on_stream_status([&](const Core::StreamStatusEvent &e) { status.push_back(e.status); });
+    EXPECT_TRUE(bus.has_candle_update_handlers());
+
+    Core::Candle c{};
+    c.open_time = 60'000;
+    bus.publish_candle_closed("BTCUSDT", "1m", c);
+    bus.publish_candle_closed("ETHUSDT", "1m", c);
+    bus.publish_candle_closed("BTCUSDT", "5m", c);
+    bus.publish_candle_update("BTCUSDT", "1m", c);
+    EXPECT_EQ(seen, &c); // handlers see the producer's object, not a copy
+    bus.publish_stream_status("binance", Core::StreamStatus::Connected);
+
+    bus.unsubscribe(all);
+    bus.publish_candle_closed("BTCUSDT", "1m", c);
+
+    EXPECT_EQ(log, (std::vector<std::string>{"all:BTCUSDT:60000", "btc:1m",
+                                             "all:ETHUSDT:60000", "all:BTCUSDT:60000",
+                                             "btc:1m"}));
+    EXPECT_EQ(status, std::vector<Core::StreamStatus>{Core::StreamStatus::Connected});
+}
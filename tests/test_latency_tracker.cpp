@@ -0,0 +1,71 @@
+#include <gtest/gtest.h>
+#include "core/latency_tracker.h"
+#include <algorithm>
+#include <cmath>
+#include <nlohmann/json.hpp>
+#include <random>
+#include <thread>
+#include <vector>
+
+using Core::LatencyHistogram;
+using Core::LatencyTracker;
+
+TEST(LatencyHistogramTest, BucketsStayWithinRelativeError) {
+    for (long long v : {0LL, 1LL, 63LL, 64LL, 65LL, 1'000LL, 123'456LL, 4'000'000'000LL}) {
+        const double mid = LatencyHistogram::bucket_mid(LatencyHistogram::bucket_of(v));
+        EXPECT_LE(std::abs(mid - static_cast<double>(v)), 0.032 * static_cast<double>(v) + 0.5)
+            << v;
+    }
+    EXPECT_LT(LatencyHistogram::bucket_of(1LL << 40), LatencyHistogram::kBuckets);
+    EXPECT_EQ(LatencyHistogram::bucket_of(-5), 0u);
+}
+
+TEST(LatencyHistogramTest, PercentilesMatchSortedSamples) {
+    LatencyHistogram h;
+    std::mt19937 rng(7);
+    std::lognormal_distribution<double> dist(8.0, 1.5); // ~3 ms median, long tail
+    std::vector<long long> samples;
+    for (int i = 0; i < 100'000; ++i)
+        samples.push_back(static_cast<long long>(dist(rng)));
+    // Recording is safe from several threads at once.
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t)
+        threads.emplace_back([&, t] {
+            for (std::size_t i = t; i < samples.size(); i += 4)
+                h.record(samples[i]);
+        });
+    for (auto &th : threads)
+        th.join();
+    std::sort(samples.begin(), samples.end());
+    ASSERT_EQ(h.count(), samples.size());
+    EXPECT_EQ(h.max(), samples.back());
+    for (double q : {0.5, 0.9, 0.99, 0.999}) {
+        const double exact = static_cast<double>(samples[static_cast<std::size_t>(q * samples.size()) - 1]);
+        EXPECT_NEAR(h.percentile(q), exact, 0.035 * exact + 1.0) << q;
+    }
+    h.reset();
+    EXPECT_EQ(h.count(), 0u);
+    EXPECT_EQ(h.percentile(0.5), 0.0);
+}
+
+TEST(LatencyTrackerTest, SummarisesAndDumpsStages) {
+    auto &tracker = LatencyTracker::instance();
+    tracker.reset();
+    EXPECT_EQ(tracker.status_line(), "");
+    for (int i = 1; i <= 100; ++i)
+        tracker.record(LatencyTracker::Stage::EndToEnd, i * 1000); // 1..100 ms
+    tracker.record(LatencyTracker::Stage::Parse, 40);
+    const auto s = tracker.summary(LatencyTracker::Stage::EndToEnd);
+    EXPECT_EQ(s.count, 100u);
+    EXPECT_NEAR(s.p50_ms, 50.0, 1.6);
+    EXPECT_NEAR(s.p99_ms, 99.0, 3.2);
+    EXPECT_DOUBLE_EQ(s.max_ms, 100.0);
+    EXPECT_EQ(tracker.status_line().rfind("e2e ", 0), 0u);
+    EXPECT_NE(tracker.status_line().find("parse 0.04/0.04"), std::string::npos);
+
+    auto dump = nlohmann::json::parse(tracker.dump_json());
+    EXPECT_EQ(dump["end_to_end"]["count"], 100);
+    EXPECT_EQ(dump["network"]["count"], 0);
+    EXPECT_TRUE(dump.contains("persist"));
+    tracker.reset();
+}
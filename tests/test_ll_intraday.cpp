@@ -0,0 +1,167 @@
+#include <gtest/gtest.h>
+#include "analytics/ll_intraday.h"
+#include "core/candle.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <optional>
+#include <random>
+#include <vector>
+
+using llintraday::Params;
+using llintraday::Record;
+
+namespace {
+
+// Minute candles on a 0.5 price grid, so equal highs and lows are common.
+std::vector<Core::Candle> random_candles(std::size_t n, unsigned seed) {
+    std::mt19937 rng(seed);
+    std::normal_distribution<double> step(0.0, 1.0);
+    std::uniform_int_distribution<int> wick(0, 3);
+    std::vector<Core::Candle> candles;
+    double price = 1000.0;
+    for (std::size_t i = 0; i < n; ++i) {
+        const double open = std::round(price * 2) / 2;
+        price += step(rng);
+        const double close = std::round(price * 2) / 2;
+        const double high = std::max(open, close) + 0.5 * wick(rng);
+        const double low = std::min(open, close) - 0.5 * wick(rng);
+        const long long t = static_cast<long long>(i) * 60'000;
+        candles.emplace_back(t, open, high, low, close, 1.0, t + 59'999);
+    }
+    return candles;
+}
+
+// The analysis as first written: every neighbour compared for pivots, and
+// the lookahead windows scanned for each lower low.
+std::vector<Record> reference(const std::vector<Core::Candle>& v, const Params& P) {
+    std::vector<Record> out;
+    const int n = static_cast<int>(v.size());
+    if (n < P.left + P.right + 2) {
+        return out;
+    }
+    std::vector<double> ema(n);
+    const double alpha = 2.0 / (P.ema_slow + 1.0);
+    for (int i = 0; i < n; ++i) {
+        ema[i] = P.ema_slow <= 1 ? v[i].close : i == 0 ? v[0].close : alpha * v[i].close + (1.0 - alpha) * ema[i - 1];
+    }
+    std::vector<int> ph, pl;
+    for (int i = P.left; i < n - P.right; ++i) {
+        bool is_ph = true, is_pl = true;
+        for (int k = 0; k <= P.left; ++k) {
+            if (!(v[i].high >= v[i - k].high)) is_ph = false;
+            if (!(v[i].low <= v[i - k].low)) is_pl = false;
+        }
+        for (int k = 1; k <= P.right; ++k) {
+            if (!(v[i].high > v[i + k].high)) is_ph = false;
+            if (!(v[i].low < v[i + k].low)) is_pl = false;
+        }
+        if (is_ph) ph.push_back(i);
+        if (is_pl) pl.push_back(i);
+    }
+    for (std::size_t p = 1; p < pl.size(); ++p) {
+        const int ll = pl[p];
+        if (!(v[ll].low < v[pl[p - 1]].low)) {
+            continue;
+        }
+        Record rec;
+        rec.ll_time_ms = v[ll].open_time;
+        rec.ll_price = v[ll].low;
+        const int last = std::min(n - 1, ll + P.lookahead_min);
+        auto minutes = [&](int i) { return static_cast<int>((v[i].open_time - rec.ll_time_ms) / 1000 / 60); };
+        int prev_ph = -1;
+        for (int k : ph) {
+            if (k >= ll) break;
+            prev_ph = k;
+        }
+        if (prev_ph >= 0) {
+            rec.prev_ph_time_ms = v[prev_ph].open_time;
+            rec.prev_ph_price = v[prev_ph].high;
+            for (int j : ph) {
+                if (j > ll && j <= last && v[j].high > v[prev_ph].high) {
+                    rec.hh_time_ms = v[j].open_time;
+                    rec.mins_ll_to_hh = minutes(j);
+                    break;
+                }
+            }
+        }
+        for (int i = ll + 1; i <= last; ++i) {
+            if (v[i].close > ema[i]) {
+                rec.ema200_cross_time_ms = v[i].open_time;
+                rec.mins_ll_to_ema200 = minutes(i);
+                break;
+            }
+        }
+        for (int i = ll + 1; i <= last; ++i) {
+            if (v[i].low <= rec.ll_price * (1.0 + P.retest_eps)) {
+                rec.retest_time_ms = v[i].open_time;
+                rec.mins_ll_to_retest = minutes(i);
+                break;
+            }
+        }
+        out.push_back(rec);
+    }
+    return out;
+}
+
+void expect_same(const std::vector<Record>& got, const std::vector<Record>& want) {
+    ASSERT_EQ(got.size(), want.size());
+    for (std::size_t i = 0; i < got.size(); ++i) {
+        SCOPED_TRACE(i);
+        EXPECT_EQ(got[i].ll_time_ms, want[i].ll_time_ms);
+        EXPECT_EQ(got[i].ll_price, want[i].ll_price);
+        EXPECT_EQ(got[i].prev_ph_time_ms, want[i].prev_ph_time_ms);
+        EXPECT_EQ(got[i].prev_ph_price, want[i].prev_ph_price);
+        EXPECT_EQ(got[i].hh_time_ms, want[i].hh_time_ms);
+        EXPECT_EQ(got[i].mins_ll_to_hh, want[i].mins_ll_to_hh);
+        EXPECT_EQ(got[i].ema200_cross_time_ms, want[i].ema200_cross_time_ms);
+        EXPECT_EQ(got[i].mins_ll_to_ema200, want[i].mins_ll_to_ema200);
+        EXPECT_EQ(got[i].retest_time_ms, want[i].retest_time_ms);
+        EXPECT_EQ(got[i].mins_ll_to_retest, want[i].mins_ll_to_retest);
+    }
+}
+
+} // namespace
+
+TEST(LlIntradayTest, MatchesNeighbourScanAcrossParameters) {
+    const auto candles = random_candles(10'000, 3);
+    for (int left : {0, 1, 3, 8}) {
+        for (int right : {0, 2, 3}) {
+            for (int lookahead : {0, 45, 720}) {
+                for (double eps : {0.0, 0.001}) {
+                    Params p;
+                    p.left = left;
+                    p.right = right;
+                    p.lookahead_min = lookahead;
+                    p.retest_eps = eps;
+                    p.ema_slow = left == 0 ? 1 : 200;
+                    SCOPED_TRACE(testing::Message() << left << " " << right << " " << lookahead << " " << eps);
+                    const auto result = llintraday::analyze_core_candles(candles, p);
+                    expect_same(result.records, reference(candles, p));
+                    if (HasFailure()) {
+                        return;
+                    }
+                }
+            }
+        }
+    }
+}
+
+TEST(LlIntradayTest, MissingPricesAndShortSeries) {
+    auto candles = random_candles(5'000, 9);
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+    for (std::size_t i = 100; i < candles.size(); i += 397) {
+        candles[i].high = nan;
+        candles[i + 5].low = nan;
+    }
+    const Params p;
+    const auto result = llintraday::analyze_core_candles(candles, p);
+    expect_same(result.records, reference(candles, p));
+    EXPECT_EQ(result.summary.rows_used, candles.size());
+    EXPECT_EQ(result.summary.mins_ll_to_retest.count,
+              std::count_if(result.records.begin(), result.records.end(),
+                            [](const Record& r) { return r.mins_ll_to_retest.has_value(); }));
+
+    const std::vector<Core::Candle> few(candles.begin(), candles.begin() + 7);
+    EXPECT_TRUE(llintraday::analyze_core_candles(few, p).records.empty());
+}
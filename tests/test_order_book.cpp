@@ -0,0 +1,139 @@
+#include <gtest/gtest.h>
+#include "core/depth_parsers.h"
+#include "core/order_book.h"
+#include <nlohmann/json.hpp>
+#include <vector>
+
+using Core::OrderBook;
+using Side = Core::OrderBook::Side;
+
+namespace {
+
+Core::DepthDiff diff(std::uint64_t first, std::uint64_t last,
+                     std::vector<Core::PriceLevel> bids,
+                     std::vector<Core::PriceLevel> asks) {
+    Core::DepthDiff d;
+    d.first_update_id = first;
+    d.final_update_id = last;
+    d.bids = std::move(bids);
+    d.asks = std::move(asks);
+    return d;
+}
+
+} // namespace
+
+TEST(OrderBookTest, KeepsLevelsSortedBestFirst) {
+    OrderBook book;
+    book.apply_snapshot({10, {{99.0, 1.0}, {100.0, 2.0}, {98.0, 3.0}, {97.0, 0.0}},
+                         {{102.0, 1.0}, {101.0, 3.0}}});
+    ASSERT_EQ(book.depth(Side::Bid), 3u); // zero-qty level dropped
+    EXPECT_DOUBLE_EQ(book.best_bid().price, 100.0);
+    EXPECT_DOUBLE_EQ(book.level(Side::Bid, 2).price, 98.0);
+    EXPECT_DOUBLE_EQ(book.best_ask().price, 101.0);
+
+    book.set_level(Side::Bid, 99.5, 4.0);  // inside the book
+    book.set_level(Side::Bid, 100.0, 0.0); // remove the top
+    book.set_level(Side::Ask, 100.5, 1.0); // new best ask
+    book.set_level(Side::Ask, 101.0, 5.0); // modify
+    std::vector<Core::PriceLevel> top;
+    book.top(Side::Bid, 2, top);
+    ASSERT_EQ(top.size(), 2u);
+    EXPECT_DOUBLE_EQ(top[0].price, 99.5);
+    EXPECT_DOUBLE_EQ(top[1].price, 99.0);
+    book.top(Side::Ask, 10, top);
+    ASSERT_EQ(top.size(), 3u);
+    EXPECT_DOUBLE_EQ(top[0].price, 100.5);
+    EXPECT_DOUBLE_EQ(top[1].qty, 5.0);
+
+    EXPECT_DOUBLE_EQ(book.spread(), 1.0);
+    EXPECT_DOUBLE_EQ(book.mid(), 100.0);
+    // bid 99.5 x 4, ask 100.5 x 1: the thin ask pulls the price up.
+    EXPECT_DOUBLE_EQ(book.microprice(), (99.5 * 1.0 + 100.5 * 4.0) / 5.0);
+    EXPECT_DOUBLE_EQ(book.imbalance(), 3.0 / 5.0);
+    EXPECT_DOUBLE_EQ(book.imbalance(2), (5.0 - 6.0) / 11.0);
+}
+
+TEST(OrderBookTest, SequencesBinanceDiffs) {
+    OrderBook book;
+    EXPECT_EQ(book.apply_diff(diff(1, 5, {{1.0, 1.0}}, {})), OrderBook::DiffResult::Gap);
+    book.apply_snapshot({100, {{10.0, 1.0}}, {{11.0, 1.0}}});
+
+    EXPECT_EQ(book.apply_diff(diff(90, 100, {{10.0, 9.0}}, {})),
+              OrderBook::DiffResult::Stale);
+    EXPECT_DOUBLE_EQ(book.best_bid().qty, 1.0);
+    // The first diff straddles lastUpdateId + 1.
+    EXPECT_EQ(book.apply_diff(diff(95, 105, {{10.5, 2.0}}, {})),
+              OrderBook::DiffResult::Applied);
+    EXPECT_EQ(book.apply_diff(diff(106, 110, {}, {{11.0, 0.0}, {12.0, 3.0}})),
+              OrderBook::DiffResult::Applied);
+    EXPECT_EQ(book.last_update_id(), 110u);
+    EXPECT_DOUBLE_EQ(book.best_bid().price, 10.5);
+    EXPECT_DOUBLE_EQ(book.best_ask().price, 12.0);
+
+    // 111 was missed.
+    EXPECT_EQ(book.apply_diff(diff(112, 115, {}, {})), OrderBook::DiffResult::Gap);
+    EXPECT_FALSE(book.synced());
+    EXPECT_EQ(book.gaps(), 1u);
+    EXPECT_EQ(book.apply_diff(diff(116, 117, {}, {})), OrderBook::DiffResult::Gap);
+    EXPECT_EQ(book.gaps(), 1u);
+}
+
+TEST(OrderBookTest, ParsesVenueDepthMessages) {
+    auto snap = Core::parse_binance_depth_snapshot(nlohmann::json::parse(
+        R"({"lastUpdateId":160,"bids":[["0.0024","10"]],"asks":[["0.0026","100"]]})"));
+    ASSERT_TRUE(snap);
+    auto upd = Core::parse_binance_depth_update(nlohmann::json::parse(
+        R"({"e":"depthUpdate","E":1,"s":"BNBBTC","U":157,"u":161,
+            "b":[["0.0024","0"],["0.0023","5"]],"a":[["0.0026","50"]]})"));
+    ASSERT_TRUE(upd);
+    OrderBook book;
+    book.apply_snapshot(*snap);
+    ASSERT_EQ(book.apply_diff(*upd), OrderBook::DiffResult::Applied);
+    EXPECT_DOUBLE_EQ(book.best_bid().price, 0.0023);
+    EXPECT_DOUBLE_EQ(book.best_ask().qty, 50.0);
+
+    auto l2 = Core::parse_hyperliquid_l2_book(nlohmann::json::parse(
+        R"({"coin":"BTC","time":1700000000000,"levels":[
+            [{"px":"100","sz":"1.5","n":3},{"px":"99","sz":"2","n":1}],
+            [{"px":"101","sz":"0.5","n":2}]]})"));
+    ASSERT_TRUE(l2);
+    book.apply_snapshot(*l2);
+    EXPECT_EQ(book.last_update_id(), 1700000000000u);
+    EXPECT_EQ(book.depth(Side::Bid), 2u);
+    EXPECT_DOUBLE_EQ(book.best_ask().price, 101.0);
+
+    EXPECT_FALSE(Core::parse_binance_depth_update(nlohmann::json::parse(R"({"e":"trade"})")));
+    EXPECT_FALSE(Core::parse_hyperliquid_l2_book(nlohmann::json::parse(R"({"levels":[[]]})")));
+}
+
+TEST(OrderBookTest, ScansDepthUpdatesWithoutDom) {
+    const std::string bare = R"({"e":"depthUpdate","E":1700000000123,"s":"BNBBTC","U":157,"u":161,
+        "b":[["0.0024","0"],["0.0023","5"]],"a":[["0.0026","50.5"]],"x":{"y":[1,"]"]}})";
+    const auto dom = Core::parse_binance_depth_update(nlohmann::json::parse(bare));
+    ASSERT_TRUE(dom);
+    Core::DepthDiff fast;
+    ASSERT_TRUE(Core::parse_binance_depth_update(std::string_view(bare), fast));
+    EXPECT_EQ(fast.first_update_id, dom->first_update_id);
+    EXPECT_EQ(fast.final_update_id, dom->final_update_id);
+    EXPECT_EQ(fast.event_time, dom->event_time);
+    ASSERT_EQ(fast.bids.size(), 2u);
+    ASSERT_EQ(fast.asks.size(), 1u);
+    for (std::size_t i = 0; i < 2; ++i) {
+        EXPECT_EQ(fast.bids[i].price, dom->bids[i].price);
+        EXPECT_EQ(fast.bids[i].qty, dom->bids[i].qty);
+    }
+    EXPECT_EQ(fast.asks[0].qty, 50.5);
+
+    // Combined-stream envelope; the vectors of the previous diff are reused.
+    ASSERT_TRUE(Core::parse_binance_depth_update(
+        std::string_view(R"({"stream":"bnbbtc@depth","data":{"U":162,"u":162,"b":[],"a":[["0.0027","1"]]}})"),
+        fast));
+    EXPECT_EQ(fast.first_update_id, 162u);
+    EXPECT_TRUE(fast.bids.empty());
+    ASSERT_EQ(fast.asks.size(), 1u);
+    EXPECT_EQ(fast.asks[0].price, 0.0027);
+
+    EXPECT_FALSE(Core::parse_binance_depth_update(std::string_view(R"({"e":"trade","p":"1"})"), fast));
+    EXPECT_FALSE(Core::parse_binance_depth_update(std::string_view(R"({"U":1,"u":2,"b":[["1",)"), fast));
+    EXPECT_FALSE(Core::parse_binance_depth_update(std::string_view(R"({"U":1,"u":2,"a":[["x","1"]]})"), fast));
+}
@@ -0,0 +1,738 @@
+#include <gtest/gtest.h>
+#include "core/backtester.h"
+#include "indicator_cache.h"
+#include "indicator_kernels.h"
+#include "indicators.h"
+#include "rule_program.h"
+#include "services/signal_bot.h"
+#include "signal.h"
+#include "strategy.h"
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+std::vector<Core::Candle> random_walk(std::size_t n, unsigned seed = 7) {
+    std::mt19937 rng(seed);
+    std::normal_distribution<double> step(0.0, 1.0);
+    std::vector<Core::Candle> candles;
+    double price = 100.0;
+    for (std::size_t i = 0; i < n; ++i) {
+        price += step(rng);
+        const long long t = static_cast<long long>(i) * 60'000;
+        candles.emplace_back(t, price, price + 1, price - 1, price, 1.0, t + 59'999);
+    }
+    return candles;
+}
+
+std::vector<Core::Candle> from_closes(const std::vector<double>& closes) {
+    std::vector<Core::Candle> candles;
+    for (double c : closes) {
+        candles.emplace_back(0, c, c, c, c, 1.0, 0);
+    }
+    return candles;
+}
+
+} // namespace
+
+TEST(IndicatorTest, SmaAndEmaMatchTheirDefinitions) {
+    const auto candles = random_walk(2000);
+    const std::size_t period = 20;
+    const auto sma = Signal::sma_series(candles, period);
+    const auto ema = Signal::ema_series(candles, period);
+    ASSERT_EQ(sma.size(), candles.size());
+    EXPECT_EQ(sma[period - 2], 0.0);
+    EXPECT_EQ(ema[period - 2], 0.0);
+
+    const double k = 2.0 / (period + 1.0);
+    double expected_ema = 0.0;
+    for (std::size_t i = period - 1; i < candles.size(); ++i) {
+        double sum = 0.0;
+        for (std::size_t j = i + 1 - period; j <= i; ++j) {
+            sum += candles[j].close;
+        }
+        EXPECT_NEAR(sma[i], sum / period, 1e-9) << i;
+        expected_ema = i == period - 1 ? sum / period
+                                       : (candles[i].close - expected_ema) * k + expected_ema;
+        EXPECT_NEAR(ema[i], expected_ema, 1e-9) << i;
+    }
+    // The per-index functions are wrappers over the same objects.
+    for (std::size_t i : {std::size_t{19}, std::size_t{500}, std::size_t{1999}}) {
+        EXPECT_NEAR(Signal::simple_moving_average(candles, i, period), sma[i], 1e-9);
+        EXPECT_DOUBLE_EQ(Signal::exponential_moving_average(candles, i, period), ema[i]);
+    }
+}
+
+TEST(IndicatorTest, RsiUsesWilderSmoothing) {
+    const auto candles = from_closes({1.0, 2.0, 3.0, 2.0, 2.0});
+    const auto rsi = Signal::rsi_series(candles, 2);
+    EXPECT_EQ(rsi[1], 0.0);    // one change is not enough
+    EXPECT_EQ(rsi[2], 100.0);  // averages 1 / 0
+    EXPECT_DOUBLE_EQ(rsi[3], 50.0);  // gain (1 + 0) / 2, loss (0 + 1) / 2
+    EXPECT_DOUBLE_EQ(rsi[4], 50.0);  // both halve
+    EXPECT_DOUBLE_EQ(Signal::relative_strength_index(candles, 3, 2), rsi[3]);
+
+    Signal::Rsi incremental(2);
+    for (const auto& c : candles) {
+        incremental.update(c.close);
+    }
+    EXPECT_DOUBLE_EQ(incremental.value(), rsi[4]);
+    incremental.reset();
+    EXPECT_FALSE(incremental.ready());
+}
+
+TEST(IndicatorTest, MacdSignalIsEmaOfTheLine) {
+    const auto candles = random_walk(500);
+    const auto macd = Signal::macd_series(candles, 12, 26, 9);
+    Signal::Ema fast(12), slow(26), signal(9);
+    for (std::size_t i = 0; i < candles.size(); ++i) {
+        fast.update(candles[i].close);
+        slow.update(candles[i].close);
+        if (slow.ready()) {
+            signal.update(fast.value() - slow.value());
+        }
+        if (i < 26 + 9 - 2) {
+            EXPECT_EQ(macd[i].signal, 0.0) << i;
+            continue;
+        }
+        EXPECT_DOUBLE_EQ(macd[i].macd, fast.value() - slow.value());
+        EXPECT_DOUBLE_EQ(macd[i].signal, signal.value());
+        EXPECT_DOUBLE_EQ(macd[i].histogram, macd[i].macd - macd[i].signal);
+    }
+    const auto at = Signal::macd(candles, 300, 12, 26, 9);
+    EXPECT_DOUBLE_EQ(at.macd, macd[300].macd);
+    EXPECT_DOUBLE_EQ(at.signal, macd[300].signal);
+}
+
+TEST(IndicatorTest, SeriesSignalsMatchPerIndexSignals) {
+    const auto candles = random_walk(400, 11);
+    const auto sma = Signal::sma_crossover_signals(candles, 5, 20);
+    const auto ema = Signal::ema_signals(candles, 10);
+    const auto rsi = Signal::rsi_signals(candles, 14, 30.0, 70.0);
+    const auto macd = Signal::macd_signals(candles, 12, 26, 9);
+    int crossings = 0;
+    for (std::size_t i = 0; i < candles.size(); ++i) {
+        EXPECT_EQ(sma[i], Signal::sma_crossover_signal(candles, i, 5, 20)) << i;
+        EXPECT_EQ(ema[i], Signal::ema_signal(candles, i, 10)) << i;
+        EXPECT_EQ(rsi[i], Signal::rsi_signal(candles, i, 14, 30.0, 70.0)) << i;
+        EXPECT_EQ(macd[i], Signal::macd_signal(candles, i, 12, 26, 9)) << i;
+        crossings += std::abs(sma[i]) + std::abs(macd[i]);
+    }
+    EXPECT_GT(crossings, 0);
+    // No signal before the indicator exists at the previous index.
+    EXPECT_EQ(ema[10 - 1], 0);
+    EXPECT_EQ(macd[26 + 9 - 2], 0);
+}
+
+TEST(SignalBotTest, BacktestUsesOnePassSignals) {
+    const auto candles = random_walk(1000, 3);
+    Config::SignalConfig cfg;
+    cfg.type = "rsi";
+    cfg.short_period = 14;
+    cfg.params = {{"oversold", 40.0}, {"overbought", 60.0}};
+    SignalBot bot(cfg);
+    for (std::size_t i = 0; i < candles.size(); i += 37) {
+        EXPECT_EQ(bot.generate_signal(candles, i),
+                  Signal::rsi_signal(candles, i, 14, 40.0, 60.0)) << i;
+    }
+    Core::Backtester backtester(candles, bot);
+    const auto result = backtester.run();
+    EXPECT_FALSE(result.trades.empty());
+
+    // A different series invalidates the cached signals.
+    auto shifted = candles;
+    shifted.back().close += 50.0;
+    EXPECT_EQ(bot.generate_signal(shifted, shifted.size() - 1),
+              Signal::rsi_signal(shifted, shifted.size() - 1, 14, 40.0, 60.0));
+}
+
+TEST(IndicatorCacheTest, ExtendsAppendedAndUpdatedBarsIncrementally) {
+    const auto all = random_walk(600, 17);
+    std::vector<Core::Candle> candles(all.begin(), all.begin() + 500);
+    Signal::IndicatorCache cache;
+    const auto macd_spec = Signal::IndicatorSpec::macd(12, 26, 9);
+    auto expect_exact = [&](const std::vector<Core::Candle>& series) {
+        EXPECT_EQ(cache.get("X|1m", 0, series, Signal::IndicatorSpec::sma(20))->values,
+                  Signal::sma_series(series, 20));
+        EXPECT_EQ(cache.get("X|1m", 0, series, Signal::IndicatorSpec::rsi(14))->values,
+                  Signal::rsi_series(series, 14));
+        const auto macd = cache.get("X|1m", 0, series, macd_spec);
+        const auto reference = Signal::macd_series(series, 12, 26, 9);
+        ASSERT_EQ(macd->signal.size(), reference.size());
+        for (std::size_t i = 0; i < reference.size(); ++i) {
+            EXPECT_EQ(macd->values[i], reference[i].macd);
+            EXPECT_EQ(macd->signal[i], reference[i].signal);
+            EXPECT_EQ(macd->histogram[i], reference[i].histogram);
+        }
+    };
+
+    expect_exact(candles);
+    EXPECT_EQ(cache.stats().misses, 3u);
+    const auto held = cache.get("X|1m", 0, candles, Signal::IndicatorSpec::sma(20));
+    EXPECT_EQ(cache.stats().hits, 1u);
+
+    // New bars, then an in-place update of the forming bar.
+    candles.insert(candles.end(), all.begin() + 500, all.end());
+    expect_exact(candles);
+    candles.back().close += 3.0;
+    expect_exact(candles);
+    auto stats = cache.stats();
+    EXPECT_EQ(stats.misses, 3u);
+    EXPECT_EQ(stats.extensions, 6u);
+    // The snapshot taken before the append is unchanged.
+    EXPECT_EQ(held->values.size(), 500u);
+
+    // A rewritten history needs a new version, a different series is a miss.
+    candles[100].close += 1.0;
+    EXPECT_EQ(cache.get("X|1m", 1, candles, Signal::IndicatorSpec::sma(20))->values,
+              Signal::sma_series(candles, 20));
+    EXPECT_TRUE(cache.get("Y|1m", 0, candles, Signal::IndicatorSpec::sma(20)) != nullptr);
+    EXPECT_EQ(cache.stats().misses, 5u);
+    cache.invalidate("X|1m");
+    EXPECT_EQ(cache.stats().entries, 1u);
+
+    // Field columns also follow fields other than the close.
+    const auto high = Signal::IndicatorSpec::column(Signal::IndicatorKind::High);
+    EXPECT_EQ(cache.get("X|1m", 0, candles, high)->values.back(), candles.back().high);
+    candles.back().high += 2.0;
+    EXPECT_EQ(cache.get("X|1m", 0, candles, high)->values.back(), candles.back().high);
+    candles[candles.size() - 2].high += 2.0;
+    EXPECT_EQ(cache.get("X|1m", 0, candles, high)->values[candles.size() - 2],
+              candles[candles.size() - 2].high);
+}
+
+TEST(IndicatorCacheTest, EvictsLeastRecentlyUsedOverTheCap) {
+    const auto candles = random_walk(1000);
+    Signal::IndicatorCache cache(3 * 1000 * sizeof(double));
+    const auto first = cache.get("A|1m", 0, candles, Signal::IndicatorSpec::ema(10));
+    (void)cache.get("B|1m", 0, candles, Signal::IndicatorSpec::ema(10));
+    (void)cache.get("A|1m", 0, candles, Signal::IndicatorSpec::ema(10));
+    (void)cache.get("C|1m", 0, candles, Signal::IndicatorSpec::ema(10));
+    auto stats = cache.stats();
+    EXPECT_EQ(stats.entries, 2u);
+    EXPECT_EQ(stats.evictions, 1u);
+    EXPECT_LE(stats.bytes, 3 * 1000 * sizeof(double));
+    // B was the least recently used.
+    (void)cache.get("A|1m", 0, candles, Signal::IndicatorSpec::ema(10));
+    EXPECT_EQ(cache.stats().hits, 2u);
+    (void)cache.get("B|1m", 0, candles, Signal::IndicatorSpec::ema(10));
+    EXPECT_EQ(cache.stats().misses, 4u);
+    // Evicted results stay valid for holders.
+    EXPECT_EQ(first->values, Signal::ema_series(candles, 10));
+}
+
+TEST(IndicatorCacheTest, SignalBotsShareNamedSeries) {
+    const auto candles = random_walk(800, 23);
+    Signal::IndicatorCache::instance().clear();
+    const auto before = Signal::IndicatorCache::instance().stats();
+    Config::SignalConfig cfg;
+    cfg.type = "sma_crossover";
+    cfg.short_period = 5;
+    cfg.long_period = 20;
+    SignalBot first(cfg);
+    first.set_series(Signal::series_id("X", "1m"));
+    SignalBot second(cfg);
+    second.set_series(Signal::series_id("X", "1m"));
+    const auto expected = Signal::sma_crossover_signals(candles, 5, 20);
+    for (std::size_t i = 0; i < candles.size(); i += 13) {
+        EXPECT_EQ(first.generate_signal(candles, i), expected[i]) << i;
+        EXPECT_EQ(second.generate_signal(candles, i), expected[i]) << i;
+    }
+    const auto after = Signal::IndicatorCache::instance().stats();
+    EXPECT_EQ(after.misses - before.misses, 2u);  // short and long SMA, once
+    EXPECT_EQ(after.hits - before.hits, 2u);
+
+    cfg.type = "ema";
+    cfg.short_period = 10;
+    first.set_config(cfg);
+    const auto ema = Signal::ema_signals(candles, 10);
+    for (std::size_t i = 0; i < candles.size(); i += 13) {
+        EXPECT_EQ(first.generate_signal(candles, i), ema[i]) << i;
+    }
+}
+
+TEST(StrategyTest, FactoryResolvesConfigIntoPolicies) {
+    const auto candles = random_walk(700, 29);
+    auto run = [&](const Config::SignalConfig& cfg, std::string_view expected_name) {
+        const auto strategy = Signal::make_strategy(cfg);
+        EXPECT_EQ(strategy->name(), expected_name);
+        std::vector<int> out(candles.size(), 7);
+        strategy->generate_signals({candles}, out);
+        return out;
+    };
+    Config::SignalConfig cfg;
+    cfg.type = "sma_crossover";
+    cfg.short_period = 5;
+    cfg.long_period = 20;
+    EXPECT_EQ(run(cfg, "sma_crossover"), Signal::sma_crossover_signals(candles, 5, 20));
+
+    cfg = {};
+    cfg.type = "ema";
+    cfg.params = {{"period", 12.0}};
+    EXPECT_EQ(run(cfg, "ema"), Signal::ema_signals(candles, 12));
+
+    cfg.type = "rsi";
+    cfg.short_period = 10;
+    cfg.params = {{"oversold", 35.0}};
+    EXPECT_EQ(run(cfg, "rsi"), Signal::rsi_signals(candles, 10, 35.0, 70.0));
+
+    cfg = {};
+    cfg.type = "macd";
+    EXPECT_EQ(run(cfg, "macd"), Signal::macd_signals(candles, 12, 26, 9));
+
+    // Invalid settings hold instead of failing per candle.
+    const std::vector<int> hold(candles.size(), 0);
+    cfg = {};
+    cfg.type = "ema";
+    cfg.params = {{"period", 2.5}};
+    EXPECT_EQ(run(cfg, "none"), hold);
+    cfg.type = "sma_crossover";
+    cfg.short_period = 20;
+    cfg.long_period = 5;
+    EXPECT_EQ(run(cfg, "none"), hold);
+    cfg.type = "bollinger";
+    EXPECT_EQ(run(cfg, "none"), hold);
+}
+
+TEST(StrategyTest, BacktesterEvaluatesTheSeriesOnce) {
+    // Counts calls to show how the backtester drives a strategy.
+    class Counting : public Core::IStrategy {
+    public:
+        int generate_signal(const std::vector<Core::Candle>&, size_t index) override {
+            ++per_index;
+            return index % 10 == 0 ? 1 : (index % 10 == 5 ? -1 : 0);
+        }
+        int per_index = 0;
+    };
+    const auto candles = random_walk(100);
+    Counting counting;
+    const auto fallback = Core::Backtester(candles, counting).run();
+    EXPECT_EQ(counting.per_index, 100);
+    EXPECT_EQ(fallback.trades.size(), 10u);
+
+    Config::SignalConfig cfg;
+    cfg.type = "macd";
+    SignalBot bot(cfg);
+    const auto batch = Core::Backtester(candles, bot).run();
+    const auto expected = Signal::macd_signals(candles, 12, 26, 9);
+    std::size_t entries = 0;
+    bool in_position = false;
+    for (int sig : expected) {
+        if (!in_position && sig > 0) {
+            in_position = true;
+            ++entries;
+        } else if (in_position && sig < 0) {
+            in_position = false;
+        }
+    }
+    EXPECT_EQ(batch.trades.size(), entries);
+}
+
+TEST(RuleProgramTest, SharesSubexpressionsAndReportsErrors) {
+    std::string error;
+    const auto program = Signal::RuleProgram::compile("rsi(14) < 30 and close > ema(2 * 100)",
+                                                      "rsi(14) > 70 or 30 > rsi(14)", error);
+    ASSERT_TRUE(program) << error;
+    using Op = Signal::RuleProgram::Op;
+    // rsi(14) is one input and one instruction for both rules; 2 * 100 is
+    // folded and the period read from the constant.
+    ASSERT_EQ(program->inputs().size(), 3u);
+    EXPECT_EQ(program->inputs()[1].spec, Signal::IndicatorSpec::column(Signal::IndicatorKind::Close));
+    EXPECT_EQ(program->inputs()[2].spec, Signal::IndicatorSpec::ema(200));
+    const auto& code = program->code();
+    EXPECT_EQ(std::count_if(code.begin(), code.end(), [](const auto& in) { return in.op == Op::Input; }), 3);
+    EXPECT_EQ(std::count_if(code.begin(), code.end(), [](const auto& in) { return in.op == Op::Mul; }), 0);
+    EXPECT_EQ(std::count_if(code.begin(), code.end(), [](const auto& in) { return in.op == Op::Lt; }), 1);
+    EXPECT_EQ(program->lookback(), 0u);
+    EXPECT_EQ(Signal::RuleProgram::compile("cross_above(prev(close, 3), sma(5))", "", error)->lookback(), 4u);
+
+    auto fails = [&](std::string_view buy, std::string_view sell) {
+        error.clear();
+        EXPECT_FALSE(Signal::RuleProgram::compile(buy, sell, error)) << buy;
+        return error;
+    };
+    EXPECT_EQ(fails("close > ", ""), "buy: unexpected end of rule at column 9");
+    EXPECT_EQ(fails("close > 1", "rsi(14) >> 70"), "sell: unexpected '>' at column 10");
+    EXPECT_EQ(fails("closes > 1", ""), "buy: unknown name 'closes' at column 1");
+    EXPECT_EQ(fails("sma(close) > 1", ""), "buy: sma() needs positive whole-number periods at column 1");
+    EXPECT_EQ(fails("macd(26, 12, 9) > 0", ""),
+              "buy: macd() needs the fast period below the slow one at column 1");
+    EXPECT_EQ(fails("1 < vwap(20)", ""), "buy: unknown function 'vwap' at column 5");
+    EXPECT_EQ(fails("(close > 1", ""), "buy: expected ')' at column 11");
+}
+
+TEST(RuleProgramTest, MatchesBuiltInStrategies) {
+    const auto candles = random_walk(1500, 31);
+    auto run = [&](std::string_view buy, std::string_view sell) {
+        std::string error;
+        const auto program = Signal::RuleProgram::compile(buy, sell, error);
+        EXPECT_TRUE(program) << error;
+        std::vector<int> out(candles.size(), 7);
+        if (program) {
+            program->run({candles}, 0, out);
+        }
+        return out;
+    };
+    EXPECT_EQ(run("cross_above(sma(5), sma(20))", "cross_below(sma(5), sma(20))"),
+              Signal::sma_crossover_signals(candles, 5, 20));
+    EXPECT_EQ(run("cross_above(close, ema(10))", "cross_below(close, ema(10))"),
+              Signal::ema_signals(candles, 10));
+    EXPECT_EQ(run("rsi(14) < 30", "rsi(14) > 70"), Signal::rsi_signals(candles, 14, 30.0, 70.0));
+    EXPECT_EQ(run("cross_above(macd(12, 26, 9), macd_signal(12, 26, 9))",
+                  "macd_hist(12, 26, 9) < 0 and prev(macd_hist(12, 26, 9)) >= 0"),
+              Signal::macd_signals(candles, 12, 26, 9));
+
+    // Unknown values never fire, and not/or follow three-valued logic.
+    const auto warm = run("not (sma(50) < close) or 1 > 2", "");
+    EXPECT_TRUE(std::all_of(warm.begin(), warm.begin() + 49, [](int s) { return s == 0; }));
+    EXPECT_EQ(run("close > 0 or sma(50) > 0", "")[0], 1);
+    EXPECT_EQ(run("close < 0 and sma(50) > 0", "close > 0")[0], -1);
+
+    Config::SignalConfig cfg;
+    cfg.type = "expression";
+    cfg.buy = "rsi(14) < 30";
+    cfg.sell = "rsi(14) > 70";
+    const auto strategy = Signal::make_strategy(cfg);
+    EXPECT_EQ(strategy->name(), "expression");
+    cfg.buy = "rsi(14) <";
+    EXPECT_EQ(Signal::make_strategy(cfg)->name(), "none");
+}
+
+TEST(RuleProgramTest, UpdatesOnlyAppendedBars) {
+    // Longer than a block, with prev() chains reaching across blocks.
+    const auto candles = random_walk(3 * Signal::RuleProgram::kBlock + 77, 37);
+    std::string error;
+    const auto program = Signal::RuleProgram::compile(
+        "cross_above(prev(close, 3), prev(sma(8), 2)) and volume >= prev(volume, 40)",
+        "prev(rsi(6)) > 60 and abs(close - prev(close, 5)) > 0.5", error);
+    ASSERT_TRUE(program) << error;
+    std::vector<int> full(candles.size());
+    program->run({candles}, 0, full);
+    ASSERT_TRUE(std::any_of(full.begin(), full.end(), [](int s) { return s > 0; }));
+    ASSERT_TRUE(std::any_of(full.begin(), full.end(), [](int s) { return s < 0; }));
+
+    for (std::size_t from : {1u, 45u, 511u, 512u, 700u, 1500u}) {
+        std::vector<int> part = full;
+        std::fill(part.begin() + from, part.end(), 7);
+        program->run({candles}, from, part);
+        EXPECT_EQ(part, full) << from;
+    }
+
+    // The bot extends its signals as bars arrive instead of starting over.
+    Config::SignalConfig cfg;
+    cfg.type = "expression";
+    cfg.buy = "cross_above(close, prev(ema(20), 2))";
+    cfg.sell = "cross_below(close, prev(ema(20), 2))";
+    SignalBot bot(cfg);
+    bot.set_series(Signal::series_id("RULEUSDT", "1m"));
+    std::vector<Core::Candle> live(candles.begin(), candles.begin() + 600);
+    std::vector<int> expected(candles.size());
+    Signal::make_strategy(cfg)->generate_signals({candles}, expected);
+    for (std::size_t n = 600; n <= candles.size(); n += 113) {
+        live.assign(candles.begin(), candles.begin() + n);
+        for (std::size_t i = 0; i < n; ++i) {
+            ASSERT_EQ(bot.generate_signal(live, i), expected[i]) << n << " " << i;
+        }
+    }
+}
+
+namespace {
+
+// Candles of `minutes` minutes built from one-minute candles; the last one
+// may still be forming.
+std::vector<Core::Candle> aggregate(const std::vector<Core::Candle>& candles, long long minutes) {
+    const long long span = minutes * 60'000;
+    std::vector<Core::Candle> out;
+    for (const auto& c : candles) {
+        const long long open = c.open_time - c.open_time % span;
+        if (out.empty() || out.back().open_time != open) {
+            out.emplace_back(open, c.open, c.high, c.low, c.close, c.volume, open + span - 1);
+            continue;
+        }
+        auto& bar = out.back();
+        bar.high = std::max(bar.high, c.high);
+        bar.low = std::min(bar.low, c.low);
+        bar.close = c.close;
+        bar.volume += c.volume;
+    }
+    return out;
+}
+
+// buy: close > ema(10)@15m, sell: close < close@15m, evaluated by hand.
+std::vector<int> trend_rule_signals(const std::vector<Core::Candle>& lower,
+                                    const Core::AlignedSeries& frame) {
+    const auto& higher = *frame.candles;
+    const auto ema = Signal::compute_indicator(higher, Signal::IndicatorSpec::ema(10));
+    std::vector<int> out(lower.size(), 0);
+    for (std::size_t i = 0; i < lower.size(); ++i) {
+        const std::int32_t k = frame.aligned[i];
+        if (k >= 9 && lower[i].close > ema.values[k]) {
+            out[i] = 1;
+        } else if (k >= 0 && lower[i].close < higher[k].close) {
+            out[i] = -1;
+        }
+    }
+    return out;
+}
+
+} // namespace
+
+TEST(RuleProgramTest, ReadsAlignedTimeframes) {
+    std::map<std::string, std::vector<Core::Candle>> intervals;
+    intervals["1m"] = random_walk(1200, 43);
+    intervals["15m"] = aggregate(intervals["1m"], 15);
+    Core::TimeframeAlignments alignments;
+    const auto frames = alignments.align("MTFUSDT", intervals, "1m");
+    ASSERT_EQ(frames.size(), 1u);
+    const auto& lower = intervals["1m"];
+    const auto expected = trend_rule_signals(lower, frames[0]);
+    ASSERT_TRUE(std::any_of(expected.begin(), expected.end(), [](int s) { return s > 0; }));
+    ASSERT_TRUE(std::any_of(expected.begin(), expected.end(), [](int s) { return s < 0; }));
+
+    std::string error;
+    const auto program =
+        Signal::RuleProgram::compile("close > ema(10)@15m", "close < close@15m", error);
+    ASSERT_TRUE(program) << error;
+    EXPECT_EQ(program->inputs()[1].interval, "15m");
+    const std::string id = Signal::series_id("MTFUSDT", "1m");
+    for (std::string_view view_id : {std::string_view(), std::string_view(id)}) {
+        std::vector<int> out(lower.size());
+        program->run({lower, view_id, 0, frames}, 0, out);
+        EXPECT_EQ(out, expected);
+    }
+    // Without the interval in the view the rule never fires.
+    std::vector<int> out(lower.size(), 5);
+    program->run({lower, id}, 0, out);
+    EXPECT_TRUE(std::all_of(out.begin(), out.end(), [](int s) { return s == 0; }));
+    // The view's own interval reads the candles themselves.
+    const auto own = Signal::RuleProgram::compile("close@1m > ema(10)@1m", "", error);
+    const auto plain = Signal::RuleProgram::compile("close > ema(10)", "", error);
+    std::vector<int> a(lower.size()), b(lower.size());
+    own->run({lower, id}, 0, a);
+    plain->run({lower, id}, 0, b);
+    EXPECT_EQ(a, b);
+
+    error.clear();
+    EXPECT_FALSE(Signal::RuleProgram::compile("close@1x > 1", "", error));
+    EXPECT_EQ(error, "buy: unknown interval '1x' at column 6");
+    EXPECT_FALSE(Signal::RuleProgram::compile("abs(close)@1h > 1", "", error));
+    EXPECT_EQ(error, "buy: abs() takes no interval at column 1");
+}
+
+TEST(SignalBotTest, FollowsAppendedTimeframes) {
+    const auto candles = random_walk(900, 47);
+    Config::SignalConfig cfg;
+    cfg.type = "expression";
+    cfg.buy = "close > ema(10)@15m";
+    cfg.sell = "close < close@15m";
+    SignalBot bot(cfg);
+    bot.set_series(Signal::series_id("MTFBOT", "1m"));
+    std::map<std::string, std::vector<Core::Candle>> live;
+    Core::TimeframeAlignments alignments;
+    for (std::size_t n = 200; n <= candles.size(); n += 37) {
+        // The forming 15m candle changes with every minute.
+        live["1m"].assign(candles.begin(), candles.begin() + n);
+        live["15m"] = aggregate(live["1m"], 15);
+        const auto frames = alignments.align("MTFBOT", live, "1m");
+        bot.set_timeframes(frames);
+        const auto expected = trend_rule_signals(live["1m"], frames[0]);
+        for (std::size_t i = 0; i < n; ++i) {
+            ASSERT_EQ(bot.generate_signal(live["1m"], i), expected[i]) << n << " " << i;
+        }
+    }
+}
+
+TEST(SignalBotTest, NewVersionsRecomputeRewrittenHistory) {
+    auto candles = random_walk(400, 53);
+    Config::SignalConfig cfg;
+    cfg.type = "sma_crossover";
+    cfg.short_period = 5;
+    cfg.long_period = 20;
+    SignalBot bot(cfg);
+    const std::string id = Signal::series_id("REWRITE", "1m");
+    bot.set_series(id, 1);
+    for (std::size_t i = 0; i < candles.size(); ++i) {
+        bot.generate_signal(candles, i);
+    }
+    // A bar well before the last one changes in place, as a merge filling a
+    // gap would; the first and second-to-last candles stay the same, so
+    // under the old version the stored result is served as is.
+    candles[150].close += 25.0;
+    auto& cache = Signal::IndicatorCache::instance();
+    const auto sma = Signal::IndicatorSpec::sma(5);
+    const auto fresh = Signal::compute_indicator(candles, sma);
+    EXPECT_NE(cache.get(id, 1, candles, sma)->values[152], fresh.values[152]);
+
+    bot.set_series(id, 2);
+    const auto expected = Signal::sma_crossover_signals(candles, 5, 20);
+    for (std::size_t i = 0; i < candles.size(); ++i) {
+        ASSERT_EQ(bot.generate_signal(candles, i), expected[i]) << i;
+    }
+    EXPECT_EQ(cache.get(id, 2, candles, sma)->values, fresh.values);
+
+    // The same for another interval read through a timeframe.
+    cfg.type = "expression";
+    cfg.buy = "close > ema(10)@15m";
+    cfg.sell = "close < close@15m";
+    SignalBot mtf(cfg);
+    mtf.set_series(Signal::series_id("REWRITEMTF", "1m"));
+    std::map<std::string, std::vector<Core::Candle>> live;
+    live["1m"] = random_walk(900, 59);
+    live["15m"] = aggregate(live["1m"], 15);
+    Core::TimeframeAlignments alignments;
+    auto frames = alignments.align("REWRITEMTF", live, "1m");
+    mtf.set_timeframes(frames);
+    for (std::size_t i = 0; i < live["1m"].size(); ++i) {
+        mtf.generate_signal(live["1m"], i);
+    }
+    live["15m"][20].close += 30.0;
+    frames = alignments.align("REWRITEMTF", live, "1m");
+    frames[0].version = 1;
+    mtf.set_timeframes(frames);
+    const auto trend = trend_rule_signals(live["1m"], frames[0]);
+    for (std::size_t i = 0; i < live["1m"].size(); ++i) {
+        ASSERT_EQ(mtf.generate_signal(live["1m"], i), trend[i]) << i;
+    }
+}
+
+namespace {
+
+// Restores the runtime-selected kernels when a test ends.
+class KernelIsaGuard {
+public:
+    explicit KernelIsaGuard(Signal::KernelIsa isa) : saved_(Signal::kernel_isa()) {
+        Signal::set_kernel_isa(isa);
+    }
+    ~KernelIsaGuard() { Signal::set_kernel_isa(saved_); }
+
+private:
+    Signal::KernelIsa saved_;
+};
+
+struct KernelOutputs {
+    std::vector<double> sma, ema, rsi, min, max, stddev, tr;
+};
+
+KernelOutputs run_kernels(const Signal::CandleColumns& cols, std::size_t period) {
+    const std::size_t n = cols.close.size();
+    KernelOutputs o{std::vector<double>(n), std::vector<double>(n), std::vector<double>(n),
+                    std::vector<double>(n), std::vector<double>(n), std::vector<double>(n),
+                    std::vector<double>(n)};
+    Signal::compute_sma(cols.close, period, o.sma);
+    Signal::compute_ema(cols.close, period, o.ema);
+    Signal::compute_rsi(cols.close, period, o.rsi);
+    Signal::compute_rolling_min(cols.low, period, o.min);
+    Signal::compute_rolling_max(cols.high, period, o.max);
+    Signal::compute_rolling_stddev(cols.close, period, o.stddev);
+    Signal::compute_true_range(cols.high, cols.low, cols.close, o.tr);
+    return o;
+}
+
+} // namespace
+
+TEST(IndicatorKernelTest, ScalarKernelsMatchReferenceIndicators) {
+    KernelIsaGuard guard(Signal::KernelIsa::Scalar);
+    const auto candles = random_walk(3000, 5);
+    const auto cols = Signal::to_columns(candles);
+    for (std::size_t period : {1u, 2u, 14u, 50u}) {
+        const auto o = run_kernels(cols, period);
+        EXPECT_EQ(o.sma, Signal::sma_series(candles, period)) << period;
+        EXPECT_EQ(o.ema, Signal::ema_series(candles, period)) << period;
+        EXPECT_EQ(o.rsi, Signal::rsi_series(candles, period)) << period;
+        for (std::size_t i = period - 1; i < candles.size(); i += 7) {
+            double lo = candles[i].low, hi = candles[i].high, mean = 0.0, sq = 0.0;
+            for (std::size_t j = i + 1 - period; j <= i; ++j) {
+                lo = std::min(lo, candles[j].low);
+                hi = std::max(hi, candles[j].high);
+                mean += candles[j].close / period;
+            }
+            for (std::size_t j = i + 1 - period; j <= i; ++j) {
+                sq += (candles[j].close - mean) * (candles[j].close - mean) / period;
+            }
+            EXPECT_EQ(o.min[i], lo);
+            EXPECT_EQ(o.max[i], hi);
+            EXPECT_NEAR(o.stddev[i], std::sqrt(sq), 1e-9) << i;
+        }
+        EXPECT_EQ(o.tr[0], candles[0].high - candles[0].low);
+        EXPECT_EQ(o.tr[10], std::max({candles[10].high - candles[10].low,
+                                      std::fabs(candles[10].high - candles[9].close),
+                                      std::fabs(candles[10].low - candles[9].close)}));
+    }
+    // A short output span is filled only as far as it reaches.
+    std::vector<double> out(5, -1.0);
+    Signal::compute_sma(std::span<const double>(cols.close).first(3), 2, out);
+    EXPECT_EQ(out[0], 0.0);
+    EXPECT_EQ(out[3], -1.0);
+}
+
+TEST(IndicatorKernelTest, Avx2KernelsMatchScalarKernels) {
+    if (!Signal::avx2_available()) {
+        GTEST_SKIP() << "AVX2 not available on this CPU";
+    }
+    // Long enough to cross several resum points, and lengths that leave
+    // every possible remainder after the 4-wide blocks.
+    for (std::size_t n : {1u, 3u, 6u, 37u, 2049u, 20003u}) {
+        const auto cols = Signal::to_columns(random_walk(n, static_cast<unsigned>(n)));
+        for (std::size_t period : {1u, 2u, 3u, 14u, 200u, 700u}) {
+            KernelOutputs scalar, vector;
+            {
+                KernelIsaGuard guard(Signal::KernelIsa::Scalar);
+                scalar = run_kernels(cols, period);
+            }
+            {
+                KernelIsaGuard guard(Signal::KernelIsa::Avx2);
+                ASSERT_EQ(Signal::kernel_isa(), Signal::KernelIsa::Avx2);
+                vector = run_kernels(cols, period);
+            }
+            EXPECT_EQ(vector.min, scalar.min) << n << " " << period;
+            EXPECT_EQ(vector.max, scalar.max) << n << " " << period;
+            EXPECT_EQ(vector.tr, scalar.tr) << n << " " << period;
+            auto close = [&](const std::vector<double>& a, const std::vector<double>& b,
+                             double tol, const char* name) {
+                for (std::size_t i = 0; i < a.size(); ++i) {
+                    ASSERT_NEAR(a[i], b[i], tol * std::max(1.0, std::fabs(b[i])))
+                        << name << " n=" << n << " period=" << period << " i=" << i;
+                }
+            };
+            close(vector.sma, scalar.sma, 1e-12, "sma");
+            close(vector.ema, scalar.ema, 1e-12, "ema");
+            close(vector.rsi, scalar.rsi, 1e-9, "rsi");
+            // The sums carry an absolute error in the variance, which the
+            // square root magnifies when the spread is near zero.
+            std::vector<double> var_vector(n), var_scalar(n);
+            for (std::size_t i = 0; i < n; ++i) {
+                var_vector[i] = vector.stddev[i] * vector.stddev[i];
+                var_scalar[i] = scalar.stddev[i] * scalar.stddev[i];
+            }
+            close(var_vector, var_scalar, 1e-10, "variance");
+        }
+    }
+}
+
+TEST(RuleProgramTest, Avx2BlocksMatchScalarBlocks) {
+    if (!Signal::avx2_available()) {
+        GTEST_SKIP() << "AVX2 not available on this CPU";
+    }
+    // Zeros, unknowns and both signs reach every operator.
+    const auto candles = random_walk(2 * Signal::RuleProgram::kBlock + 13, 41);
+    std::string error;
+    const auto program = Signal::RuleProgram::compile(
+        "(rsi(5) - 50) * (close - prev(close)) / abs(close - open + 0.5) > min(1, max(-1, close - ema(9)))"
+        " or not (close != prev(close, 2)) and prev(sma(3)) <= sma(3)",
+        "(rsi(5) >= 60 or -close == -prev(close, 3)) and not (close < ema(9))", error);
+    ASSERT_TRUE(program) << error;
+    auto run = [&](Signal::KernelIsa isa) {
+        KernelIsaGuard guard(isa);
+        std::vector<int> out(candles.size(), 7);
+        program->run({candles}, 0, out);
+        return out;
+    };
+    const auto scalar = run(Signal::KernelIsa::Scalar);
+    EXPECT_EQ(run(Signal::KernelIsa::Avx2), scalar);
+    EXPECT_TRUE(std::count(scalar.begin(), scalar.end(), 1) > 0);
+    EXPECT_TRUE(std::count(scalar.begin(), scalar.end(), -1) > 0);
+}
@@ -0,0 +1,170 @@
+#include <gtest/gtest.h>
+#include "core/timeframe_alignment.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+using Core::Candle;
+using Core::TimeframeAlignment;
+using namespace std::chrono_literals;
+
+namespace {
+
+constexpr long long kMinute = 60'000;
+constexpr long long kHour = 60 * kMinute;
+
+// Minute candles with about one in ten missing.
+std::vector<Candle> minutes(std::size_t count, std::mt19937& rng, long long start = 0) {
+    std::vector<Candle> out;
+    std::bernoulli_distribution gap(0.1);
+    for (long long t = start; out.size() < count; t += kMinute) {
+        if (!gap(rng)) {
+            out.emplace_back(t, 1.0, 1.0, 1.0, static_cast<double>(t / kMinute), 1.0);
+        }
+    }
+    return out;
+}
+
+// Hour candles for the hours the minute candles touch.
+std::vector<Candle> hours(const std::vector<Candle>& lower) {
+    std::vector<Candle> out;
+    for (const auto& c : lower) {
+        const long long open = c.open_time - c.open_time % kHour;
+        if (out.empty() || out.back().open_time != open) {
+            out.emplace_back(open, c.open, c.high, c.low, c.close, c.volume);
+        }
+    }
+    return out;
+}
+
+std::vector<std::int32_t> brute_force(const std::vector<Candle>& lower, long long lower_ms,
+                                      const std::vector<Candle>& higher, long long higher_ms) {
+    std::vector<std::int32_t> out;
+    for (const auto& c : lower) {
+        std::int32_t last = TimeframeAlignment::kNone;
+        for (std::size_t k = 0; k < higher.size(); ++k) {
+            if (higher[k].open_time + higher_ms <= c.open_time + lower_ms) {
+                last = static_cast<std::int32_t>(k);
+            }
+        }
+        out.push_back(last);
+    }
+    return out;
+}
+
+std::vector<std::int32_t> indices(const TimeframeAlignment& a) {
+    return {a.indices().begin(), a.indices().end()};
+}
+
+} // namespace
+
+TEST(TimeframeAlignmentTest, MatchesBruteForceWithGaps) {
+    std::mt19937 rng(3);
+    const auto lower = minutes(1000, rng);
+    auto higher = hours(lower);
+    higher.erase(higher.begin() + 5);  // an hour the exchange never sent
+
+    TimeframeAlignment a(1min, 1h);
+    EXPECT_EQ(a.update(lower, higher), 0u);
+    ASSERT_EQ(a.size(), lower.size());
+    EXPECT_EQ(indices(a), brute_force(lower, kMinute, higher, kHour));
+    // The 59th minute closes the first hour; earlier minutes see nothing.
+    EXPECT_EQ(a[0], TimeframeAlignment::kNone);
+    for (std::size_t i = 0; i < lower.size(); ++i) {
+        if (a[i] != TimeframeAlignment::kNone) {
+            EXPECT_LE(higher[a[i]].open_time + kHour, lower[i].open_time + kMinute);
+        }
+    }
+
+    // Any pair of intervals works, even a "higher" one that is shorter.
+    TimeframeAlignment reverse(1h, 1min);
+    reverse.update(higher, lower);
+    EXPECT_EQ(indices(reverse), brute_force(higher, kHour, lower, kMinute));
+}
+
+TEST(TimeframeAlignmentTest, AppendsOnlyRecomputeTheirBars) {
+    std::mt19937 rng(11);
+    const auto all_lower = minutes(1500, rng);
+    const auto all_higher = hours(all_lower);
+    std::vector<Candle> lower;
+    std::vector<Candle> higher;
+    TimeframeAlignment a(1min, 1h);
+    std::uniform_int_distribution<int> pick(0, 3);
+    std::size_t next_higher = 0;
+    while (lower.size() < all_lower.size()) {
+        // Minutes arrive in small batches; an hour bar sometimes arrives
+        // late, after the minutes that follow it.
+        const int step = pick(rng);
+        if (step == 0 && next_higher < all_higher.size()) {
+            higher.push_back(all_higher[next_higher++]);
+        } else {
+            for (int k = 0; k < step && lower.size() < all_lower.size(); ++k) {
+                lower.push_back(all_lower[lower.size()]);
+            }
+        }
+        const auto before = indices(a);
+        const std::size_t from = a.update(lower, higher);
+        const auto after = indices(a);
+        ASSERT_EQ(after, brute_force(lower, kMinute, higher, kHour));
+        std::size_t first_diff = after.size();
+        for (std::size_t i = 0; i < after.size(); ++i) {
+            if (i >= before.size() || before[i] != after[i]) {
+                first_diff = i;
+                break;
+            }
+        }
+        EXPECT_LE(from, first_diff);
+    }
+}
+
+TEST(TimeframeAlignmentTest, RebuildsRewrittenHistory) {
+    std::mt19937 rng(5);
+    auto lower = minutes(400, rng);
+    auto higher = hours(lower);
+    TimeframeAlignment a(1min, 1h);
+    a.update(lower, higher);
+
+    // Another series under the same key: every entry is rebuilt.
+    lower = minutes(300, rng, 30 * kMinute);
+    higher = hours(lower);
+    EXPECT_EQ(a.update(lower, higher), 0u);
+    EXPECT_EQ(indices(a), brute_force(lower, kMinute, higher, kHour));
+
+    // Fewer higher candles than before.
+    higher.pop_back();
+    higher.pop_back();
+    a.update(lower, higher);
+    EXPECT_EQ(indices(a), brute_force(lower, kMinute, higher, kHour));
+
+    // Nothing new: nothing changes.
+    EXPECT_EQ(a.update(lower, higher), lower.size());
+}
+
+TEST(TimeframeAlignmentsTest, AlignsEveryOtherInterval) {
+    std::mt19937 rng(2);
+    std::map<std::string, std::vector<Candle>> intervals;
+    intervals["1m"] = minutes(200, rng);
+    intervals["1h"] = hours(intervals["1m"]);
+    intervals["bogus"] = intervals["1h"];
+
+    Core::TimeframeAlignments alignments;
+    auto frames = alignments.align("BTCUSDT", intervals, "1m");
+    ASSERT_EQ(frames.size(), 1u);
+    EXPECT_EQ(frames[0].interval, "1h");
+    EXPECT_EQ(frames[0].candles, &intervals["1h"]);
+    const auto expected = brute_force(intervals["1m"], kMinute, intervals["1h"], kHour);
+    EXPECT_TRUE(std::equal(frames[0].aligned.begin(), frames[0].aligned.end(), expected.begin(),
+                           expected.end()));
+
+    // The next call extends the stored index.
+    intervals["1m"].emplace_back(intervals["1m"].back().open_time + kMinute, 1.0, 1.0, 1.0, 1.0, 1.0);
+    frames = alignments.align("BTCUSDT", intervals, "1m");
+    ASSERT_EQ(frames.size(), 1u);
+    EXPECT_EQ(frames[0].aligned.size(), intervals["1m"].size());
+
+    EXPECT_TRUE(alignments.align("BTCUSDT", intervals, "5m").empty());
+}